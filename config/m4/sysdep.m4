@@ -95,6 +95,20 @@ AC_CHECK_DECLS([ethtool_cmd_speed, SPEED_UNKNOWN], [], [],
                [#include <linux/ethtool.h>])
 
 
+#
+# Zero-copy socket send
+#
+AC_CHECK_DECLS([MSG_ZEROCOPY, SO_ZEROCOPY, SO_EE_ORIGIN_ZEROCOPY], [], [],
+               [#include <sys/socket.h>
+                #include <linux/errqueue.h>])
+
+
+#
+# io_uring event set
+#
+AC_CHECK_HEADERS([linux/io_uring.h])
+
+
 #
 # PowerPC query for TB frequency
 #
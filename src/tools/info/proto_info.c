@@ -134,6 +134,9 @@ void print_ucp_info(int print_opts, ucs_config_print_flags_t print_flags,
     if (!(dev_type_bitmap & UCS_BIT(UCT_DEVICE_TYPE_NET))) {
         ucp_config_modify(config, "NET_DEVICES", "");
     }
+    if (print_opts & PRINT_CALIBRATION) {
+        ucp_config_modify(config, "CALIBRATE", "refresh");
+    }
 
     status = ucp_init(&params, config, &context);
     if (status != UCS_OK) {
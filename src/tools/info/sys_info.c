@@ -11,6 +11,7 @@
 #include "ucx_info.h"
 
 #include <ucs/sys/sys.h>
+#include <ucs/sys/topo.h>
 #include <ucs/time/time.h>
 #include <ucs/config/parser.h>
 #include <ucs/config/global_opts.h>
@@ -85,6 +86,7 @@ void print_sys_info()
     printf("# Timer frequency: %.3f MHz\n", ucs_get_cpu_clocks_per_sec() / 1e6);
     printf("# CPU vendor: %s\n", cpu_vendor_names[ucs_arch_get_cpu_vendor()]);
     printf("# CPU model: %s\n", cpu_model_names[ucs_arch_get_cpu_model()]);
+    ucs_topo_print_info(stdout);
     ucs_arch_print_memcpy_limits(&ucs_global_opts.arch);
     printf("# Memcpy bandwidth:\n");
     for (size = 4096; size <= 256 * UCS_MBYTE; size *= 2) {
@@ -34,6 +34,7 @@ static void usage() {
     printf("  -p              Show UCP context information\n");
     printf("  -w              Show UCP worker information\n");
     printf("  -e              Show UCP endpoint configuration\n");
+    printf("  -k              Calibrate the transports and show the measured performance\n");
     printf("  -m <size>       Show UCP memory allocation method for a given size\n");
     printf("  -u <features>   UCP context features to use. String of one or more of:\n");
     printf("                    'a' : atomic operations\n");
@@ -77,7 +78,7 @@ int main(int argc, char **argv)
     mem_size                 = NULL;
     dev_type_bitmap          = UINT_MAX;
     ucp_ep_params.field_mask = 0;
-    while ((c = getopt(argc, argv, "fahvcydbswpet:n:u:D:m:N:")) != -1) {
+    while ((c = getopt(argc, argv, "fahvcydbswpekt:n:u:D:m:N:")) != -1) {
         switch (c) {
         case 'f':
             print_flags |= UCS_CONFIG_PRINT_CONFIG | UCS_CONFIG_PRINT_HEADER | UCS_CONFIG_PRINT_DOC;
@@ -112,6 +113,9 @@ int main(int argc, char **argv)
         case 'e':
             print_opts |= PRINT_UCP_EP;
             break;
+        case 'k':
+            print_opts |= PRINT_UCP_WORKER | PRINT_CALIBRATION;
+            break;
         case 'm':
             print_opts |= PRINT_MEM_MAP;
             mem_size = optarg;
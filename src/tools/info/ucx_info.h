@@ -20,7 +20,8 @@ enum {
     PRINT_UCP_CONTEXT    = UCS_BIT(5),
     PRINT_UCP_WORKER     = UCS_BIT(6),
     PRINT_UCP_EP         = UCS_BIT(7),
-    PRINT_MEM_MAP        = UCS_BIT(8)
+    PRINT_MEM_MAP        = UCS_BIT(8),
+    PRINT_CALIBRATION    = UCS_BIT(9)
 };
 
 
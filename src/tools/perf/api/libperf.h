@@ -56,6 +56,7 @@ typedef enum {
 typedef enum {
     UCP_PERF_DATATYPE_CONTIG,
     UCP_PERF_DATATYPE_IOV,
+    UCP_PERF_DATATYPE_STRIDED,
 } ucp_perf_datatype_t;
 
 
@@ -107,6 +108,8 @@ typedef struct ucx_perf_result {
     ucx_perf_counter_t      iters;
     double                  elapsed_time;
     ucx_perf_counter_t      bytes;
+    double                  cpu_util;       /* Process CPU time (user+system)
+                                               relative to elapsed time */
     struct {
         double              typical;
         double              moment_average; /* Average since last report */
@@ -17,6 +17,7 @@
 #include <ucs/sys/string.h>
 #include <string.h>
 #include <tools/perf/lib/libperf_int.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #if _OPENMP
@@ -268,11 +269,24 @@ static void uct_perf_test_free_mem(ucx_perf_context_t *perf)
     free(perf->uct.iov);
 }
 
+static double ucx_perf_get_cpu_time()
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) < 0) {
+        return 0.0;
+    }
+
+    return usage.ru_utime.tv_sec + (usage.ru_utime.tv_usec * 1e-6) +
+           usage.ru_stime.tv_sec + (usage.ru_stime.tv_usec * 1e-6);
+}
+
 void ucx_perf_test_start_clock(ucx_perf_context_t *perf)
 {
     ucs_time_t start_time = ucs_get_time();
 
     perf->start_time_acc   = ucs_get_accurate_time();
+    perf->start_cpu_time   = ucx_perf_get_cpu_time();
     perf->end_time         = (perf->params.max_time == 0.0) ? UINT64_MAX :
                               ucs_time_from_sec(perf->params.max_time) + start_time;
     perf->prev_time        = start_time;
@@ -329,6 +343,8 @@ void ucx_perf_calc_result(ucx_perf_context_t *perf, ucx_perf_result_t *result)
     result->iters = perf->current.iters;
     result->bytes = perf->current.bytes;
     result->elapsed_time = perf->current.time_acc - perf->start_time_acc;
+    result->cpu_util     = (ucx_perf_get_cpu_time() - perf->start_cpu_time) /
+                           result->elapsed_time;
 
     /* Latency */
     median = __find_median_quick_select(perf->timing_queue, TIMING_QUEUE_SIZE);
@@ -908,6 +924,11 @@ static ucs_status_t ucp_perf_test_fill_params(ucx_perf_params_t *params,
         ucp_params->field_mask  |= UCP_PARAM_FIELD_REQUEST_SIZE;
         ucp_params->request_size = sizeof(ucp_perf_request_t);
         break;
+    case UCX_PERF_CMD_AM:
+        ucp_params->features    |= UCP_FEATURE_AM;
+        ucp_params->field_mask  |= UCP_PARAM_FIELD_REQUEST_SIZE;
+        ucp_params->request_size = sizeof(ucp_perf_request_t);
+        break;
     default:
         if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
             ucs_error("Invalid test command");
@@ -941,6 +962,38 @@ static ucs_status_t ucp_perf_test_alloc_iov_mem(ucp_perf_datatype_t datatype,
     return UCS_OK;
 }
 
+/*
+ * Strided datatype made of the message size list: every entry is a block, and
+ * the blocks are iov_stride bytes apart, same as with the IOV datatype.
+ */
+static ucs_status_t
+ucp_perf_test_create_strided_dt(const ucx_perf_params_t *params,
+                                ucp_perf_datatype_t datatype,
+                                ucp_datatype_t *datatype_p)
+{
+    ucp_dt_stride_t dim;
+    size_t it;
+
+    *datatype_p = ucp_dt_make_contig(1);
+    if (UCP_PERF_DATATYPE_STRIDED != datatype) {
+        return UCS_OK;
+    }
+
+    for (it = 1; it < params->msg_size_cnt; ++it) {
+        if (params->msg_size_list[it] != params->msg_size_list[0]) {
+            ucs_error("strided datatype requires equal message sizes, "
+                      "got %zu and %zu", params->msg_size_list[0],
+                      params->msg_size_list[it]);
+            return UCS_ERR_INVALID_PARAM;
+        }
+    }
+
+    dim.count  = params->msg_size_cnt;
+    dim.stride = params->iov_stride ? params->iov_stride :
+                 params->msg_size_list[0];
+    return ucp_dt_create_strided(params->msg_size_list[0], &dim, 1, datatype_p);
+}
+
 static ucs_status_t
 ucp_perf_test_alloc_host(const ucx_perf_context_t *perf, size_t length,
                          void **address_p, ucp_mem_h *memh, int non_blk_flag)
@@ -1037,8 +1090,25 @@ static ucs_status_t ucp_perf_test_alloc_mem(ucx_perf_context_t *perf)
         goto err_free_send_iov_buffers;
     }
 
+    /* Create strided datatypes */
+    status = ucp_perf_test_create_strided_dt(params, params->ucp.send_datatype,
+                                             &perf->ucp.send_strided);
+    if (UCS_OK != status) {
+        goto err_free_recv_iov_buffers;
+    }
+
+    status = ucp_perf_test_create_strided_dt(params, params->ucp.recv_datatype,
+                                             &perf->ucp.recv_strided);
+    if (UCS_OK != status) {
+        goto err_destroy_send_strided;
+    }
+
     return UCS_OK;
 
+err_destroy_send_strided:
+    ucp_dt_destroy(perf->ucp.send_strided);
+err_free_recv_iov_buffers:
+    free(perf->ucp.recv_iov);
 err_free_send_iov_buffers:
     free(perf->ucp.send_iov);
 err_free_buffers:
@@ -1051,6 +1121,8 @@ err:
 
 static void ucp_perf_test_free_mem(ucx_perf_context_t *perf)
 {
+    ucp_dt_destroy(perf->ucp.recv_strided);
+    ucp_dt_destroy(perf->ucp.send_strided);
     free(perf->ucp.recv_iov);
     free(perf->ucp.send_iov);
     perf->allocator->ucp_free(perf, perf->recv_buffer, perf->ucp.recv_memh);
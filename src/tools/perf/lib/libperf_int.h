@@ -60,6 +60,7 @@ struct ucx_perf_context {
 
     /* Measurements */
     double                       start_time_acc;  /* accurate start time */
+    double                       start_cpu_time;  /* process CPU time at start */
     ucs_time_t                   end_time;        /* inaccurate end time (upper bound) */
     ucs_time_t                   prev_time;       /* time of previous iteration */
     ucs_time_t                   report_interval; /* interval of showing report */
@@ -99,6 +100,8 @@ struct ucx_perf_context {
             ucp_mem_h            recv_memh;
             ucp_dt_iov_t         *send_iov;
             ucp_dt_iov_t         *recv_iov;
+            ucp_datatype_t       send_strided;
+            ucp_datatype_t       recv_strided;
         } ucp;
     };
 };
@@ -10,6 +10,7 @@
 
 extern "C" {
 #include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/sys.h>
 }
@@ -24,18 +25,28 @@ public:
     static const ucp_tag_t TAG      = 0x1337a880u;
     static const ucp_tag_t TAG_MASK = (FLAGS & UCX_PERF_TEST_FLAG_TAG_WILDCARD) ?
                                       0 : (ucp_tag_t)-1;
+    static const uint16_t  AM_ID    = 0;
 
     typedef uint8_t psn_t;
 
     ucp_perf_test_runner(ucx_perf_context_t &perf) :
         m_perf(perf),
         m_outstanding(0),
-        m_max_outstanding(m_perf.params.max_outstanding)
+        m_max_outstanding(m_perf.params.max_outstanding),
+        m_am_received(0),
+        m_am_rndv_requests(NULL),
+        m_am_rndv_count(0),
+        m_am_rndv_max(0)
 
     {
         ucs_assert_always(m_max_outstanding > 0);
     }
 
+    ~ucp_perf_test_runner()
+    {
+        ucs_free(m_am_rndv_requests);
+    }
+
     void create_iov_buffer(ucp_dt_iov_t *iov, void *buffer)
     {
         size_t iov_length_it, iov_it;
@@ -58,6 +69,7 @@ public:
     }
 
     ucp_datatype_t ucp_perf_test_get_datatype(ucp_perf_datatype_t datatype, ucp_dt_iov_t *iov,
+                                              ucp_datatype_t strided,
                                               size_t *length, void **buffer_p)
     {
         ucp_datatype_t type = ucp_dt_make_contig(1);
@@ -65,6 +77,9 @@ public:
             *buffer_p = iov;
             *length   = m_perf.params.msg_size_cnt;
             type      = ucp_dt_make_iov();
+        } else if (UCP_PERF_DATATYPE_STRIDED == datatype) {
+            *length   = 1;
+            type      = strided;
         }
         return type;
     }
@@ -136,6 +151,79 @@ public:
         ucp_request_release(request);
     }
 
+    static ucs_status_t am_handler(void *arg, void *data, size_t length,
+                                   ucp_ep_h reply_ep, unsigned flags)
+    {
+        ucp_perf_test_runner *test = (ucp_perf_test_runner*)arg;
+        void *request;
+
+        if (!(flags & UCP_CB_PARAM_FLAG_RNDV)) {
+            ++test->m_am_received;
+            return UCS_OK;
+        }
+
+        /* fetch the data of a rendezvous AM directly to the receive buffer */
+        request = ucp_am_rndv_recv_nb(test->m_perf.ucp.worker, data,
+                                      test->m_perf.recv_buffer, length,
+                                      ucp_dt_make_contig(1),
+                                      (ucp_am_rndv_recv_callback_t)
+                                      ucs_empty_function);
+        if (ucs_unlikely(UCS_PTR_IS_ERR(request))) {
+            ucs_error("ucp_am_rndv_recv_nb() failed: %s",
+                      ucs_status_string(UCS_PTR_STATUS(request)));
+            ucp_am_data_release(test->m_perf.ucp.worker, data);
+        } else {
+            test->am_add_rndv_request(request);
+        }
+        return UCS_INPROGRESS;
+    }
+
+    void am_add_rndv_request(void *request)
+    {
+        if (m_am_rndv_count == m_am_rndv_max) {
+            /* the sender may complete before all data is received, so there
+             * can be more receives in progress than max_outstanding */
+            m_am_rndv_max      = ucs_max(m_am_rndv_max * 2, m_max_outstanding);
+            m_am_rndv_requests = (void**)ucs_realloc(m_am_rndv_requests,
+                                                     m_am_rndv_max *
+                                                     sizeof(*m_am_rndv_requests),
+                                                     "ucp_perf_am_rndv_requests");
+            ucs_assert_always(m_am_rndv_requests != NULL);
+        }
+
+        m_am_rndv_requests[m_am_rndv_count++] = request;
+    }
+
+    void UCS_F_ALWAYS_INLINE am_check_rndv_requests()
+    {
+        unsigned i = 0;
+
+        while (i < m_am_rndv_count) {
+            if (ucp_request_is_completed(m_am_rndv_requests[i])) {
+                ucp_request_release(m_am_rndv_requests[i]);
+                m_am_rndv_requests[i] = m_am_rndv_requests[--m_am_rndv_count];
+                ++m_am_received;
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    void set_am_handler()
+    {
+        ucs_status_t status;
+
+        if (CMD != UCX_PERF_CMD_AM) {
+            return;
+        }
+
+        status = ucp_worker_set_am_handler(m_perf.ucp.worker, AM_ID,
+                                           am_handler, this,
+                                           UCP_AM_FLAG_WHOLE_MSG |
+                                           UCP_AM_FLAG_RNDV);
+        ucs_assert_always(status == UCS_OK);
+    }
+
     void UCS_F_ALWAYS_INLINE wait_window(unsigned n)
     {
         while (m_outstanding >= (m_max_outstanding - n + 1)) {
@@ -154,6 +242,7 @@ public:
         case UCX_PERF_CMD_TAG:
         case UCX_PERF_CMD_TAG_SYNC:
         case UCX_PERF_CMD_STREAM:
+        case UCX_PERF_CMD_AM:
             wait_window(1);
             /* coverity[switch_selector_expr_is_constant] */
             switch (CMD) {
@@ -169,6 +258,10 @@ public:
                 request = ucp_stream_send_nb(ep, buffer, length, datatype,
                                              send_cb, 0);
                 break;
+            case UCX_PERF_CMD_AM:
+                request = ucp_am_send_nb(ep, AM_ID, buffer, length, datatype,
+                                         send_cb, 0);
+                break;
             default:
                 request = UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
                 break;
@@ -274,6 +367,13 @@ public:
             } else {
                 return recv_stream(ep, buffer, length, datatype);
             }
+        case UCX_PERF_CMD_AM:
+            while (m_am_received == 0) {
+                progress_responder();
+                am_check_rndv_requests();
+            }
+            --m_am_received;
+            return UCS_OK;
         default:
             return UCS_ERR_INVALID_PARAM;
         }
@@ -296,6 +396,7 @@ public:
         ucs_assert(length >= sizeof(psn_t));
 
         ucp_perf_test_prepare_iov_buffers();
+        set_am_handler();
 
         if (CMD == UCX_PERF_CMD_PUT) {
             m_perf.allocator->memcpy((psn_t*)m_perf.recv_buffer + length - 1,
@@ -320,10 +421,14 @@ public:
         send_length   = length;
         recv_length   = length;
         send_datatype = ucp_perf_test_get_datatype(m_perf.params.ucp.send_datatype,
-                                                   m_perf.ucp.send_iov, &send_length,
+                                                   m_perf.ucp.send_iov,
+                                                   m_perf.ucp.send_strided,
+                                                   &send_length,
                                                    &send_buffer);
         recv_datatype = ucp_perf_test_get_datatype(m_perf.params.ucp.recv_datatype,
-                                                   m_perf.ucp.recv_iov, &recv_length,
+                                                   m_perf.ucp.recv_iov,
+                                                   m_perf.ucp.recv_strided,
+                                                   &recv_length,
                                                    &recv_buffer);
 
         if (my_index == 0) {
@@ -365,6 +470,7 @@ public:
         ucs_assert(length >= sizeof(psn_t));
 
         ucp_perf_test_prepare_iov_buffers();
+        set_am_handler();
 
         ucp_perf_barrier(&m_perf);
 
@@ -382,10 +488,14 @@ public:
         send_length   = length;
         recv_length   = length;
         send_datatype = ucp_perf_test_get_datatype(m_perf.params.ucp.send_datatype,
-                                                   m_perf.ucp.send_iov, &send_length,
+                                                   m_perf.ucp.send_iov,
+                                                   m_perf.ucp.send_strided,
+                                                   &send_length,
                                                    &send_buffer);
         recv_datatype = ucp_perf_test_get_datatype(m_perf.params.ucp.recv_datatype,
-                                                   m_perf.ucp.recv_iov, &recv_length,
+                                                   m_perf.ucp.recv_iov,
+                                                   m_perf.ucp.recv_strided,
+                                                   &recv_length,
                                                    &recv_buffer);
 
         if (my_index == 0) {
@@ -487,6 +597,10 @@ private:
     ucx_perf_context_t &m_perf;
     unsigned           m_outstanding;
     const unsigned     m_max_outstanding;
+    unsigned           m_am_received;      /* Completed AMs not yet counted */
+    void               **m_am_rndv_requests; /* Rendezvous AMs being received */
+    unsigned           m_am_rndv_count;    /* Size of m_am_rndv_requests */
+    unsigned           m_am_rndv_max;      /* Capacity of m_am_rndv_requests */
 };
 
 
@@ -546,6 +660,8 @@ ucs_status_t ucp_perf_test_dispatch(ucx_perf_context_t *perf)
         (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_STREAM_UNI)
         );
 
+    TEST_CASE(perf, UCX_PERF_CMD_AM, UCX_PERF_TEST_TYPE_STREAM_UNI, 0, 0);
+
     UCS_PP_FOREACH(TEST_CASE_ALL_STREAM, perf,
         (UCX_PERF_CMD_STREAM,   UCX_PERF_TEST_TYPE_STREAM_UNI),
         (UCX_PERF_CMD_STREAM,   UCX_PERF_TEST_TYPE_PINGPONG)
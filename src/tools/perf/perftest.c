@@ -152,6 +152,9 @@ test_type_t tests[] = {
     {"stream_lat", UCX_PERF_API_UCP, UCX_PERF_CMD_STREAM, UCX_PERF_TEST_TYPE_PINGPONG,
      "stream latency"},
 
+    {"ucp_am_bw", UCX_PERF_API_UCP, UCX_PERF_CMD_AM, UCX_PERF_TEST_TYPE_STREAM_UNI,
+     "active message bandwidth"},
+
      {NULL}
 };
 
@@ -238,6 +241,11 @@ static void print_progress(char **test_names, unsigned num_names,
            result->bandwidth.total_average / (1024.0 * 1024.0),
            result->msgrate.moment_average,
            result->msgrate.total_average);
+
+    if (final && !(flags & TEST_FLAG_PRINT_CSV)) {
+        printf("%14s CPU utilization: %.1f%%\n", "",
+               result->cpu_util * 100.0);
+    }
     fflush(stdout);
 }
 
@@ -424,6 +432,7 @@ static void usage(const struct perftest_context *ctx, const char *program)
     printf("                    data layout for sender and receiver side (contig)\n");
     printf("                        contig - Continuous datatype\n");
     printf("                        iov    - Scatter-gather list\n");
+    printf("                        strided - Equal blocks (from -s) spaced by -i bytes\n");
     printf("     -C             use wild-card tag for tag tests\n");
     printf("     -U             force unexpected flow by using tag probe\n");
     printf("     -r <mode>      receive mode for stream tests (recv)\n");
@@ -442,9 +451,13 @@ static ucs_status_t parse_ucp_datatype_params(const char *optarg,
     const size_t iov_type_size    = strlen("iov");
     const char  *contig_type      = "contig";
     const size_t contig_type_size = strlen("contig");
+    const char  *strided_type      = "strided";
+    const size_t strided_type_size = strlen("strided");
 
     if (0 == strncmp(optarg, iov_type, iov_type_size)) {
         *datatype = UCP_PERF_DATATYPE_IOV;
+    } else if (0 == strncmp(optarg, strided_type, strided_type_size)) {
+        *datatype = UCP_PERF_DATATYPE_STRIDED;
     } else if (0 == strncmp(optarg, contig_type, contig_type_size)) {
         *datatype = UCP_PERF_DATATYPE_CONTIG;
     } else {
@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include <errno.h>
+#include <inttypes.h>
 
 
 #define INDENT             4
@@ -66,10 +67,28 @@ typedef struct options {
 } options_t;
 
 
+typedef struct {
+    off_t                        offset;       /* File offset of the records */
+    uint64_t                     count;        /* Number of records */
+} profile_records_chunk_t;
+
+
 typedef struct {
     const ucs_profile_thread_header_t   *header;
     const ucs_profile_thread_location_t *locations;
     const ucs_profile_record_t          *records;
+
+    /* Stream mode: the thread data is collected from chunks, and the records
+     * are read from the file only when they are displayed */
+    struct {
+        ucs_profile_thread_header_t     header;
+        ucs_profile_thread_location_t   *locations;
+        ucs_profile_record_t            *records;
+        profile_records_chunk_t         *chunks;
+        unsigned                        num_chunks;
+        uint64_t                        num_dropped;
+        int                             completed;  /* Summary was read */
+    } stream;
 } profile_thread_data_t;
 
 
@@ -79,6 +98,13 @@ typedef struct {
     const ucs_profile_header_t   *header;
     const ucs_profile_location_t *locations;
     profile_thread_data_t        *threads;
+
+    /* Stream mode */
+    struct {
+        int                      fd;           /* Open file, to read records */
+        ucs_profile_header_t     header;       /* Header with actual counts */
+        ucs_profile_location_t   *locations;   /* Locations from all chunks */
+    } stream;
 } profile_data_t;
 
 
@@ -102,6 +128,298 @@ static const char* time_units_str[] = {
 };
 
 
+static int is_stream_profile(const profile_data_t *data)
+{
+    return data->header->mode & UCS_BIT(UCS_PROFILE_MODE_STREAM);
+}
+
+static int read_stream_data(FILE *stream, void *buffer, size_t size)
+{
+    return (size == 0) || (fread(buffer, size, 1, stream) == 1);
+}
+
+static profile_thread_data_t *
+stream_get_thread(profile_data_t *data, uint32_t tid)
+{
+    ucs_profile_header_t *header = &data->stream.header;
+    profile_thread_data_t *thread, *threads;
+
+    /* A thread id may be reused after a thread whose summary was written */
+    for (thread = data->threads; thread < data->threads + header->num_threads;
+         ++thread) {
+        if ((thread->stream.header.tid == tid) && !thread->stream.completed) {
+            return thread;
+        }
+    }
+
+    threads = realloc(data->threads,
+                      (header->num_threads + 1) * sizeof(*data->threads));
+    if (threads == NULL) {
+        print_error("failed to allocate threads array");
+        return NULL;
+    }
+
+    data->threads = threads;
+    thread        = &data->threads[header->num_threads++];
+    memset(thread, 0, sizeof(*thread));
+    thread->stream.header.tid = tid;
+    return thread;
+}
+
+static int read_stream_records(FILE *stream, profile_data_t *data,
+                               const ucs_profile_chunk_header_t *chunk_hdr)
+{
+    profile_records_chunk_t *chunks;
+    profile_thread_data_t *thread;
+    ucs_profile_record_t record;
+    off_t offset;
+
+    if (chunk_hdr->count == 0) {
+        return 0;
+    }
+
+    thread = stream_get_thread(data, chunk_hdr->tid);
+    if (thread == NULL) {
+        return -ENOMEM;
+    }
+
+    /* Make sure the chunk is complete, and take the start time from the first
+     * record in case the thread summary is missing */
+    offset = ftello(stream);
+    if (!read_stream_data(stream, &record, sizeof(record)) ||
+        (fseeko(stream, offset + (chunk_hdr->count * sizeof(record)) - 1,
+                SEEK_SET) != 0) ||
+        (fgetc(stream) == EOF)) {
+        return -EAGAIN;
+    }
+
+    chunks = realloc(thread->stream.chunks,
+                     (thread->stream.num_chunks + 1) * sizeof(*chunks));
+    if (chunks == NULL) {
+        print_error("failed to allocate records chunks array");
+        return -ENOMEM;
+    }
+
+    if (thread->stream.num_chunks == 0) {
+        thread->stream.header.start_time = record.timestamp;
+    }
+
+    thread->stream.chunks                                   = chunks;
+    thread->stream.chunks[thread->stream.num_chunks].offset = offset;
+    thread->stream.chunks[thread->stream.num_chunks].count  = chunk_hdr->count;
+    thread->stream.header.num_records                      += chunk_hdr->count;
+    ++thread->stream.num_chunks;
+    return 0;
+}
+
+static int read_stream_thread(FILE *stream, profile_data_t *data,
+                              const ucs_profile_chunk_header_t *chunk_hdr)
+{
+    ucs_profile_stream_thread_t thread_info;
+    ucs_profile_thread_location_t *locations;
+    profile_thread_data_t *thread;
+
+    if (chunk_hdr->count > data->stream.header.num_locations) {
+        print_error("thread %u summary has %"PRIu64" locations, but only %u "
+                    "are defined", chunk_hdr->tid, chunk_hdr->count,
+                    data->stream.header.num_locations);
+        return -EINVAL;
+    }
+
+    locations = calloc(data->stream.header.num_locations, sizeof(*locations));
+    if (locations == NULL) {
+        print_error("failed to allocate thread locations");
+        return -ENOMEM;
+    }
+
+    if (!read_stream_data(stream, &thread_info, sizeof(thread_info)) ||
+        !read_stream_data(stream, locations,
+                          chunk_hdr->count * sizeof(*locations))) {
+        free(locations);
+        return -EAGAIN;
+    }
+
+    thread = stream_get_thread(data, chunk_hdr->tid);
+    if (thread == NULL) {
+        free(locations);
+        return -ENOMEM;
+    }
+
+    /* Keep the number of records which were actually found in the file */
+    thread->stream.header.start_time = thread_info.super.start_time;
+    thread->stream.header.end_time   = thread_info.super.end_time;
+    thread->stream.num_dropped       = thread_info.num_dropped;
+    thread->stream.locations         = locations;
+    thread->stream.completed         = 1;
+    return 0;
+}
+
+static int read_stream_locations(FILE *stream, profile_data_t *data,
+                                 const ucs_profile_chunk_header_t *chunk_hdr)
+{
+    ucs_profile_header_t *header = &data->stream.header;
+    ucs_profile_location_t *locations;
+
+    locations = realloc(data->stream.locations,
+                        (header->num_locations + chunk_hdr->count) *
+                        sizeof(*locations));
+    if (locations == NULL) {
+        print_error("failed to allocate locations array");
+        return -ENOMEM;
+    }
+
+    data->stream.locations = locations;
+    if (!read_stream_data(stream, locations + header->num_locations,
+                          chunk_hdr->count * sizeof(*locations))) {
+        return -EAGAIN;
+    }
+
+    header->num_locations += chunk_hdr->count;
+    return 0;
+}
+
+/*
+ * Read a profile written in stream mode chunk by chunk. Only the locations and
+ * thread summaries are kept in memory; the records are indexed, and read when
+ * the thread is displayed. The file may be still written, so a trailing
+ * incomplete chunk is ignored.
+ */
+static int read_profile_stream(int fd, profile_data_t *data)
+{
+    ucs_profile_chunk_header_t chunk_hdr;
+    profile_thread_data_t *thread;
+    uint64_t num_chunks;
+    FILE *stream;
+    size_t nread;
+    int ret;
+
+    stream = fdopen(dup(fd), "r");
+    if (stream == NULL) {
+        print_error("fdopen() failed: %m");
+        return -1;
+    }
+
+    data->stream.header               = *data->header;
+    data->stream.header.num_locations = 0;
+    data->stream.header.num_threads   = 0;
+    data->header                      = &data->stream.header;
+
+    ret = fseeko(stream, sizeof(ucs_profile_header_t), SEEK_SET);
+    num_chunks = 0;
+    while (ret == 0) {
+        nread = fread(&chunk_hdr, 1, sizeof(chunk_hdr), stream);
+        if (nread == 0) {
+            break; /* end of file at chunk boundary */
+        } else if (nread < sizeof(chunk_hdr)) {
+            ret = -EAGAIN;
+            break;
+        }
+
+        ++num_chunks;
+        switch (chunk_hdr.type) {
+        case UCS_PROFILE_CHUNK_LOCATIONS:
+            ret = read_stream_locations(stream, data, &chunk_hdr);
+            break;
+        case UCS_PROFILE_CHUNK_RECORDS:
+            ret = read_stream_records(stream, data, &chunk_hdr);
+            break;
+        case UCS_PROFILE_CHUNK_THREAD:
+            ret = read_stream_thread(stream, data, &chunk_hdr);
+            break;
+        default:
+            print_error("invalid chunk type %u at offset %jd", chunk_hdr.type,
+                        (intmax_t)ftello(stream) - sizeof(chunk_hdr));
+            ret = -EINVAL;
+            break;
+        }
+    }
+
+    fclose(stream);
+
+    if (ret == -EAGAIN) {
+        fprintf(stderr, "Warning: the profile is truncated after %"PRIu64
+                " complete chunks\n", num_chunks - 1);
+    } else if (ret < 0) {
+        return ret;
+    }
+
+    /* Fill missing parts for threads which did not write a summary */
+    for (thread = data->threads;
+         thread < data->threads + data->stream.header.num_threads; ++thread) {
+        if (thread->stream.locations == NULL) {
+            thread->stream.locations = calloc(data->stream.header.num_locations,
+                                              sizeof(*thread->stream.locations));
+            if (thread->stream.locations == NULL) {
+                print_error("failed to allocate thread locations");
+                return -ENOMEM;
+            }
+        }
+
+        if (thread->stream.header.end_time < thread->stream.header.start_time) {
+            thread->stream.header.end_time = thread->stream.header.start_time;
+        }
+
+        thread->header    = &thread->stream.header;
+        thread->locations = thread->stream.locations;
+    }
+
+    data->stream.fd = dup(fd);
+    data->locations = data->stream.locations;
+    return 0;
+}
+
+static int load_thread_records(profile_data_t *data,
+                               profile_thread_data_t *thread)
+{
+    const profile_records_chunk_t *chunk;
+    ucs_profile_record_t *rec;
+    size_t size;
+    ssize_t ret;
+
+    if (!is_stream_profile(data)) {
+        return 0;
+    }
+
+    thread->stream.records = malloc(thread->header->num_records *
+                                    sizeof(*thread->stream.records));
+    if (thread->stream.records == NULL) {
+        print_error("failed to allocate %"PRIu64" records",
+                    thread->header->num_records);
+        return -ENOMEM;
+    }
+
+    rec = thread->stream.records;
+    for (chunk = thread->stream.chunks;
+         chunk < thread->stream.chunks + thread->stream.num_chunks; ++chunk) {
+        size = chunk->count * sizeof(*rec);
+        ret  = pread(data->stream.fd, rec, size, chunk->offset);
+        if (ret != (ssize_t)size) {
+            print_error("failed to read %zu bytes at offset %jd: %m", size,
+                        (intmax_t)chunk->offset);
+            free(thread->stream.records);
+            thread->stream.records = NULL;
+            return -EIO;
+        }
+
+        rec += chunk->count;
+    }
+
+    thread->records = thread->stream.records;
+    return 0;
+}
+
+static void release_thread_records(profile_data_t *data,
+                                   profile_thread_data_t *thread)
+{
+    if (!is_stream_profile(data)) {
+        return;
+    }
+
+    free(thread->stream.records);
+    thread->stream.records = NULL;
+    thread->records        = NULL;
+}
+
 static int read_profile_data(const char *file_name, profile_data_t *data)
 {
     uint32_t thread_idx;
@@ -131,17 +449,33 @@ static int read_profile_data(const char *file_name, profile_data_t *data)
         goto out_close;
     }
 
+    if (data->length < sizeof(*data->header)) {
+        print_error("%s is too short (%zu bytes)", file_name, data->length);
+        ret = -EINVAL;
+        goto err_munmap;
+    }
+
     ptr          = data->mem;
     data->header = ptr;
     ptr          = data->header + 1;
 
-    if (data->header->version != UCS_PROFILE_FILE_VERSION) {
-        print_error("invalid file version, expected: %u, actual: %u",
+    /* Version 3 only added the stream mode */
+    if ((data->header->version < 2) ||
+        (data->header->version > UCS_PROFILE_FILE_VERSION)) {
+        print_error("invalid file version, expected: 2..%u, actual: %u",
                     UCS_PROFILE_FILE_VERSION, data->header->version);
         ret = -EINVAL;
         goto err_munmap;
     }
 
+    if (is_stream_profile(data)) {
+        ret = read_profile_stream(fd, data);
+        if (ret < 0) {
+            goto err_munmap;
+        }
+        goto out_close;
+    }
+
     data->locations = ptr;
     ptr             = data->locations + data->header->num_locations;
 
@@ -174,6 +508,19 @@ err_munmap:
 
 static void release_profile_data(profile_data_t *data)
 {
+    profile_thread_data_t *thread;
+
+    if (is_stream_profile(data)) {
+        for (thread = data->threads;
+             thread < data->threads + data->header->num_threads; ++thread) {
+            release_thread_records(data, thread);
+            free(thread->stream.locations);
+            free(thread->stream.chunks);
+        }
+        free(data->stream.locations);
+        close(data->stream.fd);
+    }
+
     free(data->threads);
     munmap(data->mem, data->length);
 }
@@ -462,10 +809,14 @@ static void show_profile_data_log(profile_data_t *data, options_t *opts,
     }
 
     printf("\n");
-    printf("%sThread %d (tid %d%s)%s\n", HEAD_COLOR, thread_idx + 1,
+    printf("%sThread %d (tid %d%s)%s", HEAD_COLOR, thread_idx + 1,
            thread->header->tid,
            (thread->header->tid == data->header->pid) ? ", main" : "",
            CLEAR_COLOR);
+    if (thread->stream.num_dropped > 0) {
+        printf(" (%"PRIu64" records dropped)", thread->stream.num_dropped);
+    }
+    printf("\n");
     printf("\n");
 
     memset(stack, 0, sizeof(stack));
@@ -618,7 +969,8 @@ static int redirect_output(const profile_data_t *data, options_t *opts)
                      1; /* locations footer */
     }
 
-    if (data->header->mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
+    if (data->header->mode & (UCS_BIT(UCS_PROFILE_MODE_LOG) |
+                              UCS_BIT(UCS_PROFILE_MODE_STREAM))) {
         for (t = opts->thread_list; *t != -1; ++t) {
             num_lines += 3 + /* thread header */
                          data->threads[*t - 1].header->num_records; /* thread records */
@@ -762,9 +1114,16 @@ static int show_profile_data(profile_data_t *data, options_t *opts)
         printf("\n");
     }
 
-    if (data->header->mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
+    if (data->header->mode & (UCS_BIT(UCS_PROFILE_MODE_LOG) |
+                              UCS_BIT(UCS_PROFILE_MODE_STREAM))) {
         for (t = opts->thread_list; *t != -1; ++t) {
+            ret = load_thread_records(data, &data->threads[*t - 1]);
+            if (ret < 0) {
+                return ret;
+            }
+
             show_profile_data_log(data, opts, *t - 1);
+            release_thread_records(data, &data->threads[*t - 1]);
         }
         printf("\n");
     }
@@ -403,13 +403,15 @@ enum {
  * @ingroup UCP_WORKER
  * @brief Flags for a UCP Active Message callback.
  *
- * Flags that indicate how to handle UCP Active Messages
- * Currently only UCP_AM_FLAG_WHOLE_MSG is supported,
- * which indicates the entire message is handled in one
- * callback.
+ * Flags that indicate how to handle UCP Active Messages.
+ * UCP_AM_FLAG_WHOLE_MSG indicates the entire message is handled in one
+ * callback. UCP_AM_FLAG_RNDV indicates the callback is able to provide
+ * its own receive buffer for messages sent with the rendezvous protocol,
+ * see @ref ucp_am_rndv_recv_nb.
  */
 enum ucp_am_cb_flags {
-    UCP_AM_FLAG_WHOLE_MSG = UCS_BIT(0)
+    UCP_AM_FLAG_WHOLE_MSG = UCS_BIT(0),
+    UCP_AM_FLAG_RNDV      = UCS_BIT(1)
 };
 
 
@@ -438,7 +440,11 @@ enum ucp_send_am_flags {
  * no longer needed.
  */
 enum ucp_cb_param_flags {
-    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0)
+    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0),
+    UCP_CB_PARAM_FLAG_RNDV = UCS_BIT(1)  /**< @a data is a rendezvous
+                                              descriptor, which has to be
+                                              passed to @ref ucp_am_rndv_recv_nb
+                                              or @ref ucp_am_data_release */
 };
 
 
@@ -543,6 +549,29 @@ typedef struct ucp_dt_iov {
 } ucp_dt_iov_t;
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Maximal number of dimensions in a strided datatype.
+ */
+#define UCP_DT_STRIDED_MAX_DIMS 4
+
+
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Dimension of a strided datatype.
+ *
+ * This structure describes a single dimension of a strided datatype created
+ * by @ref ucp_dt_create_strided "ucp_dt_create_strided()": @a count items
+ * of the next inner dimension (or contiguous blocks, for the innermost
+ * dimension), each one located @a stride bytes after the previous one.
+ */
+typedef struct ucp_dt_stride {
+    size_t  count;    /**< Number of items in the dimension */
+    size_t  stride;   /**< Distance in bytes between the beginnings of two
+                           consecutive items */
+} ucp_dt_stride_t;
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief UCP generic data type descriptor
@@ -2196,10 +2225,15 @@ void ucp_rkey_destroy(ucp_rkey_h rkey);
  *                          in to every invocation of the callback as the
  *                          arg argument.
  * @param [in]  flags       Dictates how an Active Message is handled on the
- *                          remote endpoint. Currently only
- *                          UCP_AM_FLAG_WHOLE_MSG is supported, which
+ *                          remote endpoint. UCP_AM_FLAG_WHOLE_MSG
  *                          indicates the callback will not be invoked
- *                          until all data has arrived.
+ *                          until all data has arrived. UCP_AM_FLAG_RNDV
+ *                          indicates the callback receives rendezvous
+ *                          messages with UCP_CB_PARAM_FLAG_RNDV set, and
+ *                          provides the receive buffer for them. Without
+ *                          this flag, rendezvous messages are received to
+ *                          an internal buffer before the callback is
+ *                          invoked.
  *
  * @return error code if the worker does not support Active Messages or
  *         requested callback flags.
@@ -2253,6 +2287,41 @@ ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id,
 void ucp_am_data_release(ucp_worker_h worker, void *data);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Receive the data of a rendezvous Active Message.
+ *
+ * Active Messages which are larger than the rendezvous threshold (see
+ * UCX_AM_RNDV_THRESH) are announced to a callback registered with the
+ * UCP_AM_FLAG_RNDV flag, with UCP_CB_PARAM_FLAG_RNDV set in its flags
+ * parameter and @a length set to the full message size. To receive the data,
+ * the callback must return UCS_INPROGRESS, and pass the data descriptor to
+ * this routine, either from within the callback or later on. The data is
+ * fetched from the sender directly into @a buffer, using zero-copy RMA
+ * when the transports allow it. Passing the descriptor to
+ * @ref ucp_am_data_release instead, or returning UCS_OK from the callback,
+ * discards the message.
+ *
+ * @param [in]  worker      Worker which received the Active Message.
+ * @param [in]  data_desc   Data descriptor which was passed to the Active
+ *                          Message callback as the data parameter.
+ * @param [in]  buffer      Pointer to the buffer to receive the data to.
+ * @param [in]  count       Number of elements to receive.
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  cb          Callback that is invoked when the data has been
+ *                          received. The callback may be invoked before this
+ *                          routine returns.
+ *
+ * @return UCS_PTR_IS_ERR(_ptr) Error receiving the data.
+ * @return otherwise        Request handle, which has to be released with
+ *                          @ref ucp_request_free when it is completed.
+ */
+ucs_status_ptr_t ucp_am_rndv_recv_nb(ucp_worker_h worker, void *data_desc,
+                                     void *buffer, size_t count,
+                                     ucp_datatype_t datatype,
+                                     ucp_am_rndv_recv_callback_t cb);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking stream send operation.
@@ -3059,6 +3128,39 @@ ucs_status_t ucp_dt_create_generic(const ucp_generic_dt_ops_t *ops, void *contex
                                    ucp_datatype_t *datatype_p);
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Create a strided datatype.
+ *
+ * This routine creates a datatype which describes a multi-dimensional
+ * (vector) layout of equally sized contiguous blocks, similar to a nested
+ * MPI_Type_vector. A single element of the datatype consists of
+ * @a dims[0].count x ... x @a dims[num_dims-1].count blocks of @a blocklen
+ * bytes each. Consecutive elements, when a send or receive operation is
+ * posted with a count larger than 1, are placed one after another with a
+ * distance of @a dims[num_dims-1].count x @a dims[num_dims-1].stride bytes.
+ * The data is sent on the wire packed, so the sender and the receiver may use
+ * different layouts as long as the total data length matches.
+ * The application is responsible for releasing the @a datatype_p object using
+ * @ref ucp_dt_destroy "ucp_dt_destroy()" routine.
+ *
+ * @param [in]  blocklen     Length of a contiguous block in bytes.
+ * @param [in]  dims         Array of @a num_dims dimensions, starting from the
+ *                           innermost one. The stride of every dimension must
+ *                           be large enough to prevent overlapping of the
+ *                           items of the inner dimension.
+ * @param [in]  num_dims     Number of entries in @a dims, up to
+ *                           @ref UCP_DT_STRIDED_MAX_DIMS.
+ * @param [out] datatype_p   A pointer to datatype object.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ *
+ * @note Strided datatypes are supported only for host memory.
+ */
+ucs_status_t ucp_dt_create_strided(size_t blocklen, const ucp_dt_stride_t *dims,
+                                   unsigned num_dims, ucp_datatype_t *datatype_p);
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief Destroy a datatype and release its resources.
@@ -3066,7 +3168,8 @@ ucs_status_t ucp_dt_create_generic(const ucp_generic_dt_ops_t *ops, void *contex
  * This routine destroys the @a datatype object and
  * releases any resources that are associated with the object.
  * The @a datatype object must be allocated using @ref ucp_dt_create_generic
- * "ucp_dt_create_generic()" routine.
+ * "ucp_dt_create_generic()" or @ref ucp_dt_create_strided
+ * "ucp_dt_create_strided()" routine.
  *
  * @warning
  * @li Once the @a datatype object is released an access to this object may
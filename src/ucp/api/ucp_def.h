@@ -506,6 +506,23 @@ typedef ucs_status_t (*ucp_am_callback_t)(void *arg, void *data, size_t length,
                                           ucp_ep_h reply_ep, unsigned flags);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Completion callback for receiving a rendezvous Active Message.
+ *
+ * This callback routine is invoked when the data of a rendezvous Active
+ * Message, requested by @ref ucp_am_rndv_recv_nb, has been received.
+ *
+ * @param [in]  request   The completed receive request.
+ * @param [in]  status    Completion status. If the receive buffer was too
+ *                        small for the message, the status is
+ *                        UCS_ERR_MESSAGE_TRUNCATED.
+ * @param [in]  length    Size of the received message, in bytes.
+ */
+typedef void (*ucp_am_rndv_recv_callback_t)(void *request, ucs_status_t status,
+                                            size_t length);
+
+
 /**
  * @ingroup UCP_ENDPOINT
  * @brief Tuning parameters for the UCP endpoint.
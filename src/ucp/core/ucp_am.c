@@ -18,8 +18,120 @@
 #include <ucp/core/ucp_context.h>
 #include <ucp/proto/proto.h>
 #include <ucp/proto/proto_am.inl>
+#include <ucp/tag/rndv.h>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
+#include <ucs/datastruct/mpool.inl>
+
+__KHASH_IMPL(ucp_am_unfinished_hash, static UCS_F_MAYBE_UNUSED inline,
+             uint64_t, ucp_am_unfinished_t*, 1, kh_int64_hash_func,
+             kh_int64_hash_equal);
+
+
+static ucs_mpool_ops_t ucp_am_rdesc_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
+
+ucs_status_t ucp_am_worker_init(ucp_worker_h worker)
+{
+    ucp_am_worker_t *am = &worker->am;
+    size_t elem_size;
+    ucs_status_t status;
+    unsigned i;
+
+    status = ucs_mpool_init(&am->unfinished_mp, 0, sizeof(ucp_am_unfinished_t),
+                            0, UCS_SYS_CACHE_LINE_SIZE, 128, UINT_MAX,
+                            &ucp_am_rdesc_mpool_ops, "ucp_am_unfinished");
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    for (i = 0; i < UCP_AM_RDESC_MP_COUNT; ++i) {
+        elem_size = sizeof(ucp_recv_desc_t) +
+                    UCS_BIT(i + UCP_AM_RDESC_MP_MIN_SHIFT);
+        status    = ucs_mpool_init(&am->rdesc_mp[i], 0, elem_size, 0,
+                                   UCS_SYS_CACHE_LINE_SIZE,
+                                   ucs_max(UCP_AM_RDESC_MP_CHUNK_SIZE /
+                                           elem_size, 1),
+                                   UINT_MAX, &ucp_am_rdesc_mpool_ops,
+                                   "ucp_am_rdesc");
+        if (status != UCS_OK) {
+            goto err_cleanup_rdesc_mp;
+        }
+    }
+
+    kh_init_inplace(ucp_am_unfinished_hash, &am->unfinished);
+    return UCS_OK;
+
+err_cleanup_rdesc_mp:
+    while (i-- > 0) {
+        ucs_mpool_cleanup(&am->rdesc_mp[i], 0);
+    }
+    ucs_mpool_cleanup(&am->unfinished_mp, 0);
+err:
+    return status;
+}
+
+void ucp_am_worker_cleanup(ucp_worker_h worker)
+{
+    ucp_am_worker_t *am = &worker->am;
+    unsigned i;
+
+    kh_destroy_inplace(ucp_am_unfinished_hash, &am->unfinished);
+    for (i = 0; i < UCP_AM_RDESC_MP_COUNT; ++i) {
+        ucs_mpool_cleanup(&am->rdesc_mp[i], 1);
+    }
+    ucs_mpool_cleanup(&am->unfinished_mp, 1);
+}
+
+static ucp_recv_desc_t *ucp_am_rdesc_get(ucp_worker_h worker, size_t length)
+{
+    ucp_recv_desc_t *rdesc;
+    unsigned shift;
+
+    shift = ucs_max(ucs_ilog2(ucs_roundup_pow2(ucs_max(length, 1))),
+                    UCP_AM_RDESC_MP_MIN_SHIFT);
+    if (shift > UCP_AM_RDESC_MP_MAX_SHIFT) {
+        rdesc = ucs_malloc(length + sizeof(ucp_recv_desc_t),
+                           "ucp recv desc for long AM");
+        if (rdesc != NULL) {
+            rdesc->flags = UCP_RECV_DESC_FLAG_MALLOC;
+        }
+        return rdesc;
+    }
+
+    rdesc = ucs_mpool_get_inline(&worker->am.rdesc_mp[shift -
+                                                      UCP_AM_RDESC_MP_MIN_SHIFT]);
+    if (rdesc != NULL) {
+        rdesc->flags = 0;
+    }
+    return rdesc;
+}
+
+static void ucp_am_rdesc_put(ucp_recv_desc_t *rdesc)
+{
+    if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
+        ucs_free(rdesc);
+    } else {
+        ucs_mpool_put_inline(rdesc);
+    }
+}
+
+static void ucp_am_unfinished_release(ucp_worker_h worker,
+                                      ucp_am_unfinished_t *unfinished)
+{
+    khiter_t iter;
+
+    iter = kh_get(ucp_am_unfinished_hash, &worker->am.unfinished,
+                  unfinished->msg_id);
+    ucs_assert(iter != kh_end(&worker->am.unfinished));
+    kh_del(ucp_am_unfinished_hash, &worker->am.unfinished, iter);
+    ucs_list_del(&unfinished->list);
+    ucs_mpool_put_inline(unfinished);
+}
 
 void ucp_am_ep_init(ucp_ep_h ep)
 {
@@ -33,15 +145,92 @@ void ucp_am_ep_init(ucp_ep_h ep)
 void ucp_am_ep_cleanup(ucp_ep_h ep)
 {
     ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+    ucp_am_unfinished_t *unfinished, *tmp;
 
     if (ep->worker->context->config.features & UCP_FEATURE_AM) {
         if (ucs_unlikely(!ucs_list_is_empty(&ep_ext->am.started_ams))) {
             ucs_warn("worker : %p not all UCP active messages have been" 
                      "run to completion", ep->worker);
         }
+
+        ucs_list_for_each_safe(unfinished, tmp, &ep_ext->am.started_ams,
+                               list) {
+            ucp_am_rdesc_put(unfinished->all_data);
+            ucp_am_unfinished_release(ep->worker, unfinished);
+        }
+    }
+}
+
+static void ucp_am_rndv_rreq_init(ucp_request_t *rreq, ucp_worker_h worker,
+                                  void *buffer, size_t count,
+                                  ucp_datatype_t datatype, uint32_t flags)
+{
+    rreq->flags         = flags;
+    rreq->status        = UCS_OK;
+    rreq->recv.worker   = worker;
+    rreq->recv.buffer   = buffer;
+    rreq->recv.datatype = datatype;
+
+    ucp_dt_recv_state_init(&rreq->recv.state, buffer, datatype, count);
+
+    rreq->recv.length   = ucp_dt_length(datatype, count, buffer,
+                                        &rreq->recv.state);
+    rreq->recv.mem_type = ucp_memory_type_detect(worker->context, buffer,
+                                                 rreq->recv.length);
+    if (ucs_log_is_enabled(UCS_LOG_LEVEL_TRACE_REQ)) {
+        rreq->recv.tag.info.sender_tag = 0;
     }
 }
 
+static void ucp_am_rndv_drop(ucp_worker_h worker,
+                             const ucp_rndv_rts_hdr_t *rts_hdr)
+{
+    ucp_request_t *rreq;
+
+    rreq = ucp_request_get(worker);
+    if (ucs_unlikely(rreq == NULL)) {
+        ucs_error("failed to allocate request to discard rendezvous AM");
+        return;
+    }
+
+    /* An empty receive buffer completes the sender by the truncation flow */
+    ucp_am_rndv_rreq_init(rreq, worker, NULL, 0, ucp_dt_make_contig(1),
+                          UCP_REQUEST_FLAG_RELEASED);
+    ucp_rndv_matched(worker, rreq, rts_hdr);
+}
+
+static void ucp_am_rndv_recv_completed(void *request, ucs_status_t status,
+                                       ucp_tag_recv_info_t *info)
+{
+    ucp_request_t *rreq = (ucp_request_t*)request - 1;
+
+    rreq->recv.am.cb(request, status, info->length);
+}
+
+static void ucp_am_rndv_internal_recv_completed(void *request,
+                                                ucs_status_t status,
+                                                ucp_tag_recv_info_t *info)
+{
+    ucp_request_t *rreq    = (ucp_request_t*)request - 1;
+    ucp_worker_h worker    = rreq->recv.worker;
+    uint16_t am_id         = rreq->recv.am.am_id;
+    ucp_recv_desc_t *rdesc = (ucp_recv_desc_t*)rreq->recv.buffer - 1;
+
+    if (ucs_likely(status == UCS_OK) &&
+        (am_id < worker->am_cb_array_len) &&
+        (worker->am_cbs[am_id].cb != NULL)) {
+        status = worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context,
+                                          rdesc + 1, info->length,
+                                          rreq->recv.am.reply_ep,
+                                          UCP_CB_PARAM_FLAG_DATA);
+        if (status == UCS_INPROGRESS) {
+            return;
+        }
+    }
+
+    ucp_am_rdesc_put(rdesc);
+}
+
 UCS_PROFILE_FUNC_VOID(ucp_am_data_release,
                       (worker, data),
                       ucp_worker_h worker, void *data)
@@ -49,7 +238,14 @@ UCS_PROFILE_FUNC_VOID(ucp_am_data_release,
     ucp_recv_desc_t *rdesc = (ucp_recv_desc_t *)data - 1;
     ucp_recv_desc_t *desc;
 
-    if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
+    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_RNDV)) {
+        /* rendezvous AM which the user decided not to receive */
+        UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+        ucp_am_rndv_drop(worker, (void*)(rdesc + 1));
+        ucp_recv_desc_release(rdesc);
+        UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+        return;
+    } else if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
         ucs_free(rdesc);
         return;
     } else if (rdesc->flags & UCP_RECV_DESC_FLAG_AM_HDR) {
@@ -64,6 +260,46 @@ UCS_PROFILE_FUNC_VOID(ucp_am_data_release,
     ucp_recv_desc_release(rdesc);
 }
 
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_rndv_recv_nb,
+                 (worker, data_desc, buffer, count, datatype, cb),
+                 ucp_worker_h worker, void *data_desc, void *buffer,
+                 size_t count, ucp_datatype_t datatype,
+                 ucp_am_rndv_recv_callback_t cb)
+{
+    ucp_recv_desc_t *rdesc = (ucp_recv_desc_t*)data_desc - 1;
+    ucs_status_ptr_t ret;
+    ucp_request_t *rreq;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_AM,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    if (ucs_unlikely(!(rdesc->flags & UCP_RECV_DESC_FLAG_RNDV))) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    rreq = ucp_request_get(worker);
+    if (ucs_unlikely(rreq == NULL)) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    ucp_am_rndv_rreq_init(rreq, worker, buffer, count, datatype, 0);
+    if (cb != NULL) {
+        rreq->recv.am.cb = cb;
+        ucp_request_set_callback(rreq, recv.tag.cb, ucp_am_rndv_recv_completed);
+    }
+
+    ucp_rndv_matched(worker, rreq, (void*)(rdesc + 1));
+    ucp_recv_desc_release(rdesc);
+    ret = rreq + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
+
 UCS_PROFILE_FUNC(ucs_status_t, ucp_worker_set_am_handler,
                  (worker, id, cb, arg, flags),
                  ucp_worker_h worker, uint16_t id, 
@@ -353,6 +589,31 @@ static ucs_status_t ucp_am_zcopy_multi_reply(uct_pending_req_t *self)
                                  ucp_proto_am_zcopy_req_complete, 0);
 }
 
+static ucs_status_t ucp_am_progress_rndv_rts(uct_pending_req_t *self)
+{
+    return ucp_rndv_send_rts(self, UCP_AM_ID_AM_RNDV_RTS);
+}
+
+static ucs_status_t ucp_am_send_start_rndv(ucp_request_t *sreq)
+{
+    ucp_tag_t tag;
+
+    ucp_trace_req(sreq, "start am rndv to %s buffer %p length %zu",
+                  ucp_ep_peer_name(sreq->send.ep), sreq->send.buffer,
+                  sreq->send.length);
+    UCS_PROFILE_REQUEST_EVENT(sreq, "start_rndv", sreq->send.length);
+
+    /* send.am shares a union with send.tag, which is packed in the RTS */
+    tag                = UCP_AM_RNDV_TAG(sreq->send.am.am_id,
+                                         sreq->send.am.flags);
+    sreq->send.tag.tag = tag;
+
+    ucs_assert(sreq->send.lane == ucp_ep_get_am_lane(sreq->send.ep));
+    sreq->send.uct.func = ucp_am_progress_rndv_rts;
+
+    return ucp_rndv_reg_send_buffer(sreq);
+}
+
 static void ucp_am_send_req_init(ucp_request_t *req, ucp_ep_h ep,
                                  const void *buffer, uintptr_t datatype,
                                  size_t count, uint16_t flags, 
@@ -379,17 +640,27 @@ ucp_am_send_req(ucp_request_t *req, size_t count,
                 ucp_send_callback_t cb, const ucp_proto_t *proto)
 {
     
+    size_t rndv_thresh  = ucp_ep_config(req->send.ep)->am_u.rndv_thresh;
     size_t zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config,
-                                                        count, SIZE_MAX);
+                                                        count, rndv_thresh);
     ssize_t max_short   = ucp_am_get_short_max(req, msg_config);
     ucs_status_t status;
     
     status = ucp_request_send_start(req, max_short, 
-                                    zcopy_thresh, SIZE_MAX,
+                                    zcopy_thresh, rndv_thresh,
                                     count, msg_config,
                                     proto);
-    if (status != UCS_OK) {
-       return UCS_STATUS_PTR(status);
+    if (ucs_unlikely(status != UCS_OK)) {
+        if (status != UCS_ERR_NO_PROGRESS) {
+            return UCS_STATUS_PTR(status);
+        }
+
+        ucs_assert(req->send.length >= rndv_thresh);
+        status = ucp_am_send_start_rndv(req);
+        if (status != UCS_OK) {
+            return UCS_STATUS_PTR(status);
+        }
+        UCP_EP_STAT_TAG_OP(req->send.ep, RNDV);
     }
 
     /* Start the request.
@@ -554,20 +825,17 @@ ucp_am_handler(void *am_arg, void *am_data, size_t am_length,
                                  am_flags);    
 }
 
-static ucp_am_unfinished_t *
-ucp_am_find_unfinished(ucp_worker_h worker, ucp_ep_h ep, 
-                       ucp_ep_ext_proto_t *ep_ext, 
-                       ucp_am_long_hdr_t *hdr, size_t am_length)
+static UCS_F_ALWAYS_INLINE ucp_am_unfinished_t *
+ucp_am_find_unfinished(ucp_worker_h worker, ucp_am_long_hdr_t *hdr)
 {
-    ucp_am_unfinished_t *unfinished;
-    /* TODO make this hash table for faster lookup */
-    ucs_list_for_each(unfinished, &ep_ext->am.started_ams, list) {
-        if (unfinished->msg_id == hdr->msg_id) {
-            return unfinished;
-        }
+    khiter_t iter;
+
+    iter = kh_get(ucp_am_unfinished_hash, &worker->am.unfinished, hdr->msg_id);
+    if (iter == kh_end(&worker->am.unfinished)) {
+        return NULL;
     }
-    
-    return NULL;
+
+    return kh_value(&worker->am.unfinished, iter);
 }
 
 static ucs_status_t
@@ -576,6 +844,7 @@ ucp_am_handle_unfinished(ucp_worker_h worker,
                          ucp_am_long_hdr_t *long_hdr, 
                          size_t am_length, ucp_ep_h reply_ep) 
 {
+    ucp_recv_desc_t *all_data;
     uint16_t am_id;
     ucs_status_t status;
 
@@ -583,19 +852,18 @@ ucp_am_handle_unfinished(ucp_worker_h worker,
            long_hdr + 1, am_length - sizeof(*long_hdr));
     unfinished->left -= am_length - sizeof(*long_hdr);
     if (unfinished->left == 0) {
-        am_id = long_hdr->am_id;
+        all_data = unfinished->all_data;
+        ucp_am_unfinished_release(worker, unfinished);
+
+        am_id  = long_hdr->am_id;
         status = worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context,
-                                          unfinished->all_data + 1,
+                                          all_data + 1,
                                           long_hdr->total_size,
                                           reply_ep,
                                           UCP_CB_PARAM_FLAG_DATA);
-
         if (status != UCS_INPROGRESS) {
-            ucs_free(unfinished->all_data);
+            ucp_am_rdesc_put(all_data);
         }
-
-        ucs_list_del(&unfinished->list);
-        ucs_free(unfinished);
     }
     
     return UCS_OK;
@@ -613,6 +881,8 @@ ucp_am_long_handler_common(void *am_arg, void *am_data, size_t am_length,
     ucp_recv_desc_t *all_data;
     size_t left;
     ucp_am_unfinished_t *unfinished;
+    khiter_t iter;
+    int ret;
 
     if (ucs_unlikely((long_hdr->am_id >= worker->am_cb_array_len) ||
                      (worker->am_cbs[long_hdr->am_id].cb == NULL))) {
@@ -626,8 +896,7 @@ ucp_am_long_handler_common(void *am_arg, void *am_data, size_t am_length,
      * have arrived. If any messages have arrived,
      * we copy ourselves into the buffer and leave
      */
-    unfinished = ucp_am_find_unfinished(worker, ep, ep_ext, long_hdr, am_length);
-    
+    unfinished = ucp_am_find_unfinished(worker, long_hdr);
     if (unfinished) {
         return ucp_am_handle_unfinished(worker, unfinished, 
                                         long_hdr, am_length,
@@ -637,14 +906,11 @@ ucp_am_long_handler_common(void *am_arg, void *am_data, size_t am_length,
     /* If I am first, I make the buffer for everyone to go into,
      * copy myself in, and put myself on the list so people can find me
      */
-    all_data = ucs_malloc(long_hdr->total_size + sizeof(ucp_recv_desc_t),
-                          "ucp recv desc for long AM");
+    all_data = ucp_am_rdesc_get(worker, long_hdr->total_size);
     if (ucs_unlikely(all_data == NULL)) {
         return UCS_ERR_NO_MEMORY;
     }
 
-    all_data->flags = UCP_RECV_DESC_FLAG_MALLOC;
-
     left = long_hdr->total_size - (am_length -
                                    sizeof(ucp_am_long_hdr_t));
     
@@ -652,16 +918,24 @@ ucp_am_long_handler_common(void *am_arg, void *am_data, size_t am_length,
            long_hdr + 1, am_length - sizeof(ucp_am_long_hdr_t));
     
     /* Can't use a desc for this because of the buffer */
-    unfinished           = ucs_malloc(sizeof(ucp_am_unfinished_t),
-                                         "unfinished UCP AM");
+    unfinished = ucs_mpool_get_inline(&worker->am.unfinished_mp);
     if (ucs_unlikely(unfinished == NULL)) {
-        ucs_free(all_data);
+        ucp_am_rdesc_put(all_data);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    iter = kh_put(ucp_am_unfinished_hash, &worker->am.unfinished,
+                  long_hdr->msg_id, &ret);
+    if (ucs_unlikely(ret == -1)) {
+        ucs_mpool_put_inline(unfinished);
+        ucp_am_rdesc_put(all_data);
         return UCS_ERR_NO_MEMORY;
     }
 
     unfinished->all_data = all_data;
     unfinished->left     = left;
     unfinished->msg_id   = long_hdr->msg_id;
+    kh_value(&worker->am.unfinished, iter) = unfinished;
 
     ucs_list_add_head(&ep_ext->am.started_ams, &unfinished->list);
 
@@ -689,6 +963,75 @@ ucp_am_long_handler(void *am_arg, void *am_data, size_t am_length,
                                       NULL); 
 }
 
+UCS_PROFILE_FUNC(ucs_status_t, ucp_am_rndv_rts_handler,
+                 (arg, data, length, tl_flags),
+                 void *arg, void *data, size_t length, unsigned tl_flags)
+{
+    ucp_worker_h worker         = arg;
+    ucp_rndv_rts_hdr_t *rts_hdr = data;
+    uint16_t am_id              = UCP_AM_RNDV_TAG_AM_ID(rts_hdr->super.tag);
+    ucp_ep_h reply_ep           = NULL;
+    ucp_worker_am_entry_t *am_cb;
+    ucp_recv_desc_t *rdesc;
+    ucp_request_t *rreq;
+    ucs_status_t status;
+
+    if (ucs_unlikely((am_id >= worker->am_cb_array_len) ||
+                     (worker->am_cbs[am_id].cb == NULL))) {
+        ucs_warn("UCP Active Message was received with id : %u, but there"
+                 "is no registered callback for that id", am_id);
+        ucp_am_rndv_drop(worker, rts_hdr);
+        return UCS_OK;
+    }
+
+    am_cb = &worker->am_cbs[am_id];
+    if (UCP_AM_RNDV_TAG_FLAGS(rts_hdr->super.tag) & UCP_AM_SEND_REPLY) {
+        reply_ep = ucp_worker_get_ep_by_ptr(worker, rts_hdr->sreq.ep_ptr);
+    }
+
+    if (am_cb->flags & UCP_AM_FLAG_RNDV) {
+        /* The user provides the receive buffer. The descriptor may be
+         * released from within the callback, so never keep the UCT one. */
+        status = ucp_recv_desc_init(worker, data, length, 0,
+                                    tl_flags & ~UCT_CB_PARAM_FLAG_DESC, 0,
+                                    UCP_RECV_DESC_FLAG_RNDV, 0, &rdesc);
+        if (ucs_unlikely(UCS_STATUS_IS_ERR(status))) {
+            return status;
+        }
+
+        status = am_cb->cb(am_cb->context, rdesc + 1, rts_hdr->size, reply_ep,
+                           UCP_CB_PARAM_FLAG_RNDV);
+        if (status != UCS_INPROGRESS) {
+            ucp_am_rndv_drop(worker, rts_hdr);
+            ucp_recv_desc_release(rdesc);
+        }
+        return UCS_OK;
+    }
+
+    /* Receive to an internal buffer, and invoke the callback when all data
+     * has arrived */
+    rdesc = ucp_am_rdesc_get(worker, rts_hdr->size);
+    if (ucs_unlikely(rdesc == NULL)) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    rreq = ucp_request_get(worker);
+    if (ucs_unlikely(rreq == NULL)) {
+        ucp_am_rdesc_put(rdesc);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    ucp_am_rndv_rreq_init(rreq, worker, rdesc + 1, rts_hdr->size,
+                          ucp_dt_make_contig(1),
+                          UCP_REQUEST_FLAG_CALLBACK | UCP_REQUEST_FLAG_RELEASED);
+    rreq->recv.tag.cb      = ucp_am_rndv_internal_recv_completed;
+    rreq->recv.am.am_id    = am_id;
+    rreq->recv.am.reply_ep = reply_ep;
+
+    ucp_rndv_matched(worker, rreq, rts_hdr);
+    return UCS_OK;
+}
+
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE,
               ucp_am_handler, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_MULTI,
@@ -697,6 +1040,8 @@ UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE_REPLY,
               ucp_am_handler_reply, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_MULTI_REPLY,
               ucp_am_long_handler_reply, NULL, 0);
+UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_AM_RNDV_RTS,
+              ucp_am_rndv_rts_handler, NULL, 0);
 
 const ucp_proto_t ucp_am_proto = {
     .contig_short           = ucp_am_contig_short,
@@ -4,10 +4,31 @@
  * See file LICENSE for terms.
  */
 
+#ifndef UCP_AM_H_
+#define UCP_AM_H_
+
 #include "ucp_ep.h"
 
+#include <ucs/datastruct/khash.h>
+#include <ucs/datastruct/mpool.h>
+
 #define UCP_AM_CB_BLOCK_SIZE 16
 
+/* Reassembly buffers of multi-fragment AMs are taken from power-of-2 sized
+ * memory pools, from 2^UCP_AM_RDESC_MP_MIN_SHIFT to 2^UCP_AM_RDESC_MP_MAX_SHIFT
+ * bytes. Larger messages are reassembled in a malloc'ed buffer. */
+#define UCP_AM_RDESC_MP_MIN_SHIFT  12
+#define UCP_AM_RDESC_MP_MAX_SHIFT  20
+#define UCP_AM_RDESC_MP_COUNT      (UCP_AM_RDESC_MP_MAX_SHIFT - \
+                                    UCP_AM_RDESC_MP_MIN_SHIFT + 1)
+#define UCP_AM_RDESC_MP_CHUNK_SIZE (1ul << UCP_AM_RDESC_MP_MAX_SHIFT)
+
+/* Rendezvous AMs reuse the tag-matching RTS header, with the AM id and the
+ * send flags packed in place of the tag */
+#define UCP_AM_RNDV_TAG(_am_id, _flags) (((uint64_t)(_flags) << 16) | (_am_id))
+#define UCP_AM_RNDV_TAG_AM_ID(_tag)     ((uint16_t)(_tag))
+#define UCP_AM_RNDV_TAG_FLAGS(_tag)     ((uint16_t)((_tag) >> 16))
+
 
 typedef union {
     struct {
@@ -42,12 +63,35 @@ typedef struct {
 } UCS_S_PACKED ucp_am_long_hdr_t;
 
 typedef struct {
-    ucs_list_link_t   list;       /* entry into list of unfinished AM's */
+    ucs_list_link_t   list;       /* entry into endpoint list of unfinished AM's */
     ucp_recv_desc_t  *all_data;   /* buffer for all parts of the AM */
     uint64_t          msg_id;     /* way to match up all parts of AM */
     size_t            left;
 } ucp_am_unfinished_t;
 
+
+/* Hash of AM's which are being reassembled, keyed by message id */
+__KHASH_TYPE(ucp_am_unfinished_hash, uint64_t, ucp_am_unfinished_t*);
+
+
+/**
+ * Worker-wide context of multi-fragment active messages
+ */
+typedef struct ucp_am_worker {
+    khash_t(ucp_am_unfinished_hash) unfinished;    /* In-progress reassemblies */
+    ucs_mpool_t                     unfinished_mp; /* Pool of reassembly records */
+    ucs_mpool_t                     rdesc_mp[UCP_AM_RDESC_MP_COUNT];
+                                                   /* Size-classed pools of
+                                                      reassembly buffers */
+} ucp_am_worker_t;
+
+
+ucs_status_t ucp_am_worker_init(ucp_worker_h worker);
+
+void ucp_am_worker_cleanup(ucp_worker_h worker);
+
 void ucp_am_ep_init(ucp_ep_h ep);
 
 void ucp_am_ep_cleanup(ucp_ep_h ep);
+
+#endif
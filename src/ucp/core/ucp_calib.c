@@ -0,0 +1,975 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "ucp_calib.h"
+#include "ucp_worker.h"
+
+#include <ucs/algorithm/crc.h>
+#include <ucs/async/async.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/sys/string.h>
+#include <ucs/sys/sys.h>
+#include <ucs/time/time.h>
+#include <sys/utsname.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <limits.h>
+
+
+/* Active message id which is used only while calibrating, before the UCP
+ * handlers are installed on the interface */
+#define UCP_CALIB_AM_ID             (UCT_AM_ID_MAX - 1)
+
+#define UCP_CALIB_WARMUP_ITERS      16
+#define UCP_CALIB_LAT_ITERS         1000
+#define UCP_CALIB_OVH_ITERS         10000
+#define UCP_CALIB_OVH_BURST         32
+#define UCP_CALIB_BW_MIN_ITERS      64
+#define UCP_CALIB_BW_TOTAL_SIZE     (32 * UCS_MBYTE)
+#define UCP_CALIB_RMA_MAX_SIZE      UCS_MBYTE
+#define UCP_CALIB_TIMEOUT           1.0 /* seconds, per benchmark phase */
+#define UCP_CALIB_KEY_MAX           256
+#define UCP_CALIB_CACHE_HEADER      "# UCX transport calibration cache"
+
+
+typedef struct ucp_calib_test {
+    ucp_worker_iface_t     *wiface;
+    uct_ep_h               ep;
+    void                   *buffer;      /* bcopy source buffer */
+    size_t                 msg_size;     /* bcopy message size */
+    size_t                 send_count;
+    volatile size_t        recv_count;
+    volatile size_t        completed;    /* RMA completions */
+    uct_completion_t       comp;
+    ucs_time_t             deadline;
+} ucp_calib_test_t;
+
+
+typedef struct ucp_calib_cache_entry {
+    char                   tl_name[UCT_TL_NAME_MAX];
+    char                   dev_name[UCT_DEVICE_NAME_MAX];
+    ucp_calib_result_t     result;
+} ucp_calib_cache_entry_t;
+
+
+typedef struct ucp_calib_cache {
+    char                    key[UCP_CALIB_KEY_MAX];
+    char                    path[PATH_MAX];  /* Empty if the cache is disabled */
+    ucp_calib_cache_entry_t *entries;
+    unsigned                num_entries;
+    int                     loaded;
+} ucp_calib_cache_t;
+
+
+static const char *ucp_calib_source_names[] = {
+    [UCP_CALIB_SOURCE_NONE]     = "none",
+    [UCP_CALIB_SOURCE_DEFAULT]  = "default",
+    [UCP_CALIB_SOURCE_MEASURED] = "measured",
+    [UCP_CALIB_SOURCE_CACHED]   = "cached",
+    [UCP_CALIB_SOURCE_LAST]     = NULL
+};
+
+const char *ucp_calib_mode_names[] = {
+    [UCP_CALIB_MODE_OFF]     = "off",
+    [UCP_CALIB_MODE_ON]      = "on",
+    [UCP_CALIB_MODE_REFRESH] = "refresh",
+    [UCP_CALIB_MODE_LAST]    = NULL
+};
+
+
+static void ucp_calib_get_cpu_model(char *model, size_t max)
+{
+    char buf[256];
+    char *p;
+    FILE *f;
+
+    ucs_strncpy_zero(model, "unknown", max);
+
+    f = fopen("/proc/cpuinfo", "r");
+    if (f == NULL) {
+        return;
+    }
+
+    while (fgets(buf, sizeof(buf), f) != NULL) {
+        if (strncmp(buf, "model name", 10)) {
+            continue;
+        }
+
+        p = strchr(buf, ':');
+        if (p != NULL) {
+            ucs_strncpy_zero(model, ucs_strtrim(p + 1), max);
+        }
+        break;
+    }
+
+    fclose(f);
+}
+
+/* The calibration results depend on the CPU and the kernel, so the cache file
+ * is keyed by both; identical hosts produce the same key */
+static void ucp_calib_cache_init(ucp_context_h context, ucp_calib_cache_t *cache)
+{
+    const char *dir = context->config.calib_dir;
+    char model[128];
+    struct utsname uts;
+
+    ucp_calib_get_cpu_model(model, sizeof(model));
+    if (uname(&uts) < 0) {
+        ucs_strncpy_zero(uts.machine, "unknown", sizeof(uts.machine));
+        ucs_strncpy_zero(uts.release, "unknown", sizeof(uts.release));
+    }
+
+    ucs_snprintf_zero(cache->key, sizeof(cache->key), "%s|%s|%s", model,
+                      uts.machine, uts.release);
+
+    cache->entries     = NULL;
+    cache->num_entries = 0;
+    cache->loaded      = 0;
+
+    if (!strcmp(dir, "none")) {
+        cache->path[0] = '\0';
+        return;
+    }
+
+    ucs_snprintf_zero(cache->path, sizeof(cache->path), "%s/ucx_calib_%u_%08x",
+                      strlen(dir) ? dir : ucs_get_tmpdir(), geteuid(),
+                      ucs_crc32(0, cache->key, strlen(cache->key)));
+}
+
+static void ucp_calib_cache_cleanup(ucp_calib_cache_t *cache)
+{
+    ucs_free(cache->entries);
+}
+
+static ucp_calib_cache_entry_t *
+ucp_calib_cache_find(ucp_calib_cache_t *cache, const uct_tl_resource_desc_t *tl_rsc)
+{
+    ucp_calib_cache_entry_t *entry;
+
+    for (entry = cache->entries; entry < cache->entries + cache->num_entries;
+         ++entry) {
+        if (!strcmp(entry->tl_name, tl_rsc->tl_name) &&
+            !strcmp(entry->dev_name, tl_rsc->dev_name)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static ucp_calib_cache_entry_t *
+ucp_calib_cache_add(ucp_calib_cache_t *cache, const char *tl_name,
+                    const char *dev_name)
+{
+    ucp_calib_cache_entry_t *entries, *entry;
+
+    entries = ucs_realloc(cache->entries,
+                          (cache->num_entries + 1) * sizeof(*entries),
+                          "ucp_calib_cache");
+    if (entries == NULL) {
+        return NULL;
+    }
+
+    cache->entries = entries;
+    entry          = &entries[cache->num_entries++];
+    ucs_strncpy_zero(entry->tl_name, tl_name, sizeof(entry->tl_name));
+    ucs_strncpy_zero(entry->dev_name, dev_name, sizeof(entry->dev_name));
+    return entry;
+}
+
+static void ucp_calib_cache_load(ucp_calib_cache_t *cache)
+{
+    char tl_name[64], dev_name[64];
+    ucp_calib_cache_entry_t *entry;
+    ucp_calib_result_t result;
+    char line[512];
+    struct stat st;
+    int key_match;
+    FILE *f;
+
+    if (cache->loaded) {
+        return;
+    }
+
+    cache->loaded = 1;
+    if (!strlen(cache->path)) {
+        return;
+    }
+
+    f = fopen(cache->path, "r");
+    if (f == NULL) {
+        ucs_debug("calibration cache '%s' is not available: %m", cache->path);
+        return;
+    }
+
+    /* Do not trust a file which could be modified by another user */
+    if ((fstat(fileno(f), &st) < 0) || (st.st_uid != geteuid()) ||
+        (st.st_mode & (S_IWGRP | S_IWOTH))) {
+        ucs_warn("ignoring calibration cache '%s': not owned by the user or "
+                 "writable by others", cache->path);
+        goto out;
+    }
+
+    key_match = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (line[0] == '#') {
+            continue;
+        } else if (!strncmp(line, "key ", 4)) {
+            key_match = !strcmp(ucs_strtrim(line + 4), cache->key);
+            if (!key_match) {
+                ucs_debug("calibration cache '%s' has a different key",
+                          cache->path);
+                break;
+            }
+            continue;
+        } else if (!key_match) {
+            break;
+        }
+
+        if ((sscanf(line, "%63s %63s %zu %lf %lf %lf", tl_name, dev_name,
+                    &result.msg_size, &result.overhead, &result.latency,
+                    &result.bandwidth) != 6) ||
+            (result.bandwidth <= 0)) {
+            ucs_debug("invalid line in calibration cache '%s': %s", cache->path,
+                      line);
+            continue;
+        }
+
+        entry = ucp_calib_cache_add(cache, tl_name, dev_name);
+        if (entry == NULL) {
+            break;
+        }
+
+        result.source = UCP_CALIB_SOURCE_CACHED;
+        entry->result = result;
+    }
+
+    ucs_debug("loaded %u entries from calibration cache '%s'",
+              cache->num_entries, cache->path);
+out:
+    fclose(f);
+}
+
+static void ucp_calib_cache_update(ucp_calib_cache_t *cache,
+                                   const uct_tl_resource_desc_t *tl_rsc,
+                                   const ucp_calib_result_t *result)
+{
+    ucp_calib_cache_entry_t *entry;
+
+    entry = ucp_calib_cache_find(cache, tl_rsc);
+    if (entry == NULL) {
+        entry = ucp_calib_cache_add(cache, tl_rsc->tl_name, tl_rsc->dev_name);
+        if (entry == NULL) {
+            return;
+        }
+    }
+
+    entry->result = *result;
+}
+
+/* Write to a temporary file and rename it, so concurrent processes on the
+ * same host never observe a partially written cache */
+static void ucp_calib_cache_save(ucp_calib_cache_t *cache)
+{
+    char tmp_path[PATH_MAX];
+    ucp_calib_cache_entry_t *entry;
+    FILE *f;
+    int fd;
+
+    if (!strlen(cache->path)) {
+        return;
+    }
+
+    ucs_snprintf_zero(tmp_path, sizeof(tmp_path), "%s.%d", cache->path,
+                      getpid());
+
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        ucs_debug("failed to create calibration cache '%s': %m", tmp_path);
+        return;
+    }
+
+    f = fdopen(fd, "w");
+    if (f == NULL) {
+        close(fd);
+        goto err_unlink;
+    }
+
+    fprintf(f, "%s\n", UCP_CALIB_CACHE_HEADER);
+    fprintf(f, "# tl dev msg_size overhead[sec] latency[sec] bandwidth[B/sec]\n");
+    fprintf(f, "key %s\n", cache->key);
+    for (entry = cache->entries; entry < cache->entries + cache->num_entries;
+         ++entry) {
+        fprintf(f, "%s %s %zu %.9e %.9e %.9e\n", entry->tl_name,
+                entry->dev_name, entry->result.msg_size, entry->result.overhead,
+                entry->result.latency, entry->result.bandwidth);
+    }
+
+    if (fclose(f) != 0) {
+        goto err_unlink;
+    }
+
+    if (rename(tmp_path, cache->path) < 0) {
+        ucs_debug("failed to rename '%s' to '%s': %m", tmp_path, cache->path);
+        goto err_unlink;
+    }
+
+    ucs_debug("saved %u entries to calibration cache '%s'", cache->num_entries,
+              cache->path);
+    return;
+
+err_unlink:
+    unlink(tmp_path);
+}
+
+static ucs_status_t ucp_calib_am_handler(void *arg, void *data, size_t length,
+                                         unsigned flags)
+{
+    ucp_calib_test_t *test = arg;
+
+    ++test->recv_count;
+    return UCS_OK;
+}
+
+static size_t ucp_calib_pack_cb(void *dest, void *arg)
+{
+    ucp_calib_test_t *test = arg;
+
+    memcpy(dest, test->buffer, test->msg_size);
+    return test->msg_size;
+}
+
+static void ucp_calib_completion_cb(uct_completion_t *self, ucs_status_t status)
+{
+    ucp_calib_test_t *test = ucs_container_of(self, ucp_calib_test_t, comp);
+
+    ++test->completed;
+}
+
+static void ucp_calib_progress(ucp_calib_test_t *test)
+{
+    uct_iface_progress(test->wiface->iface);
+    ucs_async_check_miss(&test->wiface->worker->async);
+}
+
+static void ucp_calib_set_deadline(ucp_calib_test_t *test)
+{
+    test->deadline = ucs_get_time() + ucs_time_from_sec(UCP_CALIB_TIMEOUT);
+}
+
+static int ucp_calib_is_timeout(ucp_calib_test_t *test)
+{
+    return ucs_get_time() > test->deadline;
+}
+
+static ucs_status_t ucp_calib_wait_recv(ucp_calib_test_t *test)
+{
+    while (test->recv_count < test->send_count) {
+        if (ucp_calib_is_timeout(test)) {
+            return UCS_ERR_TIMED_OUT;
+        }
+        ucp_calib_progress(test);
+    }
+
+    return UCS_OK;
+}
+
+static ucs_status_t ucp_calib_post_small(ucp_calib_test_t *test)
+{
+    uint64_t hdr = 0;
+    ucs_status_t status;
+    ssize_t packed_len;
+    size_t msg_size;
+
+    if (test->wiface->attr.cap.flags & UCT_IFACE_FLAG_AM_SHORT) {
+        status = uct_ep_am_short(test->ep, UCP_CALIB_AM_ID, hdr, NULL, 0);
+    } else {
+        msg_size       = test->msg_size;
+        test->msg_size = sizeof(hdr);
+        packed_len     = uct_ep_am_bcopy(test->ep, UCP_CALIB_AM_ID,
+                                         ucp_calib_pack_cb, test, 0);
+        test->msg_size = msg_size;
+        status         = (packed_len < 0) ? (ucs_status_t)packed_len : UCS_OK;
+    }
+
+    if (status == UCS_OK) {
+        ++test->send_count;
+    }
+    return status;
+}
+
+static ucs_status_t ucp_calib_post_bcopy(ucp_calib_test_t *test)
+{
+    ssize_t packed_len;
+
+    packed_len = uct_ep_am_bcopy(test->ep, UCP_CALIB_AM_ID, ucp_calib_pack_cb,
+                                 test, 0);
+    if (packed_len < 0) {
+        return (ucs_status_t)packed_len;
+    }
+
+    ++test->send_count;
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucp_calib_send(ucp_calib_test_t *test,
+               ucs_status_t (*post)(ucp_calib_test_t *test))
+{
+    ucs_status_t status;
+
+    for (;;) {
+        status = post(test);
+        if (status != UCS_ERR_NO_RESOURCE) {
+            return status;
+        }
+
+        if (ucp_calib_is_timeout(test)) {
+            return UCS_ERR_TIMED_OUT;
+        }
+        ucp_calib_progress(test);
+    }
+}
+
+static ucs_status_t ucp_calib_flush(ucp_calib_test_t *test)
+{
+    ucs_status_t status;
+
+    ucp_calib_set_deadline(test);
+    for (;;) {
+        status = uct_ep_flush(test->ep, 0, NULL);
+        if ((status != UCS_INPROGRESS) && (status != UCS_ERR_NO_RESOURCE)) {
+            return status;
+        }
+
+        if (ucp_calib_is_timeout(test)) {
+            return UCS_ERR_TIMED_OUT;
+        }
+        ucp_calib_progress(test);
+    }
+}
+
+/* Ping a small message and wait for it to arrive; the one-way time includes
+ * the send and receive overheads */
+static ucs_status_t ucp_calib_am_latency(ucp_calib_test_t *test, double *time_p)
+{
+    ucs_time_t start_time = 0;
+    ucs_status_t status;
+    unsigned i;
+
+    ucp_calib_set_deadline(test);
+    for (i = 0; i < UCP_CALIB_WARMUP_ITERS + UCP_CALIB_LAT_ITERS; ++i) {
+        if (i == UCP_CALIB_WARMUP_ITERS) {
+            start_time = ucs_get_time();
+        }
+
+        status = ucp_calib_send(test, ucp_calib_post_small);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        status = ucp_calib_wait_recv(test);
+        if (status != UCS_OK) {
+            return status;
+        }
+    }
+
+    *time_p = ucs_time_to_sec(ucs_get_time() - start_time) / UCP_CALIB_LAT_ITERS;
+    return UCS_OK;
+}
+
+/* Post bursts of small messages and account only the time spent in the send
+ * calls */
+static ucs_status_t ucp_calib_am_overhead(ucp_calib_test_t *test,
+                                          double *overhead_p)
+{
+    ucs_time_t send_time = 0;
+    ucs_time_t start_time;
+    ucs_status_t status;
+    unsigned burst, count;
+
+    ucp_calib_set_deadline(test);
+    count = 0;
+    while (count < UCP_CALIB_OVH_ITERS) {
+        start_time = ucs_get_time();
+        for (burst = 0; (burst < UCP_CALIB_OVH_BURST) &&
+                        (count < UCP_CALIB_OVH_ITERS); ++burst) {
+            status = ucp_calib_post_small(test);
+            if (status == UCS_ERR_NO_RESOURCE) {
+                break;
+            } else if (status != UCS_OK) {
+                return status;
+            }
+            ++count;
+        }
+        send_time += ucs_get_time() - start_time;
+
+        if (ucp_calib_is_timeout(test)) {
+            return UCS_ERR_TIMED_OUT;
+        }
+        ucp_calib_progress(test);
+    }
+
+    status = ucp_calib_wait_recv(test);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    *overhead_p = ucs_time_to_sec(send_time) / UCP_CALIB_OVH_ITERS;
+    return UCS_OK;
+}
+
+static ucs_status_t ucp_calib_am_bandwidth(ucp_calib_test_t *test,
+                                           double *bandwidth_p)
+{
+    ucs_time_t start_time = 0;
+    ucs_status_t status;
+    size_t i, count;
+
+    count = ucs_max(UCP_CALIB_BW_MIN_ITERS,
+                    UCP_CALIB_BW_TOTAL_SIZE / test->msg_size);
+
+    ucp_calib_set_deadline(test);
+    for (i = 0; i < UCP_CALIB_WARMUP_ITERS + count; ++i) {
+        if (i == UCP_CALIB_WARMUP_ITERS) {
+            status = ucp_calib_wait_recv(test);
+            if (status != UCS_OK) {
+                return status;
+            }
+            start_time = ucs_get_time();
+        }
+
+        status = ucp_calib_send(test, ucp_calib_post_bcopy);
+        if (status != UCS_OK) {
+            return status;
+        }
+    }
+
+    status = ucp_calib_wait_recv(test);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    *bandwidth_p = (count * test->msg_size) /
+                   ucs_time_to_sec(ucs_get_time() - start_time);
+    return UCS_OK;
+}
+
+static ucs_status_t ucp_calib_measure_am(ucp_calib_test_t *test,
+                                         ucp_calib_result_t *result)
+{
+    uct_iface_h iface = test->wiface->iface;
+    double oneway, overhead, bandwidth;
+    ucs_status_t status;
+
+    status = uct_iface_set_am_handler(iface, UCP_CALIB_AM_ID,
+                                      ucp_calib_am_handler, test,
+                                      (test->wiface->attr.cap.flags &
+                                       UCT_IFACE_FLAG_CB_SYNC) ?
+                                      0 : UCT_CB_FLAG_ASYNC);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    status = ucp_calib_am_latency(test, &oneway);
+    if (status != UCS_OK) {
+        goto out;
+    }
+
+    status = ucp_calib_am_overhead(test, &overhead);
+    if (status != UCS_OK) {
+        goto out;
+    }
+
+    if (test->wiface->attr.cap.flags & UCT_IFACE_FLAG_AM_BCOPY) {
+        status = ucp_calib_am_bandwidth(test, &bandwidth);
+        if (status != UCS_OK) {
+            goto out;
+        }
+        result->bandwidth = bandwidth;
+    }
+
+    result->overhead = overhead;
+    result->latency  = ucs_max(oneway - (2 * overhead), 0);
+
+out:
+    (void)ucp_calib_flush(test);
+    uct_iface_set_am_handler(iface, UCP_CALIB_AM_ID, NULL, NULL, 0);
+    return status;
+}
+
+/* Transports without active messages are calibrated only for bandwidth, by
+ * zero-copy RMA operations between two buffers of the same process */
+static ucs_status_t ucp_calib_measure_rma(ucp_calib_test_t *test,
+                                          ucp_calib_result_t *result)
+{
+    ucp_context_h context       = test->wiface->worker->context;
+    ucp_tl_resource_desc_t *rsc = &context->tl_rscs[test->wiface->rsc_index];
+    ucp_tl_md_t *tl_md          = &context->tl_mds[rsc->md_index];
+    uct_component_h cmpt        = context->tl_cmpts[tl_md->cmpt_index].cmpt;
+    size_t size                 = result->msg_size;
+    int use_get                 = !!(test->wiface->attr.cap.flags &
+                                     UCT_IFACE_FLAG_GET_ZCOPY);
+    ucs_time_t start_time       = 0;
+    uct_rkey_bundle_t rkey_bundle;
+    uct_mem_h local_memh, remote_memh;
+    void *local, *remote;
+    void *rkey_buffer;
+    ucs_status_t status;
+    uct_iov_t iov;
+    size_t i, count;
+
+    if (!(tl_md->attr.cap.flags & UCT_MD_FLAG_REG)) {
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    local  = ucs_calloc(1, size, "ucp_calib_local");
+    remote = ucs_calloc(1, size, "ucp_calib_remote");
+    if ((local == NULL) || (remote == NULL)) {
+        status = UCS_ERR_NO_MEMORY;
+        goto out_free;
+    }
+
+    status = uct_md_mem_reg(tl_md->md, local, size, UCT_MD_MEM_ACCESS_ALL,
+                            &local_memh);
+    if (status != UCS_OK) {
+        goto out_free;
+    }
+
+    status = uct_md_mem_reg(tl_md->md, remote, size, UCT_MD_MEM_ACCESS_ALL,
+                            &remote_memh);
+    if (status != UCS_OK) {
+        goto out_dereg_local;
+    }
+
+    rkey_buffer = ucs_alloca(tl_md->attr.rkey_packed_size);
+    status      = uct_md_mkey_pack(tl_md->md, remote_memh, rkey_buffer);
+    if (status != UCS_OK) {
+        goto out_dereg_remote;
+    }
+
+    status = uct_rkey_unpack(cmpt, rkey_buffer, &rkey_bundle);
+    if (status != UCS_OK) {
+        goto out_dereg_remote;
+    }
+
+    iov.buffer    = local;
+    iov.length    = size;
+    iov.memh      = local_memh;
+    iov.stride    = 0;
+    iov.count     = 1;
+
+    test->comp.func = ucp_calib_completion_cb;
+    count           = ucs_max(UCP_CALIB_BW_MIN_ITERS,
+                              UCP_CALIB_BW_TOTAL_SIZE / size);
+
+    ucp_calib_set_deadline(test);
+    for (i = 0; i < UCP_CALIB_WARMUP_ITERS + count; ++i) {
+        if (i == UCP_CALIB_WARMUP_ITERS) {
+            start_time = ucs_get_time();
+        }
+
+        test->comp.count = 1;
+        test->completed  = 0;
+        do {
+            if (use_get) {
+                status = uct_ep_get_zcopy(test->ep, &iov, 1, (uintptr_t)remote,
+                                          rkey_bundle.rkey, &test->comp);
+            } else {
+                status = uct_ep_put_zcopy(test->ep, &iov, 1, (uintptr_t)remote,
+                                          rkey_bundle.rkey, &test->comp);
+            }
+            if (status == UCS_ERR_NO_RESOURCE) {
+                ucp_calib_progress(test);
+            }
+        } while ((status == UCS_ERR_NO_RESOURCE) && !ucp_calib_is_timeout(test));
+
+        if (status == UCS_INPROGRESS) {
+            while (!test->completed && !ucp_calib_is_timeout(test)) {
+                ucp_calib_progress(test);
+            }
+            status = test->completed ? UCS_OK : UCS_ERR_TIMED_OUT;
+        }
+
+        if (status != UCS_OK) {
+            goto out_release_rkey;
+        }
+    }
+
+    result->bandwidth = (count * size) /
+                        ucs_time_to_sec(ucs_get_time() - start_time);
+
+out_release_rkey:
+    uct_rkey_release(cmpt, &rkey_bundle);
+out_dereg_remote:
+    uct_md_mem_dereg(tl_md->md, remote_memh);
+out_dereg_local:
+    uct_md_mem_dereg(tl_md->md, local_memh);
+out_free:
+    ucs_free(remote);
+    ucs_free(local);
+    return status;
+}
+
+static ucs_status_t ucp_calib_ep_create(ucp_worker_iface_t *wiface,
+                                        uct_ep_h *ep_p)
+{
+    uct_device_addr_t *dev_addr;
+    uct_iface_addr_t *iface_addr;
+    uct_ep_params_t ep_params;
+    ucs_status_t status;
+
+    dev_addr   = ucs_alloca(wiface->attr.device_addr_len);
+    iface_addr = ucs_alloca(wiface->attr.iface_addr_len);
+
+    status = uct_iface_get_device_address(wiface->iface, dev_addr);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    status = uct_iface_get_address(wiface->iface, iface_addr);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if (!uct_iface_is_reachable(wiface->iface, dev_addr, iface_addr)) {
+        return UCS_ERR_UNREACHABLE;
+    }
+
+    ep_params.field_mask = UCT_EP_PARAM_FIELD_IFACE    |
+                           UCT_EP_PARAM_FIELD_DEV_ADDR |
+                           UCT_EP_PARAM_FIELD_IFACE_ADDR;
+    ep_params.iface      = wiface->iface;
+    ep_params.dev_addr   = dev_addr;
+    ep_params.iface_addr = iface_addr;
+    return uct_ep_create(&ep_params, ep_p);
+}
+
+static size_t ucp_calib_msg_size(const uct_iface_attr_t *attr)
+{
+    if (attr->cap.flags & UCT_IFACE_FLAG_AM_BCOPY) {
+        return attr->cap.am.max_bcopy;
+    } else if (attr->cap.flags & UCT_IFACE_FLAG_GET_ZCOPY) {
+        return ucs_min(attr->cap.get.max_zcopy, UCP_CALIB_RMA_MAX_SIZE);
+    } else if (attr->cap.flags & UCT_IFACE_FLAG_PUT_ZCOPY) {
+        return ucs_min(attr->cap.put.max_zcopy, UCP_CALIB_RMA_MAX_SIZE);
+    }
+
+    return 0;
+}
+
+static void ucp_calib_measure(ucp_worker_iface_t *wiface,
+                              ucp_calib_result_t *result)
+{
+    ucp_context_h context            = wiface->worker->context;
+    ucp_tl_resource_desc_t *resource = &context->tl_rscs[wiface->rsc_index];
+    const uct_iface_attr_t *attr     = &wiface->attr;
+    ucp_calib_test_t test;
+    ucs_status_t status;
+
+    /* Start from the transport estimates, benchmarks override what they can */
+    result->overhead  = attr->overhead;
+    result->latency   = attr->latency.overhead;
+    result->bandwidth = attr->bandwidth.dedicated + attr->bandwidth.shared;
+    result->msg_size  = ucp_calib_msg_size(attr);
+    result->source    = UCP_CALIB_SOURCE_DEFAULT;
+
+    if ((resource->flags & UCP_TL_RSC_FLAG_SOCKADDR) ||
+        !(attr->cap.flags & UCT_IFACE_FLAG_CONNECT_TO_IFACE) ||
+        (result->msg_size == 0)) {
+        return;
+    }
+
+    memset(&test, 0, sizeof(test));
+    test.wiface   = wiface;
+    test.msg_size = result->msg_size;
+
+    status = ucp_calib_ep_create(wiface, &test.ep);
+    if (status != UCS_OK) {
+        goto out;
+    }
+
+    if (attr->cap.flags & (UCT_IFACE_FLAG_AM_SHORT | UCT_IFACE_FLAG_AM_BCOPY)) {
+        test.buffer = ucs_calloc(1, ucs_max(test.msg_size, sizeof(uint64_t)),
+                                 "ucp_calib_buffer");
+        if (test.buffer == NULL) {
+            status = UCS_ERR_NO_MEMORY;
+        } else {
+            status = ucp_calib_measure_am(&test, result);
+            ucs_free(test.buffer);
+        }
+    } else {
+        status = ucp_calib_measure_rma(&test, result);
+    }
+
+    uct_ep_destroy(test.ep);
+
+out:
+    if (status != UCS_OK) {
+        ucs_info("failed to calibrate "UCT_TL_RESOURCE_DESC_FMT": %s, using "
+                 "the transport performance estimates",
+                 UCT_TL_RESOURCE_DESC_ARG(&resource->tl_rsc),
+                 ucs_status_string(status));
+        result->overhead  = attr->overhead;
+        result->latency   = attr->latency.overhead;
+        result->bandwidth = attr->bandwidth.dedicated + attr->bandwidth.shared;
+        return;
+    }
+
+    result->source = UCP_CALIB_SOURCE_MEASURED;
+    ucs_debug("calibrated "UCT_TL_RESOURCE_DESC_FMT": overhead %.2fns latency "
+              "%.2fns bandwidth %.2fMB/s (%zu bytes)",
+              UCT_TL_RESOURCE_DESC_ARG(&resource->tl_rsc),
+              result->overhead * 1e9, result->latency * 1e9,
+              result->bandwidth / UCS_MBYTE, result->msg_size);
+}
+
+static void ucp_calib_apply(ucp_worker_iface_t *wiface,
+                            const ucp_calib_result_t *result)
+{
+    ucp_context_h context    = wiface->worker->context;
+    uct_device_type_t type   = context->tl_rscs[wiface->rsc_index].tl_rsc.dev_type;
+    uct_iface_attr_t *attr   = &wiface->attr;
+    double bandwidth, scale;
+
+    if ((result->source != UCP_CALIB_SOURCE_MEASURED) &&
+        (result->source != UCP_CALIB_SOURCE_CACHED)) {
+        return;
+    }
+
+    attr->overhead = result->overhead;
+
+    /* Loopback traffic of a network device does not reach the wire, so the
+     * measured latency says nothing about the network, and the bandwidth is
+     * only an upper bound of what the host can drive */
+    bandwidth = attr->bandwidth.dedicated + attr->bandwidth.shared;
+    if (type == UCT_DEVICE_TYPE_NET) {
+        if (result->bandwidth >= bandwidth) {
+            return;
+        }
+    } else {
+        attr->latency.overhead = result->latency;
+    }
+
+    /* Keep the split between dedicated and shared bandwidth */
+    if (bandwidth > 0) {
+        scale                     = result->bandwidth / bandwidth;
+        attr->bandwidth.dedicated = attr->bandwidth.dedicated * scale;
+        attr->bandwidth.shared    = attr->bandwidth.shared    * scale;
+    } else {
+        attr->bandwidth.dedicated = result->bandwidth;
+    }
+}
+
+void ucp_calib_worker_ifaces(ucp_worker_h worker)
+{
+    ucp_context_h context = worker->context;
+    int refresh           = (context->config.ext.calib_mode ==
+                             UCP_CALIB_MODE_REFRESH);
+    ucp_calib_cache_entry_t *entry;
+    ucp_tl_resource_desc_t *resource;
+    ucp_calib_result_t result;
+    ucp_worker_iface_t *wiface;
+    ucp_calib_cache_t cache;
+    unsigned iface_id;
+    int cache_init, updated;
+
+    if (context->config.ext.calib_mode == UCP_CALIB_MODE_OFF) {
+        return;
+    }
+
+    cache_init = 0;
+    updated    = 0;
+
+    for (iface_id = 0; iface_id < worker->num_ifaces; ++iface_id) {
+        wiface   = worker->ifaces[iface_id];
+        resource = &context->tl_rscs[wiface->rsc_index];
+
+        UCP_THREAD_CS_ENTER_CONDITIONAL(&context->mt_lock);
+        result = resource->calib;
+        UCP_THREAD_CS_EXIT_CONDITIONAL(&context->mt_lock);
+
+        if (result.source == UCP_CALIB_SOURCE_NONE) {
+            if (!cache_init) {
+                ucp_calib_cache_init(context, &cache);
+                cache_init = 1;
+            }
+
+            /* Load the cache file also when refreshing, to preserve the
+             * entries of transports which are not used by this process */
+            ucp_calib_cache_load(&cache);
+            entry = ucp_calib_cache_find(&cache, &resource->tl_rsc);
+            if (!refresh && (entry != NULL) &&
+                (entry->result.source == UCP_CALIB_SOURCE_CACHED) &&
+                (entry->result.msg_size == ucp_calib_msg_size(&wiface->attr))) {
+                result = entry->result;
+            } else {
+                ucp_calib_measure(wiface, &result);
+                if (result.source == UCP_CALIB_SOURCE_MEASURED) {
+                    ucp_calib_cache_update(&cache, &resource->tl_rsc, &result);
+                    updated = 1;
+                }
+            }
+
+            UCP_THREAD_CS_ENTER_CONDITIONAL(&context->mt_lock);
+            if (resource->calib.source == UCP_CALIB_SOURCE_NONE) {
+                resource->calib = result;
+            } else {
+                /* Another worker calibrated this resource concurrently */
+                result = resource->calib;
+            }
+            UCP_THREAD_CS_EXIT_CONDITIONAL(&context->mt_lock);
+        }
+
+        ucp_calib_apply(wiface, &result);
+    }
+
+    if (!cache_init) {
+        return;
+    }
+
+    if (updated) {
+        ucp_calib_cache_save(&cache);
+    }
+
+    ucp_calib_cache_cleanup(&cache);
+}
+
+void ucp_calib_print_info(ucp_worker_h worker, FILE *stream)
+{
+    ucp_context_h context = worker->context;
+    ucp_tl_resource_desc_t *resource;
+    const uct_iface_attr_t *attr;
+    ucp_worker_iface_t *wiface;
+    ucp_calib_cache_t cache;
+    char tl_dev[UCT_TL_NAME_MAX + UCT_DEVICE_NAME_MAX + 1];
+    unsigned iface_id;
+
+    ucp_calib_cache_init(context, &cache);
+    fprintf(stream, "#             calibration: %s, cache '%s'\n",
+            ucp_calib_mode_names[context->config.ext.calib_mode],
+            strlen(cache.path) ? cache.path : "none");
+    fprintf(stream, "#               cache key: %s\n", cache.key);
+    ucp_calib_cache_cleanup(&cache);
+
+    for (iface_id = 0; iface_id < worker->num_ifaces; ++iface_id) {
+        wiface   = worker->ifaces[iface_id];
+        resource = &context->tl_rscs[wiface->rsc_index];
+        attr     = &wiface->attr;
+        ucs_snprintf_zero(tl_dev, sizeof(tl_dev), UCT_TL_RESOURCE_DESC_FMT,
+                          UCT_TL_RESOURCE_DESC_ARG(&resource->tl_rsc));
+        fprintf(stream, "#  %22s : overhead %.2fns latency %.2fns "
+                "bandwidth %.2fMB/s (%s)\n", tl_dev, attr->overhead * 1e9,
+                attr->latency.overhead * 1e9,
+                ucp_tl_iface_bandwidth(context, &attr->bandwidth) / UCS_MBYTE,
+                ucp_calib_source_names[resource->calib.source]);
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCP_CALIB_H_
+#define UCP_CALIB_H_
+
+#include "ucp_types.h"
+
+#include <ucp/api/ucp_def.h>
+#include <stdio.h>
+
+
+/**
+ * Where the performance model of a transport resource was taken from.
+ */
+typedef enum {
+    UCP_CALIB_SOURCE_NONE,     /* Not calibrated yet */
+    UCP_CALIB_SOURCE_DEFAULT,  /* Could not measure, using transport estimates */
+    UCP_CALIB_SOURCE_MEASURED, /* Measured by this process */
+    UCP_CALIB_SOURCE_CACHED,   /* Loaded from the calibration cache file */
+    UCP_CALIB_SOURCE_LAST
+} ucp_calib_source_t;
+
+
+/**
+ * Performance model of a transport resource, obtained by loopback
+ * micro-benchmarks.
+ */
+typedef struct ucp_calib_result {
+    double          overhead;  /* Message send overhead, seconds */
+    double          latency;   /* One-way latency, excluding the send and
+                                  receive overheads, seconds */
+    double          bandwidth; /* Bandwidth of a single process, bytes/second */
+    size_t          msg_size;  /* Message size used to measure the bandwidth */
+    uint8_t         source;    /* Where the values came from, ucp_calib_source_t */
+} ucp_calib_result_t;
+
+
+extern const char *ucp_calib_mode_names[];
+
+
+/**
+ * Calibrate the transport interfaces which were opened on the worker and
+ * update their attributes with the measured performance. Results are kept on
+ * the context, so only the first worker runs the micro-benchmarks.
+ *
+ * Must be called before the active message handlers are set on the interfaces
+ * and before the interfaces are activated.
+ *
+ * @param [in]  worker  Worker whose interfaces to calibrate.
+ */
+void ucp_calib_worker_ifaces(ucp_worker_h worker);
+
+
+/**
+ * Print the performance model of the worker transports.
+ *
+ * @param [in]  worker  Worker whose transports to print.
+ * @param [in]  stream  Output stream.
+ */
+void ucp_calib_print_info(ucp_worker_h worker, FILE *stream);
+
+
+#endif
@@ -137,6 +137,11 @@ static ucs_config_field_t ucp_config_table[] = {
    "the eager_zcopy protocol",
    ucs_offsetof(ucp_config_t, ctx.rndv_perf_diff), UCS_CONFIG_TYPE_DOUBLE},
 
+  {"AM_RNDV_THRESH", "auto",
+   "Threshold for switching Active Messages from eager to rendezvous protocol.\n"
+   "\"auto\" uses the same threshold as the tag-matching rendezvous protocol.",
+   ucs_offsetof(ucp_config_t, ctx.am_rndv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"MAX_EAGER_LANES", NULL, "",
    ucs_offsetof(ucp_config_t, ctx.max_eager_lanes), UCS_CONFIG_TYPE_UINT},
 
@@ -255,6 +260,13 @@ static ucs_config_field_t ucp_config_table[] = {
    "of all entities which connect to each other are the same.",
    ucs_offsetof(ucp_config_t, ctx.unified_mode), UCS_CONFIG_TYPE_BOOL},
 
+  {"PREFER_NEAREST_DEVICE", "y",
+   "When the same transport is available on several devices, skip the devices\n"
+   "which are farther from the CPU running the first worker than another\n"
+   "device with the same or better capabilities and performance, according to\n"
+   "the NUMA distance between the device and the CPU.",
+   ucs_offsetof(ucp_config_t, ctx.prefer_nearest_device), UCS_CONFIG_TYPE_BOOL},
+
   {"SOCKADDR_CM_ENABLE", "n" /* TODO: set try by default */,
    "Enable alternative wireup protocol for sockaddr connected endpoints.\n"
    "Enabling this mode changes underlying UCT mechanism for connection\n"
@@ -262,6 +274,22 @@ static ucs_config_field_t ucp_config_table[] = {
    "require out of band synchronization before destroying UCP resources.",
    ucs_offsetof(ucp_config_t, ctx.sockaddr_cm_enable), UCS_CONFIG_TYPE_TERNARY},
 
+  {"CALIBRATE", "off",
+   "Measure the performance of the transports by loopback micro-benchmarks when\n"
+   "the first worker is created, and use the results instead of the built-in\n"
+   "estimates for transport selection and protocol thresholds.\n"
+   " off     - use the built-in performance estimates of the transports.\n"
+   " on      - use the results from the calibration cache file, and measure\n"
+   "           the transports which are missing from it.\n"
+   " refresh - measure all transports and update the calibration cache file.",
+   ucs_offsetof(ucp_config_t, ctx.calib_mode), UCS_CONFIG_TYPE_ENUM(ucp_calib_mode_names)},
+
+  {"CALIBRATE_DIR", "",
+   "Directory of the per-host calibration cache file. The file name is derived\n"
+   "from the user id, the CPU model and the kernel version. Empty value means\n"
+   "the temporary directory ($TMPDIR or /tmp), \"none\" disables the cache file.",
+   ucs_offsetof(ucp_config_t, calib_dir), UCS_CONFIG_TYPE_STRING},
+
   {NULL}
 };
 UCS_CONFIG_REGISTER_TABLE(ucp_config_table, "UCP context", NULL, ucp_config_t)
@@ -537,6 +565,7 @@ static void ucp_add_tl_resource_if_enabled(ucp_context_h context, ucp_tl_md_t *m
         context->tl_rscs[context->num_tls].tl_name_csum =
                                   ucs_crc16_string(resource->tl_name);
         context->tl_rscs[context->num_tls].flags        = rsc_flags;
+        context->tl_rscs[context->num_tls].calib.source = UCP_CALIB_SOURCE_NONE;
 
         dev_index = 0;
         for (i = 0; i < context->num_tls; ++i) {
@@ -1302,11 +1331,17 @@ static ucs_status_t ucp_fill_config(ucp_context_h context,
      * routines */
     UCP_THREAD_LOCK_INIT(&context->mt_lock);
 
+    context->config.calib_dir = ucs_strdup(config->calib_dir, "calib_dir");
+    if (context->config.calib_dir == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto err;
+    }
+
     /* Get allocation alignment from configuration, make sure it's valid */
     if (config->alloc_prio.count == 0) {
         ucs_error("No allocation methods specified - aborting");
         status = UCS_ERR_INVALID_PARAM;
-        goto err;
+        goto err_free_calib_dir;
     }
 
     num_alloc_methods = config->alloc_prio.count;
@@ -1318,7 +1353,7 @@ static ucs_status_t ucp_fill_config(ucp_context_h context,
                                                "ucp_alloc_methods");
     if (context->config.alloc_methods == NULL) {
         status = UCS_ERR_NO_MEMORY;
-        goto err;
+        goto err_free_calib_dir;
     }
 
     /* Parse the allocation methods specified in the configuration */
@@ -1378,6 +1413,8 @@ static ucs_status_t ucp_fill_config(ucp_context_h context,
 
 err_free:
     ucs_free(context->config.alloc_methods);
+err_free_calib_dir:
+    ucs_free(context->config.calib_dir);
 err:
     UCP_THREAD_LOCK_FINALIZE(&context->mt_lock);
     return status;
@@ -1386,6 +1423,7 @@ err:
 static void ucp_free_config(ucp_context_h context)
 {
     ucs_free(context->config.alloc_methods);
+    ucs_free(context->config.calib_dir);
 }
 
 ucs_status_t ucp_init_version(unsigned api_major_version, unsigned api_minor_version,
@@ -12,6 +12,7 @@
 
 #include "ucp_types.h"
 #include "ucp_thread.h"
+#include "ucp_calib.h"
 
 #include <ucp/api/ucp.h>
 #include <uct/api/uct.h>
@@ -46,6 +47,8 @@ typedef struct ucp_context_config {
     /** The percentage allowed for performance difference between rendezvous
      *  and the eager_zcopy protocol */
     double                                 rndv_perf_diff;
+    /** Threshold for switching UCP Active Messages to rendezvous protocol */
+    size_t                                 am_rndv_thresh;
     /** Threshold for switching UCP to zero copy protocol */
     size_t                                 zcopy_thresh;
     /** Communication scheme in RNDV protocol */
@@ -86,8 +89,13 @@ typedef struct ucp_context_config {
     int                                    flush_worker_eps;
     /** Enable optimizations suitable for homogeneous systems */
     int                                    unified_mode;
+    /** Prefer a resource on the device nearest to the CPU over the same
+     *  transport on a more distant device */
+    int                                    prefer_nearest_device;
     /** Enable cm wireup-and-close protocol for client-server connections */
     ucs_ternary_value_t                    sockaddr_cm_enable;
+    /** Transport performance calibration mode */
+    ucp_calib_mode_t                       calib_mode;
 } ucp_context_config_t;
 
 
@@ -106,6 +114,8 @@ struct ucp_config {
     UCS_CONFIG_STRING_ARRAY_FIELD(cm_tls)  sockaddr_cm_tls;
     /** Warn on invalid configuration */
     int                                    warn_invalid_config;
+    /** Directory of the transport calibration cache file */
+    char                                   *calib_dir;
     /** Configuration saved directly in the context */
     ucp_context_config_t                   ctx;
 };
@@ -121,6 +131,7 @@ typedef struct ucp_tl_resource_desc {
     ucp_rsc_index_t               dev_index;  /* Arbitrary device index. Resources
                                                  with same index have same device name. */
     uint8_t                       flags;      /* Flags that describe resource specifics */
+    ucp_calib_result_t            calib;      /* Measured transport performance */
 } ucp_tl_resource_desc_t;
 
 
@@ -218,6 +229,9 @@ typedef struct ucp_context {
         ucp_rsc_index_t           sockaddr_tl_ids[UCP_MAX_RESOURCES];
         unsigned                  num_sockaddr_tls;
 
+        /* Directory of the transport calibration cache file */
+        char                      *calib_dir;
+
         /* Configuration supplied by the user */
         ucp_context_config_t      ext;
 
@@ -20,6 +20,7 @@
 #include <ucp/wireup/wireup_cm.h>
 #include <ucp/tag/eager.h>
 #include <ucp/tag/offload.h>
+#include <ucp/tag/rndv.h>
 #include <ucp/stream/stream.h>
 #include <ucp/core/ucp_listener.h>
 #include <ucs/datastruct/queue.h>
@@ -150,6 +151,7 @@ void ucp_ep_delete(ucp_ep_h ep)
     ucs_callbackq_remove_if(&ep->worker->uct->progress_q,
                             ucp_wireup_msg_ack_cb_pred, ep);
     UCS_STATS_NODE_FREE(ep->stats);
+    ucp_rndv_ep_cleanup(ep);
     ucs_list_del(&ucp_ep_ext_gen(ep)->ep_list);
     ucs_strided_alloc_put(&ep->worker->ep_alloc, ep);
 }
@@ -918,6 +920,44 @@ int ucp_ep_config_is_equal(const ucp_ep_config_key_t *key1,
     return 1;
 }
 
+static UCS_F_ALWAYS_INLINE uint32_t
+ucp_ep_config_key_hash_add(uint32_t hash, uint64_t value)
+{
+    /* FNV-1a step on a folded 64-bit value */
+    return (hash ^ (uint32_t)(value ^ (value >> 32))) * 16777619u;
+}
+
+uint32_t ucp_ep_config_key_hash(const ucp_ep_config_key_t *key)
+{
+    uint32_t hash = 2166136261u;
+    ucp_lane_index_t lane;
+    int i;
+
+    /* Hash the fields which distinguish configurations of a worker, the rest
+     * are checked by ucp_ep_config_is_equal() */
+    hash = ucp_ep_config_key_hash_add(hash, key->num_lanes);
+    for (lane = 0; lane < key->num_lanes; ++lane) {
+        hash = ucp_ep_config_key_hash_add(hash, key->lanes[lane].rsc_index);
+        hash = ucp_ep_config_key_hash_add(hash, key->lanes[lane].proxy_lane);
+        hash = ucp_ep_config_key_hash_add(hash, key->lanes[lane].dst_md_index);
+    }
+
+    hash = ucp_ep_config_key_hash_add(hash, key->am_lane);
+    hash = ucp_ep_config_key_hash_add(hash, key->tag_lane);
+    hash = ucp_ep_config_key_hash_add(hash, key->wireup_lane);
+    hash = ucp_ep_config_key_hash_add(hash, key->cm_lane);
+    hash = ucp_ep_config_key_hash_add(hash, key->rma_bw_md_map);
+    hash = ucp_ep_config_key_hash_add(hash, key->reachable_md_map);
+    hash = ucp_ep_config_key_hash_add(hash, key->err_mode);
+    hash = ucp_ep_config_key_hash_add(hash, key->status);
+
+    for (i = 0; i < ucs_popcount(key->reachable_md_map); ++i) {
+        hash = ucp_ep_config_key_hash_add(hash, key->dst_md_cmpts[i]);
+    }
+
+    return hash;
+}
+
 static void ucp_ep_config_calc_params(ucp_worker_h worker,
                                       const ucp_ep_config_t *config,
                                       const ucp_lane_index_t *lanes,
@@ -1035,10 +1075,7 @@ static void ucp_ep_config_set_am_rndv_thresh(ucp_worker_h worker, uct_iface_attr
     ucs_assert(config->key.am_lane != UCP_NULL_LANE);
     ucs_assert(config->key.lanes[config->key.am_lane].rsc_index != UCP_NULL_RESOURCE);
 
-    if (config->key.err_mode == UCP_ERR_HANDLING_MODE_PEER) {
-        /* Disable RNDV */
-        rndv_thresh = rndv_nbr_thresh = SIZE_MAX;
-    } else if (context->config.ext.rndv_thresh == UCS_MEMUNITS_AUTO) {
+    if (context->config.ext.rndv_thresh == UCS_MEMUNITS_AUTO) {
         /* auto - Make UCX calculate the AM rndv threshold on its own.*/
         rndv_thresh     = ucp_ep_config_calc_rndv_thresh(worker, config,
                                                          config->key.am_bw_lanes,
@@ -1067,6 +1104,22 @@ static void ucp_ep_config_set_am_rndv_thresh(ucp_worker_h worker, uct_iface_attr
               config->tag.rndv.am_thresh, config->tag.rndv_send_nbr.am_thresh);
 }
 
+static void ucp_ep_config_set_am_u_rndv_thresh(ucp_context_h context,
+                                               ucp_ep_config_t *config)
+{
+    if (context->config.ext.am_rndv_thresh == UCS_MEMUNITS_AUTO) {
+        /* auto - follow the thresholds of the tag-matching rendezvous */
+        config->am_u.rndv_thresh = ucs_min(config->tag.rndv.rma_thresh,
+                                           config->tag.rndv.am_thresh);
+    } else {
+        config->am_u.rndv_thresh = ucs_max(context->config.ext.am_rndv_thresh,
+                                           1);
+    }
+
+    ucs_trace("user Active Message rndv threshold is %zu",
+              config->am_u.rndv_thresh);
+}
+
 static void ucp_ep_config_set_rndv_thresh(ucp_worker_t *worker,
                                           ucp_ep_config_t *config,
                                           ucp_lane_index_t *lanes,
@@ -1090,10 +1143,7 @@ static void ucp_ep_config_set_rndv_thresh(ucp_worker_t *worker,
 
     iface_attr = ucp_worker_iface_get_attr(worker, rsc_index);
 
-    if (config->key.err_mode == UCP_ERR_HANDLING_MODE_PEER) {
-        /* Disable RNDV */
-        rndv_thresh = rndv_nbr_thresh = SIZE_MAX;
-    } else if (context->config.ext.rndv_thresh == UCS_MEMUNITS_AUTO) {
+    if (context->config.ext.rndv_thresh == UCS_MEMUNITS_AUTO) {
         /* auto - Make UCX calculate the RMA (get_zcopy) rndv threshold on its own.*/
         rndv_thresh     = ucp_ep_config_calc_rndv_thresh(worker, config,
                                                          config->key.am_bw_lanes,
@@ -1276,6 +1326,7 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
     config->stream.proto                = &ucp_stream_am_proto;
     config->am_u.proto                  = &ucp_am_proto;
     config->am_u.reply_proto            = &ucp_am_reply_proto;
+    config->am_u.rndv_thresh            = SIZE_MAX;
     max_rndv_thresh                     = SIZE_MAX;
     max_am_rndv_thresh                  = SIZE_MAX;
 
@@ -1422,6 +1473,9 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
              * any tag-matching protocol (AM and offload). */
             ucp_ep_config_set_am_rndv_thresh(worker, iface_attr, md_attr, config,
                                              max_am_rndv_thresh);
+
+            /* Rendezvous threshold of user Active Messages */
+            ucp_ep_config_set_am_u_rndv_thresh(context, config);
         } else {
             /* Stub endpoint */
             config->am.max_bcopy = UCP_MIN_BCOPY;
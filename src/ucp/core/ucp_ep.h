@@ -284,6 +284,8 @@ typedef struct ucp_ep_config {
         /* Protocols used for am operations */
         const ucp_proto_t *proto;
         const ucp_proto_t *reply_proto;
+        /* Threshold for switching to rendezvous protocol */
+        size_t            rndv_thresh;
     } am_u;
 
 } ucp_ep_config_t;
@@ -467,6 +469,8 @@ void ucp_ep_config_cleanup(ucp_worker_h worker, ucp_ep_config_t *config);
 int ucp_ep_config_is_equal(const ucp_ep_config_key_t *key1,
                            const ucp_ep_config_key_t *key2);
 
+uint32_t ucp_ep_config_key_hash(const ucp_ep_config_key_t *key);
+
 int ucp_ep_config_get_multi_lane_prio(const ucp_lane_index_t *lanes,
                                       ucp_lane_index_t lane);
 
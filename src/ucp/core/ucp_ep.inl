@@ -18,7 +18,7 @@
 
 static inline ucp_ep_config_t *ucp_ep_config(ucp_ep_h ep)
 {
-    return &ep->worker->ep_config[ep->cfg_index];
+    return ucp_worker_ep_config(ep->worker, ep->cfg_index);
 }
 
 static inline ucp_lane_index_t ucp_ep_get_am_lane(ucp_ep_h ep)
@@ -255,6 +255,17 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_request_memory_reg,
         }
         state->dt.iov.dt_reg = dt_reg;
         break;
+    case UCP_DATATYPE_STRIDED:
+        ucs_assert(ucs_popcount(md_map) <= UCP_MAX_OP_MDS);
+        status = ucp_mem_rereg_mds(context, md_map, buffer,
+                                   ucp_dt_strided_span(ucp_dt_strided(datatype),
+                                                       length),
+                                   flags, NULL, mem_type, NULL,
+                                   state->dt.strided.memh,
+                                   &state->dt.strided.md_map);
+        ucp_trace_req(req_dbg, "mem reg strided md_map 0x%"PRIx64"/0x%"PRIx64,
+                      state->dt.strided.md_map, md_map);
+        break;
     default:
         status = UCS_ERR_INVALID_PARAM;
         ucs_error("Invalid data type %lx", datatype);
@@ -290,6 +301,9 @@ UCS_PROFILE_FUNC_VOID(ucp_request_memory_dereg, (context, datatype, state, req_d
             state->dt.iov.dt_reg = NULL;
         }
         break;
+    case UCP_DATATYPE_STRIDED:
+        ucp_request_dt_dereg(context, &state->dt.strided, 1, req_dbg);
+        break;
     default:
         break;
     }
@@ -363,6 +377,9 @@ ucp_request_send_start(ucp_request_t *req, ssize_t max_short,
                 multi = ucp_dt_iov_count_nonempty(req->send.buffer, dt_count) >
                         msg_config->max_iov;
             }
+        } else if (ucs_unlikely(UCP_DT_IS_STRIDED(req->send.datatype))) {
+            multi = ucp_dt_strided_iov_count(ucp_dt_strided(req->send.datatype),
+                                             0, length) > msg_config->max_iov;
         } else {
             multi = 0;
         }
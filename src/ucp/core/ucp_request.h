@@ -44,6 +44,7 @@ enum {
     UCP_REQUEST_FLAG_STREAM_RECV_WAITALL  = UCS_BIT(12),
     UCP_REQUEST_FLAG_SEND_AM              = UCS_BIT(13),
     UCP_REQUEST_FLAG_SEND_TAG             = UCS_BIT(14),
+    UCP_REQUEST_FLAG_RNDV_WAIT            = UCS_BIT(15),
 #if UCS_ENABLE_ASSERT
     UCP_REQUEST_FLAG_STREAM_RECV          = UCS_BIT(16),
     UCP_REQUEST_DEBUG_FLAG_EXTERNAL       = UCS_BIT(17)
@@ -279,6 +280,14 @@ struct ucp_request {
                     size_t                     length; /* Completion info to fill */
                 } stream;
             };
+
+            /* Rendezvous receive of an Active Message, which completes through
+             * the tag matching rendezvous protocol */
+            struct {
+                ucp_am_rndv_recv_callback_t cb;       /* User completion callback */
+                ucp_ep_h                    reply_ep; /* Endpoint to reply on */
+                uint16_t                    am_id;    /* Active Message id */
+            } am;
         } recv;
 
         struct {
@@ -289,6 +298,19 @@ struct ucp_request {
             ucp_ep_ext_gen_t      *next_ep; /* Next endpoint to flush */
         } flush_worker;
     };
+
+    struct {
+        ucs_list_link_t           list;    /* Entry in the worker's list of
+                                              requests waiting for a reply */
+        ucp_ep_h                  ep;      /* Endpoint which should reply */
+    } rndv_wait;
+
+#if ENABLE_STATS
+    struct {
+        ucs_stats_node_t          *node;       /* Worker statistics node */
+        ucs_time_t                start_time;  /* Request creation time */
+    } stats;
+#endif
 };
 
 
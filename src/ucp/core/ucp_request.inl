@@ -46,6 +46,22 @@
     ((_rdesc)->length - (_rdesc)->payload_offset)
 
 
+#if ENABLE_STATS
+#define UCP_REQUEST_STATS_START(_req, _worker) \
+    { \
+        (_req)->stats.node = (_worker)->stats; \
+        UCS_STATS_START_TIME((_req)->stats.start_time); \
+    }
+
+#define UCP_REQUEST_STATS_COMPLETE(_req, _hist) \
+    UCS_STATS_UPDATE_HISTOGRAM_TIME((_req)->stats.node, _hist, \
+                                    (_req)->stats.start_time)
+#else
+#define UCP_REQUEST_STATS_START(_req, _worker)
+#define UCP_REQUEST_STATS_COMPLETE(_req, _hist)
+#endif
+
+
 /* defined as a macro to print the call site */
 #define ucp_request_get(_worker) \
     ({ \
@@ -55,6 +71,7 @@
                                       (_worker)->context->config.request.size); \
             ucs_trace_req("allocated request %p", _req); \
             UCS_PROFILE_REQUEST_NEW(_req, "ucp_request", 0); \
+            UCP_REQUEST_STATS_START(_req, _worker); \
         } \
         _req; \
     })
@@ -94,6 +111,7 @@ ucp_request_complete_send(ucp_request_t *req, ucs_status_t status)
                   req, req + 1, UCP_REQUEST_FLAGS_ARG(req->flags),
                   ucs_status_string(status));
     UCS_PROFILE_REQUEST_EVENT(req, "complete_send", status);
+    UCP_REQUEST_STATS_COMPLETE(req, UCP_WORKER_HIST_REQ_SEND_TIME);
     ucp_request_complete(req, send.cb, status);
 }
 
@@ -106,6 +124,7 @@ ucp_request_complete_tag_recv(ucp_request_t *req, ucs_status_t status)
                   req->recv.tag.info.sender_tag, req->recv.tag.info.length,
                   ucs_status_string(status));
     UCS_PROFILE_REQUEST_EVENT(req, "complete_recv", status);
+    UCP_REQUEST_STATS_COMPLETE(req, UCP_WORKER_HIST_REQ_TAG_RECV_TIME);
     ucp_request_complete(req, recv.tag.cb, status, &req->recv.tag.info);
 }
 
@@ -253,6 +272,9 @@ ucp_request_send_state_init(ucp_request_t *req, ucp_datatype_t datatype,
         req->send.state.dt.dt.iov.iovcnt        = dt_count;
         req->send.state.dt.dt.iov.dt_reg        = NULL;
         return;
+    case UCP_DATATYPE_STRIDED:
+        req->send.state.dt.dt.strided.md_map    = 0;
+        return;
     case UCP_DATATYPE_GENERIC:
         dt_gen    = ucp_dt_generic(datatype);
         state_gen = dt_gen->ops.start_pack(dt_gen->context, req->send.buffer,
@@ -459,6 +481,12 @@ ucp_request_recv_data_unpack(ucp_request_t *req, const void *data,
         req->recv.state.offset += length;
         return UCS_OK;
 
+    case UCP_DATATYPE_STRIDED:
+        UCS_PROFILE_CALL(ucp_dt_strided_unpack,
+                         ucp_dt_strided(req->recv.datatype), req->recv.buffer,
+                         data, offset, length);
+        return UCS_OK;
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(req->recv.datatype);
         status = UCS_PROFILE_NAMED_CALL("dt_unpack", dt_gen->ops.unpack,
@@ -91,6 +91,8 @@ enum {
     UCP_AM_ID_SINGLE_REPLY      =  25, /* For user defined AM when a reply
                                           is needed */
     UCP_AM_ID_MULTI_REPLY       =  26,
+    UCP_AM_ID_AM_RNDV_RTS       =  27, /* Ready-to-Send to init rendezvous of
+                                          a user defined Active Message */
     UCP_AM_ID_LAST
 };
 
@@ -117,6 +119,17 @@ typedef enum {
     UCP_RNDV_MODE_LAST
 } ucp_rndv_mode_t;
 
+
+/**
+ * Transport performance calibration mode.
+ */
+typedef enum {
+    UCP_CALIB_MODE_OFF,      /* Use the performance estimates of the transports */
+    UCP_CALIB_MODE_ON,       /* Use cached measurements, measure the missing ones */
+    UCP_CALIB_MODE_REFRESH,  /* Measure all transports and update the cache */
+    UCP_CALIB_MODE_LAST
+} ucp_calib_mode_t;
+
 /**
  * Active message tracer.
  */
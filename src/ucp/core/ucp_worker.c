@@ -18,12 +18,14 @@
 #include <ucp/wireup/wireup_ep.h>
 #include <ucp/tag/eager.h>
 #include <ucp/tag/offload.h>
+#include <ucp/tag/rndv.h>
 #include <ucp/stream/stream.h>
 #include <ucs/config/parser.h>
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/datastruct/queue.h>
 #include <ucs/type/cpu_set.h>
 #include <ucs/sys/string.h>
+#include <ucs/sys/topo.h>
 #include <ucs/arch/atomic.h>
 #include <sys/poll.h>
 #include <sys/eventfd.h>
@@ -38,6 +40,12 @@ typedef enum ucp_worker_event_fd_op {
     UCP_WORKER_EPFD_OP_DEL
 } ucp_worker_event_fd_op_t;
 
+
+__KHASH_IMPL(ucp_worker_ep_config_hash, static UCS_F_MAYBE_UNUSED inline,
+             const ucp_ep_config_key_t*, ucp_ep_cfg_index_t, 1,
+             ucp_ep_config_key_hash, ucp_ep_config_is_equal);
+
+
 #if ENABLE_STATS
 static ucs_stats_class_t ucp_worker_tm_offload_stats_class = {
     .name           = "tag_offload",
@@ -58,9 +66,16 @@ static ucs_stats_class_t ucp_worker_tm_offload_stats_class = {
     }
 };
 
+static const char *ucp_worker_histogram_names[] = {
+    [UCP_WORKER_HIST_REQ_SEND_TIME]            = "req_send_time_ns",
+    [UCP_WORKER_HIST_REQ_TAG_RECV_TIME]        = "req_tag_recv_time_ns"
+};
+
 static ucs_stats_class_t ucp_worker_stats_class = {
-    .name           = "ucp_worker",
-    .num_counters   = UCP_WORKER_STAT_LAST,
+    .name            = "ucp_worker",
+    .num_counters    = UCP_WORKER_STAT_LAST,
+    .num_histograms  = UCP_WORKER_HIST_LAST,
+    .histogram_names = ucp_worker_histogram_names,
     .counter_names  = {
         [UCP_WORKER_STAT_TAG_RX_EAGER_MSG]         = "rx_eager_msg",
         [UCP_WORKER_STAT_TAG_RX_EAGER_SYNC_MSG]    = "rx_sync_msg",
@@ -456,6 +471,9 @@ static unsigned ucp_worker_iface_err_handle_progress(void *arg)
 
     ucp_ep->am_lane = 0;
 
+    /* Complete rendezvous requests which wait for a reply from the peer */
+    ucp_rndv_ep_purge(ucp_ep, key.status);
+
     if (ucp_ep_ext_gen(ucp_ep)->err_cb != NULL) {
         ucs_assert(ucp_ep->flags & UCP_EP_FLAG_USED);
         ucs_debug("ep %p: calling user error callback %p with arg %p", ucp_ep,
@@ -807,6 +825,40 @@ static void ucp_worker_uct_iface_close(ucp_worker_iface_t *wiface)
     wiface->iface = NULL;
 }
 
+/* Distance (as latency) from the calling thread's CPU to the device of a
+ * resource, or a negative value if the device location is unknown */
+static double ucp_worker_rsc_device_distance(ucp_context_h ctx,
+                                             ucp_rsc_index_t rsc_index)
+{
+    const ucs_sys_device_t *sys_device = &ctx->tl_rscs[rsc_index].tl_rsc.sys_device;
+    ucs_sys_dev_distance_t distance;
+
+    if ((sys_device->id == UCS_SYS_DEVICE_ID_UNKNOWN) ||
+        (ucs_topo_get_distance(sys_device, NULL, &distance) != UCS_OK)) {
+        return -1;
+    }
+
+    return distance.latency;
+}
+
+/* Check whether a resource on another device may replace the current one
+ * because it is the same transport on a device nearer to the CPU */
+static int ucp_worker_rsc_is_nearer(ucp_context_h ctx, ucp_rsc_index_t rsc_index,
+                                    ucp_rsc_index_t cur_rsc_index,
+                                    double distance_cur)
+{
+    double distance_iter;
+
+    if (!ctx->config.ext.prefer_nearest_device || (distance_cur <= 0) ||
+        strcmp(ctx->tl_rscs[rsc_index].tl_rsc.tl_name,
+               ctx->tl_rscs[cur_rsc_index].tl_rsc.tl_name)) {
+        return 0;
+    }
+
+    distance_iter = ucp_worker_rsc_device_distance(ctx, rsc_index);
+    return (distance_iter >= 0) && (distance_iter < distance_cur);
+}
+
 static int ucp_worker_iface_find_better(ucp_worker_h worker,
                                         ucp_worker_iface_t *wiface,
                                         ucp_rsc_index_t *better_index)
@@ -815,12 +867,13 @@ static int ucp_worker_iface_find_better(ucp_worker_h worker,
     ucp_rsc_index_t rsc_index;
     ucp_worker_iface_t *if_iter;
     uint64_t test_flags;
-    double latency_iter, latency_cur, bw_cur;
+    double latency_iter, latency_cur, bw_cur, distance_cur;
 
     ucs_assert(wiface != NULL);
 
-    latency_cur = ucp_worker_iface_latency(worker, wiface);
-    bw_cur      = ucp_tl_iface_bandwidth(ctx, &wiface->attr.bandwidth);
+    latency_cur  = ucp_worker_iface_latency(worker, wiface);
+    bw_cur       = ucp_tl_iface_bandwidth(ctx, &wiface->attr.bandwidth);
+    distance_cur = ucp_worker_rsc_device_distance(ctx, wiface->rsc_index);
 
     test_flags = wiface->attr.cap.flags & ~(UCT_IFACE_FLAG_CONNECT_TO_IFACE |
                                             UCT_IFACE_FLAG_CONNECT_TO_EP);
@@ -828,8 +881,11 @@ static int ucp_worker_iface_find_better(ucp_worker_h worker,
     for (rsc_index = 0; rsc_index < ctx->num_tls; ++rsc_index) {
         if_iter = worker->ifaces[rsc_index];
 
-        /* Need to check resources which belong to the same device only */
-        if ((ctx->tl_rscs[rsc_index].dev_index != ctx->tl_rscs[wiface->rsc_index].dev_index) ||
+        /* Need to check resources which belong to the same device, or the
+         * same transport on a device nearer to the CPU */
+        if (((ctx->tl_rscs[rsc_index].dev_index != ctx->tl_rscs[wiface->rsc_index].dev_index) &&
+             !ucp_worker_rsc_is_nearer(ctx, rsc_index, wiface->rsc_index,
+                                       distance_cur)) ||
             (if_iter->flags & UCP_WORKER_IFACE_FLAG_UNUSED) ||
             (rsc_index == wiface->rsc_index)) {
             continue;
@@ -886,6 +942,8 @@ static void ucp_worker_select_best_ifaces(ucp_worker_h worker,
     /* For each iface check whether there is another iface, which:
      * 1. Supports at least the same capabilities
      * 2. Provides equivalent or better performance
+     * 3. Is on the same device, or is the same transport on a device which is
+     *    nearer to the CPU
      */
     for (tl_id = 0; tl_id < context->num_tls; ++tl_id) {
         wiface = worker->ifaces[tl_id];
@@ -993,6 +1051,10 @@ static ucs_status_t ucp_worker_add_resource_ifaces(ucp_worker_h worker)
         }
     }
 
+    /* Measured performance must be applied before the best ifaces are
+     * selected, since the selection compares the interface attributes */
+    ucp_calib_worker_ifaces(worker);
+
     if (!ctx_tl_bitmap) {
         /* Context bitmap is not set, need to select the best tl resources */
         tl_bitmap = 0;
@@ -1572,6 +1634,45 @@ out:
     return status;
 }
 
+/* All the ucp endpoints will share the configurations. No need for every ep to
+ * have it's own configuration (to save memory footprint). Same config can be used
+ * by different eps.
+ * A 'key' identifies an entry in the ep_config array. An entry holds the key and
+ * additional configuration parameters and thresholds.
+ */
+static ucs_status_t ucp_worker_ep_config_grow(ucp_worker_h worker)
+{
+    unsigned num_chunks = worker->ep_config_max >>
+                          UCP_WORKER_EP_CONFIG_CHUNK_SHIFT;
+    ucp_ep_config_t **chunks;
+
+    if (worker->ep_config_max >= UCP_WORKER_MAX_EP_CONFIG) {
+        ucs_error("worker %p: too many ep configurations: %u", worker,
+                  worker->ep_config_count);
+        return UCS_ERR_EXCEEDS_LIMIT;
+    }
+
+    /* Only the array of chunk pointers is reallocated, existing
+     * configurations remain in place */
+    chunks = ucs_realloc(worker->ep_config, sizeof(*chunks) * (num_chunks + 1),
+                         "ucp_ep_config_chunks");
+    if (chunks == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    worker->ep_config = chunks;
+
+    chunks[num_chunks] = ucs_malloc(sizeof(*chunks[num_chunks]) *
+                                    UCP_WORKER_EP_CONFIG_CHUNK_SIZE,
+                                    "ucp_ep_config");
+    if (chunks[num_chunks] == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    worker->ep_config_max += UCP_WORKER_EP_CONFIG_CHUNK_SIZE;
+    return UCS_OK;
+}
+
 /* All the ucp endpoints will share the configurations. No need for every ep to
  * have it's own configuration (to save memory footprint). Same config can be used
  * by different eps.
@@ -1584,27 +1685,48 @@ ucs_status_t ucp_worker_get_ep_config(ucp_worker_h worker,
                                       ucp_ep_cfg_index_t *config_idx_p)
 {
     ucp_ep_cfg_index_t config_idx;
+    ucp_ep_config_t *ep_config;
     ucs_status_t status;
+    khiter_t iter;
+    int ret;
 
-    /* Search for the given key in the ep_config array */
-    for (config_idx = 0; config_idx < worker->ep_config_count; ++config_idx) {
-        if (ucp_ep_config_is_equal(&worker->ep_config[config_idx].key, key)) {
-            goto out;
-        }
+    /* Search for the given key in the ep_config hash */
+    iter = kh_get(ucp_worker_ep_config_hash, &worker->ep_config_hash, key);
+    if (iter != kh_end(&worker->ep_config_hash)) {
+        config_idx = kh_value(&worker->ep_config_hash, iter);
+        goto out;
     }
 
     if (worker->ep_config_count >= worker->ep_config_max) {
-        /* TODO support larger number of configurations */
-        ucs_fatal("too many ep configurations: %d", worker->ep_config_count);
+        status = ucp_worker_ep_config_grow(worker);
+        if (status != UCS_OK) {
+            return status;
+        }
     }
 
     /* Create new configuration */
-    config_idx = worker->ep_config_count++;
-    status = ucp_ep_config_init(worker, &worker->ep_config[config_idx], key);
+    config_idx = worker->ep_config_count;
+    ep_config  = &worker->ep_config[config_idx >> UCP_WORKER_EP_CONFIG_CHUNK_SHIFT]
+                                   [config_idx &
+                                    (UCP_WORKER_EP_CONFIG_CHUNK_SIZE - 1)];
+    status = ucp_ep_config_init(worker, ep_config, key);
     if (status != UCS_OK) {
         return status;
     }
 
+    /* The hash key points to the key copy in the configuration */
+    iter = kh_put(ucp_worker_ep_config_hash, &worker->ep_config_hash,
+                  &ep_config->key, &ret);
+    if (ucs_unlikely(ret == -1)) {
+        ucp_ep_config_cleanup(worker, ep_config);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    /* khash returns 1 or 2 if the key was not present */
+    ucs_assert((ret == 1) || (ret == 2));
+    kh_value(&worker->ep_config_hash, iter) = config_idx;
+    ++worker->ep_config_count;
+
     if (print_cfg) {
         ucp_worker_print_used_tls(key, worker->context, config_idx);
     }
@@ -1621,22 +1743,36 @@ static ucs_mpool_ops_t ucp_rkey_mpool_ops = {
     .obj_cleanup   = NULL
 };
 
+static void ucp_worker_destroy_ep_configs(ucp_worker_h worker)
+{
+    ucp_ep_cfg_index_t i;
+
+    for (i = 0; i < worker->ep_config_count; ++i) {
+        ucp_ep_config_cleanup(worker, ucp_worker_ep_config(worker, i));
+    }
+
+    for (i = 0; i < (worker->ep_config_max >> UCP_WORKER_EP_CONFIG_CHUNK_SHIFT);
+         ++i) {
+        ucs_free(worker->ep_config[i]);
+    }
+
+    kh_destroy_inplace(ucp_worker_ep_config_hash, &worker->ep_config_hash);
+    ucs_free(worker->ep_config);
+    worker->ep_config       = NULL;
+    worker->ep_config_max   = 0;
+    worker->ep_config_count = 0;
+}
+
 ucs_status_t ucp_worker_create(ucp_context_h context,
                                const ucp_worker_params_t *params,
                                ucp_worker_h *worker_p)
 {
     ucs_thread_mode_t uct_thread_mode;
-    unsigned config_count;
     unsigned name_length;
     ucp_worker_h worker;
     ucs_status_t status;
 
-    config_count = ucs_min((context->num_tls + 1) * (context->num_tls + 1) * context->num_tls,
-                           UINT8_MAX);
-
-    worker = ucs_calloc(1, sizeof(*worker) +
-                           sizeof(*worker->ep_config) * config_count,
-                        "ucp worker");
+    worker = ucs_calloc(1, sizeof(*worker), "ucp worker");
     if (worker == NULL) {
         return UCS_ERR_NO_MEMORY;
     }
@@ -1665,15 +1801,18 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     worker->uuid              = ucs_generate_uuid((uintptr_t)worker);
     worker->flush_ops_count   = 0;
     worker->inprogress        = 0;
-    worker->ep_config_max     = config_count;
+    worker->ep_config_max     = 0;
     worker->ep_config_count   = 0;
+    worker->ep_config         = NULL;
     worker->num_active_ifaces = 0;
     worker->num_ifaces        = 0;
     worker->am_message_id     = ucs_generate_uuid(0);
     ucs_list_head_init(&worker->arm_ifaces);
     ucs_list_head_init(&worker->stream_ready_eps);
     ucs_list_head_init(&worker->all_eps);
+    ucs_list_head_init(&worker->rndv_wait_reqs);
     ucp_ep_match_init(&worker->ep_match_ctx);
+    kh_init_inplace(ucp_worker_ep_config_hash, &worker->ep_config_hash);
 
     UCS_STATIC_ASSERT(sizeof(ucp_ep_ext_gen_t) <= sizeof(ucp_ep_t));
     if (context->config.features & (UCP_FEATURE_STREAM | UCP_FEATURE_AM)) {
@@ -1787,6 +1926,14 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
         goto err_close_cms;
     }
 
+    /* Init AM reassembly context */
+    if (context->config.features & UCP_FEATURE_AM) {
+        status = ucp_am_worker_init(worker);
+        if (status != UCS_OK) {
+            goto err_mpools_cleanup;
+        }
+    }
+
     /* Select atomic resources */
     ucp_worker_init_atomic_tls(worker);
 
@@ -1798,6 +1945,10 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     *worker_p = worker;
     return UCS_OK;
 
+err_mpools_cleanup:
+    ucs_mpool_cleanup(&worker->am_mp, 1);
+    ucs_mpool_cleanup(&worker->reg_mp, 1);
+    ucs_mpool_cleanup(&worker->rndv_frag_mp, 1);
 err_close_cms:
     ucp_worker_close_cms(worker);
 err_close_ifaces:
@@ -1818,6 +1969,7 @@ err_free_tm_offload_stats:
 err_free_stats:
     UCS_STATS_NODE_FREE(worker->stats);
 err_free:
+    ucp_worker_destroy_ep_configs(worker);
     ucs_strided_alloc_cleanup(&worker->ep_alloc);
     ucs_free(worker);
     return status;
@@ -1833,17 +1985,6 @@ static void ucp_worker_destroy_eps(ucp_worker_h worker)
     }
 }
 
-static void ucp_worker_destroy_ep_configs(ucp_worker_h worker)
-{
-    unsigned i;
-
-    for (i = 0; i < worker->ep_config_count; ++i) {
-        ucp_ep_config_cleanup(worker, &worker->ep_config[i]);
-    }
-
-    worker->ep_config_count = 0;
-}
-
 void ucp_worker_destroy(ucp_worker_h worker)
 {
     ucs_trace_func("worker=%p", worker);
@@ -1856,6 +1997,9 @@ void ucp_worker_destroy(ucp_worker_h worker)
     UCS_ASYNC_UNBLOCK(&worker->async);
 
     ucp_worker_destroy_ep_configs(worker);
+    if (worker->context->config.features & UCP_FEATURE_AM) {
+        ucp_am_worker_cleanup(worker);
+    }
     ucs_mpool_cleanup(&worker->am_mp, 1);
     ucs_mpool_cleanup(&worker->reg_mp, 1);
     ucs_mpool_cleanup(&worker->rndv_frag_mp, 1);
@@ -2173,6 +2317,10 @@ void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
         fprintf(stream, "\n");
     }
 
+    if (context->config.ext.calib_mode != UCP_CALIB_MODE_OFF) {
+        ucp_calib_print_info(worker, stream);
+    }
+
     fprintf(stream, "#\n");
 
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
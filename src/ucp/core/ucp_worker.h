@@ -9,12 +9,14 @@
 #define UCP_WORKER_H_
 
 #include "ucp_ep.h"
+#include "ucp_am.h"
 #include "ucp_context.h"
 #include "ucp_thread.h"
 
 #include <ucp/proto/proto.h>
 #include <ucp/tag/tag_match.h>
 #include <ucp/wireup/ep_match.h>
+#include <ucs/datastruct/khash.h>
 #include <ucs/datastruct/mpool.h>
 #include <ucs/datastruct/queue_types.h>
 #include <ucs/datastruct/strided_alloc.h>
@@ -27,6 +29,17 @@
 #define UCP_WORKER_HEADROOM_PRIV_SIZE 32
 
 
+/* Endpoint configurations are allocated in chunks of this size, so they never
+ * move when more configurations are added */
+#define UCP_WORKER_EP_CONFIG_CHUNK_SHIFT  5
+#define UCP_WORKER_EP_CONFIG_CHUNK_SIZE   UCS_BIT(UCP_WORKER_EP_CONFIG_CHUNK_SHIFT)
+
+
+/* Maximal number of endpoint configurations, limited by the index type */
+#define UCP_WORKER_MAX_EP_CONFIG \
+    (UCS_MASK(8 * sizeof(ucp_ep_cfg_index_t)) + 1)
+
+
 #if ENABLE_MT
 
 #define UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(_worker)                 \
@@ -53,6 +66,12 @@
 #endif
 
 
+/* Index of endpoint configurations by their key. The key is stored in the
+ * configuration itself, which never moves. */
+__KHASH_TYPE(ucp_worker_ep_config_hash, const ucp_ep_config_key_t*,
+             ucp_ep_cfg_index_t);
+
+
 /**
  * UCP worker flags
  */
@@ -100,6 +119,17 @@ enum {
 };
 
 
+/**
+ * UCP worker statistics histograms
+ */
+enum {
+    /* Time from creating a request to its completion, in nsec */
+    UCP_WORKER_HIST_REQ_SEND_TIME,
+    UCP_WORKER_HIST_REQ_TAG_RECV_TIME,
+    UCP_WORKER_HIST_LAST
+};
+
+
 /**
  * UCP worker tag offload statistics counters
  */
@@ -226,6 +256,8 @@ typedef struct ucp_worker {
     ucs_strided_alloc_t           ep_alloc;      /* Endpoint allocator */
     ucs_list_link_t               stream_ready_eps; /* List of EPs with received stream data */
     ucs_list_link_t               all_eps;       /* List of all endpoints */
+    ucs_list_link_t               rndv_wait_reqs; /* Rendezvous requests waiting
+                                                     for a reply from the peer */
     ucp_ep_match_ctx_t            ep_match_ctx;  /* Endpoint-to-endpoint matching context */
     ucp_worker_iface_t            **ifaces;      /* Array of pointers to interfaces,
                                                     one for each resource */
@@ -245,11 +277,16 @@ typedef struct ucp_worker {
 
     ucp_worker_am_entry_t        *am_cbs;          /*array of callbacks and their data */
     size_t                        am_cb_array_len; /*len of callback array */
+    ucp_am_worker_t               am;              /* Multi-fragment AM reassembly */
 
     ucs_cpu_set_t                 cpu_mask;        /* Save CPU mask for subsequent calls to ucp_worker_listen */
-    unsigned                      ep_config_max;   /* Maximal number of configurations */
+    unsigned                      ep_config_max;   /* Number of configurations in
+                                                      the allocated chunks */
     unsigned                      ep_config_count; /* Current number of configurations */
-    ucp_ep_config_t               ep_config[0];    /* Array of transport limits and thresholds */
+    ucp_ep_config_t               **ep_config;     /* Chunks of transport limits
+                                                      and thresholds */
+    khash_t(ucp_worker_ep_config_hash) ep_config_hash; /* Configuration index
+                                                          by key */
 } ucp_worker_t;
 
 
@@ -310,6 +347,14 @@ static inline ucp_ep_h ucp_worker_get_ep_by_ptr(ucp_worker_h worker,
     return ep;
 }
 
+static UCS_F_ALWAYS_INLINE ucp_ep_config_t*
+ucp_worker_ep_config(ucp_worker_h worker, ucp_ep_cfg_index_t cfg_index)
+{
+    ucs_assert(cfg_index < worker->ep_config_count);
+    return &worker->ep_config[cfg_index >> UCP_WORKER_EP_CONFIG_CHUNK_SHIFT]
+                             [cfg_index & (UCP_WORKER_EP_CONFIG_CHUNK_SIZE - 1)];
+}
+
 static UCS_F_ALWAYS_INLINE ucp_worker_iface_t*
 ucp_worker_iface(ucp_worker_h worker, ucp_rsc_index_t rsc_index)
 {
@@ -126,6 +126,12 @@ size_t ucp_dt_pack(ucp_worker_h worker, ucp_datatype_t datatype,
         result_len = length;
         break;
 
+    case UCP_DATATYPE_STRIDED:
+        result_len = UCS_PROFILE_CALL(ucp_dt_strided_pack,
+                                      ucp_dt_strided(datatype), dest, src,
+                                      state->offset, length);
+        break;
+
     case UCP_DATATYPE_GENERIC:
         dt = ucp_dt_generic(datatype);
         result_len = UCS_PROFILE_NAMED_CALL("dt_pack", dt->ops.pack,
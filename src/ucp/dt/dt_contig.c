@@ -10,6 +10,7 @@
 
 #include "dt_contig.h"
 
+#include <ucs/arch/cpu.h>
 #include <ucs/profile/profile.h>
 #include <string.h>
 
@@ -18,6 +19,6 @@ size_t ucp_memcpy_pack(void *dest, void *arg)
 {
     ucp_memcpy_pack_context_t *ctx = arg;
     size_t length = ctx->length;
-    UCS_PROFILE_CALL(memcpy, dest, ctx->src, length);
+    UCS_PROFILE_CALL(ucs_memcpy_relaxed, dest, ctx->src, length);
     return length;
 }
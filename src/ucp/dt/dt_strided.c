@@ -0,0 +1,297 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "dt_strided.h"
+
+#include <ucs/arch/cpu.h>
+#include <ucs/debug/assert.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+
+#include <string.h>
+
+
+ucs_status_t ucp_dt_create_strided(size_t blocklen, const ucp_dt_stride_t *dims,
+                                   unsigned num_dims, ucp_datatype_t *datatype_p)
+{
+    ucp_dt_stride_t dim;
+    ucp_dt_strided_t *dt;
+    size_t span, length;
+    unsigned i, n;
+    int ret;
+
+    if ((blocklen == 0) || (num_dims == 0) ||
+        (num_dims > UCP_DT_STRIDED_MAX_DIMS)) {
+        ucs_error("invalid strided datatype: blocklen %zu num_dims %u",
+                  blocklen, num_dims);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    span   = blocklen;
+    length = blocklen;
+    for (i = 0; i < num_dims; ++i) {
+        if ((dims[i].count == 0) || (dims[i].stride < span)) {
+            ucs_error("invalid strided datatype: dimension %u count %zu "
+                      "stride %zu, inner span %zu", i, dims[i].count,
+                      dims[i].stride, span);
+            return UCS_ERR_INVALID_PARAM;
+        }
+        span    = ((dims[i].count - 1) * dims[i].stride) + span;
+        length *= dims[i].count;
+    }
+
+    ret = ucs_posix_memalign((void **)&dt,
+                             ucs_max(sizeof(void *), UCS_BIT(UCP_DATATYPE_SHIFT)),
+                             sizeof(*dt), "strided_dt");
+    if (ret != 0) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    dt->blocklen    = blocklen;
+    dt->elem_length = length;
+    dt->elem_span   = span;
+    dt->extent      = dims[num_dims - 1].count * dims[num_dims - 1].stride;
+
+    /* Merge dimensions which continue their inner dimension contiguously.
+     * The last iteration adds the dimension of consecutive elements. */
+    n = 0;
+    for (i = 0; i <= num_dims; ++i) {
+        if (i < num_dims) {
+            dim = dims[i];
+        } else {
+            dim.count  = SIZE_MAX;
+            dim.stride = dt->extent;
+        }
+
+        if ((n == 0) && (dim.stride == dt->blocklen) && (dim.count != SIZE_MAX)) {
+            dt->blocklen *= dim.count;
+        } else if ((n > 0) &&
+                   (dim.stride == (dt->dims[n - 1].count * dt->dims[n - 1].stride))) {
+            dt->dims[n - 1].count = (dim.count == SIZE_MAX) ? SIZE_MAX :
+                                    (dt->dims[n - 1].count * dim.count);
+        } else {
+            dt->dims[n++] = dim;
+        }
+    }
+
+    ucs_assert((n > 0) && (dt->dims[n - 1].count == SIZE_MAX));
+    dt->num_dims = n - 1;
+
+    ucs_debug("created strided datatype %p: blocklen %zu elem_length %zu "
+              "extent %zu dims %u", dt, dt->blocklen, dt->elem_length,
+              dt->extent, dt->num_dims);
+
+    *datatype_p = ((uintptr_t)dt) | UCP_DATATYPE_STRIDED;
+    return UCS_OK;
+}
+
+/*
+ * Find the address of a block by its index, and initialize the index of the
+ * block in every dimension.
+ */
+static void *ucp_dt_strided_block(const ucp_dt_strided_t *dt, const void *buffer,
+                                  size_t block, size_t *idx)
+{
+    uintptr_t addr = (uintptr_t)buffer;
+    unsigned i;
+
+    for (i = 0; i < dt->num_dims; ++i) {
+        idx[i]  = block % dt->dims[i].count;
+        addr   += idx[i] * dt->dims[i].stride;
+        block  /= dt->dims[i].count;
+    }
+
+    /* the outermost dimension is unlimited */
+    idx[i]  = block;
+    addr   += block * dt->dims[i].stride;
+    return (void*)addr;
+}
+
+/*
+ * Advance by @a nblocks blocks of the innermost dimension, which must not
+ * cross the end of that dimension.
+ */
+static UCS_F_ALWAYS_INLINE void *
+ucp_dt_strided_advance(const ucp_dt_strided_t *dt, void *block, size_t *idx,
+                       size_t nblocks)
+{
+    uintptr_t addr = (uintptr_t)block + (nblocks * dt->dims[0].stride);
+    unsigned i     = 0;
+
+    idx[0] += nblocks;
+    while (idx[i] == dt->dims[i].count) {
+        addr  -= dt->dims[i].count * dt->dims[i].stride;
+        idx[i] = 0;
+        ++i;
+        ++idx[i];
+        addr  += dt->dims[i].stride;
+    }
+
+    return (void*)addr;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy_fixed(void *dst, size_t dst_stride, const void *src,
+                          size_t src_stride, size_t nblocks, size_t blocklen)
+{
+    size_t i;
+
+    /* blocklen is a compile-time constant here, so the memcpy is expanded
+     * to (vector) register moves */
+    for (i = 0; i < nblocks; ++i) {
+        memcpy(dst, src, blocklen);
+        dst = UCS_PTR_BYTE_OFFSET(dst, dst_stride);
+        src = UCS_PTR_BYTE_OFFSET(src, src_stride);
+    }
+}
+
+static void ucp_dt_strided_copy_blocks(void *dst, size_t dst_stride,
+                                       const void *src, size_t src_stride,
+                                       size_t blocklen, size_t nblocks)
+{
+    if ((dst_stride == blocklen) && (src_stride == blocklen)) {
+        ucs_memcpy_relaxed(dst, src, nblocks * blocklen);
+        return;
+    }
+
+    switch (blocklen) {
+    case 4:
+        ucp_dt_strided_copy_fixed(dst, dst_stride, src, src_stride, nblocks, 4);
+        break;
+    case 8:
+        ucp_dt_strided_copy_fixed(dst, dst_stride, src, src_stride, nblocks, 8);
+        break;
+    case 16:
+        ucp_dt_strided_copy_fixed(dst, dst_stride, src, src_stride, nblocks, 16);
+        break;
+    case 32:
+        ucp_dt_strided_copy_fixed(dst, dst_stride, src, src_stride, nblocks, 32);
+        break;
+    case 64:
+        ucp_dt_strided_copy_fixed(dst, dst_stride, src, src_stride, nblocks, 64);
+        break;
+    default:
+        ucp_dt_strided_copy_fixed(dst, dst_stride, src, src_stride, nblocks,
+                                  blocklen);
+        break;
+    }
+}
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_dt_strided_copy(const ucp_dt_strided_t *dt, void *buffer, void *packed,
+                    size_t offset, size_t length, int is_pack)
+{
+    size_t blocklen = dt->blocklen;
+    size_t idx[UCP_DT_STRIDED_MAX_DIMS + 1];
+    size_t block_offset, copied, nblocks;
+    void *block, *data;
+
+    if (length == 0) {
+        return 0;
+    }
+
+    block        = ucp_dt_strided_block(dt, buffer, offset / blocklen, idx);
+    block_offset = offset % blocklen;
+    copied       = 0;
+
+    /* partial first block */
+    if (block_offset != 0) {
+        copied = ucs_min(blocklen - block_offset, length);
+        data   = UCS_PTR_BYTE_OFFSET(block, block_offset);
+        if (is_pack) {
+            memcpy(packed, data, copied);
+        } else {
+            memcpy(data, packed, copied);
+        }
+        block = ucp_dt_strided_advance(dt, block, idx, 1);
+    }
+
+    /* full blocks, a run over the innermost dimension at a time */
+    while ((length - copied) >= blocklen) {
+        nblocks = ucs_min(dt->dims[0].count - idx[0],
+                          (length - copied) / blocklen);
+        data    = UCS_PTR_BYTE_OFFSET(packed, copied);
+        if (is_pack) {
+            ucp_dt_strided_copy_blocks(data, blocklen, block, dt->dims[0].stride,
+                                       blocklen, nblocks);
+        } else {
+            ucp_dt_strided_copy_blocks(block, dt->dims[0].stride, data, blocklen,
+                                       blocklen, nblocks);
+        }
+        copied += nblocks * blocklen;
+        block   = ucp_dt_strided_advance(dt, block, idx, nblocks);
+    }
+
+    /* partial last block */
+    if (copied < length) {
+        data = UCS_PTR_BYTE_OFFSET(packed, copied);
+        if (is_pack) {
+            memcpy(data, block, length - copied);
+        } else {
+            memcpy(block, data, length - copied);
+        }
+    }
+
+    return length;
+}
+
+size_t ucp_dt_strided_pack(const ucp_dt_strided_t *dt, void *dest,
+                           const void *buffer, size_t offset, size_t length)
+{
+    return ucp_dt_strided_copy(dt, (void*)buffer, dest, offset, length, 1);
+}
+
+size_t ucp_dt_strided_unpack(const ucp_dt_strided_t *dt, void *buffer,
+                             const void *src, size_t offset, size_t length)
+{
+    return ucp_dt_strided_copy(dt, buffer, (void*)src, offset, length, 0);
+}
+
+size_t ucp_dt_strided_to_uct_iov(const ucp_dt_strided_t *dt, const void *buffer,
+                                 size_t offset, size_t length_max,
+                                 uct_mem_h memh, uct_iov_t *iov, size_t max_iov,
+                                 size_t *length_p)
+{
+    size_t blocklen = dt->blocklen;
+    size_t idx[UCP_DT_STRIDED_MAX_DIMS + 1];
+    size_t block_offset, length, iovcnt;
+    void *block;
+
+    length = 0;
+    iovcnt = 0;
+    if ((length_max == 0) || (max_iov == 0)) {
+        goto out;
+    }
+
+    block        = ucp_dt_strided_block(dt, buffer, offset / blocklen, idx);
+    block_offset = offset % blocklen;
+
+    for (;;) {
+        iov[iovcnt].buffer = UCS_PTR_BYTE_OFFSET(block, block_offset);
+        iov[iovcnt].length = ucs_min(blocklen - block_offset,
+                                     length_max - length);
+        iov[iovcnt].memh   = memh;
+        iov[iovcnt].stride = 0;
+        iov[iovcnt].count  = 1;
+        length            += iov[iovcnt].length;
+        ++iovcnt;
+
+        if ((length == length_max) || (iovcnt == max_iov)) {
+            break;
+        }
+
+        block_offset = 0;
+        block        = ucp_dt_strided_advance(dt, block, idx, 1);
+    }
+
+out:
+    *length_p = length;
+    return iovcnt;
+}
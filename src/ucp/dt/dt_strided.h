@@ -0,0 +1,121 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+
+#ifndef UCP_DT_STRIDED_H_
+#define UCP_DT_STRIDED_H_
+
+#include <ucp/api/ucp.h>
+#include <uct/api/uct.h>
+#include <ucs/sys/math.h>
+
+
+#define UCP_DT_IS_STRIDED(_datatype) \
+    (((_datatype) & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_STRIDED)
+
+
+/**
+ * Strided datatype structure.
+ *
+ * Dimensions which are contiguous with respect to their inner dimension are
+ * merged when the datatype is created, so @a blocklen is the longest possible
+ * contiguous block. The dimensions array has an extra outermost entry with an
+ * unlimited count, which describes the placement of consecutive elements and
+ * allows iterating over multiple elements with the same code.
+ */
+typedef struct ucp_dt_strided {
+    size_t                   blocklen;     /* Length of a contiguous block */
+    size_t                   elem_length;  /* Packed length of a single element */
+    size_t                   elem_span;    /* Memory range covered by an element */
+    size_t                   extent;       /* Distance between consecutive elements */
+    unsigned                 num_dims;     /* Number of dimensions, without the
+                                              outermost elements dimension */
+    ucp_dt_stride_t          dims[UCP_DT_STRIDED_MAX_DIMS + 1]; /* Innermost first */
+} ucp_dt_strided_t;
+
+
+static inline ucp_dt_strided_t* ucp_dt_strided(ucp_datatype_t datatype)
+{
+    return (ucp_dt_strided_t*)(void*)(datatype & ~UCP_DATATYPE_CLASS_MASK);
+}
+
+
+/**
+ * Get the total packed length of @a count elements
+ */
+static inline size_t ucp_dt_strided_length(ucp_datatype_t datatype, size_t count)
+{
+    return count * ucp_dt_strided(datatype)->elem_length;
+}
+
+
+/**
+ * Get the length of the memory range which holds the first @a length packed
+ * bytes of the data. This is the range which has to be registered for
+ * zero-copy operations.
+ */
+static inline size_t ucp_dt_strided_span(const ucp_dt_strided_t *dt,
+                                         size_t length)
+{
+    size_t count = ucs_div_round_up(length, dt->elem_length);
+
+    return (count == 0) ? 0 : ((count - 1) * dt->extent + dt->elem_span);
+}
+
+
+/**
+ * Get the number of contiguous blocks which hold @a length packed bytes
+ * starting from packed @a offset. This is the number of uct_iov_t entries
+ * required to describe the data.
+ */
+static inline size_t ucp_dt_strided_iov_count(const ucp_dt_strided_t *dt,
+                                              size_t offset, size_t length)
+{
+    return ucs_div_round_up((offset % dt->blocklen) + length, dt->blocklen);
+}
+
+
+/**
+ * Copy @a length bytes from strided @a buffer, starting from packed @a offset,
+ * to contiguous buffer @a dest.
+ *
+ * @return Size in bytes that is copied to @a dest.
+ */
+size_t ucp_dt_strided_pack(const ucp_dt_strided_t *dt, void *dest,
+                           const void *buffer, size_t offset, size_t length);
+
+
+/**
+ * Copy @a length bytes from contiguous buffer @a src to strided @a buffer,
+ * starting from packed @a offset.
+ *
+ * @return Size in bytes that is copied to @a buffer.
+ */
+size_t ucp_dt_strided_unpack(const ucp_dt_strided_t *dt, void *buffer,
+                             const void *src, size_t offset, size_t length);
+
+
+/**
+ * Describe up to @a length_max bytes of strided @a buffer, starting from
+ * packed @a offset, by a list of UCT iov entries, one per contiguous block.
+ *
+ * @param [in]  dt          Strided datatype.
+ * @param [in]  buffer      Strided user buffer.
+ * @param [in]  offset      Packed offset to start from.
+ * @param [in]  length_max  Maximal number of bytes to describe.
+ * @param [in]  memh        Memory handle covering the buffer span.
+ * @param [out] iov         Filled with the iov entries.
+ * @param [in]  max_iov     Size of the @a iov array.
+ * @param [out] length_p    Filled with the number of bytes described.
+ *
+ * @return Number of entries filled in @a iov.
+ */
+size_t ucp_dt_strided_to_uct_iov(const ucp_dt_strided_t *dt, const void *buffer,
+                                 size_t offset, size_t length_max,
+                                 uct_mem_h memh, uct_iov_t *iov, size_t max_iov,
+                                 size_t *length_p);
+
+#endif
@@ -112,6 +112,7 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
     size_t iov_offset, max_src_iov, src_it, dst_it;
     size_t length_it = 0;
     ucp_md_index_t memh_index;
+    uct_mem_h memh;
 
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
@@ -164,6 +165,19 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
         state->dt.iov.iovcnt_offset = src_it;
         *iovcnt                     = dst_it;
         break;
+    case UCP_DATATYPE_STRIDED:
+        /* UCT iov stride can't describe a block smaller than the element,
+         * so every contiguous block takes an iov entry */
+        if (context->tl_mds[md_index].attr.cap.flags & UCT_MD_FLAG_REG) {
+            memh_index = ucs_bitmap2idx(state->dt.strided.md_map, md_index);
+            memh       = state->dt.strided.memh[memh_index];
+        } else {
+            memh       = UCT_MEM_HANDLE_NULL;
+        }
+        *iovcnt = ucp_dt_strided_to_uct_iov(ucp_dt_strided(datatype), src_iov,
+                                            state->offset, length_max, memh,
+                                            iov, max_dst_iov, &length_it);
+        break;
     default:
         ucs_error("Invalid data type");
     }
@@ -249,8 +263,9 @@ ucs_status_t ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
             req->send.lane = ucp_ep_get_am_lane(ep);
         }
     } else {
-        ucs_assert(UCP_DT_IS_IOV(req->send.datatype));
-        /* disable multilane for IOV datatype.
+        ucs_assert(UCP_DT_IS_IOV(req->send.datatype) ||
+                   UCP_DT_IS_STRIDED(req->send.datatype));
+        /* disable multilane for IOV and strided datatypes.
          * TODO: add IOV processing for multilane */
         req->send.lane = ucp_ep_get_am_lane(ep);
     }
@@ -269,6 +284,10 @@ ucs_status_t ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
             /* This flag should guarantee middle stage usage if iovcnt exceeded */
             flag_iov_mid = ((state.dt.iov.iovcnt_offset + max_iov) <
                             state.dt.iov.iovcnt);
+        } else if (UCP_DT_IS_STRIDED(req->send.datatype)) {
+            flag_iov_mid = ucp_dt_strided_iov_count(
+                               ucp_dt_strided(req->send.datatype), offset,
+                               req->send.length - offset) > max_iov;
         } else {
             ucs_assert(UCP_DT_IS_CONTIG(req->send.datatype));
         }
@@ -391,6 +410,15 @@ ucp_proto_get_zcopy_threshold(const ucp_request_t *req,
                               ucp_worker_iface_bandwidth(worker, rsc_index));
         }
         return ucs_min(max_zcopy, zcopy_thresh);
+    } else if (UCP_DT_IS_STRIDED(req->send.datatype)) {
+        /* The whole span is registered at once, but every block takes an iov
+         * entry, so avoid zero-copy fragments smaller than bcopy ones */
+        if (msg_config->zcopy_auto_thresh &&
+            ((ucp_dt_strided(req->send.datatype)->blocklen *
+              msg_config->max_iov) < msg_config->max_bcopy)) {
+            return max_zcopy;
+        }
+        return ucs_min(max_zcopy, msg_config->zcopy_thresh[0]);
     } else if (UCP_DT_IS_GENERIC(req->send.datatype)) {
         return max_zcopy;
     }
@@ -42,6 +42,60 @@ static int ucp_rndv_is_recv_pipeline_needed(ucp_request_t *rndv_req,
     return 1;
 }
 
+/* Track a request which waits for RTR/ATS (send side) or for the data/ATP
+ * (receive side) from the peer, to complete it if the peer fails */
+static UCS_F_ALWAYS_INLINE void
+ucp_rndv_req_wait_reply(ucp_request_t *req, ucp_ep_h ep)
+{
+    ucs_assert(!(req->flags & UCP_REQUEST_FLAG_RNDV_WAIT));
+    req->flags        |= UCP_REQUEST_FLAG_RNDV_WAIT;
+    req->rndv_wait.ep  = ep;
+    ucs_list_add_tail(&ep->worker->rndv_wait_reqs, &req->rndv_wait.list);
+}
+
+static UCS_F_ALWAYS_INLINE void ucp_rndv_req_reply_arrived(ucp_request_t *req)
+{
+    if (req->flags & UCP_REQUEST_FLAG_RNDV_WAIT) {
+        req->flags &= ~UCP_REQUEST_FLAG_RNDV_WAIT;
+        ucs_list_del(&req->rndv_wait.list);
+    }
+}
+
+/* Keep the first error which was reported on a request with several
+ * outstanding zero-copy operations, and return it */
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_rndv_req_update_status(ucp_request_t *req, ucs_status_t status)
+{
+    if (ucs_unlikely(status != UCS_OK) && (req->status == UCS_OK)) {
+        req->status = status;
+    }
+    return req->status;
+}
+
+/* Stop sending a request after an operation failed, and release it from the
+ * completion callback once all operations which were already posted are
+ * completed */
+static void ucp_rndv_req_send_failed(ucp_request_t *req, ucs_status_t status)
+{
+    ucs_assert(UCS_STATUS_IS_ERR(status));
+
+    ucp_rndv_req_update_status(req, status);
+    req->send.state.dt.offset = req->send.length;
+    if (req->send.state.uct_comp.count == 0) {
+        req->send.state.uct_comp.func(&req->send.state.uct_comp, status);
+    }
+}
+
+/* Release the resources of a send request which is going to be completed
+ * with an error by the caller */
+static void ucp_rndv_send_release(ucp_request_t *sreq, ucs_status_t status)
+{
+    if (UCS_STATUS_IS_ERR(status) && (status != UCS_ERR_NO_RESOURCE)) {
+        ucp_request_send_generic_dt_finish(sreq);
+        ucp_request_send_buffer_dereg(sreq);
+    }
+}
+
 size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
 {
     ucp_request_t *sreq              = arg;   /* send request */
@@ -80,16 +134,33 @@ size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
     return sizeof(*rndv_rts_hdr) + packed_rkey_size;
 }
 
-UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rts, (self),
-                 uct_pending_req_t *self)
+ucs_status_t ucp_rndv_send_rts(uct_pending_req_t *self, uint8_t am_id)
 {
     ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_h ep         = sreq->send.ep;
     size_t packed_rkey_size;
+    ucs_status_t status;
+
+    /* The reply may be handled before the send returns, for example on a
+     * loopback transport, so start waiting for it in advance */
+    ucp_rndv_req_wait_reply(sreq, ep);
 
     /* send the RTS. the pack_cb will pack all the necessary fields in the RTS */
-    packed_rkey_size = ucp_ep_config(sreq->send.ep)->tag.rndv.rkey_size;
-    return ucp_do_am_single(self, UCP_AM_ID_RNDV_RTS, ucp_tag_rndv_rts_pack,
-                            sizeof(ucp_rndv_rts_hdr_t) + packed_rkey_size);
+    packed_rkey_size = ucp_ep_config(ep)->tag.rndv.rkey_size;
+    status = ucp_do_am_single(self, am_id, ucp_tag_rndv_rts_pack,
+                              sizeof(ucp_rndv_rts_hdr_t) + packed_rkey_size);
+    if (status != UCS_OK) {
+        ucp_rndv_req_reply_arrived(sreq);
+        ucp_rndv_send_release(sreq, status);
+    }
+
+    return status;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rts, (self),
+                 uct_pending_req_t *self)
+{
+    return ucp_rndv_send_rts(self, UCP_AM_ID_RNDV_RTS);
 }
 
 static size_t ucp_tag_rndv_rtr_pack(void *dest, void *arg)
@@ -145,10 +216,45 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rtr, (self),
     return status;
 }
 
-ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
+static void ucp_rndv_complete_send(ucp_request_t *sreq, ucs_status_t status)
+{
+    ucp_request_send_generic_dt_finish(sreq);
+    ucp_request_send_buffer_dereg(sreq);
+    ucp_request_complete_send(sreq, status);
+}
+
+/* Called when a send request is purged from the pending queue, while it is
+ * waiting to send the RTS or to send the data with bcopy active messages */
+static void ucp_rndv_send_purge_completion(uct_completion_t *self,
+                                           ucs_status_t status)
+{
+    ucp_request_t *sreq = ucs_container_of(self, ucp_request_t,
+                                           send.state.uct_comp);
+
+    ucp_rndv_complete_send(sreq, status);
+}
+
+ucs_status_t ucp_rndv_reg_send_buffer(ucp_request_t *sreq)
 {
     ucp_ep_h ep = sreq->send.ep;
     ucp_md_map_t md_map;
+
+    sreq->send.state.uct_comp.func = ucp_rndv_send_purge_completion;
+
+    if (UCP_DT_IS_CONTIG(sreq->send.datatype) &&
+        ucp_rndv_is_get_zcopy(sreq->send.mem_type,
+                              ep->worker->context->config.ext.rndv_mode)) {
+        /* register a contiguous buffer for rma_get */
+        md_map = ucp_ep_config(ep)->key.rma_bw_md_map;
+        return ucp_request_send_buffer_reg(sreq, md_map);
+    }
+
+    return UCS_OK;
+}
+
+ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
+{
+    ucp_ep_h ep = sreq->send.ep;
     ucs_status_t status;
 
     ucp_trace_req(sreq, "start_rndv to %s buffer %p length %zu",
@@ -167,15 +273,9 @@ ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
             return status;
         }
     } else {
-        if (UCP_DT_IS_CONTIG(sreq->send.datatype) &&
-            ucp_rndv_is_get_zcopy(sreq->send.mem_type,
-                                  ep->worker->context->config.ext.rndv_mode)) {
-            /* register a contiguous buffer for rma_get */
-            md_map = ucp_ep_config(ep)->key.rma_bw_md_map;
-            status = ucp_request_send_buffer_reg(sreq, md_map);
-            if (status != UCS_OK) {
-                return status;
-            }
+        status = ucp_rndv_reg_send_buffer(sreq);
+        if (status != UCS_OK) {
+            return status;
         }
 
         ucs_assert(sreq->send.lane == ucp_ep_get_am_lane(ep));
@@ -185,23 +285,23 @@ ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
     return UCS_OK;
 }
 
-static void ucp_rndv_complete_send(ucp_request_t *sreq)
-{
-    ucp_request_send_generic_dt_finish(sreq);
-    ucp_request_send_buffer_dereg(sreq);
-    ucp_request_complete_send(sreq, UCS_OK);
-}
-
 static void ucp_rndv_req_send_ats(ucp_request_t *rndv_req, ucp_request_t *rreq,
-                                  uintptr_t remote_request)
+                                  uintptr_t remote_request, ucs_status_t status)
 {
-    ucp_trace_req(rndv_req, "send ats remote_request 0x%lx", remote_request);
+    ucp_trace_req(rndv_req, "send ats remote_request 0x%lx status '%s'",
+                  remote_request, ucs_status_string(status));
     UCS_PROFILE_REQUEST_EVENT(rreq, "send_ats", 0);
 
+    if (ucs_unlikely(rndv_req->send.ep->flags & UCP_EP_FLAG_FAILED)) {
+        /* the sender request is completed by the peer failure flow */
+        ucp_request_put(rndv_req);
+        return;
+    }
+
     rndv_req->send.lane         = ucp_ep_get_am_lane(rndv_req->send.ep);
     rndv_req->send.uct.func     = ucp_proto_progress_am_single;
     rndv_req->send.proto.am_id  = UCP_AM_ID_RNDV_ATS;
-    rndv_req->send.proto.status = UCS_OK;
+    rndv_req->send.proto.status = status;
     rndv_req->send.proto.remote_request = remote_request;
     rndv_req->send.proto.comp_cb = ucp_request_put;
 
@@ -284,19 +384,25 @@ static void ucp_rndv_zcopy_recv_req_complete(ucp_request_t *req, ucs_status_t st
 static void ucp_rndv_complete_rma_get_zcopy(ucp_request_t *rndv_req)
 {
     ucp_request_t *rreq = rndv_req->send.rndv_get.rreq;
+    ucs_status_t status = rndv_req->status;
 
     ucs_assertv(rndv_req->send.state.dt.offset == rndv_req->send.length,
                 "rndv_req=%p offset=%zu length=%zu", rndv_req,
                 rndv_req->send.state.dt.offset, rndv_req->send.length);
 
-    ucp_trace_req(rndv_req, "rndv_get completed");
+    ucp_trace_req(rndv_req, "rndv_get completed with status '%s'",
+                  ucs_status_string(status));
     UCS_PROFILE_REQUEST_EVENT(rreq, "complete_rndv_get", 0);
 
     ucp_rkey_destroy(rndv_req->send.rndv_get.rkey);
     ucp_request_send_buffer_dereg(rndv_req);
 
-    ucp_rndv_req_send_ats(rndv_req, rreq, rndv_req->send.rndv_get.remote_request);
-    ucp_rndv_zcopy_recv_req_complete(rreq, UCS_OK);
+    ucp_rndv_req_send_ats(rndv_req, rreq, rndv_req->send.rndv_get.remote_request,
+                          status);
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucp_request_recv_generic_dt_finish(rreq);
+    }
+    ucp_rndv_zcopy_recv_req_complete(rreq, status);
 }
 
 static void ucp_rndv_recv_data_init(ucp_request_t *rreq, size_t size)
@@ -412,6 +518,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
         ucp_rkey_destroy(rndv_req->send.rndv_get.rkey);
         ucp_rndv_recv_data_init(rndv_req->send.rndv_get.rreq,
                                 rndv_req->send.length);
+        ucp_rndv_req_wait_reply(rndv_req->send.rndv_get.rreq, ep);
         ucp_rndv_req_send_rtr(rndv_req, rndv_req->send.rndv_get.rreq,
                               rndv_req->send.rndv_get.remote_request);
         return UCS_OK;
@@ -497,20 +604,21 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
             /* in case if not all chunks are transmitted - return in_progress
              * status */
             return UCS_INPROGRESS;
-        } else {
-            if (status == UCS_ERR_NO_RESOURCE) {
-                if (lane != rndv_req->send.pending_lane) {
-                    /* switch to new pending lane */
-                    pending_add_res = ucp_request_pending_add(rndv_req, &status, 0);
-                    if (!pending_add_res) {
-                        /* failed to switch req to pending queue, try again */
-                        continue;
-                    }
-                    ucs_assert(status == UCS_INPROGRESS);
-                    return UCS_OK;
+        } else if (status == UCS_ERR_NO_RESOURCE) {
+            if (lane != rndv_req->send.pending_lane) {
+                /* switch to new pending lane */
+                pending_add_res = ucp_request_pending_add(rndv_req, &status, 0);
+                if (!pending_add_res) {
+                    /* failed to switch req to pending queue, try again */
+                    continue;
                 }
+                ucs_assert(status == UCS_INPROGRESS);
+                return UCS_OK;
             }
             return status;
+        } else {
+            ucp_rndv_req_send_failed(rndv_req, status);
+            return UCS_OK;
         }
     }
 }
@@ -521,6 +629,7 @@ UCS_PROFILE_FUNC_VOID(ucp_rndv_get_completion, (self, status),
     ucp_request_t *rndv_req = ucs_container_of(self, ucp_request_t,
                                                send.state.uct_comp);
 
+    ucp_rndv_req_update_status(rndv_req, status);
     if (rndv_req->send.state.dt.offset == rndv_req->send.length) {
         ucp_rndv_complete_rma_get_zcopy(rndv_req);
     }
@@ -531,8 +640,16 @@ static void ucp_rndv_put_completion(uct_completion_t *self, ucs_status_t status)
     ucp_request_t *sreq = ucs_container_of(self, ucp_request_t,
                                            send.state.uct_comp);
 
-    if (sreq->send.state.dt.offset == sreq->send.length) {
+    status = ucp_rndv_req_update_status(sreq, status);
+    if (sreq->send.state.dt.offset != sreq->send.length) {
+        return;
+    }
+
+    if (ucs_likely(status == UCS_OK)) {
         ucp_rndv_send_atp(sreq, sreq->send.rndv_put.remote_request);
+    } else {
+        ucp_rkey_destroy(sreq->send.rndv_put.rkey);
+        ucp_rndv_complete_send(sreq, status);
     }
 }
 
@@ -554,6 +671,7 @@ static void ucp_rndv_req_send_rma_get(ucp_request_t *rndv_req, ucp_request_t *rr
     rndv_req->send.rndv_get.lanes_map      = 0;
     rndv_req->send.rndv_get.lane_count     = 0;
     rndv_req->send.datatype                = rreq->recv.datatype;
+    rndv_req->status                       = UCS_OK;
 
     status = ucp_ep_rkey_unpack(rndv_req->send.ep, rndv_rts_hdr + 1,
                                 &rndv_req->send.rndv_get.rkey);
@@ -676,16 +794,25 @@ UCS_PROFILE_FUNC_VOID(ucp_rndv_matched, (worker, rreq, rndv_rts_hdr),
         ucp_trace_req(rndv_req,
                       "rndv truncated remote size %zu local size %zu rreq %p",
                       rndv_rts_hdr->size, rreq->recv.length, rreq);
-        ucp_rndv_req_send_ats(rndv_req, rreq, rndv_rts_hdr->sreq.reqptr);
+        ucp_rndv_req_send_ats(rndv_req, rreq, rndv_rts_hdr->sreq.reqptr,
+                              UCS_OK);
         ucp_request_recv_generic_dt_finish(rreq);
         ucp_rndv_zcopy_recv_req_complete(rreq, UCS_ERR_MESSAGE_TRUNCATED);
         goto out;
     }
 
-
     /* if the receive side is not connected yet then the RTS was received on a stub ep */
     ep = rndv_req->send.ep;
 
+    if (ucs_unlikely(UCS_STATUS_IS_ERR(ucp_ep_config(ep)->key.status))) {
+        /* the RTS was waiting in the unexpected queue while the peer failed */
+        ucp_trace_req(rreq, "rndv sender %s failed", ucp_ep_peer_name(ep));
+        ucp_request_put(rndv_req);
+        ucp_request_recv_generic_dt_finish(rreq);
+        ucp_request_complete_tag_recv(rreq, ucp_ep_config(ep)->key.status);
+        goto out;
+    }
+
     rndv_mode = worker->context->config.ext.rndv_mode;
     if (UCP_DT_IS_CONTIG(rreq->recv.datatype)) {
         if (rndv_rts_hdr->address &&
@@ -716,6 +843,7 @@ UCS_PROFILE_FUNC_VOID(ucp_rndv_matched, (worker, rreq, rndv_rts_hdr),
      * configured to PUT, or GET rndv mode is unsupported - send an RTR and
      * the sender will send the data with active message or put_zcopy. */
     ucp_rndv_recv_data_init(rreq, rndv_rts_hdr->size);
+    ucp_rndv_req_wait_reply(rreq, ep);
     ucp_rndv_req_send_rtr(rndv_req, rreq, rndv_rts_hdr->sreq.reqptr);
 
 out:
@@ -769,10 +897,11 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_ats_handler,
 
     /* dereg the original send request and set it to complete */
     UCS_PROFILE_REQUEST_EVENT(sreq, "rndv_ats_recv", 0);
+    ucp_rndv_req_reply_arrived(sreq);
     if (sreq->flags & UCP_REQUEST_FLAG_OFFLOADED) {
         ucp_tag_offload_cancel_rndv(sreq);
     }
-    ucp_rndv_complete_send(sreq);
+    ucp_rndv_complete_send(sreq, rep_hdr->status);
     return UCS_OK;
 }
 
@@ -814,9 +943,11 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_am_bcopy, (self),
                                        ucp_rndv_pack_data, 1);
     }
     if (status == UCS_OK) {
-        ucp_rndv_complete_send(sreq);
+        ucp_rndv_complete_send(sreq, UCS_OK);
     } else if (status == UCP_STATUS_PENDING_SWITCH) {
         status = UCS_OK;
+    } else if (status != UCS_ERR_NO_RESOURCE) {
+        ucp_rndv_send_release(sreq, status);
     }
 
     return status;
@@ -878,8 +1009,11 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_put_zcopy, (self),
         return UCS_OK;
     } else if (!UCS_STATUS_IS_ERR(status)) {
         return UCS_INPROGRESS;
-    } else {
+    } else if (status == UCS_ERR_NO_RESOURCE) {
         return status;
+    } else {
+        ucp_rndv_req_send_failed(sreq, status);
+        return UCS_OK;
     }
 }
 
@@ -899,7 +1033,12 @@ static void ucp_rndv_am_zcopy_completion(uct_completion_t *self,
     if (sreq->send.state.dt.offset == sreq->send.length) {
         ucp_rndv_am_zcopy_send_req_complete(sreq, status);
     } else if (status != UCS_OK) {
-        ucs_fatal("error handling is unsupported with rendezvous protocol");
+        /* NOTE: the request is in pending queue if data was not completely
+         *       sent, so just dereg the buffer here and complete the request
+         *       on purge pending later.
+         */
+        ucp_request_send_buffer_dereg(sreq);
+        sreq->send.state.uct_comp.func = NULL;
     }
 }
 
@@ -1178,6 +1317,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_atp_handler,
         ucp_request_send(req, 0);
     } else {
         UCS_PROFILE_REQUEST_EVENT(req, "rndv_atp_recv", 0);
+        ucp_rndv_req_reply_arrived(req);
         ucp_rndv_zcopy_recv_req_complete(req, UCS_OK);
     }
 
@@ -1197,6 +1337,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rtr_handler,
     ucp_trace_req(sreq, "received rtr address 0x%lx remote rreq 0x%lx",
                   rndv_rtr_hdr->address, rndv_rtr_hdr->rreq_ptr);
     UCS_PROFILE_REQUEST_EVENT(sreq, "rndv_rtr_recv", 0);
+    ucp_rndv_req_reply_arrived(sreq);
 
     if (sreq->flags & UCP_REQUEST_FLAG_OFFLOADED) {
         /* Do not deregister memory here, because am zcopy rndv may
@@ -1238,6 +1379,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rtr_handler,
                 ucp_ep_config(ep)->tag.rndv.max_put_zcopy) {
                 ucp_request_send_state_reset(sreq, ucp_rndv_put_completion,
                                              UCP_REQUEST_SEND_PROTO_RNDV_PUT);
+                sreq->status                       = UCS_OK;
                 sreq->send.uct.func                = ucp_rndv_progress_rma_put_zcopy;
                 sreq->send.rndv_put.remote_request = rndv_rtr_hdr->rreq_ptr;
                 sreq->send.rndv_put.remote_address = rndv_rtr_hdr->address;
@@ -1293,11 +1435,73 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_data_handler,
     recv_len = length - sizeof(*rndv_data_hdr);
     UCS_PROFILE_REQUEST_EVENT(rreq, "rndv_data_recv", recv_len);
 
+    if (rreq->recv.tag.remaining == recv_len) {
+        /* last fragment - the request is completed below */
+        ucp_rndv_req_reply_arrived(rreq);
+    }
+
     (void)ucp_tag_request_process_recv_data(rreq, rndv_data_hdr + 1, recv_len,
                                             rndv_data_hdr->offset, 1, 0);
     return UCS_OK;
 }
 
+void ucp_rndv_ep_purge(ucp_ep_h ep, ucs_status_t status)
+{
+    ucp_worker_h worker = ep->worker;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr;
+    ucp_recv_desc_t *rdesc, *tmp_rdesc;
+    ucp_request_t *req, *tmp;
+
+    ucs_assert(UCS_STATUS_IS_ERR(status));
+
+    /* The data of unexpected RTS messages from the peer can not be fetched,
+     * and the endpoint may be destroyed before they are matched */
+    ucs_list_for_each_safe(rdesc, tmp_rdesc, &worker->tm.unexpected.all,
+                           tag_list[UCP_RDESC_ALL_LIST]) {
+        rndv_rts_hdr = (ucp_rndv_rts_hdr_t*)(rdesc + 1);
+        if ((rdesc->flags & UCP_RECV_DESC_FLAG_RNDV) &&
+            (rndv_rts_hdr->sreq.ep_ptr == (uintptr_t)ep)) {
+            ucs_trace_req("drop unexp "UCP_RECV_DESC_FMT" from failed ep %p",
+                          UCP_RECV_DESC_ARG(rdesc), ep);
+            ucp_tag_unexp_remove(&worker->tm, rdesc);
+            ucp_recv_desc_release(rdesc);
+        }
+    }
+
+    /* The peer will not reply anymore, so complete the requests which are
+     * waiting for RTR/ATS or for the data with an error */
+    ucs_list_for_each_safe(req, tmp, &worker->rndv_wait_reqs, rndv_wait.list) {
+        if (req->rndv_wait.ep != ep) {
+            continue;
+        }
+
+        ucp_trace_req(req, "rndv purged: %s", ucs_status_string(status));
+        ucp_rndv_req_reply_arrived(req);
+        if (req->flags & (UCP_REQUEST_FLAG_SEND_TAG | UCP_REQUEST_FLAG_SEND_AM)) {
+            ucp_rndv_complete_send(req, status);
+        } else {
+            ucp_request_recv_generic_dt_finish(req);
+            ucp_rndv_zcopy_recv_req_complete(req, status);
+        }
+    }
+}
+
+void ucp_rndv_ep_cleanup(ucp_ep_h ep)
+{
+    ucp_request_t *req, *tmp;
+
+    /* The peer may still reply, so keep the requests outstanding but stop
+     * tracking them on the destroyed endpoint */
+    ucs_list_for_each_safe(req, tmp, &ep->worker->rndv_wait_reqs,
+                           rndv_wait.list) {
+        if (req->rndv_wait.ep == ep) {
+            ucs_debug("ep %p: request %p is waiting for rendezvous reply",
+                      ep, req);
+            ucp_rndv_req_reply_arrived(req);
+        }
+    }
+}
+
 static void ucp_rndv_dump_rkey(const void *packed_rkey, char *buffer, size_t max)
 {
     char *p    = buffer;
@@ -1359,14 +1563,14 @@ static void ucp_rndv_dump(ucp_worker_h worker, uct_am_trace_type_t type,
 
 UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_RTS, ucp_rndv_rts_handler,
               ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATS, ucp_rndv_ats_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATP, ucp_rndv_atp_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_RTR, ucp_rndv_rtr_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_DATA, ucp_rndv_data_handler,
-              ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM, UCP_AM_ID_RNDV_ATS,
+              ucp_rndv_ats_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM, UCP_AM_ID_RNDV_ATP,
+              ucp_rndv_atp_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM, UCP_AM_ID_RNDV_RTR,
+              ucp_rndv_rtr_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM, UCP_AM_ID_RNDV_DATA,
+              ucp_rndv_data_handler, ucp_rndv_dump, 0);
 
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_RTS);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_ATS);
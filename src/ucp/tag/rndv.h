@@ -49,6 +49,8 @@ typedef struct {
 
 ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *req);
 
+ucs_status_t ucp_rndv_reg_send_buffer(ucp_request_t *sreq);
+
 void ucp_rndv_matched(ucp_worker_h worker, ucp_request_t *req,
                       const ucp_rndv_rts_hdr_t *rndv_rts_hdr);
 
@@ -59,4 +61,21 @@ ucs_status_t ucp_rndv_process_rts(void *arg, void *data, size_t length,
 
 size_t ucp_tag_rndv_rts_pack(void *dest, void *arg);
 
+ucs_status_t ucp_rndv_send_rts(uct_pending_req_t *self, uint8_t am_id);
+
+/**
+ * Complete the rendezvous requests which are waiting for a reply from the
+ * peer of a failed endpoint.
+ *
+ * @param [in]  ep      Failed endpoint.
+ * @param [in]  status  Error status to complete the requests with.
+ */
+void ucp_rndv_ep_purge(ucp_ep_h ep, ucs_status_t status);
+
+/**
+ * Detach the rendezvous requests which are waiting for a reply from an
+ * endpoint which is being destroyed.
+ */
+void ucp_rndv_ep_cleanup(ucp_ep_h ep);
+
 #endif
@@ -12,37 +12,96 @@
 #include <ucp/tag/offload.h>
 
 
-ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm)
+static ucp_request_queue_t *ucp_tag_exp_hash_buckets_alloc(unsigned size)
 {
-    size_t hash_size, bucket;
+    ucp_request_queue_t *buckets;
+    unsigned bucket;
+
+    buckets = ucs_malloc(sizeof(*buckets) * size, "ucp_tm_exp_hash");
+    if (buckets == NULL) {
+        return NULL;
+    }
+
+    for (bucket = 0; bucket < size; ++bucket) {
+        buckets[bucket].sw_count    = 0;
+        buckets[bucket].block_count = 0;
+        ucs_queue_head_init(&buckets[bucket].queue);
+    }
+
+    return buckets;
+}
+
+static ucs_list_link_t *ucp_tag_unexp_hash_buckets_alloc(unsigned size)
+{
+    ucs_list_link_t *buckets;
+    unsigned bucket;
+
+    buckets = ucs_malloc(sizeof(*buckets) * size, "ucp_tm_unexp_hash");
+    if (buckets == NULL) {
+        return NULL;
+    }
+
+    for (bucket = 0; bucket < size; ++bucket) {
+        ucs_list_head_init(&buckets[bucket]);
+    }
+
+    return buckets;
+}
+
+static ucs_status_t ucp_tag_exp_hash_init(ucp_tag_exp_hash_t *hash,
+                                          unsigned size)
+{
+    hash->buckets = ucp_tag_exp_hash_buckets_alloc(size);
+    if (hash->buckets == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    hash->mask  = size - 1;
+    hash->count = 0;
+    return UCS_OK;
+}
 
-    hash_size = ucs_roundup_pow2(UCP_TAG_MATCH_HASH_SIZE);
+ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm)
+{
+    ucs_status_t status;
+    unsigned i;
 
-    tm->expected.sn           = 0;
-    tm->expected.sw_all_count = 0;
+    tm->expected.sn               = 0;
+    tm->expected.sw_all_count     = 0;
+    tm->expected.sw_masked_count  = 0;
+    tm->expected.num_mask_classes = 0;
+    tm->expected.wildcard.sw_count    = 0;
+    tm->expected.wildcard.block_count = 0;
     ucs_queue_head_init(&tm->expected.wildcard.queue);
     ucs_list_head_init(&tm->unexpected.all);
 
-    tm->expected.hash = ucs_malloc(sizeof(*tm->expected.hash) * hash_size,
-                                   "ucp_tm_exp_hash");
-    if (tm->expected.hash == NULL) {
-        return UCS_ERR_NO_MEMORY;
+    status = ucp_tag_exp_hash_init(&tm->expected.hash,
+                                   UCP_TAG_MATCH_HASH_INIT_SIZE);
+    if (status != UCS_OK) {
+        goto err;
     }
 
-    tm->unexpected.hash = ucs_malloc(sizeof(*tm->unexpected.hash) * hash_size,
-                                     "ucp_tm_unexp_hash");
-    if (tm->unexpected.hash == NULL) {
-        ucs_free(tm->expected.hash);
-        return UCS_ERR_NO_MEMORY;
+    /* mask classes are allocated in advance, so a new class can be started on
+     * the fast path without a failure */
+    for (i = 0; i < UCP_TAG_MATCH_MAX_MASK_CLASSES; ++i) {
+        tm->expected.mask_classes[i].tag_mask = 0;
+        status = ucp_tag_exp_hash_init(&tm->expected.mask_classes[i].hash,
+                                       UCP_TAG_MATCH_MASK_HASH_INIT_SIZE);
+        if (status != UCS_OK) {
+            goto err_free_mask_classes;
+        }
     }
 
-    for (bucket = 0; bucket < hash_size; ++bucket) {
-        tm->expected.hash[bucket].sw_count    = 0;
-        tm->expected.hash[bucket].block_count = 0;
-        ucs_queue_head_init(&tm->expected.hash[bucket].queue);
-        ucs_list_head_init(&tm->unexpected.hash[bucket]);
+    tm->unexpected.hash = ucp_tag_unexp_hash_buckets_alloc(
+                                  UCP_TAG_MATCH_HASH_INIT_SIZE);
+    if (tm->unexpected.hash == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto err_free_mask_classes;
     }
 
+    tm->unexpected.hash_mask = UCP_TAG_MATCH_HASH_INIT_SIZE - 1;
+    tm->unexpected.count     = 0;
+
     kh_init_inplace(ucp_tag_frag_hash, &tm->frag_hash);
     ucs_queue_head_init(&tm->offload.sync_reqs);
     kh_init_inplace(ucp_tag_offload_hash, &tm->offload.tag_hash);
@@ -50,14 +109,125 @@ ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm)
     tm->offload.zcopy_thresh = SIZE_MAX;
     tm->offload.iface        = NULL;
     return UCS_OK;
+
+err_free_mask_classes:
+    while (i-- > 0) {
+        ucs_free(tm->expected.mask_classes[i].hash.buckets);
+    }
+    ucs_free(tm->expected.hash.buckets);
+err:
+    return status;
 }
 
 void ucp_tag_match_cleanup(ucp_tag_match_t *tm)
 {
+    unsigned i;
+
     kh_destroy_inplace(ucp_tag_offload_hash, &tm->offload.tag_hash);
     kh_destroy_inplace(ucp_tag_frag_hash, &tm->frag_hash);
     ucs_free(tm->unexpected.hash);
-    ucs_free(tm->expected.hash);
+    for (i = 0; i < UCP_TAG_MATCH_MAX_MASK_CLASSES; ++i) {
+        ucs_free(tm->expected.mask_classes[i].hash.buckets);
+    }
+    ucs_free(tm->expected.hash.buckets);
+}
+
+ucp_tag_exp_hash_t*
+ucp_tag_exp_mask_class_add(ucp_tag_match_t *tm, ucp_tag_t tag_mask)
+{
+    ucp_tag_exp_mask_class_t *mask_class;
+
+    /* A zero mask matches all tags, so hashing by the masked tag is useless.
+     * Mask classes are never released, since requests which were posted
+     * before a class was started must remain on the wildcard queue. */
+    if ((tag_mask == 0) ||
+        (tm->expected.num_mask_classes == UCP_TAG_MATCH_MAX_MASK_CLASSES)) {
+        return NULL;
+    }
+
+    mask_class           = &tm->expected.mask_classes[tm->expected.num_mask_classes++];
+    mask_class->tag_mask = tag_mask;
+    ucs_debug("tm %p: added mask class %"PRIx64, tm, tag_mask);
+    return &mask_class->hash;
+}
+
+void ucp_tag_exp_hash_grow(ucp_tag_exp_hash_t *hash, ucp_tag_t tag_mask)
+{
+    ucp_request_queue_t *old_buckets = hash->buckets;
+    unsigned old_size                = hash->mask + 1;
+    ucp_request_queue_t *req_queue, *new_buckets;
+    ucp_request_t *req;
+    unsigned bucket;
+
+    if (old_size >= UCP_TAG_MATCH_HASH_MAX_SIZE) {
+        return;
+    }
+
+    new_buckets = ucp_tag_exp_hash_buckets_alloc(old_size * 2);
+    if (new_buckets == NULL) {
+        /* keep the current size, matching is still correct */
+        return;
+    }
+
+    hash->buckets = new_buckets;
+    hash->mask    = (old_size * 2) - 1;
+
+    /* Since the number of buckets is doubled, every new bucket gets requests
+     * from a single old bucket, so the requests remain ordered by their
+     * sequence number */
+    for (bucket = 0; bucket < old_size; ++bucket) {
+        while (!ucs_queue_is_empty(&old_buckets[bucket].queue)) {
+            req = ucs_queue_pull_elem_non_empty(&old_buckets[bucket].queue,
+                                                ucp_request_t, recv.queue);
+            req_queue = ucp_tag_exp_hash_bucket(hash,
+                                                req->recv.tag.tag & tag_mask);
+            ucs_queue_push(&req_queue->queue, &req->recv.queue);
+            if (!(req->flags & UCP_REQUEST_FLAG_OFFLOADED)) {
+                ++req_queue->sw_count;
+                req_queue->block_count +=
+                        !!(req->flags & UCP_REQUEST_FLAG_BLOCK_OFFLOAD);
+            }
+        }
+    }
+
+    ucs_free(old_buckets);
+    ucs_debug("expected hash %p with mask %"PRIx64" resized to %u buckets",
+              hash, tag_mask, hash->mask + 1);
+}
+
+void ucp_tag_unexp_hash_grow(ucp_tag_match_t *tm)
+{
+    ucs_list_link_t *old_buckets = tm->unexpected.hash;
+    unsigned old_size            = tm->unexpected.hash_mask + 1;
+    ucp_recv_desc_t *rdesc, *tmp;
+    unsigned bucket;
+
+    if (old_size >= UCP_TAG_MATCH_HASH_MAX_SIZE) {
+        return;
+    }
+
+    tm->unexpected.hash = ucp_tag_unexp_hash_buckets_alloc(old_size * 2);
+    if (tm->unexpected.hash == NULL) {
+        tm->unexpected.hash = old_buckets;
+        return;
+    }
+
+    tm->unexpected.hash_mask = (old_size * 2) - 1;
+
+    /* Keep the order of descriptors with the same tag, as in the expected
+     * hash table */
+    for (bucket = 0; bucket < old_size; ++bucket) {
+        ucs_list_for_each_safe(rdesc, tmp, &old_buckets[bucket],
+                               tag_list[UCP_RDESC_HASH_LIST]) {
+            ucs_list_add_tail(ucp_tag_unexp_get_list_for_tag(tm,
+                                                  ucp_rdesc_get_tag(rdesc)),
+                              &rdesc->tag_list[UCP_RDESC_HASH_LIST]);
+        }
+    }
+
+    ucs_free(old_buckets);
+    ucs_debug("tm %p: unexpected hash resized to %u buckets", tm,
+              tm->unexpected.hash_mask + 1);
 }
 
 int ucp_tag_unexp_is_empty(ucp_tag_match_t *tm)
@@ -85,58 +255,71 @@ int ucp_tag_exp_remove(ucp_tag_match_t *tm, ucp_request_t *req)
     return 0;
 }
 
-static inline uint64_t ucp_tag_exp_req_seq(ucs_queue_iter_t iter)
+/* Find the first request in the queue which matches the tag, if it was posted
+ * before the best match found so far */
+static UCS_F_ALWAYS_INLINE void
+ucp_tag_exp_search_queue(ucp_request_queue_t *req_queue, ucp_tag_t tag,
+                         ucp_request_queue_t **match_queue_p,
+                         ucs_queue_iter_t *match_iter_p, uint64_t *match_sn_p)
 {
-    return (*iter == NULL) ? ULONG_MAX :
-           ucs_container_of(*iter, ucp_request_t, recv.queue)->recv.tag.sn;
+    ucs_queue_head_t *queue = &req_queue->queue;
+    ucs_queue_iter_t iter;
+    ucp_request_t *req;
+
+    for (iter = ucs_queue_iter_begin(queue); !ucs_queue_iter_end(queue, iter);
+         iter = ucs_queue_iter_next(iter)) {
+        req = ucs_queue_iter_elem(req, iter, recv.queue);
+        if (req->recv.tag.sn >= *match_sn_p) {
+            /* the queue is ordered by sequence number */
+            return;
+        }
+
+        if (ucp_tag_is_match(tag, req->recv.tag.tag, req->recv.tag.tag_mask)) {
+            *match_queue_p = req_queue;
+            *match_iter_p  = iter;
+            *match_sn_p    = req->recv.tag.sn;
+            return;
+        }
+    }
 }
 
 ucp_request_t*
 ucp_tag_exp_search_all(ucp_tag_match_t *tm, ucp_request_queue_t *req_queue,
                        ucp_tag_t tag)
 {
-    ucs_queue_head_t *hash_queue = &req_queue->queue;
-    ucp_request_queue_t *queue;
-    ucs_queue_iter_t hash_iter, wild_iter, *iter;
-    uint64_t hash_sn, wild_sn, *sn_p;
+    ucp_request_queue_t *match_queue = NULL;
+    ucs_queue_iter_t match_iter      = NULL;
+    uint64_t match_sn                = UINT64_MAX;
+    ucp_tag_exp_mask_class_t *mask_class;
     ucp_request_t *req;
 
-    *hash_queue->ptail                 = NULL;
-    *tm->expected.wildcard.queue.ptail = NULL;
-
-    hash_iter = ucs_queue_iter_begin(hash_queue);
-    wild_iter = ucs_queue_iter_begin(&tm->expected.wildcard.queue);
+    /* Every queue is ordered by sequence number, so the request which should
+     * be matched is the earliest among the first matches of all queues which
+     * may contain the tag */
+    ucp_tag_exp_search_queue(req_queue, tag, &match_queue, &match_iter,
+                             &match_sn);
+    ucp_tag_exp_search_queue(&tm->expected.wildcard, tag, &match_queue,
+                             &match_iter, &match_sn);
 
-    hash_sn = ucp_tag_exp_req_seq(hash_iter);
-    wild_sn = ucp_tag_exp_req_seq(wild_iter);
-
-    while (hash_sn != wild_sn) {
-        if (hash_sn < wild_sn) {
-            iter  = &hash_iter;
-            sn_p  = &hash_sn;
-            queue = req_queue;
-        } else {
-            iter  = &wild_iter;
-            sn_p  = &wild_sn;
-            queue = &tm->expected.wildcard;
-        }
-
-        req = ucs_container_of(**iter, ucp_request_t, recv.queue);
-        if (ucp_tag_is_match(tag, req->recv.tag.tag, req->recv.tag.tag_mask)) {
-            ucs_trace_req("matched received tag %"PRIx64" to req %p", tag, req);
-            ucp_tag_exp_delete(req, tm, queue, *iter);
-            return req;
+    for (mask_class = tm->expected.mask_classes;
+         mask_class < tm->expected.mask_classes + tm->expected.num_mask_classes;
+         ++mask_class) {
+        if (mask_class->hash.count > 0) {
+            ucp_tag_exp_search_queue(ucp_tag_exp_hash_bucket(&mask_class->hash,
+                                                             tag &
+                                                             mask_class->tag_mask),
+                                     tag, &match_queue, &match_iter, &match_sn);
         }
+    }
 
-        *iter = ucs_queue_iter_next(*iter);
-        *sn_p = ucp_tag_exp_req_seq(*iter);
+    if (match_queue == NULL) {
+        return NULL;
     }
 
-    ucs_assertv((hash_sn == ULONG_MAX) && (wild_sn == ULONG_MAX),
-                "hash_seq=%lu wild_seq=%lu", hash_sn, wild_sn);
-    ucs_assert(ucs_queue_iter_end(hash_queue, hash_iter));
-    ucs_assert(ucs_queue_iter_end(&tm->expected.wildcard.queue, wild_iter));
-    return NULL;
+    req = ucs_queue_iter_elem(req, match_iter, recv.queue);
+    ucs_trace_req("matched received tag %"PRIx64" to req %p", tag, req);
+    ucp_tag_exp_delete(req, tm, match_queue, match_iter);
+    return req;
 }
 
 void ucp_tag_frag_list_process_queue(ucp_tag_match_t *tm, ucp_request_t *req,
@@ -18,6 +18,11 @@
 #define UCP_TAG_MASK_FULL     0xffffffffffffffffUL  /* All 1-s */
 
 
+/* Maximal number of distinct partial tag masks which have their own hash
+ * table of expected requests */
+#define UCP_TAG_MATCH_MAX_MASK_CLASSES  4
+
+
 KHASH_INIT(ucp_tag_offload_hash, ucp_tag_t, ucp_worker_iface_t *, 1,
            kh_int64_hash_func, kh_int64_hash_equal);
 
@@ -42,6 +47,27 @@ typedef struct {
 } ucp_request_queue_t;
 
 
+/**
+ * Hash table of expected requests. The number of buckets is a power of 2, and
+ * it grows when the average bucket length becomes too large.
+ */
+typedef struct {
+    ucp_request_queue_t   *buckets;    /* Array of (mask + 1) request queues */
+    unsigned              mask;        /* Number of buckets - 1 */
+    unsigned              count;       /* Number of requests in the table */
+} ucp_tag_exp_hash_t;
+
+
+/**
+ * Expected requests posted with the same partial tag mask, hashed by the
+ * masked tag
+ */
+typedef struct {
+    ucp_tag_t             tag_mask;    /* Tag mask of all requests in the class */
+    ucp_tag_exp_hash_t    hash;        /* Hash table of the requests */
+} ucp_tag_exp_mask_class_t;
+
+
 /**
  * Hash table entry for tag message fragments
  */
@@ -62,17 +88,27 @@ typedef struct ucp_tag_match {
 
     /* Expected queue */
     struct {
-        ucp_request_queue_t   wildcard;   /* Expected wildcard requests */
-        ucp_request_queue_t   *hash;      /* Hash table of expected non-wild tags */
+        ucp_request_queue_t   wildcard;   /* Expected wildcard requests, which
+                                             don't have a mask class */
+        ucp_tag_exp_hash_t    hash;       /* Hash table of expected non-wild tags */
+        ucp_tag_exp_mask_class_t mask_classes[UCP_TAG_MATCH_MAX_MASK_CLASSES];
+                                          /* Hash tables of expected requests
+                                             with a partial tag mask */
+        unsigned              num_mask_classes; /* Number of used mask classes */
         uint64_t              sn;
         unsigned              sw_all_count; /* Number of all expected requests which
                                                are not posted to offload */
+        unsigned              sw_masked_count; /* Number of expected requests with
+                                                  a partial tag mask which are
+                                                  not posted to offload */
     } expected;
 
     /* Unexpected queue */
     struct {
         ucs_list_link_t       all;        /* Linked list of all tags */
         ucs_list_link_t       *hash;      /* Hash table of unexpected tags */
+        unsigned              hash_mask;  /* Number of hash buckets - 1 */
+        unsigned              count;      /* Number of unexpected tags */
     } unexpected;
 
     /* Hash for fragment assembly, the key is a globally unique tag message id */
@@ -107,6 +143,13 @@ void ucp_tag_match_cleanup(ucp_tag_match_t *tm);
 
 int ucp_tag_exp_remove(ucp_tag_match_t *tm, ucp_request_t *req);
 
+ucp_tag_exp_hash_t*
+ucp_tag_exp_mask_class_add(ucp_tag_match_t *tm, ucp_tag_t tag_mask);
+
+void ucp_tag_exp_hash_grow(ucp_tag_exp_hash_t *hash, ucp_tag_t tag_mask);
+
+void ucp_tag_unexp_hash_grow(ucp_tag_match_t *tm);
+
 int ucp_tag_unexp_is_empty(ucp_tag_match_t *tm);
 
 ucp_request_t*
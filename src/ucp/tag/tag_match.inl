@@ -20,9 +20,18 @@
 #include <inttypes.h>
 
 
-/* Hash size is a prime number just below 1024. Prime number for even distribution,
- * and small enough to fit L1 cache. */
-#define UCP_TAG_MATCH_HASH_SIZE     1021
+/* Initial number of buckets in the hash tables of expected and unexpected tags.
+ * Small enough to fit L1 cache. */
+#define UCP_TAG_MATCH_HASH_INIT_SIZE       1024
+
+/* Initial number of buckets in the hash table of a mask class */
+#define UCP_TAG_MATCH_MASK_HASH_INIT_SIZE  64
+
+/* Maximal number of buckets in a hash table */
+#define UCP_TAG_MATCH_HASH_MAX_SIZE        UCS_BIT(24)
+
+/* Average bucket length which makes a hash table grow */
+#define UCP_TAG_MATCH_HASH_MAX_LOAD        2
 
 
 static UCS_F_ALWAYS_INLINE
@@ -44,25 +53,77 @@ int ucp_tag_is_match(ucp_tag_t tag, ucp_tag_t exp_tag, ucp_tag_t tag_mask)
 static UCS_F_ALWAYS_INLINE size_t
 ucp_tag_match_calc_hash(ucp_tag_t tag)
 {
-    /* Compute two 32-bit modulo and combine their result */
-    return ((uint32_t)tag % UCP_TAG_MATCH_HASH_SIZE) ^
-           ((uint32_t)(tag >> 32) % UCP_TAG_MATCH_HASH_SIZE);
+    /* Fold the tag to 32 bits and scramble it by a multiplicative hash, so the
+     * low bits of the result, which select the bucket, depend on all tag bits */
+    return (uint32_t)(((tag ^ (tag >> 32)) * 0x9e3779b97f4a7c15ul) >> 32);
+}
+
+static UCS_F_ALWAYS_INLINE int
+ucp_tag_match_hash_is_full(unsigned count, unsigned hash_mask)
+{
+    return ucs_unlikely(count > ((hash_mask + 1) * UCP_TAG_MATCH_HASH_MAX_LOAD));
+}
+
+static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
+ucp_tag_exp_hash_bucket(ucp_tag_exp_hash_t *hash, ucp_tag_t key)
+{
+    return &hash->buckets[ucp_tag_match_calc_hash(key) & hash->mask];
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
 ucp_tag_exp_get_queue_for_tag(ucp_tag_match_t *tm, ucp_tag_t tag)
 {
-    return &tm->expected.hash[ucp_tag_match_calc_hash(tag)];
+    return ucp_tag_exp_hash_bucket(&tm->expected.hash, tag);
+}
+
+/* Get the hash table of expected requests with the given tag mask, or NULL if
+ * such requests are kept on the wildcard queue */
+static UCS_F_ALWAYS_INLINE ucp_tag_exp_hash_t*
+ucp_tag_exp_get_hash(ucp_tag_match_t *tm, ucp_tag_t tag_mask)
+{
+    unsigned i;
+
+    if (ucs_likely(tag_mask == UCP_TAG_MASK_FULL)) {
+        return &tm->expected.hash;
+    }
+
+    for (i = 0; i < tm->expected.num_mask_classes; ++i) {
+        if (tm->expected.mask_classes[i].tag_mask == tag_mask) {
+            return &tm->expected.mask_classes[i].hash;
+        }
+    }
+
+    return NULL;
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
 ucp_tag_exp_get_queue(ucp_tag_match_t *tm, ucp_tag_t tag, ucp_tag_t tag_mask)
 {
-    if (tag_mask == UCP_TAG_MASK_FULL) {
-        return ucp_tag_exp_get_queue_for_tag(tm, tag);
-    } else {
+    ucp_tag_exp_hash_t *hash = ucp_tag_exp_get_hash(tm, tag_mask);
+
+    if (ucs_unlikely(hash == NULL)) {
         return &tm->expected.wildcard;
     }
+
+    return ucp_tag_exp_hash_bucket(hash, tag & tag_mask);
+}
+
+/* Get the queue for a new expected request, and start a new mask class for
+ * its tag mask if there is room for it */
+static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
+ucp_tag_exp_get_post_queue(ucp_tag_match_t *tm, ucp_tag_t tag,
+                           ucp_tag_t tag_mask)
+{
+    ucp_tag_exp_hash_t *hash = ucp_tag_exp_get_hash(tm, tag_mask);
+
+    if (ucs_unlikely(hash == NULL)) {
+        hash = ucp_tag_exp_mask_class_add(tm, tag_mask);
+        if (hash == NULL) {
+            return &tm->expected.wildcard;
+        }
+    }
+
+    return ucp_tag_exp_hash_bucket(hash, tag & tag_mask);
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
@@ -75,8 +136,16 @@ static UCS_F_ALWAYS_INLINE void
 ucp_tag_exp_push(ucp_tag_match_t *tm, ucp_request_queue_t *req_queue,
                  ucp_request_t *req)
 {
+    ucp_tag_exp_hash_t *hash;
+
     req->recv.tag.sn = tm->expected.sn++;
     ucs_queue_push(&req_queue->queue, &req->recv.queue);
+
+    /* req_queue is not used after the hash table grows */
+    hash = ucp_tag_exp_get_hash(tm, req->recv.tag.tag_mask);
+    if ((hash != NULL) && ucp_tag_match_hash_is_full(++hash->count, hash->mask)) {
+        ucp_tag_exp_hash_grow(hash, req->recv.tag.tag_mask);
+    }
 }
 
 static UCS_F_ALWAYS_INLINE void
@@ -85,6 +154,18 @@ ucp_tag_exp_add(ucp_tag_match_t *tm, ucp_request_t *req)
     ucp_tag_exp_push(tm, ucp_tag_exp_get_req_queue(tm, req), req);
 }
 
+/* Account a request which was removed from its expected queue */
+static UCS_F_ALWAYS_INLINE void
+ucp_tag_exp_hash_count_dec(ucp_tag_match_t *tm, ucp_request_t *req)
+{
+    ucp_tag_exp_hash_t *hash = ucp_tag_exp_get_hash(tm, req->recv.tag.tag_mask);
+
+    if (hash != NULL) {
+        ucs_assert(hash->count > 0);
+        --hash->count;
+    }
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_tag_exp_delete(ucp_request_t *req, ucp_tag_match_t *tm,
                    ucp_request_queue_t *req_queue, ucs_queue_iter_t iter)
@@ -95,8 +176,12 @@ ucp_tag_exp_delete(ucp_request_t *req, ucp_tag_match_t *tm,
         if (req->flags & UCP_REQUEST_FLAG_BLOCK_OFFLOAD) {
             --req_queue->block_count;
         }
+        if (req->recv.tag.tag_mask != UCP_TAG_MASK_FULL) {
+            --tm->expected.sw_masked_count;
+        }
     }
     ucs_queue_del_iter(&req_queue->queue, iter);
+    ucp_tag_exp_hash_count_dec(tm, req);
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_t *
@@ -106,12 +191,14 @@ ucp_tag_exp_search(ucp_tag_match_t *tm, ucp_tag_t tag)
     ucs_queue_iter_t iter;
     ucp_request_t *req;
 
-    if (ucs_unlikely(!ucs_queue_is_empty(&tm->expected.wildcard.queue))) {
+    if (ucs_unlikely(!ucs_queue_is_empty(&tm->expected.wildcard.queue) ||
+                     (tm->expected.num_mask_classes > 0))) {
         req_queue = ucp_tag_exp_get_queue_for_tag(tm, tag);
         return ucp_tag_exp_search_all(tm, req_queue, tag);
     }
 
-    /* fast path - wildcard queue is empty, search only the specific queue */
+    /* fast path - there are no requests with a partial mask, search only the
+     * specific queue */
     req_queue = ucp_tag_exp_get_queue_for_tag(tm, tag);
     ucs_queue_for_each_safe(req, iter, &req_queue->queue, recv.queue) {
         req = ucs_container_of(*iter, ucp_request_t, recv.queue);
@@ -134,14 +221,17 @@ static UCS_F_ALWAYS_INLINE ucp_tag_t ucp_rdesc_get_tag(ucp_recv_desc_t *rdesc)
 static UCS_F_ALWAYS_INLINE ucs_list_link_t*
 ucp_tag_unexp_get_list_for_tag(ucp_tag_match_t *tm, ucp_tag_t tag)
 {
-    return &tm->unexpected.hash[ucp_tag_match_calc_hash(tag)];
+    return &tm->unexpected.hash[ucp_tag_match_calc_hash(tag) &
+                                tm->unexpected.hash_mask];
 }
 
 static UCS_F_ALWAYS_INLINE void
-ucp_tag_unexp_remove(ucp_recv_desc_t *rdesc)
+ucp_tag_unexp_remove(ucp_tag_match_t *tm, ucp_recv_desc_t *rdesc)
 {
     ucs_list_del(&rdesc->tag_list[UCP_RDESC_HASH_LIST]);
     ucs_list_del(&rdesc->tag_list[UCP_RDESC_ALL_LIST] );
+    ucs_assert(tm->unexpected.count > 0);
+    --tm->unexpected.count;
 }
 
 static UCS_F_ALWAYS_INLINE void
@@ -155,6 +245,11 @@ ucp_tag_unexp_recv(ucp_tag_match_t *tm, ucp_recv_desc_t *rdesc, ucp_tag_t tag)
 
     ucs_trace_req("unexp "UCP_RECV_DESC_FMT" tag %"PRIx64,
                   UCP_RECV_DESC_ARG(rdesc), tag);
+
+    if (ucp_tag_match_hash_is_full(++tm->unexpected.count,
+                                   tm->unexpected.hash_mask)) {
+        ucp_tag_unexp_hash_grow(tm);
+    }
 }
 
 static UCS_F_ALWAYS_INLINE ucp_recv_desc_t*
@@ -202,7 +297,7 @@ ucp_tag_unexp_search(ucp_tag_match_t *tm, ucp_tag_t tag, uint64_t tag_mask,
                           "%s tag %"PRIx64"/%"PRIx64, UCP_RECV_DESC_ARG(rdesc),
                           title, tag, tag_mask);
             if (remove) {
-                ucp_tag_unexp_remove(rdesc);
+                ucp_tag_unexp_remove(tm, rdesc);
             }
             return rdesc;
         }
@@ -111,7 +111,7 @@ ucp_tag_recv_common(ucp_worker_h worker, void *buffer, size_t count,
     if (ucs_unlikely(rdesc == NULL)) {
         /* If not found on unexpected, wait until it arrives.
          * If was found but need this receive request for later completion, save it */
-        req_queue = ucp_tag_exp_get_queue(&worker->tm, tag, tag_mask);
+        req_queue = ucp_tag_exp_get_post_queue(&worker->tm, tag, tag_mask);
 
         /* If offload supported, post this tag to transport as well.
          * TODO: need to distinguish the cases when posting is not needed. */
@@ -167,6 +167,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_tag_recv_nbr,
                                     return UCS_ERR_INVALID_PARAM);
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
 
+    UCP_REQUEST_STATS_START(req, worker);
     rdesc = ucp_tag_unexp_search(&worker->tm, tag, tag_mask, 1, "recv_nbr");
     ucp_tag_recv_common(worker, buffer, count, datatype, tag, tag_mask,
                         req, UCP_REQUEST_DEBUG_FLAG_EXTERNAL, NULL, rdesc,
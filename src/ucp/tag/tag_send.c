@@ -36,6 +36,16 @@ ucp_tag_get_rndv_threshold(const ucp_request_t *req, size_t count,
         /* Fall through */
     case UCP_DATATYPE_CONTIG:
         return ucs_min(rndv_rma_thresh, rndv_am_thresh);
+    case UCP_DATATYPE_STRIDED:
+        if ((ucp_dt_strided_iov_count(ucp_dt_strided(req->send.datatype), 0,
+                                      req->send.length) > max_iov) &&
+            ucp_ep_is_tag_offload_enabled(ucp_ep_config(req->send.ep))) {
+            /* Same as IOV, tag offload does not support multi-packet eager */
+            return 1;
+        }
+        /* The sender buffer is not contiguous, so RMA rendezvous is not
+         * possible */
+        return rndv_am_thresh;
     case UCP_DATATYPE_GENERIC:
         return rndv_am_thresh;
     default:
@@ -253,6 +263,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_tag_send_nbr,
         return status;
     }
 
+    UCP_REQUEST_STATS_START(req, ep->worker);
     ucp_tag_send_req_init(req, ep, buffer, datatype, count, tag, 0);
 
     ret = ucp_tag_send_req(req, count, &ucp_ep_config(ep)->tag.eager,
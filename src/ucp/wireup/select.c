@@ -1169,7 +1169,8 @@ ucp_wireup_add_rma_bw_lanes(const ucp_wireup_select_params_t *select_params,
     if (ep_init_flags & UCP_EP_INIT_FLAG_MEM_TYPE) {
         bw_info.criteria.remote_md_flags = 0;
         bw_info.criteria.local_md_flags  = 0;
-    } else if (ucp_ep_get_context_features(ep) & UCP_FEATURE_TAG) {
+    } else if (ucp_ep_get_context_features(ep) &
+               (UCP_FEATURE_TAG | UCP_FEATURE_AM)) {
         /* if needed for RNDV, need only access for remote registered memory */
         bw_info.criteria.remote_md_flags = UCT_MD_FLAG_REG;
         bw_info.criteria.local_md_flags  = UCT_MD_FLAG_REG;
@@ -1254,8 +1255,8 @@ ucp_wireup_add_tag_lane(const ucp_wireup_select_params_t *select_params,
     ucs_status_t status;
 
     if (!(ucp_ep_get_context_features(ep) & UCP_FEATURE_TAG) ||
-        /* TODO: remove check below when UCP_ERR_HANDLING_MODE_PEER supports
-         *       RNDV-protocol or HW TM supports fragmented protocols
+        /* TODO: remove check below when HW TM supports fragmented protocols
+         *       and offloaded rendezvous is cleaned up on peer failure
          */
         (err_mode != UCP_ERR_HANDLING_MODE_NONE)) {
         return UCS_OK;
@@ -13,6 +13,8 @@
 #include <ucs/sys/sys.h>
 #include <ucs/sys/string.h>
 
+#include <immintrin.h>
+
 #define X86_CPUID_GENUINEINTEL    "GenuntelineI" /* GenuineIntel in magic notation */
 #define X86_CPUID_AUTHENTICAMD    "AuthcAMDenti" /* AuthenticAMD in magic notation */
 #define X86_CPUID_GET_MODEL       0x00000001u
@@ -27,6 +29,9 @@
 #define X86_CPU_CACHE_TAG_L1_ONLY 0x40
 #define X86_CPU_CACHE_TAG_LEAF4   0xff
 
+/* Number of vectors copied by a single iteration of non-temporal memcpy */
+#define X86_MEMCPY_NT_UNROLL      4
+
 
 typedef enum ucs_x86_cpu_cache_type {
     X86_CPU_CACHE_TYPE_DATA        = 1,
@@ -67,6 +72,13 @@ typedef union ucs_x86_cache_line_reg_info {
     };
 } UCS_S_PACKED ucs_x86_cache_line_reg_info_t;
 
+/* memcpy with non-temporal stores */
+typedef struct ucs_x86_memcpy_nt_engine {
+    const char     *name;
+    ucs_cpu_flag_t cpu_flag;  /* Required CPU flag */
+    void           (*func)(void *dst, const void *src, size_t len);
+} ucs_x86_memcpy_nt_engine_t;
+
 typedef union ucs_x86_cpu_registers {
     struct {
         union {
@@ -429,6 +441,13 @@ int ucs_arch_get_cpu_flag()
             if ((result & UCS_CPU_FLAG_AVX) && (_ebx & (1 << 5))) {
                 result |= UCS_CPU_FLAG_AVX2;
             }
+            if ((result & UCS_CPU_FLAG_AVX) && (_ebx & (1 << 16))) {
+                /* OS must save the opmask and ZMM registers */
+                ucs_x86_xgetbv(0, _eax, _edx);
+                if ((_eax & 0xe6) == 0xe6) {
+                    result |= UCS_CPU_FLAG_AVX512F;
+                }
+            }
         }
         cpu_flag = result;
     }
@@ -452,6 +471,111 @@ ucs_cpu_vendor_t ucs_arch_get_cpu_vendor()
     return UCS_CPU_VENDOR_UNKNOWN;
 }
 
+/*
+ * Copy the unaligned head with regular stores, so that the destination of the
+ * non-temporal stores is aligned to the vector size. Called for lengths which
+ * are much larger than the vector size.
+ */
+#define UCS_X86_MEMCPY_NT(_vec_type, _load, _stream, _dst, _src, _len) \
+    { \
+        size_t head = ucs_padding((uintptr_t)(_dst), sizeof(_vec_type)); \
+        const _vec_type *s; \
+        _vec_type *d; \
+        _vec_type v0, v1, v2, v3; \
+        \
+        memcpy(_dst, _src, head); \
+        d     = (_vec_type*)UCS_PTR_BYTE_OFFSET(_dst, head); \
+        s     = (const _vec_type*)UCS_PTR_BYTE_OFFSET(_src, head); \
+        _len -= head; \
+        \
+        for (; _len >= (X86_MEMCPY_NT_UNROLL * sizeof(_vec_type)); \
+             _len -= X86_MEMCPY_NT_UNROLL * sizeof(_vec_type)) { \
+            v0 = _load(s + 0); \
+            v1 = _load(s + 1); \
+            v2 = _load(s + 2); \
+            v3 = _load(s + 3); \
+            _stream(d + 0, v0); \
+            _stream(d + 1, v1); \
+            _stream(d + 2, v2); \
+            _stream(d + 3, v3); \
+            s += X86_MEMCPY_NT_UNROLL; \
+            d += X86_MEMCPY_NT_UNROLL; \
+        } \
+        \
+        /* Non-temporal stores are weakly ordered */ \
+        ucs_memory_bus_store_fence(); \
+        memcpy(d, s, _len); \
+    }
+
+static void ucs_x86_memcpy_nt_sse2(void *dst, const void *src, size_t len)
+{
+    UCS_X86_MEMCPY_NT(__m128i, _mm_loadu_si128, _mm_stream_si128, dst, src,
+                      len);
+}
+
+static void __attribute__((target("avx2")))
+ucs_x86_memcpy_nt_avx2(void *dst, const void *src, size_t len)
+{
+    UCS_X86_MEMCPY_NT(__m256i, _mm256_loadu_si256, _mm256_stream_si256, dst,
+                      src, len);
+}
+
+static void __attribute__((target("avx512f")))
+ucs_x86_memcpy_nt_avx512(void *dst, const void *src, size_t len)
+{
+    UCS_X86_MEMCPY_NT(__m512i, _mm512_loadu_si512, _mm512_stream_si512, dst,
+                      src, len);
+}
+
+/* Ordered from the most preferred */
+static const ucs_x86_memcpy_nt_engine_t ucs_x86_memcpy_nt_engines[] = {
+    {"avx512", UCS_CPU_FLAG_AVX512F, ucs_x86_memcpy_nt_avx512},
+    {"avx2",   UCS_CPU_FLAG_AVX2,    ucs_x86_memcpy_nt_avx2},
+    {"sse2",   UCS_CPU_FLAG_SSE2,    ucs_x86_memcpy_nt_sse2}
+};
+
+/* SSE2 is always supported on x86_64 */
+static const ucs_x86_memcpy_nt_engine_t *ucs_x86_memcpy_nt_engine =
+        &ucs_x86_memcpy_nt_engines[ucs_array_size(ucs_x86_memcpy_nt_engines) - 1];
+
+void ucs_x86_memcpy_nt(void *dst, const void *src, size_t len)
+{
+    ucs_x86_memcpy_nt_engine->func(dst, src, len);
+}
+
+const char *ucs_x86_memcpy_nt_name()
+{
+    return ucs_x86_memcpy_nt_engine->name;
+}
+
+static void ucs_x86_memcpy_nt_init()
+{
+    int cpu_flag = ucs_arch_get_cpu_flag();
+    size_t llc_size;
+    unsigned i;
+
+    for (i = 0; i < ucs_array_size(ucs_x86_memcpy_nt_engines); ++i) {
+        if (cpu_flag & ucs_x86_memcpy_nt_engines[i].cpu_flag) {
+            ucs_x86_memcpy_nt_engine = &ucs_x86_memcpy_nt_engines[i];
+            break;
+        }
+    }
+
+    if (ucs_global_opts.arch.nt_memcpy_thresh != UCS_MEMUNITS_AUTO) {
+        return;
+    }
+
+    /* Larger copies would evict most of the application data from the last
+     * level cache anyway */
+    llc_size = ucs_cpu_get_cache_size(UCS_CPU_CACHE_L3);
+    if (llc_size == 0) {
+        llc_size = ucs_cpu_get_cache_size(UCS_CPU_CACHE_L2);
+    }
+
+    ucs_global_opts.arch.nt_memcpy_thresh = (llc_size != 0) ? (llc_size / 2) :
+                                            UCS_MEMUNITS_INF;
+}
+
 #if ENABLE_BUILTIN_MEMCPY
 static size_t ucs_cpu_memcpy_thresh(size_t user_val, size_t auto_val)
 {
@@ -471,6 +595,8 @@ static size_t ucs_cpu_memcpy_thresh(size_t user_val, size_t auto_val)
 
 void ucs_cpu_init()
 {
+    ucs_x86_memcpy_nt_init();
+
 #if ENABLE_BUILTIN_MEMCPY
     ucs_global_opts.arch.builtin_memcpy_min =
         ucs_cpu_memcpy_thresh(ucs_global_opts.arch.builtin_memcpy_min,
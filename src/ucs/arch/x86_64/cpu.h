@@ -52,6 +52,8 @@ ucs_cpu_flag_t ucs_arch_get_cpu_flag() UCS_F_NOOPTIMIZE;
 ucs_cpu_vendor_t ucs_arch_get_cpu_vendor();
 void ucs_cpu_init();
 ucs_status_t ucs_arch_get_cache_size(size_t *cache_sizes);
+void ucs_x86_memcpy_nt(void *dst, const void *src, size_t len);
+const char *ucs_x86_memcpy_nt_name();
 
 static inline int ucs_arch_x86_rdtsc_enabled()
 {
@@ -92,6 +94,11 @@ static inline void ucs_arch_clear_cache(void *start, void *end)
 
 static inline void *ucs_memcpy_relaxed(void *dst, const void *src, size_t len)
 {
+    if (ucs_unlikely(len >= ucs_global_opts.arch.nt_memcpy_thresh)) {
+        ucs_x86_memcpy_nt(dst, src, len);
+        return dst;
+    }
+
 #if ENABLE_BUILTIN_MEMCPY
     if (ucs_unlikely((len > ucs_global_opts.arch.builtin_memcpy_min) &&
                      (len < ucs_global_opts.arch.builtin_memcpy_max))) {
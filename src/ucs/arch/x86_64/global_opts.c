@@ -11,6 +11,7 @@
 #endif
 
 #include <ucs/arch/global_opts.h>
+#include <ucs/arch/cpu.h>
 #include <ucs/config/parser.h>
 
 ucs_config_field_t ucs_arch_global_opts_table[] = {
@@ -23,12 +24,20 @@ ucs_config_field_t ucs_arch_global_opts_table[] = {
    "Maximal threshold of buffer length for using built-in memcpy.",
    ucs_offsetof(ucs_arch_global_opts_t, builtin_memcpy_max), UCS_CONFIG_TYPE_MEMUNITS},
 #endif
+
+  {"NT_MEMCPY_THRESH", "auto",
+   "Minimal threshold of buffer length for using memcpy with non-temporal stores,\n"
+   "which bypass the CPU cache and do not evict the application data from it.\n"
+   "\"auto\" selects half of the last level cache size.",
+   ucs_offsetof(ucs_arch_global_opts_t, nt_memcpy_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {NULL}
 };
 
 
 void ucs_arch_print_memcpy_limits(ucs_arch_global_opts_t *config)
 {
+    char nt_thresh_str[32];
 #if ENABLE_BUILTIN_MEMCPY
     char min_thresh_str[32];
     char max_thresh_str[32];
@@ -39,6 +48,11 @@ void ucs_arch_print_memcpy_limits(ucs_arch_global_opts_t *config)
                                 &config->builtin_memcpy_max, NULL);
     printf("# Using built-in memcpy() for size %s..%s\n", min_thresh_str, max_thresh_str);
 #endif
+
+    ucs_config_sprintf_memunits(nt_thresh_str, sizeof(nt_thresh_str),
+                                &config->nt_memcpy_thresh, NULL);
+    printf("# Using %s non-temporal memcpy() for size %s and above\n",
+           ucs_x86_memcpy_nt_name(), nt_thresh_str);
 }
 
 #endif
@@ -92,15 +92,13 @@ static void ucs_async_thread_ev_handler(void *callback_data, int event,
 static void *ucs_async_thread_func(void *arg)
 {
     ucs_async_thread_t *thread = arg;
-    ucs_time_t last_time, curr_time, timer_interval, time_spent;
+    ucs_time_t curr_time, next_expiration;
     int is_missed, timeout_ms;
     ucs_status_t status;
     unsigned num_events;
     ucs_async_thread_callback_arg_t cb_arg;
 
     is_missed        = 0;
-    curr_time        = ucs_get_time();
-    last_time        = ucs_get_time();
     cb_arg.thread    = thread;
     cb_arg.is_missed = &is_missed;
 
@@ -114,14 +112,15 @@ static void *ucs_async_thread_func(void *arg)
             is_missed = 0;
         }
 
-        /* Wait until the remainder of current period */
-        timer_interval = ucs_timerq_min_interval(&thread->timerq);
-        if (timer_interval == UCS_TIME_INFINITY) {
+        /* Sleep until the next timer expires. Adding or removing a timer
+         * wakes up the thread, so the deadline is re-evaluated. */
+        next_expiration = ucs_timerq_next_expiration(&thread->timerq);
+        if (next_expiration == UCS_TIME_INFINITY) {
             timeout_ms = -1;
         } else {
-            time_spent = curr_time - last_time;
-            timeout_ms = ucs_time_to_msec(timer_interval -
-                                          ucs_min(time_spent, timer_interval));
+            curr_time  = ucs_get_time();
+            timeout_ms = (next_expiration <= curr_time) ? 0 :
+                         (int)ceil(ucs_time_to_msec(next_expiration - curr_time));
         }
 
         status = ucs_event_set_wait(thread->event_set,
@@ -134,13 +133,11 @@ static void *ucs_async_thread_func(void *arg)
 
         /* Check timers */
         curr_time = ucs_get_time();
-        if (curr_time - last_time > timer_interval) {
+        if (curr_time >= next_expiration) {
             status = ucs_async_dispatch_timerq(&thread->timerq, curr_time);
             if (status == UCS_ERR_NO_PROGRESS) {
                  is_missed = 1;
             }
-
-            last_time = curr_time;
         }
     }
 
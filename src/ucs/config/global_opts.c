@@ -45,6 +45,7 @@ ucs_global_opts_t ucs_global_opts = {
     .stats_filter          = { NULL, 0 },
     .stats_format          = UCS_STATS_FULL,
     .rcache_check_pfn      = 0,
+    .rcache_thread_cache   = 1,
     .module_dir            = UCX_MODULE_DIR, /* defined in Makefile.am */
     .module_log_level      = UCS_LOG_LEVEL_TRACE,
     .arch                  = UCS_ARCH_GLOBAL_OPTS_INITALIZER
@@ -194,8 +195,11 @@ static ucs_config_field_t ucs_global_opts_table[] = {
 
   {"PROFILE_MODE", "",
    "Profile collection modes. If none is specified, profiling is disabled.\n"
-   " - log   - Record all timestamps.\n"
-   " - accum - Accumulate measurements per location.\n",
+   " - log    - Record all timestamps.\n"
+   " - stream - Record all timestamps, and write them to the profiling file\n"
+   "            in the background while the program is running. Memory usage\n"
+   "            is bounded by PROFILE_LOG_SIZE per thread.\n"
+   " - accum  - Accumulate measurements per location.\n",
    ucs_offsetof(ucs_global_opts_t, profile_mode),
    UCS_CONFIG_TYPE_BITMAP(ucs_profile_mode_names)},
 
@@ -205,7 +209,9 @@ static ucs_config_field_t ucs_global_opts_table[] = {
    ucs_offsetof(ucs_global_opts_t, profile_file), UCS_CONFIG_TYPE_STRING},
 
   {"PROFILE_LOG_SIZE", "4m",
-   "Maximal size of profiling log. New records will replace old records.",
+   "Maximal size of profiling log. New records will replace old records.\n"
+   "In stream mode, this is the size of the per-thread buffer of records which\n"
+   "were not written to the file yet.",
    ucs_offsetof(ucs_global_opts_t, profile_log_size), UCS_CONFIG_TYPE_MEMUNITS},
 
   {"RCACHE_CHECK_PFN", "n",
@@ -213,6 +219,12 @@ static ucs_config_field_t ucs_global_opts_table[] = {
    "memory region was not changed since the time the region was registered.\n",
    ucs_offsetof(ucs_global_opts_t, rcache_check_pfn), UCS_CONFIG_TYPE_BOOL},
 
+  {"RCACHE_THREAD_CACHE", "y",
+   "Registration cache to remember the last found memory region in every thread,\n"
+   "and find it again without taking the cache lock, as long as no region was\n"
+   "removed from the cache since.\n",
+   ucs_offsetof(ucs_global_opts_t, rcache_thread_cache), UCS_CONFIG_TYPE_BOOL},
+
   {"MODULE_DIR", UCX_MODULE_DIR,
    "Directory to search for loadable modules",
    ucs_offsetof(ucs_global_opts_t, module_dir), UCS_CONFIG_TYPE_STRING},
@@ -112,6 +112,9 @@ typedef struct {
     /* registration cache checks if physical page is not moved */
     int                      rcache_check_pfn;
 
+    /* registration cache keeps the last found region per thread */
+    int                      rcache_thread_cache;
+
     /* directory for loadable modules */
     char                     *module_dir;
 
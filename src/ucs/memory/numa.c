@@ -8,6 +8,8 @@
 
 #include <ucs/debug/assert.h>
 #include <ucs/debug/log.h>
+#include <ucs/sys/math.h>
+#include <ucs/sys/sys.h>
 #include <stdint.h>
 #include <sched.h>
 
@@ -67,4 +69,50 @@ int ucs_numa_node_of_cpu(int cpu)
     return cpu_numa_nodes[cpu] - 1;
 }
 
+
+ucs_status_t ucs_numa_set_preferred_node(void *address, size_t length,
+                                         int numa_node)
+{
+    struct bitmask *nodemask;
+    uintptr_t start, end;
+    ucs_status_t status;
+    int ret;
+
+    if ((numa_node < 0) || (numa_node > numa_max_node())) {
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    nodemask = numa_allocate_nodemask();
+    if (nodemask == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    numa_bitmask_clearall(nodemask);
+    numa_bitmask_setbit(nodemask, numa_node);
+
+    start = ucs_align_down_pow2((uintptr_t)address, ucs_get_page_size());
+    end   = ucs_align_up_pow2((uintptr_t)address + length, ucs_get_page_size());
+    ret   = mbind((void*)start, end - start, MPOL_PREFERRED,
+                  numa_nodemask_p(nodemask), numa_nodemask_size(nodemask),
+                  MPOL_MF_MOVE);
+    if (ret < 0) {
+        ucs_debug("mbind(addr=0x%lx length=%ld node=%d) failed: %m", start,
+                  end - start, numa_node);
+        status = UCS_ERR_IO_ERROR;
+    } else {
+        status = UCS_OK;
+    }
+
+    numa_free_nodemask(nodemask);
+    return status;
+}
+
+#else
+
+ucs_status_t ucs_numa_set_preferred_node(void *address, size_t length,
+                                         int numa_node)
+{
+    return UCS_ERR_UNSUPPORTED;
+}
+
 #endif
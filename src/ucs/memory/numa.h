@@ -12,6 +12,8 @@
 #endif
 
 #include <ucs/debug/memtrack.h>
+#include <ucs/type/status.h>
+#include <stddef.h>
 
 #if HAVE_NUMA
 #include <numaif.h>
@@ -62,4 +64,19 @@ extern const char *ucs_numa_policy_names[];
 int ucs_numa_node_of_cpu(int cpu);
 
 
+/**
+ * Set the memory policy of an address range to prefer a NUMA node, and move
+ * the pages which were already allocated to that node.
+ *
+ * @param [in] address    Start of the range, rounded down to a page boundary.
+ * @param [in] length     Length of the range.
+ * @param [in] numa_node  NUMA node to prefer.
+ *
+ * @return UCS_OK, UCS_ERR_UNSUPPORTED if NUMA support is not compiled in, or
+ *         UCS_ERR_IO_ERROR if the policy could not be set.
+ */
+ucs_status_t ucs_numa_set_preferred_node(void *address, size_t length,
+                                         int numa_node);
+
+
 #endif
@@ -6,6 +6,7 @@
 
 
 #include <ucs/arch/atomic.h>
+#include <ucs/arch/cpu.h>
 #include <ucs/type/class.h>
 #include <ucs/datastruct/queue.h>
 #include <ucs/debug/log.h>
@@ -14,6 +15,7 @@
 #include <ucs/stats/stats.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/sys.h>
+#include <ucs/time/time.h>
 #include <ucs/type/spinlock.h>
 #include <ucm/api/ucm.h>
 
@@ -48,10 +50,33 @@ typedef struct ucs_rcache_inv_entry {
 } ucs_rcache_inv_entry_t;
 
 
+/*
+ * Per-thread cache of the last found region. It is used to find the region
+ * again without taking the rcache lock, as long as no region was removed from
+ * the page table since (so the cached region is still there).
+ * The region memory is not released while a thread publishes it as a hazard,
+ * and a region is held only if its reference count is not zero.
+ */
+typedef struct ucs_rcache_thread {
+    ucs_list_link_t          list;       /* Entry in rcache->threads */
+    ucs_rcache_t             *rcache;    /* Registration cache */
+    ucs_rcache_region_t      *region;    /* Last found region */
+    uint64_t                 generation; /* rcache generation when the region
+                                            was found */
+    volatile uint64_t        hazard;     /* Address of the region being held */
+} ucs_rcache_thread_t;
+
+
 #if ENABLE_STATS
+static const char *ucs_rcache_histogram_names[] = {
+    [UCS_RCACHE_HIST_MISS_TIME]         = "miss_time_ns"
+};
+
 static ucs_stats_class_t ucs_rcache_stats_class = {
     .name = "rcache",
     .num_counters = UCS_RCACHE_STAT_LAST,
+    .num_histograms = UCS_RCACHE_HIST_LAST,
+    .histogram_names = ucs_rcache_histogram_names,
     .counter_names = {
         [UCS_RCACHE_GETS]               = "gets",
         [UCS_RCACHE_HITS_FAST]          = "hits_fast",
@@ -63,6 +88,7 @@ static ucs_stats_class_t ucs_rcache_stats_class = {
         [UCS_RCACHE_PUTS]               = "puts",
         [UCS_RCACHE_REGS]               = "mem_regs",
         [UCS_RCACHE_DEREGS]             = "mem_deregs",
+        [UCS_RCACHE_EVICTS]             = "regions_evicted",
     }
 };
 #endif
@@ -197,6 +223,142 @@ static void ucs_rcache_find_regions(ucs_rcache_t *rcache, ucs_pgt_addr_t from,
                              ucs_rcache_region_collect_callback, list);
 }
 
+static inline size_t ucs_rcache_region_size(ucs_rcache_region_t *region)
+{
+    return region->super.end - region->super.start;
+}
+
+/* Lock must be held in write mode */
+static void ucs_rcache_region_lru_add(ucs_rcache_t *rcache,
+                                      ucs_rcache_region_t *region)
+{
+    ucs_list_add_tail(&rcache->lru, &region->lru_list);
+    ++rcache->num_regions;
+    rcache->total_size += ucs_rcache_region_size(region);
+}
+
+/* Lock must be held in write mode */
+static void ucs_rcache_region_lru_remove(ucs_rcache_t *rcache,
+                                         ucs_rcache_region_t *region)
+{
+    ucs_list_del(&region->lru_list);
+
+    /* Invalidate the regions cached by threads */
+    ucs_atomic_add64(&rcache->generation, 1);
+
+    ucs_assert(rcache->num_regions > 0);
+    ucs_assert(rcache->total_size >= ucs_rcache_region_size(region));
+    --rcache->num_regions;
+    rcache->total_size -= ucs_rcache_region_size(region);
+}
+
+/* Mark the region as recently used. The LRU list is reordered lazily, during
+ * eviction, to avoid a shared lock on cache hits.
+ */
+static UCS_F_ALWAYS_INLINE void
+ucs_rcache_region_lru_touch(ucs_rcache_t *rcache, ucs_rcache_region_t *region)
+{
+    if (!region->lru_hit) {
+        region->lru_hit = 1;
+    }
+}
+
+static int ucs_rcache_region_is_hazard(ucs_rcache_t *rcache,
+                                       ucs_rcache_region_t *region)
+{
+    ucs_rcache_thread_t *thread;
+    int found = 0;
+
+    if (!rcache->thread_cache) {
+        return 0;
+    }
+
+    ucs_spin_lock(&rcache->threads_lock);
+    ucs_list_for_each(thread, &rcache->threads, list) {
+        if (thread->hazard == (uintptr_t)region) {
+            found = 1;
+            break;
+        }
+    }
+    ucs_spin_unlock(&rcache->threads_lock);
+
+    return found;
+}
+
+static void ucs_rcache_thread_cleanup(void *arg)
+{
+    ucs_rcache_thread_t *thread = arg;
+    ucs_rcache_t *rcache        = thread->rcache;
+
+    ucs_spin_lock(&rcache->threads_lock);
+    ucs_list_del(&thread->list);
+    ucs_spin_unlock(&rcache->threads_lock);
+    ucs_free(thread);
+}
+
+/* Remember the found region in the calling thread's cache.
+ * Lock must be held, at least for read
+ */
+static void ucs_rcache_thread_update(ucs_rcache_t *rcache,
+                                     ucs_rcache_region_t *region)
+{
+    ucs_rcache_thread_t *thread;
+    int ret;
+
+    if (!rcache->thread_cache) {
+        return;
+    }
+
+    thread = pthread_getspecific(rcache->thread_key);
+    if (ucs_unlikely(thread == NULL)) {
+        thread = ucs_calloc(1, sizeof(*thread), "rcache_thread");
+        if (thread == NULL) {
+            return;
+        }
+
+        ret = pthread_setspecific(rcache->thread_key, thread);
+        if (ret != 0) {
+            ucs_warn("%s: pthread_setspecific() failed: %s", rcache->name,
+                     strerror(ret));
+            ucs_free(thread);
+            return;
+        }
+
+        thread->rcache = rcache;
+        ucs_spin_lock(&rcache->threads_lock);
+        ucs_list_add_tail(&rcache->threads, &thread->list);
+        ucs_spin_unlock(&rcache->threads_lock);
+    }
+
+    thread->region     = region;
+    thread->generation = rcache->generation;
+}
+
+/* Increment the region reference count, unless it was already released */
+static UCS_F_ALWAYS_INLINE int
+ucs_rcache_region_try_hold(ucs_rcache_region_t *region)
+{
+    uint32_t refcount;
+
+    do {
+        refcount = region->refcount;
+        if (refcount == 0) {
+            return 0;
+        }
+    } while (ucs_atomic_cswap32(&region->refcount, refcount,
+                                refcount + 1) != refcount);
+
+    return 1;
+}
+
+static inline int ucs_rcache_is_over_limit(ucs_rcache_t *rcache,
+                                           unsigned long num_regions,
+                                           size_t total_size)
+{
+    return (num_regions > rcache->params.max_regions) ||
+           (total_size  > rcache->params.max_size);
+}
+
 /* Lock must be held in write mode */
 static void ucs_mem_region_destroy_internal(ucs_rcache_t *rcache,
                                             ucs_rcache_region_t *region)
@@ -213,7 +375,25 @@ static void ucs_mem_region_destroy_internal(ucs_rcache_t *rcache,
         }
     }
 
-    ucs_free(region);
+    if (ucs_rcache_region_is_hazard(rcache, region)) {
+        /* Some thread is checking the region now, release it later */
+        ucs_list_add_tail(&rcache->retired, &region->lru_list);
+    } else {
+        ucs_free(region);
+    }
+}
+
+/* Lock must be held in write mode */
+static void ucs_rcache_release_retired(ucs_rcache_t *rcache)
+{
+    ucs_rcache_region_t *region, *tmp;
+
+    ucs_list_for_each_safe(region, tmp, &rcache->retired, lru_list) {
+        if (!ucs_rcache_region_is_hazard(rcache, region)) {
+            ucs_list_del(&region->lru_list);
+            ucs_free(region);
+        }
+    }
 }
 
 static inline void ucs_rcache_region_put_internal(ucs_rcache_t *rcache,
@@ -255,6 +435,7 @@ static void ucs_rcache_region_invalidate(ucs_rcache_t *rcache,
                                    ucs_status_string(status));
         }
         region->flags &= ~UCS_RCACHE_REGION_FLAG_PGTABLE;
+        ucs_rcache_region_lru_remove(rcache, region);
     } else {
         ucs_assert(!must_be_in_pgt);
     }
@@ -360,6 +541,7 @@ static void ucs_rcache_purge(ucs_rcache_t *rcache)
     ucs_list_for_each_safe(region, tmp, &region_list, list) {
         if (region->flags & UCS_RCACHE_REGION_FLAG_PGTABLE) {
             region->flags &= ~UCS_RCACHE_REGION_FLAG_PGTABLE;
+            ucs_rcache_region_lru_remove(rcache, region);
             ucs_atomic_add32(&region->refcount, (uint32_t)-1);
         }
         if (region->refcount > 0) {
@@ -369,6 +551,39 @@ static void ucs_rcache_purge(ucs_rcache_t *rcache)
     }
 }
 
+/* Evict least recently used regions which are referenced only by the page
+ * table, until adding a new region of the given size would not exceed the
+ * cache limits. Regions which are in use are skipped.
+ * Lock must be held in write mode
+ */
+static void ucs_rcache_lru_evict(ucs_rcache_t *rcache, unsigned new_regions,
+                                 size_t new_size)
+{
+    unsigned long max_checks = 2 * rcache->num_regions;
+    ucs_rcache_region_t *region;
+
+    while (ucs_rcache_is_over_limit(rcache, rcache->num_regions + new_regions,
+                                    rcache->total_size + new_size) &&
+           (max_checks-- > 0)) {
+        region = ucs_list_head(&rcache->lru, ucs_rcache_region_t, lru_list);
+
+        /* Regions which were used since the last check get a second chance.
+         * A region may be held concurrently from a thread cache, so it is
+         * not necessarily destroyed here.
+         */
+        if ((region->refcount > 1) || region->lru_hit) {
+            region->lru_hit = 0;
+            ucs_list_del(&region->lru_list);
+            ucs_list_add_tail(&rcache->lru, &region->lru_list);
+            continue;
+        }
+
+        ucs_rcache_region_trace(rcache, region, "evict");
+        ucs_rcache_region_invalidate(rcache, region, 1, 0);
+        UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_EVICTS, 1);
+    }
+}
+
 static inline int ucs_rcache_region_test(ucs_rcache_region_t *region, int prot)
 {
     return (region->flags & UCS_RCACHE_REGION_FLAG_REGISTERED) &&
@@ -401,6 +616,7 @@ ucs_rcache_check_overlap(ucs_rcache_t *rcache, ucs_pgt_addr_t *start,
         {
             /* Found a region which contains the given address range */
             ucs_rcache_region_hold(rcache, region);
+            ucs_rcache_region_lru_touch(rcache, region);
             *region_p = region;
             return UCS_ERR_ALREADY_EXISTS;
         }
@@ -465,6 +681,7 @@ static ucs_status_t
 ucs_rcache_create_region(ucs_rcache_t *rcache, void *address, size_t length,
                          int prot, void *arg, ucs_rcache_region_t **region_p)
 {
+    ucs_time_t UCS_V_UNUSED start_time;
     ucs_rcache_region_t *region;
     ucs_pgt_addr_t start, end;
     ucs_status_t status;
@@ -473,6 +690,7 @@ ucs_rcache_create_region(ucs_rcache_t *rcache, void *address, size_t length,
     ucs_trace_func("rcache=%s, address=%p, length=%zu", rcache->name, address,
                    length);
 
+    UCS_STATS_START_TIME(start_time);
     pthread_rwlock_wrlock(&rcache->lock);
 
 retry:
@@ -502,6 +720,10 @@ retry:
         goto out_unlock;
     }
 
+    /* Make room for the new region */
+    ucs_rcache_lru_evict(rcache, 1, end - start);
+    ucs_rcache_release_retired(rcache);
+
     /* Allocate structure for new region */
     error = ucs_posix_memalign((void **)&region,
                                ucs_max(sizeof(void *), UCS_PGT_ENTRY_MIN_ALIGN),
@@ -525,6 +747,8 @@ retry:
         goto out_unlock;
     }
 
+    ucs_rcache_region_lru_add(rcache, region);
+
     /* If memory registration failed, keep the region and mark it as invalid,
      * to avoid numerous retries of registering the region.
      */
@@ -566,10 +790,15 @@ retry:
     }
 
     UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_MISSES, 1);
+    UCS_STATS_UPDATE_HISTOGRAM_TIME(rcache->stats, UCS_RCACHE_HIST_MISS_TIME,
+                                    start_time);
 
     ucs_rcache_region_trace(rcache, region, "created");
 
 out_set_region:
+    if (status == UCS_OK) {
+        ucs_rcache_thread_update(rcache, region);
+    }
     *region_p = region;
 out_unlock:
     pthread_rwlock_unlock(&rcache->lock);
@@ -582,6 +811,48 @@ void ucs_rcache_region_hold(ucs_rcache_t *rcache, ucs_rcache_region_t *region)
     ucs_rcache_region_trace(rcache, region, "hold");
 }
 
+/* Lookup the region in the calling thread's cache, without taking the lock */
+static UCS_F_ALWAYS_INLINE int
+ucs_rcache_thread_lookup(ucs_rcache_t *rcache, ucs_pgt_addr_t start,
+                         size_t length, int prot,
+                         ucs_rcache_region_t **region_p)
+{
+    ucs_rcache_thread_t *thread;
+    ucs_rcache_region_t *region;
+    int found;
+
+    thread = pthread_getspecific(rcache->thread_key);
+    if ((thread == NULL) || (thread->generation != rcache->generation)) {
+        return 0;
+    }
+
+    /* Publish the region before checking it's still in the page table, so its
+     * memory would not be released even if it's removed right after the check.
+     * The atomic swap also orders the following loads after the store.
+     */
+    region = thread->region;
+    ucs_atomic_swap64(&thread->hazard, (uintptr_t)region);
+
+    found = (thread->generation == rcache->generation) &&
+            ucs_queue_is_empty(&rcache->inv_q) &&
+            (start >= region->super.start) &&
+            ((start + length) <= region->super.end) &&
+            ucs_rcache_region_test(region, prot) &&
+            ucs_rcache_region_try_hold(region);
+
+    ucs_memory_cpu_fence();
+    thread->hazard = 0;
+
+    if (!found) {
+        return 0;
+    }
+
+    ucs_rcache_region_lru_touch(rcache, region);
+    ucs_rcache_region_trace(rcache, region, "thread hit");
+    *region_p = region;
+    return 1;
+}
+
 ucs_status_t ucs_rcache_get(ucs_rcache_t *rcache, void *address, size_t length,
                             int prot, void *arg, ucs_rcache_region_t **region_p)
 {
@@ -592,8 +863,16 @@ ucs_status_t ucs_rcache_get(ucs_rcache_t *rcache, void *address, size_t length,
     ucs_trace_func("rcache=%s, address=%p, length=%zu", rcache->name, address,
                    length);
 
-    pthread_rwlock_rdlock(&rcache->lock);
     UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_GETS, 1);
+
+    if (rcache->thread_cache &&
+        ucs_rcache_thread_lookup(rcache, start, length, prot, region_p)) {
+        ucs_rcache_region_validate_pfn(rcache, *region_p);
+        UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_HITS_FAST, 1);
+        return UCS_OK;
+    }
+
+    pthread_rwlock_rdlock(&rcache->lock);
     if (ucs_queue_is_empty(&rcache->inv_q)) {
         pgt_region = UCS_PROFILE_CALL(ucs_pgtable_lookup, &rcache->pgtable,
                                       start);
@@ -603,7 +882,9 @@ ucs_status_t ucs_rcache_get(ucs_rcache_t *rcache, void *address, size_t length,
                 ucs_rcache_region_test(region, prot))
             {
                 ucs_rcache_region_hold(rcache, region);
+                ucs_rcache_region_lru_touch(rcache, region);
                 ucs_rcache_region_validate_pfn(rcache, region);
+                ucs_rcache_thread_update(rcache, region);
                 *region_p = region;
                 UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_HITS_FAST, 1);
                 pthread_rwlock_unlock(&rcache->lock);
@@ -626,6 +907,16 @@ void ucs_rcache_region_put(ucs_rcache_t *rcache, ucs_rcache_region_t *region)
 {
     ucs_rcache_region_put_internal(rcache, region, 1, 0);
     UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_PUTS, 1);
+
+    /* The cache could exceed its limits if all regions were in use when a new
+     * one was added, so try to shrink it once a region becomes unused.
+     */
+    if (ucs_unlikely(ucs_rcache_is_over_limit(rcache, rcache->num_regions,
+                                              rcache->total_size))) {
+        pthread_rwlock_wrlock(&rcache->lock);
+        ucs_rcache_lru_evict(rcache, 0, 0);
+        pthread_rwlock_unlock(&rcache->lock);
+    }
 }
 
 static UCS_CLASS_INIT_FUNC(ucs_rcache_t, const ucs_rcache_params_t *params,
@@ -676,10 +967,25 @@ static UCS_CLASS_INIT_FUNC(ucs_rcache_t, const ucs_rcache_params_t *params,
         goto err_destroy_rwlock;
     }
 
+    status = ucs_spinlock_init(&self->threads_lock);
+    if (status != UCS_OK) {
+        goto err_destroy_inv_q_lock;
+    }
+
+    self->thread_cache = ucs_global_opts.rcache_thread_cache;
+    if (self->thread_cache) {
+        ret = pthread_key_create(&self->thread_key, ucs_rcache_thread_cleanup);
+        if (ret) {
+            ucs_error("pthread_key_create() failed: %s", strerror(ret));
+            status = UCS_ERR_NO_RESOURCE;
+            goto err_destroy_threads_lock;
+        }
+    }
+
     status = ucs_pgtable_init(&self->pgtable, ucs_rcache_pgt_dir_alloc,
                               ucs_rcache_pgt_dir_release);
     if (status != UCS_OK) {
-        goto err_destroy_inv_q_lock;
+        goto err_delete_thread_key;
     }
 
     status = ucs_mpool_init(&self->inv_mp, 0, sizeof(ucs_rcache_inv_entry_t), 0,
@@ -689,6 +995,12 @@ static UCS_CLASS_INIT_FUNC(ucs_rcache_t, const ucs_rcache_params_t *params,
     }
 
     ucs_queue_head_init(&self->inv_q);
+    ucs_list_head_init(&self->lru);
+    ucs_list_head_init(&self->threads);
+    ucs_list_head_init(&self->retired);
+    self->generation  = 0;
+    self->num_regions = 0;
+    self->total_size  = 0;
 
     status = ucm_set_event_handler(params->ucm_events, params->ucm_event_priority,
                                    ucs_rcache_unmapped_callback, self);
@@ -702,6 +1014,15 @@ err_destroy_mp:
     ucs_mpool_cleanup(&self->inv_mp, 1);
 err_cleanup_pgtable:
     ucs_pgtable_cleanup(&self->pgtable);
+err_delete_thread_key:
+    if (self->thread_cache) {
+        pthread_key_delete(self->thread_key);
+    }
+err_destroy_threads_lock:
+    spinlock_status = ucs_spinlock_destroy(&self->threads_lock);
+    if (spinlock_status != UCS_OK) {
+        ucs_warn("ucs_spinlock_destroy() failed (%d)", spinlock_status);
+    }
 err_destroy_inv_q_lock:
     spinlock_status = ucs_spinlock_destroy(&self->inv_lock);
     if (spinlock_status != UCS_OK) {
@@ -719,6 +1040,8 @@ err:
 
 static UCS_CLASS_CLEANUP_FUNC(ucs_rcache_t)
 {
+    ucs_rcache_thread_t *thread, *tmp_thread;
+    ucs_rcache_region_t *region, *tmp_region;
     ucs_status_t status;
 
     ucm_unset_event_handler(self->params.ucm_events, ucs_rcache_unmapped_callback,
@@ -728,6 +1051,23 @@ static UCS_CLASS_CLEANUP_FUNC(ucs_rcache_t)
 
     ucs_mpool_cleanup(&self->inv_mp, 1);
     ucs_pgtable_cleanup(&self->pgtable);
+    ucs_assert(ucs_list_is_empty(&self->lru));
+
+    ucs_list_for_each_safe(region, tmp_region, &self->retired, lru_list) {
+        ucs_free(region);
+    }
+
+    if (self->thread_cache) {
+        pthread_key_delete(self->thread_key);
+        ucs_list_for_each_safe(thread, tmp_thread, &self->threads, list) {
+            ucs_free(thread);
+        }
+    }
+
+    status = ucs_spinlock_destroy(&self->threads_lock);
+    if (status != UCS_OK) {
+        ucs_warn("ucs_spinlock_destroy() failed (%d)", status);
+    }
     status = ucs_spinlock_destroy(&self->inv_lock);
     if (status != UCS_OK) {
         ucs_warn("ucs_spinlock_destroy() failed (%d)", status);
@@ -22,10 +22,20 @@ enum {
     UCS_RCACHE_PUTS,                /* number of put operations */
     UCS_RCACHE_REGS,                /* number of memory registrations */
     UCS_RCACHE_DEREGS,              /* number of memory deregistrations */
+    UCS_RCACHE_EVICTS,              /* number of regions evicted because of
+                                       the cache size limits */
     UCS_RCACHE_STAT_LAST
 };
 
 
+/* The histograms of rcache */
+enum {
+    UCS_RCACHE_HIST_MISS_TIME,      /* time to handle a miss, including
+                                       memory registration, in nsec */
+    UCS_RCACHE_HIST_LAST
+};
+
+
 struct ucs_rcache {
     ucs_rcache_params_t    params;   /**< rcache parameters (immutable) */
     pthread_rwlock_t       lock;     /**< Protects the page table and all regions
@@ -42,6 +52,25 @@ struct ucs_rcache {
                                           since we cannot use regulat malloc().
                                           The backing storage is original mmap()
                                           which does not generate memory events */
+    ucs_list_link_t        lru;      /**< Regions in the page table, ordered from
+                                          least to most recently used. Regions
+                                          which were hit since they were added
+                                          to the tail are moved during eviction */
+    unsigned long          num_regions; /**< Number of regions in the page table */
+    size_t                 total_size;  /**< Total size of regions in the page table */
+
+    int                    thread_cache; /**< Whether per-thread region caches
+                                              are enabled */
+    pthread_key_t          thread_key;   /**< Key of the per-thread region cache */
+    ucs_spinlock_t         threads_lock; /**< Lock for the threads list */
+    ucs_list_link_t        threads;      /**< Per-thread region caches */
+    volatile uint64_t      generation;   /**< Incremented when a region is removed
+                                              from the page table, invalidates
+                                              the per-thread caches */
+    ucs_list_link_t        retired;      /**< Destroyed regions whose memory is
+                                              not released yet, because a thread
+                                              could be checking them */
+
     char                   *name;
     UCS_STATS_NODE_DECLARE(stats)
 };
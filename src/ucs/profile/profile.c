@@ -15,6 +15,17 @@
 #include <pthread.h>
 
 
+/* Number of chunks in the per-thread log buffer in stream mode */
+#define UCS_PROFILE_STREAM_NUM_CHUNKS      8
+
+/* How often the stream writer wakes up if it was not signaled */
+#define UCS_PROFILE_STREAM_FLUSH_INTERVAL  0.1
+
+/* Modes which record every event */
+#define UCS_PROFILE_LOG_MODES              (UCS_BIT(UCS_PROFILE_MODE_LOG) | \
+                                            UCS_BIT(UCS_PROFILE_MODE_STREAM))
+
+
 typedef struct ucs_profile_global_location {
     ucs_profile_location_t       super;      /*< Location info */
     volatile int                 *loc_id_p;  /*< Back-pointer to location index */
@@ -31,6 +42,15 @@ typedef struct ucs_profile_global_context {
     pthread_mutex_t               mutex;         /**< Protects updating the locations array */
     pthread_key_t                 tls_key;       /**< TLS key for per-thread context */
     ucs_list_link_t               thread_list;   /**< List of all thread contexts */
+
+    struct {
+        int                       fd;            /**< Stream file, -1 if closed */
+        unsigned                  num_locations; /**< Locations written to the file */
+        pthread_t                 writer;        /**< Background writer thread */
+        int                       writer_active; /**< Whether writer is running */
+        pthread_cond_t            cond;          /**< Signaled on a full chunk */
+        volatile int              stop;          /**< Stop the writer thread */
+    } stream;
 } ucs_profile_global_context_t;
 
 
@@ -44,12 +64,23 @@ typedef struct ucs_profile_thread_context {
     int                               is_completed;  /**< Set to 1 when thread exits */
 
     struct {
+        ucs_profile_record_t          *buffer;       /**< Allocated log memory */
         ucs_profile_record_t          *start;        /**< Circular log buffer start */
         ucs_profile_record_t          *end;          /**< Circular log buffer end */
         ucs_profile_record_t          *current;      /**< Current log pointer */
         int                           wraparound;    /**< Whether log was rotated */
     } log;
 
+    /* In stream mode, the log buffer is a ring of chunks: the thread fills the
+     * chunk at 'head', and the writer thread writes full chunks from 'tail' */
+    struct {
+        unsigned                      chunk_size;    /**< Records per chunk */
+        volatile uint64_t             head;          /**< Number of full chunks */
+        volatile uint64_t             tail;          /**< Number of written chunks */
+        uint64_t                      num_written;   /**< Records written to file */
+        uint64_t                      num_dropped;   /**< Records which were dropped */
+    } stream;
+
     struct {
         unsigned                      num_locations; /**< Number of valid locations */
         ucs_profile_thread_location_t *locations;    /**< Statistics per location */
@@ -67,9 +98,10 @@ typedef struct ucs_profile_thread_context {
 
 
 const char *ucs_profile_mode_names[] = {
-    [UCS_PROFILE_MODE_ACCUM] = "accum",
-    [UCS_PROFILE_MODE_LOG]   = "log",
-    [UCS_PROFILE_MODE_LAST]  = NULL
+    [UCS_PROFILE_MODE_ACCUM]  = "accum",
+    [UCS_PROFILE_MODE_LOG]    = "log",
+    [UCS_PROFILE_MODE_STREAM] = "stream",
+    [UCS_PROFILE_MODE_LAST]   = NULL
 };
 
 static ucs_profile_global_context_t ucs_profile_global_ctx = {
@@ -79,6 +111,11 @@ static ucs_profile_global_context_t ucs_profile_global_ctx = {
     .mutex         = PTHREAD_MUTEX_INITIALIZER,
     .thread_list   = UCS_LIST_INITIALIZER(&ucs_profile_global_ctx.thread_list,
                                           &ucs_profile_global_ctx.thread_list),
+    .stream        = {
+        .fd            = -1,
+        .writer_active = 0,
+        .cond          = PTHREAD_COND_INITIALIZER
+    }
 };
 
 static ucs_status_t ucs_profile_file_write_data(int fd, void *data, size_t size)
@@ -208,24 +245,12 @@ static ucs_status_t ucs_profile_write_locations(int fd)
     return UCS_OK;
 }
 
-static void ucs_profile_write()
+static int ucs_profile_file_open()
 {
-    ucs_profile_thread_context_t *ctx;
-    ucs_profile_header_t header;
     char fullpath[1024] = {0};
     char filename[1024] = {0};
-    ucs_time_t write_time;
-    ucs_status_t status;
     int fd;
 
-    if (!ucs_global_opts.profile_mode) {
-        return;
-    }
-
-    pthread_mutex_lock(&ucs_profile_global_ctx.mutex);
-
-    write_time = ucs_get_time();
-
     ucs_fill_filename_template(ucs_global_opts.profile_file,
                                filename, sizeof(filename));
     ucs_expand_path(filename, fullpath, sizeof(fullpath) - 1);
@@ -233,10 +258,16 @@ static void ucs_profile_write()
     fd = open(fullpath, O_WRONLY|O_CREAT|O_TRUNC, 0600);
     if (fd < 0) {
         ucs_error("failed to write profiling data to '%s': %m", fullpath);
-        goto out_unlock;
     }
 
-    /* write header */
+    return fd;
+}
+
+static ucs_status_t ucs_profile_file_write_header(int fd, unsigned num_locations,
+                                                  unsigned num_threads)
+{
+    ucs_profile_header_t header;
+
     memset(&header, 0, sizeof(header));
     ucs_read_file(header.cmdline, sizeof(header.cmdline), 1, "/proc/self/cmdline");
     strncpy(header.hostname, ucs_get_host_name(), sizeof(header.hostname) - 1);
@@ -244,10 +275,263 @@ static void ucs_profile_write()
     strncpy(header.ucs_path, ucs_debug_get_lib_path(), sizeof(header.ucs_path) - 1);
     header.pid           = getpid();
     header.mode          = ucs_global_opts.profile_mode;
-    header.num_locations = ucs_profile_global_ctx.num_locations;
-    header.num_threads   = ucs_list_length(&ucs_profile_global_ctx.thread_list);
+    header.num_locations = num_locations;
+    header.num_threads   = num_threads;
     header.one_second    = ucs_time_from_sec(1.0);
-    ucs_profile_file_write_data(fd, &header, sizeof(header));
+    return ucs_profile_file_write_data(fd, &header, sizeof(header));
+}
+
+/* Global lock must be held */
+static void ucs_profile_stream_write_data(void *data, size_t size)
+{
+    ucs_status_t status;
+
+    if (ucs_profile_global_ctx.stream.fd < 0) {
+        return;
+    }
+
+    status = ucs_profile_file_write_data(ucs_profile_global_ctx.stream.fd, data,
+                                         size);
+    if (status != UCS_OK) {
+        /* Stop streaming; threads keep recycling their chunks */
+        close(ucs_profile_global_ctx.stream.fd);
+        ucs_profile_global_ctx.stream.fd = -1;
+    }
+}
+
+/* Global lock must be held */
+static void ucs_profile_stream_write_chunk(ucs_profile_chunk_type_t type,
+                                           int tid, uint64_t count, void *data,
+                                           size_t size)
+{
+    ucs_profile_chunk_header_t chunk_hdr;
+
+    chunk_hdr.type  = type;
+    chunk_hdr.tid   = tid;
+    chunk_hdr.count = count;
+    ucs_profile_stream_write_data(&chunk_hdr, sizeof(chunk_hdr));
+    ucs_profile_stream_write_data(data, size);
+}
+
+/* Global lock must be held */
+static void ucs_profile_stream_write_locations()
+{
+    unsigned first = ucs_profile_global_ctx.stream.num_locations;
+    ucs_profile_global_location_t *loc;
+
+    if (first == ucs_profile_global_ctx.num_locations) {
+        return;
+    }
+
+    ucs_profile_stream_write_chunk(UCS_PROFILE_CHUNK_LOCATIONS, 0,
+                                   ucs_profile_global_ctx.num_locations - first,
+                                   NULL, 0);
+    for (loc = ucs_profile_global_ctx.locations + first;
+         loc < ucs_profile_global_ctx.locations +
+               ucs_profile_global_ctx.num_locations; ++loc) {
+        ucs_profile_stream_write_data(&loc->super, sizeof(loc->super));
+    }
+
+    ucs_profile_global_ctx.stream.num_locations =
+                    ucs_profile_global_ctx.num_locations;
+}
+
+/* Global lock must be held */
+static void ucs_profile_stream_write_records(ucs_profile_thread_context_t *ctx,
+                                             ucs_profile_record_t *begin,
+                                             ucs_profile_record_t *end)
+{
+    ucs_profile_stream_write_chunk(UCS_PROFILE_CHUNK_RECORDS, ctx->tid,
+                                   end - begin, begin,
+                                   UCS_PTR_BYTE_DIFF(begin, end));
+    ctx->stream.num_written += end - begin;
+}
+
+/*
+ * Write all full chunks to the file. If 'flush_all' is set, or the thread has
+ * exited, write also its partially filled chunk.
+ * Global lock must be held.
+ */
+static void ucs_profile_stream_flush(int flush_all)
+{
+    ucs_profile_thread_context_t *ctx;
+    ucs_profile_record_t *chunk;
+    uint64_t head;
+
+    /* Locations must precede the records which refer to them */
+    ucs_profile_stream_write_locations();
+
+    ucs_list_for_each(ctx, &ucs_profile_global_ctx.thread_list, list) {
+        head = ctx->stream.head;
+        ucs_memory_cpu_load_fence();
+
+        for (; ctx->stream.tail < head; ++ctx->stream.tail) {
+            chunk = ctx->log.buffer +
+                    ((ctx->stream.tail % UCS_PROFILE_STREAM_NUM_CHUNKS) *
+                     ctx->stream.chunk_size);
+            ucs_profile_stream_write_records(ctx, chunk,
+                                             chunk + ctx->stream.chunk_size);
+            /* Finish reading the chunk before the thread may reuse it */
+            ucs_memory_cpu_fence();
+        }
+
+        if ((flush_all || ctx->is_completed) &&
+            (ctx->log.current > ctx->log.start)) {
+            ucs_profile_stream_write_records(ctx, ctx->log.start,
+                                             ctx->log.current);
+            ctx->log.current = ctx->log.start;
+        }
+    }
+}
+
+/*
+ * Write summary of completed threads, or all threads if 'write_all' is set.
+ * Global lock must be held.
+ */
+static void ucs_profile_stream_write_threads(ucs_time_t default_end_time,
+                                             int write_all)
+{
+    ucs_profile_stream_thread_t thread_info;
+    ucs_profile_thread_context_t *ctx;
+    unsigned num_locations;
+
+    ucs_list_for_each(ctx, &ucs_profile_global_ctx.thread_list, list) {
+        if (!write_all && !ctx->is_completed) {
+            continue;
+        }
+
+        if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_ACCUM)) {
+            num_locations = ctx->accum.num_locations;
+        } else {
+            num_locations = 0;
+        }
+
+        thread_info.super.tid         = ctx->tid;
+        thread_info.super.start_time  = ctx->start_time;
+        thread_info.super.end_time    = ctx->is_completed ? ctx->end_time :
+                                        default_end_time;
+        thread_info.super.num_records = ctx->stream.num_written;
+        thread_info.num_dropped       = ctx->stream.num_dropped;
+
+        ucs_profile_stream_write_chunk(UCS_PROFILE_CHUNK_THREAD, ctx->tid,
+                                       num_locations, &thread_info,
+                                       sizeof(thread_info));
+        ucs_profile_stream_write_data(ctx->accum.locations,
+                                      num_locations *
+                                      sizeof(*ctx->accum.locations));
+    }
+}
+
+static void *ucs_profile_stream_writer_func(void *arg)
+{
+    struct timespec deadline;
+    double deadline_sec;
+
+    ucs_debug("profiling stream writer started");
+
+    pthread_mutex_lock(&ucs_profile_global_ctx.mutex);
+    while (!ucs_profile_global_ctx.stream.stop) {
+        ucs_profile_stream_flush(0);
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline_sec     = deadline.tv_sec + (deadline.tv_nsec * 1e-9) +
+                           UCS_PROFILE_STREAM_FLUSH_INTERVAL;
+        deadline.tv_sec  = (time_t)deadline_sec;
+        deadline.tv_nsec = (long)((deadline_sec - deadline.tv_sec) * 1e9);
+        pthread_cond_timedwait(&ucs_profile_global_ctx.stream.cond,
+                               &ucs_profile_global_ctx.mutex, &deadline);
+    }
+    pthread_mutex_unlock(&ucs_profile_global_ctx.mutex);
+
+    return NULL;
+}
+
+static void ucs_profile_stream_open()
+{
+    ucs_status_t status;
+    int fd, ret;
+
+    fd = ucs_profile_file_open();
+    if (fd < 0) {
+        return;
+    }
+
+    status = ucs_profile_file_write_header(fd, 0, 0);
+    if (status != UCS_OK) {
+        close(fd);
+        return;
+    }
+
+    pthread_mutex_lock(&ucs_profile_global_ctx.mutex);
+    ucs_profile_global_ctx.stream.fd            = fd;
+    ucs_profile_global_ctx.stream.num_locations = 0;
+    ucs_profile_global_ctx.stream.stop          = 0;
+    pthread_mutex_unlock(&ucs_profile_global_ctx.mutex);
+
+    ret = pthread_create(&ucs_profile_global_ctx.stream.writer, NULL,
+                         ucs_profile_stream_writer_func, NULL);
+    if (ret != 0) {
+        /* Records will be written only when profiling data is dumped */
+        ucs_warn("failed to create profiling writer thread: %s", strerror(ret));
+        return;
+    }
+
+    ucs_profile_global_ctx.stream.writer_active = 1;
+}
+
+static void ucs_profile_stream_close()
+{
+    if (ucs_profile_global_ctx.stream.writer_active) {
+        pthread_mutex_lock(&ucs_profile_global_ctx.mutex);
+        ucs_profile_global_ctx.stream.stop = 1;
+        pthread_cond_signal(&ucs_profile_global_ctx.stream.cond);
+        pthread_mutex_unlock(&ucs_profile_global_ctx.mutex);
+
+        pthread_join(ucs_profile_global_ctx.stream.writer, NULL);
+        ucs_profile_global_ctx.stream.writer_active = 0;
+    }
+
+    pthread_mutex_lock(&ucs_profile_global_ctx.mutex);
+    if (ucs_profile_global_ctx.stream.fd >= 0) {
+        /* Write whatever is left, assuming profiled threads are idle */
+        ucs_profile_stream_flush(1);
+        ucs_profile_stream_write_threads(ucs_get_time(), 1);
+        close(ucs_profile_global_ctx.stream.fd);
+        ucs_profile_global_ctx.stream.fd = -1;
+    }
+    pthread_mutex_unlock(&ucs_profile_global_ctx.mutex);
+}
+
+static void ucs_profile_write()
+{
+    ucs_profile_thread_context_t *ctx;
+    ucs_time_t write_time;
+    ucs_status_t status;
+    int fd;
+
+    if (!ucs_global_opts.profile_mode) {
+        return;
+    }
+
+    pthread_mutex_lock(&ucs_profile_global_ctx.mutex);
+
+    write_time = ucs_get_time();
+
+    if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM)) {
+        /* Flush the records of exited threads, which are about to be released */
+        ucs_profile_stream_flush(0);
+        ucs_profile_stream_write_threads(write_time, 0);
+        goto out_unlock;
+    }
+
+    fd = ucs_profile_file_open();
+    if (fd < 0) {
+        goto out_unlock;
+    }
+
+    /* write header */
+    ucs_profile_file_write_header(fd, ucs_profile_global_ctx.num_locations,
+                                  ucs_list_length(&ucs_profile_global_ctx.thread_list));
 
     /* write locations */
     status = ucs_profile_write_locations(fd);
@@ -285,26 +569,43 @@ ucs_profile_thread_context_t* ucs_profile_thread_init()
 
     ctx->tid        = ucs_get_tid();
     ctx->start_time = ucs_get_time();
-    ctx->end_time   = 0;
-    ctx->pthread_id = pthread_self();
+    ctx->end_time     = 0;
+    ctx->pthread_id   = pthread_self();
+    ctx->is_completed = 0;
 
     ucs_debug("profiling context %p: start on thread 0x%lx tid %d mode %d",
               ctx, (unsigned long)pthread_self(), ucs_get_tid(), 
               ucs_global_opts.profile_mode);
 
     /* Initialize log mode */
-    if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
+    if (ucs_global_opts.profile_mode & UCS_PROFILE_LOG_MODES) {
         num_records = ucs_global_opts.profile_log_size /
                       sizeof(ucs_profile_record_t);
-        ctx->log.start = ucs_calloc(num_records, sizeof(ucs_profile_record_t),
-                                    "profile_log");
-        if (ctx->log.start == NULL) {
+        if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM)) {
+            ctx->stream.chunk_size  = ucs_max(num_records /
+                                              UCS_PROFILE_STREAM_NUM_CHUNKS, 1);
+            ctx->stream.head        = 0;
+            ctx->stream.tail        = 0;
+            ctx->stream.num_written = 0;
+            ctx->stream.num_dropped = 0;
+            num_records             = ctx->stream.chunk_size *
+                                      UCS_PROFILE_STREAM_NUM_CHUNKS;
+        }
+
+        ctx->log.buffer = ucs_calloc(num_records, sizeof(ucs_profile_record_t),
+                                     "profile_log");
+        if (ctx->log.buffer == NULL) {
             ucs_fatal("failed to allocate profiling log");
         }
 
-        ctx->log.end        = ctx->log.start + num_records;
+        ctx->log.start      = ctx->log.buffer;
         ctx->log.current    = ctx->log.start;
         ctx->log.wraparound = 0;
+        if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM)) {
+            ctx->log.end    = ctx->log.start + ctx->stream.chunk_size;
+        } else {
+            ctx->log.end    = ctx->log.start + num_records;
+        }
     }
 
     /* Initialize accumulate mode */
@@ -327,8 +628,8 @@ static void ucs_profile_thread_cleanup(ucs_profile_thread_context_t *ctx)
 {
     ucs_debug("profiling context %p: cleanup", ctx);
 
-    if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
-        ucs_free(ctx->log.start);
+    if (ucs_global_opts.profile_mode & UCS_PROFILE_LOG_MODES) {
+        ucs_free(ctx->log.buffer);
     }
 
     if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_ACCUM)) {
@@ -344,6 +645,8 @@ static void ucs_profile_thread_finalize(ucs_profile_thread_context_t *ctx)
     ucs_debug("profiling context %p: completed", ctx);
 
     ctx->end_time     = ucs_get_time();
+    /* The stream writer may flush the log once the thread is completed */
+    ucs_memory_cpu_store_fence();
     ctx->is_completed = 1;
 }
 
@@ -462,6 +765,34 @@ static void ucs_profile_thread_expand_locations(int loc_id)
     ctx->accum.num_locations = new_num_locations;
 }
 
+/*
+ * Called when the current chunk is full in stream mode. Hands the chunk over to
+ * the writer thread and moves to the next one. If the writer did not release
+ * the next chunk yet, the current chunk is overwritten rather than waiting.
+ */
+static UCS_F_NOINLINE void
+ucs_profile_stream_next_chunk(ucs_profile_thread_context_t *ctx)
+{
+    uint64_t head = ctx->stream.head;
+
+    if ((head + 1 - ctx->stream.tail) >= UCS_PROFILE_STREAM_NUM_CHUNKS) {
+        ctx->stream.num_dropped += ctx->stream.chunk_size;
+        ctx->log.current         = ctx->log.start;
+        return;
+    }
+
+    /* Make the records visible before publishing the chunk */
+    ucs_memory_cpu_store_fence();
+    ctx->stream.head = ++head;
+    pthread_cond_signal(&ucs_profile_global_ctx.stream.cond);
+
+    ctx->log.start   = ctx->log.buffer +
+                       ((head % UCS_PROFILE_STREAM_NUM_CHUNKS) *
+                        ctx->stream.chunk_size);
+    ctx->log.end     = ctx->log.start + ctx->stream.chunk_size;
+    ctx->log.current = ctx->log.start;
+}
+
 void ucs_profile_record(ucs_profile_type_t type, const char *name,
                         uint32_t param32, uint64_t param64, const char *file,
                         int line, const char *function, volatile int *loc_id_p)
@@ -516,15 +847,19 @@ void ucs_profile_record(ucs_profile_type_t type, const char *name,
         ++loc->count;
     }
 
-    if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
+    if (ucs_global_opts.profile_mode & UCS_PROFILE_LOG_MODES) {
         rec              = ctx->log.current;
         rec->timestamp   = current_time;
         rec->param64     = param64;
         rec->param32     = param32;
         rec->location    = loc_id - 1;
         if (++ctx->log.current >= ctx->log.end) {
-            ctx->log.current    = ctx->log.start;
-            ctx->log.wraparound = 1;
+            if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM)) {
+                ucs_profile_stream_next_chunk(ctx);
+            } else {
+                ctx->log.current    = ctx->log.start;
+                ctx->log.wraparound = 1;
+            }
         }
     }
 }
@@ -599,11 +934,16 @@ void ucs_profile_global_init()
 
     pthread_key_create(&ucs_profile_global_ctx.tls_key,
                        ucs_profile_thread_key_destr);
+
+    if (ucs_global_opts.profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM)) {
+        ucs_profile_stream_open();
+    }
 }
 
 void ucs_profile_global_cleanup()
 {
     ucs_profile_dump();
+    ucs_profile_stream_close();
     ucs_profile_check_active_threads();
     pthread_key_delete(ucs_profile_global_ctx.tls_key);
 }
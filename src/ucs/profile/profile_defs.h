@@ -17,7 +17,7 @@ BEGIN_C_DECLS
 /** @file profile_defs.h */
 
 #define UCS_PROFILE_STACK_MAX     64
-#define UCS_PROFILE_FILE_VERSION  2u
+#define UCS_PROFILE_FILE_VERSION  3u
 
 
 /**
@@ -26,6 +26,7 @@ BEGIN_C_DECLS
 enum {
     UCS_PROFILE_MODE_ACCUM, /**< Accumulate elapsed time per location */
     UCS_PROFILE_MODE_LOG,   /**< Record all events */
+    UCS_PROFILE_MODE_STREAM,/**< Record all events and stream them to the file */
     UCS_PROFILE_MODE_LAST
 };
 
@@ -55,6 +56,21 @@ typedef enum {
  *    < ucs_profile_record_t > * ucs_profile_thread_header_t::num_records
  *
  * ] * ucs_profile_thread_header_t::num_threads
+ *
+ *
+ * In UCS_PROFILE_MODE_STREAM, the records are written while the program is
+ * running, so the file is a sequence of chunks following the header. Both
+ * ucs_profile_header_t::num_locations and ucs_profile_header_t::num_threads
+ * are 0, and the file may end at any chunk boundary:
+ *
+ * < ucs_profile_header_t >
+ * [
+ *    < ucs_profile_chunk_header_t >
+ *    < ucs_profile_location_t > * count           (UCS_PROFILE_CHUNK_LOCATIONS)
+ *    < ucs_profile_record_t > * count             (UCS_PROFILE_CHUNK_RECORDS)
+ *    < ucs_profile_stream_thread_t >
+ *    < ucs_profile_thread_location_t > * count    (UCS_PROFILE_CHUNK_THREAD)
+ * ] * N
  */
 
 
@@ -117,6 +133,38 @@ typedef struct ucs_profile_record {
 } UCS_S_PACKED ucs_profile_record_t;
 
 
+/**
+ * Profile stream chunk types
+ */
+typedef enum {
+    UCS_PROFILE_CHUNK_LOCATIONS,    /**< Newly added locations */
+    UCS_PROFILE_CHUNK_RECORDS,      /**< Records of a single thread */
+    UCS_PROFILE_CHUNK_THREAD,       /**< Thread summary, written when it's dumped */
+    UCS_PROFILE_CHUNK_LAST
+} ucs_profile_chunk_type_t;
+
+
+/**
+ * Profile stream chunk header
+ */
+typedef struct ucs_profile_chunk_header {
+    uint32_t                 type;          /**< From ucs_profile_chunk_type_t */
+    uint32_t                 tid;           /**< System thread id, 0 for locations */
+    uint64_t                 count;         /**< Number of elements in the chunk */
+} UCS_S_PACKED ucs_profile_chunk_header_t;
+
+
+/**
+ * Profile stream thread summary
+ */
+typedef struct ucs_profile_stream_thread {
+    ucs_profile_thread_header_t super;      /**< Thread header, num_records is the
+                                                 number of records streamed */
+    uint64_t                 num_dropped;   /**< Records dropped because the
+                                                 writer did not keep up */
+} UCS_S_PACKED ucs_profile_stream_thread_t;
+
+
 extern const char *ucs_profile_mode_names[];
 
 
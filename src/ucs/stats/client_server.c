@@ -63,6 +63,7 @@ struct stats_entity {
     pthread_mutex_t     lock;
     volatile unsigned   refcount;
     void                *completed_buffer;  /* Completed buffer */
+    size_t              completed_size; /* Size of completed data, 0 if none */
     struct timeval      update_time;
 };
 
@@ -79,6 +80,7 @@ typedef struct ucs_stats_server {
     int                     udp_port;
     pthread_t               server_thread;
     volatile unsigned long  rcvd_packets;
+    volatile unsigned long  rcvd_reports;
     volatile int            stop;
     ucs_list_link_t         curr_stats;
     pthread_mutex_t         entities_lock;
@@ -239,6 +241,7 @@ static void ucs_stats_server_entity_reset_buffer(stats_entity_t * entity,
                                             new_size + sizeof(frag_hole_t));
         entity->completed_buffer  = realloc(entity->completed_buffer,
                                             new_size + sizeof(frag_hole_t));
+        entity->completed_size    = 0;
         pthread_mutex_unlock(&entity->lock);
     }
 
@@ -262,6 +265,7 @@ static stats_entity_t *ucs_stats_server_entity_alloc(struct sockaddr_in *addr)
     entity->buffer_size       = SIZE_MAX;
     entity->inprogress_buffer = NULL;
     entity->completed_buffer  = NULL;
+    entity->completed_size    = 0;
     entity->refcount          = 1;
     ucs_list_head_init(&entity->holes);
     pthread_mutex_init(&entity->lock, NULL);
@@ -401,7 +405,9 @@ ucs_stats_server_entity_update(ucs_stats_server_h server, stats_entity_t *entity
         ucs_debug("timestamp %"PRIu64" fully assembled", entity->timestamp);
         pthread_mutex_lock(&entity->lock);
         memcpy(entity->completed_buffer, entity->inprogress_buffer, entity->buffer_size);
+        entity->completed_size = entity->buffer_size;
         pthread_mutex_unlock(&entity->lock);
+        ++server->rcvd_reports;
     }
 
     return UCS_OK;
@@ -577,6 +583,7 @@ ucs_status_t ucs_stats_server_start(int port, ucs_stats_server_h *p_server)
     }
 
     server->rcvd_packets = 0;
+    server->rcvd_reports = 0;
     server->stop         = 0;
     pthread_create(&server->server_thread, NULL, ucs_stats_server_thread_func,
                    server);
@@ -627,7 +634,13 @@ ucs_list_link_t *ucs_stats_server_get_stats(ucs_stats_server_h server)
     {
         /* Parse the statistics data */
         pthread_mutex_lock(&entity->lock);
-        stream = fmemopen(entity->completed_buffer, entity->buffer_size, "rb");
+        if (entity->completed_size == 0) {
+            /* No report was fully assembled yet */
+            pthread_mutex_unlock(&entity->lock);
+            continue;
+        }
+
+        stream = fmemopen(entity->completed_buffer, entity->completed_size, "rb");
         status = ucs_stats_deserialize(stream, &node);
         fclose(stream);
         pthread_mutex_unlock(&entity->lock);
@@ -656,6 +669,11 @@ unsigned long ucs_stats_server_rcvd_packets(ucs_stats_server_h server)
    return server->rcvd_packets;
 }
 
+unsigned long ucs_stats_server_rcvd_reports(ucs_stats_server_h server)
+{
+   return server->rcvd_reports;
+}
+
 static inline int stats_entity_cmp(stats_entity_t *e1, stats_entity_t *e2)
 {
     int addr_diff = e1->in_addr.sin_addr.s_addr < e2->in_addr.sin_addr.s_addr;
@@ -7,14 +7,23 @@
 #include "libstats.h"
 
 #include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/sys/sys.h>
 #include <errno.h>
 #include <string.h>
+#include <inttypes.h>
 
 
 #define UCS_STATS_NAME_VALID_CHARS \
     "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_"
 
 
+/* Histogram lane of the current thread, plus 1; 0 if not assigned yet */
+__thread unsigned ucs_stats_histogram_thread_lane = 0;
+
+static volatile uint32_t ucs_stats_histogram_next_lane = 0;
+
+
 static ucs_status_t ucs_stats_name_check(const char *name)
 {
     size_t length, valid_length;
@@ -52,6 +61,12 @@ ucs_status_t ucs_stats_node_initv(ucs_stats_node_t *node, ucs_stats_class_t *cls
             return status;
         }
     }
+    for (i = 0; i < cls->num_histograms; ++i) {
+        status = ucs_stats_name_check(cls->histogram_names[i]);
+        if (status != UCS_OK) {
+            return status;
+        }
+    }
 
     /* Set up node */
     node->cls = cls;
@@ -63,3 +78,96 @@ ucs_status_t ucs_stats_node_initv(ucs_stats_node_t *node, ucs_stats_class_t *cls
     return UCS_OK;
 }
 
+
+ucs_status_t ucs_stats_node_histograms_alloc(ucs_stats_node_t *node)
+{
+    size_t size = node->cls->num_histograms * sizeof(*node->histograms);
+    int ret;
+
+    if (size == 0) {
+        node->histograms = NULL;
+        return UCS_OK;
+    }
+
+    ret = ucs_posix_memalign((void**)&node->histograms,
+                             UCS_SYS_CACHE_LINE_SIZE, size, "stats histograms");
+    if (ret != 0) {
+        ucs_error("failed to allocate %u stats histograms for %s",
+                  node->cls->num_histograms, node->cls->name);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    memset(node->histograms, 0, size);
+    return UCS_OK;
+}
+
+unsigned ucs_stats_histogram_lane_init()
+{
+    uint32_t lane;
+
+    /* Threads are spread round-robin, lanes are shared only when there are
+     * more threads than lanes */
+    lane = ucs_atomic_fadd32(&ucs_stats_histogram_next_lane, 1) %
+           UCS_STATS_HISTOGRAM_NUM_LANES;
+    ucs_stats_histogram_thread_lane = lane + 1;
+    return ucs_stats_histogram_thread_lane;
+}
+
+void ucs_stats_histogram_data_add(ucs_stats_histogram_data_t *dst,
+                                  const ucs_stats_histogram_data_t *src)
+{
+    unsigned i;
+
+    dst->count += src->count;
+    dst->sum   += src->sum;
+    for (i = 0; i < UCS_STATS_HISTOGRAM_NUM_BUCKETS; ++i) {
+        dst->buckets[i] += src->buckets[i];
+    }
+}
+
+void ucs_stats_histogram_merge(const ucs_stats_histogram_t *histogram,
+                               ucs_stats_histogram_data_t *result)
+{
+    unsigned lane;
+
+    memset(result, 0, sizeof(*result));
+    for (lane = 0; lane < UCS_STATS_HISTOGRAM_NUM_LANES; ++lane) {
+        ucs_stats_histogram_data_add(result, &histogram->lanes[lane]);
+    }
+}
+
+uint64_t ucs_stats_histogram_quantile(const ucs_stats_histogram_data_t *data,
+                                      double quantile)
+{
+    uint64_t threshold, count;
+    unsigned i;
+
+    if (data->count == 0) {
+        return 0;
+    }
+
+    threshold = ucs_max((uint64_t)(quantile * data->count + 0.5), 1);
+    count     = 0;
+    for (i = 0; i < UCS_STATS_HISTOGRAM_NUM_BUCKETS; ++i) {
+        count += data->buckets[i];
+        if (count >= threshold) {
+            return ucs_stats_histogram_bucket_max(i);
+        }
+    }
+
+    /* lanes were updated while merging */
+    return ucs_stats_histogram_bucket_max(UCS_STATS_HISTOGRAM_NUM_BUCKETS - 1);
+}
+
+void ucs_stats_histogram_data_print(FILE *stream,
+                                    const ucs_stats_histogram_data_t *data)
+{
+    fprintf(stream, "count %"PRIu64" avg %"PRIu64" p50 %"PRIu64" p90 %"PRIu64
+            " p99 %"PRIu64" p999 %"PRIu64" max %"PRIu64,
+            data->count, (data->count > 0) ? (data->sum / data->count) : 0,
+            ucs_stats_histogram_quantile(data, 0.5),
+            ucs_stats_histogram_quantile(data, 0.9),
+            ucs_stats_histogram_quantile(data, 0.99),
+            ucs_stats_histogram_quantile(data, 0.999),
+            ucs_stats_histogram_quantile(data, 1.0));
+}
@@ -11,6 +11,9 @@
 #include <ucs/datastruct/list.h>
 #include <ucs/type/status.h>
 #include <ucs/sys/math.h>
+#include <ucs/arch/atomic.h>
+#include <ucs/arch/bitops.h>
+#include <ucs/arch/cpu.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -30,6 +33,19 @@ enum {
 
 #define UCS_STAT_NAME_MAX          39
 
+
+/*
+ * Histogram buckets are log-linear: every power of 2 is split to
+ * 2^UCS_STATS_HISTOGRAM_SUB_BITS linear sub-buckets, so the relative error of
+ * a recorded value is below 1/2^UCS_STATS_HISTOGRAM_SUB_BITS.
+ */
+#define UCS_STATS_HISTOGRAM_SUB_BITS    2
+#define UCS_STATS_HISTOGRAM_NUM_BUCKETS \
+    ((64 - UCS_STATS_HISTOGRAM_SUB_BITS + 1) << UCS_STATS_HISTOGRAM_SUB_BITS)
+
+/* Number of per-thread recording lanes in every histogram */
+#define UCS_STATS_HISTOGRAM_NUM_LANES   8
+
 #define UCS_STATS_NODE_FMT \
     "%s%s"
 #define UCS_STATS_NODE_ARG(_node) \
@@ -54,9 +70,33 @@ typedef enum ucs_stats_children_sel {
 struct ucs_stats_class {
     const char           *name;
     unsigned             num_counters;
+    unsigned             num_histograms;
+    const char* const    *histogram_names;
     const char*          counter_names[];
 };
 
+
+/*
+ * Histogram data recorded by a single thread, or the result of merging the
+ * data of all threads. Laid out as an array of counters, to reuse counter
+ * serialization.
+ */
+typedef struct ucs_stats_histogram_data {
+    ucs_stats_counter_t      count;              /* Number of values */
+    ucs_stats_counter_t      sum;                /* Sum of all values */
+    ucs_stats_counter_t      buckets[UCS_STATS_HISTOGRAM_NUM_BUCKETS];
+} UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE) ucs_stats_histogram_data_t;
+
+
+/*
+ * Histogram of values, for example operation latencies. Every thread records
+ * to its own lane, so recording does not contend on a lock or a cache line,
+ * and the lanes are merged when the statistics are reported.
+ */
+struct ucs_stats_histogram {
+    ucs_stats_histogram_data_t lanes[UCS_STATS_HISTOGRAM_NUM_LANES];
+};
+
 /*
  * ucs_stats_node is used to hold the counters, their classes and the
  * relationship between them.
@@ -127,6 +167,7 @@ struct ucs_stats_node {
     ucs_list_link_t          type_list;          /* nodes with same class/es
                                                     hierarchy */
     ucs_stats_filter_node_t  *filter_node;       /* ptr to type list head */
+    ucs_stats_histogram_t    *histograms;        /* instance histograms */
     ucs_stats_counter_t      counters[1];        /* instance counters */
 };
 
@@ -138,8 +179,116 @@ struct ucs_stats_filter_node {
     int                       type_list_len;      /* length of list */
     int                       ref_count;          /* report node when non zero */
     uint64_t                  counters_bitmask;   /* which counters to print */
+    uint64_t                  histograms_bitmask; /* which histograms to print */
 };
 
+
+extern __thread unsigned ucs_stats_histogram_thread_lane;
+
+
+/**
+ * @return Histogram bucket of a value.
+ */
+static inline unsigned ucs_stats_histogram_bucket(uint64_t value)
+{
+    unsigned order;
+
+    if (value < UCS_BIT(UCS_STATS_HISTOGRAM_SUB_BITS)) {
+        return value;
+    }
+
+    order = ucs_ilog2(value);
+    return ((order - UCS_STATS_HISTOGRAM_SUB_BITS + 1) <<
+            UCS_STATS_HISTOGRAM_SUB_BITS) |
+           ((value >> (order - UCS_STATS_HISTOGRAM_SUB_BITS)) &
+            UCS_MASK(UCS_STATS_HISTOGRAM_SUB_BITS));
+}
+
+
+/**
+ * @return Largest value which falls into a histogram bucket.
+ */
+static inline uint64_t ucs_stats_histogram_bucket_max(unsigned bucket)
+{
+    unsigned order, sub;
+
+    if (bucket < UCS_BIT(UCS_STATS_HISTOGRAM_SUB_BITS)) {
+        return bucket;
+    }
+
+    order = (bucket >> UCS_STATS_HISTOGRAM_SUB_BITS) +
+            UCS_STATS_HISTOGRAM_SUB_BITS - 1;
+    sub   = bucket & UCS_MASK(UCS_STATS_HISTOGRAM_SUB_BITS);
+    return UCS_BIT(order) +
+           ((uint64_t)(sub + 1) << (order - UCS_STATS_HISTOGRAM_SUB_BITS)) - 1;
+}
+
+
+unsigned ucs_stats_histogram_lane_init();
+
+
+/**
+ * Record a value in a histogram.
+ *
+ * Updates are atomic, since more threads than lanes may share a lane, but
+ * every thread updates its own lane as long as there are enough lanes.
+ */
+static inline void ucs_stats_histogram_record(ucs_stats_histogram_t *histogram,
+                                              uint64_t value)
+{
+    unsigned lane = ucs_stats_histogram_thread_lane;
+    ucs_stats_histogram_data_t *data;
+
+    if (ucs_unlikely(lane == 0)) {
+        lane = ucs_stats_histogram_lane_init();
+    }
+
+    data = &histogram->lanes[lane - 1];
+    ucs_atomic_add64(&data->count, 1);
+    ucs_atomic_add64(&data->sum, value);
+    ucs_atomic_add64(&data->buckets[ucs_stats_histogram_bucket(value)], 1);
+}
+
+
+/**
+ * Merge the per-thread lanes of a histogram.
+ *
+ * @param histogram  Histogram to merge.
+ * @param result     Filled with the merged data.
+ */
+void ucs_stats_histogram_merge(const ucs_stats_histogram_t *histogram,
+                               ucs_stats_histogram_data_t *result);
+
+
+/**
+ * Add histogram data to another one.
+ */
+void ucs_stats_histogram_data_add(ucs_stats_histogram_data_t *dst,
+                                  const ucs_stats_histogram_data_t *src);
+
+
+/**
+ * @return The smallest bucket upper bound which is greater or equal to the
+ *         given fraction (0..1) of the values in the histogram.
+ */
+uint64_t ucs_stats_histogram_quantile(const ucs_stats_histogram_data_t *data,
+                                      double quantile);
+
+
+/**
+ * Print a summary of histogram data: count, average, quantiles and maximum.
+ */
+void ucs_stats_histogram_data_print(FILE *stream,
+                                    const ucs_stats_histogram_data_t *data);
+
+/**
+ * Allocate the histograms of a statistics node, according to its class.
+ *
+ * @param node  Node to allocate histograms for.
+ */
+ucs_status_t ucs_stats_node_histograms_alloc(ucs_stats_node_t *node);
+
+
 /**
  * Initialize statistics node.
  *
@@ -260,4 +409,10 @@ void ucs_stats_server_purge_stats(ucs_stats_server_h server);
 unsigned long ucs_stats_server_rcvd_packets(ucs_stats_server_h server);
 
 
+/**
+ * @return Number of fully assembled reports received by the server.
+ */
+unsigned long ucs_stats_server_rcvd_reports(ucs_stats_server_h server);
+
+
 #endif /* LIBSTATS_H_ */
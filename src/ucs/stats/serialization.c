@@ -7,6 +7,7 @@
 #include "libstats.h"
 
 #include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
 #include <ucs/datastruct/sglib_wrapper.h>
 #include <ucs/sys/compiler.h>
 #include <string.h>
@@ -22,6 +23,13 @@
 #define UCS_STATS_CLSID_CMP(a, b)    (  ((long)((a)->cls)) - ((long)((b)->cls))  )
 #define UCS_STATS_CLSID_SENTINEL     UINT8_MAX
 
+/* Data format version; version 2 added histograms */
+#define UCS_STATS_DATA_VERSION       2
+
+/* Histogram data is serialized as counters */
+#define UCS_STATS_HISTOGRAM_NUM_COUNTERS \
+    (sizeof(ucs_stats_histogram_data_t) / sizeof(ucs_stats_counter_t))
+
 /* Encode counter size */
 #define UCS_STATS_BITS_PER_COUNTER   2
 #define UCS_STATS_COUNTER_ZERO       0
@@ -170,24 +178,36 @@ static void ucs_stats_read_counters(ucs_stats_counter_t *counters,
     }
 }
 
+static unsigned ucs_stats_counter_size_code(ucs_stats_counter_t value)
+{
+    if (value == 0) {
+        return UCS_STATS_COUNTER_ZERO;
+    } else if (value <= USHRT_MAX) {
+        return UCS_STATS_COUNTER_U16;
+    } else if (value <= UINT_MAX) {
+        return UCS_STATS_COUNTER_U32;
+    } else {
+        return UCS_STATS_COUNTER_U64;
+    }
+}
+
 static void ucs_stats_write_counters(ucs_stats_counter_t *counters,
                                      unsigned num_counters,
                                      FILE *stream)
 {
     const unsigned counters_per_byte = 8 / UCS_STATS_BITS_PER_COUNTER;
-    ucs_stats_counter_t value;
-    uint8_t *counter_desc, v;
-    char *counter_data, *pos;
+    uint16_t value16;
+    uint32_t value32;
+    uint64_t value64;
+    uint8_t *counter_desc;
     size_t counter_desc_size;
     unsigned i;
 
     UCS_STATIC_ASSERT((8 % UCS_STATS_BITS_PER_COUNTER) == 0);
     counter_desc_size = ((num_counters + counters_per_byte - 1) / counters_per_byte);
     counter_desc = ucs_alloca(counter_desc_size);
-    counter_data = ucs_alloca(num_counters * sizeof(ucs_stats_counter_t));
 
     memset(counter_desc, 0, counter_desc_size);
-    pos = counter_data;
 
     /*
      * First, we have an array with 2 bits per counter describing its size:
@@ -195,28 +215,29 @@ static void ucs_stats_write_counters(ucs_stats_counter_t *counters,
      * Then, an array of all counters, each one occupying the size listed before.
      */
     for (i = 0; i < num_counters; ++i) {
-        value = counters[i];
-        if (value == 0) {
-            v = UCS_STATS_COUNTER_ZERO;
-        } else if (value <= USHRT_MAX) {
-            v = UCS_STATS_COUNTER_U16;
-            *(uint16_t*)(pos) = value;
-            pos += sizeof(uint16_t);
-        } else if (value <= UINT_MAX) {
-            v = UCS_STATS_COUNTER_U32;
-            *(uint32_t*)(pos) = value;
-            pos += sizeof(uint32_t);
-        } else {
-            v = UCS_STATS_COUNTER_U64;
-            *(uint64_t*)(pos) = value;
-            pos += sizeof(uint64_t);
-        }
         counter_desc[i / counters_per_byte] |=
-                        v << ((i % counters_per_byte) * UCS_STATS_BITS_PER_COUNTER);
+                        ucs_stats_counter_size_code(counters[i]) <<
+                        ((i % counters_per_byte) * UCS_STATS_BITS_PER_COUNTER);
     }
 
-    FWRITE(counter_desc, counter_desc_size,  stream);
-    FWRITE(counter_data, pos - counter_data, stream);
+    FWRITE(counter_desc, counter_desc_size, stream);
+
+    for (i = 0; i < num_counters; ++i) {
+        switch (ucs_stats_counter_size_code(counters[i])) {
+        case UCS_STATS_COUNTER_U16:
+            value16 = counters[i];
+            FWRITE_ONE(&value16, stream);
+            break;
+        case UCS_STATS_COUNTER_U32:
+            value32 = counters[i];
+            FWRITE_ONE(&value32, stream);
+            break;
+        case UCS_STATS_COUNTER_U64:
+            value64 = counters[i];
+            FWRITE_ONE(&value64, stream);
+            break;
+        }
+    }
 }
 
 static void
@@ -225,9 +246,11 @@ ucs_stats_serialize_binary_recurs(FILE *stream, ucs_stats_node_t *node,
                                   ucs_stats_clsid_t **cls_hash)
 {
     ucs_stats_class_t *cls = node->cls;
+    ucs_stats_histogram_data_t histogram;
     ucs_stats_clsid_t *elem, search;
     ucs_stats_node_t *child;
     uint8_t sentinel;
+    unsigned i;
 
     /* Search the class */
     search.cls = cls;
@@ -243,6 +266,13 @@ ucs_stats_serialize_binary_recurs(FILE *stream, ucs_stats_node_t *node,
     /* Counters */
     ucs_stats_write_counters(node->counters, cls->num_counters, stream);
 
+    /* Histograms, merged from all threads */
+    for (i = 0; i < cls->num_histograms; ++i) {
+        ucs_stats_histogram_merge(&node->histograms[i], &histogram);
+        ucs_stats_write_counters(&histogram.count,
+                                 UCS_STATS_HISTOGRAM_NUM_COUNTERS, stream);
+    }
+
     /* Children */
     ucs_list_for_each(child, &node->children[sel], list) {
         ucs_stats_serialize_binary_recurs(stream, child, sel, cls_hash);
@@ -267,7 +297,7 @@ ucs_stats_serialize_binary(FILE *stream, ucs_stats_node_t *root,
     sglib_hashed_ucs_stats_clsid_t_init(cls_hash);
 
     /* Write header */
-    hdr.version     = 1;
+    hdr.version     = UCS_STATS_DATA_VERSION;
     hdr.compression = UCS_STATS_COMPRESSION_NONE;
     hdr.reserved    = 0;
     hdr.num_classes = ucs_stats_get_all_classes_recurs(root, sel, cls_hash);
@@ -285,6 +315,10 @@ ucs_stats_serialize_binary(FILE *stream, ucs_stats_node_t *root,
         for (counter = 0; counter < cls->num_counters; ++counter) {
             ucs_stats_write_str(cls->counter_names[counter], stream);
         }
+        FWRITE_ONE(&cls->num_histograms, stream);
+        for (counter = 0; counter < cls->num_histograms; ++counter) {
+            ucs_stats_write_str(cls->histogram_names[counter], stream);
+        }
         elem->clsid = index++;
     }
 
@@ -371,6 +405,24 @@ ucs_stats_serialize_text_recurs_filtered(FILE *stream,
         }
     }
 
+    for (i = 0; (i < node->cls->num_histograms) && (i < 64); ++i) {
+        if (filter_node->histograms_bitmask & UCS_BIT(i)) {
+            ucs_stats_histogram_data_t histogram_acc, histogram;
+            ucs_stats_node_t * temp_node;
+
+            memset(&histogram_acc, 0, sizeof(histogram_acc));
+            ucs_list_for_each(temp_node, &filter_node->type_list_head, type_list) {
+                ucs_stats_histogram_merge(&temp_node->histograms[i], &histogram);
+                ucs_stats_histogram_data_add(&histogram_acc, &histogram);
+            }
+
+            fprintf(stream, "%*s%s:%s%s", UCS_STATS_INDENT(is_sum, indent + 1),
+                    node->cls->histogram_names[i], space, left_b);
+            ucs_stats_histogram_data_print(stream, &histogram_acc);
+            fprintf(stream, "%s%s", is_sum ? "} " : "", nl);
+        }
+    }
+
     ucs_list_for_each(filter_child, &filter_node->children, list) {
         ucs_stats_serialize_text_recurs_filtered(stream, filter_child,
                                                  indent + 1);
@@ -403,6 +455,12 @@ ucs_status_t ucs_stats_serialize(FILE *stream, ucs_stats_node_t *root, int optio
     }
 }
 
+static void ucs_stats_free_node(ucs_stats_node_t *node, void *ptr)
+{
+    ucs_free(node->histograms);
+    free(ptr);
+}
+
 static ucs_status_t
 ucs_stats_deserialize_recurs(FILE *stream, ucs_stats_class_t **classes,
                              unsigned num_classes, size_t headroom,
@@ -412,6 +470,7 @@ ucs_stats_deserialize_recurs(FILE *stream, ucs_stats_class_t **classes,
     ucs_stats_class_t *cls;
     uint8_t clsid, namelen;
     ucs_status_t status;
+    unsigned i;
     void *ptr;
 
     if (headroom >= UINT_MAX) {
@@ -458,6 +517,18 @@ ucs_stats_deserialize_recurs(FILE *stream, ucs_stats_class_t **classes,
     /* Read counters */
     ucs_stats_read_counters(node->counters, cls->num_counters, stream);
 
+    /* Read histograms, which are already merged to a single lane */
+    status = ucs_stats_node_histograms_alloc(node);
+    if (status != UCS_OK) {
+        free(ptr);
+        return status;
+    }
+
+    for (i = 0; i < cls->num_histograms; ++i) {
+        ucs_stats_read_counters(&node->histograms[i].lanes[0].count,
+                                UCS_STATS_HISTOGRAM_NUM_COUNTERS, stream);
+    }
+
     /* Read children */
     do {
         status = ucs_stats_deserialize_recurs(stream, classes, num_classes, 0,
@@ -468,7 +539,7 @@ ucs_stats_deserialize_recurs(FILE *stream, ucs_stats_class_t **classes,
             break; /* Sentinel */
         } else {
             ucs_error("ucs_stats_deserialize_recurs returned %s", ucs_status_string(status));
-            free(ptr); /* Error TODO free previous children */
+            ucs_stats_free_node(node, ptr); /* Error TODO free previous children */
             return status;
         }
     } while (1);
@@ -486,6 +557,10 @@ static void ucs_stats_free_classes(ucs_stats_class_t **classes, unsigned num_cla
         for (j = 0; j < classes[i]->num_counters; ++j) {
             free((char*)classes[i]->counter_names[j]);
         }
+        for (j = 0; j < classes[i]->num_histograms; ++j) {
+            free((char*)classes[i]->histogram_names[j]);
+        }
+        free((void*)classes[i]->histogram_names);
         free(classes[i]);
     }
     free(classes);
@@ -497,6 +572,7 @@ ucs_status_t ucs_stats_deserialize(FILE *stream, ucs_stats_node_t **p_root)
     ucs_stats_root_storage_t *s;
     ucs_stats_class_t **classes, *cls;
     unsigned i, j, num_counters;
+    const char **histogram_names;
     ucs_status_t status;
     size_t nread;
     char *name;
@@ -507,7 +583,7 @@ ucs_status_t ucs_stats_deserialize(FILE *stream, ucs_stats_node_t **p_root)
         goto err;
     }
 
-    if (hdr.version != 1) {
+    if ((hdr.version < 1) || (hdr.version > UCS_STATS_DATA_VERSION)) {
         ucs_error("invalid file version");
         status = UCS_ERR_UNSUPPORTED;
         goto err;
@@ -534,6 +610,20 @@ ucs_status_t ucs_stats_deserialize(FILE *stream, ucs_stats_node_t **p_root)
         for (j = 0; j < cls->num_counters; ++j) {
             cls->counter_names[j] = ucs_stats_read_str(stream);
         }
+
+        cls->num_histograms  = 0;
+        cls->histogram_names = NULL;
+        if (hdr.version >= 2) {
+            FREAD_ONE(&cls->num_histograms, stream);
+
+            /* coverity[tainted_data] */
+            histogram_names = malloc(cls->num_histograms *
+                                     sizeof(*histogram_names));
+            for (j = 0; j < cls->num_histograms; ++j) {
+                histogram_names[j] = ucs_stats_read_str(stream);
+            }
+            cls->histogram_names = histogram_names;
+        }
         classes[i] = cls;
 
     }
@@ -566,11 +656,11 @@ static void ucs_stats_free_recurs(ucs_stats_node_t *node)
 
     ucs_list_for_each_safe(child, tmp, &node->children[UCS_STATS_ACTIVE_CHILDREN], list) {
         ucs_stats_free_recurs(child);
-        free(child);
+        ucs_stats_free_node(child, child);
     }
     ucs_list_for_each_safe(child, tmp, &node->children[UCS_STATS_INACTIVE_CHILDREN], list) {
         ucs_stats_free_recurs(child);
-        free(child);
+        ucs_stats_free_node(child, child);
     }
 }
 
@@ -581,6 +671,6 @@ void ucs_stats_free(ucs_stats_node_t *root)
     s = ucs_container_of(root, ucs_stats_root_storage_t, node);
     ucs_stats_free_recurs(&s->node);
     ucs_stats_free_classes(s->classes, s->num_classes);
-    free(s);
+    ucs_stats_free_node(&s->node, s);
 }
 
@@ -135,12 +135,20 @@ static void ucs_stats_free_class(ucs_stats_class_t *cls)
         ucs_free((void*)cls->counter_names[i]);
     }
 
+    if (cls->histogram_names != NULL) {
+        for (i = 0; i < cls->num_histograms; i++) {
+            ucs_free((void*)cls->histogram_names[i]);
+        }
+        ucs_free((void*)cls->histogram_names);
+    }
+
     ucs_free((void*)cls->name);
     ucs_free(cls);
 }
 
 static ucs_stats_class_t *ucs_stats_dup_class(ucs_stats_class_t *cls)
 {
+    const char **histogram_names;
     ucs_stats_class_t *dup;
 
     dup = ucs_calloc(1, sizeof(*cls) + sizeof(*cls->counter_names) * cls->num_counters,
@@ -165,6 +173,29 @@ static ucs_stats_class_t *ucs_stats_dup_class(ucs_stats_class_t *cls)
         }
     }
 
+    if (cls->num_histograms == 0) {
+        return dup;
+    }
+
+    histogram_names = ucs_calloc(cls->num_histograms, sizeof(*histogram_names),
+                                 "ucs_stats_class_t histogram names");
+    if (!histogram_names) {
+        ucs_error("failed to allocate statistics histogram names");
+        goto err_free;
+    }
+
+    dup->histogram_names = histogram_names;
+    for (dup->num_histograms = 0; dup->num_histograms < cls->num_histograms;
+         dup->num_histograms++) {
+        histogram_names[dup->num_histograms] =
+                ucs_strdup(cls->histogram_names[dup->num_histograms],
+                           "ucs_stats_class_t histogram");
+        if (!histogram_names[dup->num_histograms]) {
+            ucs_error("failed to allocate statistics histogram name");
+            goto err_free;
+        }
+    }
+
     return dup;
 
 err_free:
@@ -195,6 +226,12 @@ static ucs_stats_class_t *ucs_stats_get_class(ucs_stats_class_t *cls)
     return dup;
 }
 
+static void ucs_stats_node_release(ucs_stats_node_t *node)
+{
+    ucs_free(node->histograms);
+    ucs_free(node);
+}
+
 static void ucs_stats_node_remove(ucs_stats_node_t *node, int make_inactive)
 {
     ucs_assert(node != &ucs_stats_context.root_node);
@@ -226,7 +263,7 @@ static void ucs_stats_node_remove(ucs_stats_node_t *node, int make_inactive)
         if (!node->filter_node->type_list_len) {
             ucs_free(node->filter_node);
         }
-        ucs_free(node);
+        ucs_stats_node_release(node);
     }
 }   
 
@@ -237,6 +274,7 @@ static void ucs_stats_filter_node_init_root() {
     ucs_list_add_tail(&ucs_stats_context.root_filter_node.type_list_head,
                       &ucs_stats_context.root_node.type_list);
     ucs_stats_context.root_filter_node.counters_bitmask = 0;
+    ucs_stats_context.root_filter_node.histograms_bitmask = 0;
     ucs_stats_context.root_filter_node.ref_count = 0;
     ucs_stats_context.root_filter_node.type_list_len = 1;
     ucs_list_head_init(&ucs_stats_context.root_filter_node.children);
@@ -266,6 +304,7 @@ static void ucs_stats_node_init_root(const char *name, ...)
 static ucs_status_t ucs_stats_node_new(ucs_stats_class_t *cls, ucs_stats_node_t **p_node)
 {
     ucs_stats_node_t *node;
+    ucs_status_t status;
 
     node = ucs_malloc(sizeof(ucs_stats_node_t) +
                       sizeof(ucs_stats_counter_t) *
@@ -276,6 +315,13 @@ static ucs_status_t ucs_stats_node_new(ucs_stats_class_t *cls, ucs_stats_node_t
         return UCS_ERR_NO_MEMORY;
     }
 
+    node->cls = cls;
+    status    = ucs_stats_node_histograms_alloc(node);
+    if (status != UCS_OK) {
+        ucs_free(node);
+        return status;
+    }
+
     *p_node = node;
     return UCS_OK;
 }
@@ -341,6 +387,7 @@ static void ucs_stats_add_to_filter(ucs_stats_node_t *node,
         filter_node->type_list_len = 0;
         filter_node->ref_count = 0;
         filter_node->counters_bitmask = 0;
+        filter_node->histograms_bitmask = 0;
         ucs_list_head_init(&filter_node->children);
         ucs_list_head_init(&filter_node->type_list_head);
         filter_node->parent = filter_parent;
@@ -360,6 +407,15 @@ static void ucs_stats_add_to_filter(ucs_stats_node_t *node,
         }
     }
 
+    for (i = 0; (i < node->cls->num_histograms) && (i < 64); ++i) {
+        filter_index = ucs_config_names_search(ucs_global_opts.stats_filter,
+                                               node->cls->histogram_names[i]);
+        if (filter_index >= 0) {
+            filter_node->histograms_bitmask |= UCS_BIT(i);
+            found = 1;
+        }
+    }
+
     if (found) {
         temp_filter_node = filter_node;
         while (temp_filter_node != NULL) {
@@ -412,13 +468,13 @@ ucs_status_t ucs_stats_node_alloc(ucs_stats_node_t** p_node, ucs_stats_class_t *
     va_end(ap);
 
     if (status != UCS_OK) {
-        ucs_free(node);
+        ucs_stats_node_release(node);
         return status;
     }
 
     status = ucs_stats_filter_node_new(node->cls, &filter_node);
     if (status != UCS_OK) {
-        ucs_free(node);
+        ucs_stats_node_release(node);
         return status;
     }
 
@@ -426,7 +482,7 @@ ucs_status_t ucs_stats_node_alloc(ucs_stats_node_t** p_node, ucs_stats_class_t *
 
     status = ucs_stats_node_add(node, parent, filter_node);
     if (status != UCS_OK) {
-        ucs_free(node);
+        ucs_stats_node_release(node);
         ucs_free(filter_node);
         return status;
     }
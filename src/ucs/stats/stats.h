@@ -74,6 +74,11 @@ void ucs_stats_node_free(ucs_stats_node_t *node);
         } \
     }
 
+#define UCS_STATS_UPDATE_HISTOGRAM(_node, _index, _value) \
+    if ((_node) != NULL) { \
+        ucs_stats_histogram_record(&(_node)->histograms[(_index)], (_value)); \
+    }
+
 #define UCS_STATS_START_TIME(_start_time) \
     { \
         _start_time = ucs_get_time(); \
@@ -87,6 +92,13 @@ void ucs_stats_node_free(ucs_stats_node_t *node);
                                  (long)ucs_time_to_nsec(ucs_get_time() - (_start_time))); \
     }
 
+#define UCS_STATS_UPDATE_HISTOGRAM_TIME(_node, _index, _start_time) \
+    { \
+        ucs_compiler_fence(); \
+        UCS_STATS_UPDATE_HISTOGRAM(_node, _index, \
+                                   (uint64_t)ucs_time_to_nsec(ucs_get_time() - (_start_time))); \
+    }
+
 #define UCS_STATS_SET_TIME(_node, _index, _start_time) \
    { \
         ucs_compiler_fence(); \
@@ -105,8 +117,10 @@ void ucs_stats_node_free(ucs_stats_node_t *node);
 #define UCS_STATS_SET_COUNTER(_node, _index, _value)
 #define UCS_STATS_GET_COUNTER(_node, _index)    0
 #define UCS_STATS_UPDATE_MAX(_node, _index, _value)
+#define UCS_STATS_UPDATE_HISTOGRAM(_node, _index, _value)
 #define UCS_STATS_START_TIME(_start_time)
 #define UCS_STATS_UPDATE_TIME(_node, _index, _start_time)
+#define UCS_STATS_UPDATE_HISTOGRAM_TIME(_node, _index, _start_time)
 #define UCS_STATS_SET_TIME(_node, _index, _start_time)
 
 #endif
@@ -19,6 +19,7 @@ typedef uint64_t                          ucs_stats_counter_t;        /* Stats c
 typedef struct ucs_stats_class            ucs_stats_class_t;          /* Stats class */
 typedef struct ucs_stats_node             ucs_stats_node_t;           /* Stats node */
 typedef struct ucs_stats_filter_node      ucs_stats_filter_node_t;    /* Stats filter node */
+typedef struct ucs_stats_histogram        ucs_stats_histogram_t;      /* Stats histogram */
 
 typedef enum {
     UCS_STATS_FULL,        /* Full statistics report */
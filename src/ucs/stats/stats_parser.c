@@ -6,11 +6,38 @@
 
 #include "stats.h"
 
+#include <inttypes.h>
+
 /*
  * Dump binary statistics file to stdout.
  * Usage: ucs_stats_parser [ file1 ] [ file2 ] ...
  */
 
+static void dump_node(ucs_stats_node_t *node, unsigned indent)
+{
+    ucs_stats_node_t *child;
+    unsigned i;
+
+    printf("%*s"UCS_STATS_NODE_FMT":\n", indent * 2, "",
+           UCS_STATS_NODE_ARG(node));
+
+    for (i = 0; i < node->cls->num_counters; ++i) {
+        printf("%*s%s: %"PRIu64"\n", (indent + 1) * 2, "",
+               node->cls->counter_names[i], node->counters[i]);
+    }
+
+    /* Deserialized histograms are already merged to the first lane */
+    for (i = 0; i < node->cls->num_histograms; ++i) {
+        printf("%*s%s: ", (indent + 1) * 2, "", node->cls->histogram_names[i]);
+        ucs_stats_histogram_data_print(stdout, &node->histograms[i].lanes[0]);
+        printf("\n");
+    }
+
+    ucs_list_for_each(child, &node->children[UCS_STATS_ACTIVE_CHILDREN], list) {
+        dump_node(child, indent + 1);
+    }
+}
+
 static ucs_status_t dump_file(const char *filename)
 {
     ucs_stats_node_t *root;
@@ -29,7 +56,7 @@ static ucs_status_t dump_file(const char *filename)
             goto out;
         }
 
-        ucs_stats_serialize(stdout, root, 0);
+        dump_node(root, 0);
         ucs_stats_free(root);
     }
 
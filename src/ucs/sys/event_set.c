@@ -9,6 +9,7 @@
 #endif
 
 #include "event_set.h"
+#include "event_set_uring.h"
 
 #include <ucs/debug/memtrack.h>
 #include <ucs/debug/log.h>
@@ -27,13 +28,20 @@ enum {
 };
 
 struct ucs_sys_event_set {
-    int      event_fd;
-    unsigned flags;
+    int                   event_fd;
+    unsigned              flags;
+    ucs_event_set_uring_t *uring; /* io_uring backend, or NULL for epoll */
 };
 
 const unsigned ucs_sys_event_set_max_wait_events =
     UCS_ALLOCA_MAX_SIZE / sizeof(struct epoll_event);
 
+const char *ucs_event_set_backend_names[] = {
+    [UCS_EVENT_SET_BACKEND_EPOLL]    = "epoll",
+    [UCS_EVENT_SET_BACKEND_IO_URING] = "io_uring",
+    [UCS_EVENT_SET_BACKEND_LAST]     = NULL
+};
+
 
 static inline int ucs_event_set_map_to_raw_events(int events)
 {
@@ -85,6 +93,7 @@ static ucs_sys_event_set_t *ucs_event_set_alloc(int event_fd, unsigned flags)
 
     event_set->flags    = flags;
     event_set->event_fd = event_fd;
+    event_set->uring    = NULL;
     return event_set;
 }
 
@@ -101,10 +110,47 @@ ucs_status_t ucs_event_set_create_from_fd(ucs_sys_event_set_t **event_set_p,
 }
 
 ucs_status_t ucs_event_set_create(ucs_sys_event_set_t **event_set_p)
+{
+    return ucs_event_set_create_backend(event_set_p,
+                                        UCS_EVENT_SET_BACKEND_EPOLL);
+}
+
+static ucs_status_t
+ucs_event_set_create_uring(ucs_sys_event_set_t **event_set_p)
+{
+    ucs_event_set_uring_t *uring;
+    ucs_status_t status;
+
+    status = ucs_event_set_uring_create(&uring);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    *event_set_p = ucs_event_set_alloc(ucs_event_set_uring_fd(uring), 0);
+    if (*event_set_p == NULL) {
+        ucs_event_set_uring_destroy(uring);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    (*event_set_p)->uring = uring;
+    return UCS_OK;
+}
+
+ucs_status_t ucs_event_set_create_backend(ucs_sys_event_set_t **event_set_p,
+                                          ucs_event_set_backend_t backend)
 {
     ucs_status_t status;
     int event_fd;
 
+    if (backend == UCS_EVENT_SET_BACKEND_IO_URING) {
+        status = ucs_event_set_create_uring(event_set_p);
+        if (status != UCS_ERR_UNSUPPORTED) {
+            return status;
+        }
+
+        ucs_debug("io_uring is not available, using epoll event set");
+    }
+
     /* Create epoll set the thread will wait on */
     event_fd = epoll_create(1);
     if (event_fd < 0) {
@@ -131,6 +177,11 @@ ucs_status_t ucs_event_set_add(ucs_sys_event_set_t *event_set, int fd,
     struct epoll_event raw_event;
     int ret;
 
+    if (event_set->uring != NULL) {
+        return ucs_event_set_uring_add(event_set->uring, fd, events,
+                                       callback_data);
+    }
+
     memset(&raw_event, 0, sizeof(raw_event));
     raw_event.events   = ucs_event_set_map_to_raw_events(events);
     raw_event.data.ptr = callback_data;
@@ -151,6 +202,11 @@ ucs_status_t ucs_event_set_mod(ucs_sys_event_set_t *event_set, int fd,
     struct epoll_event raw_event;
     int ret;
 
+    if (event_set->uring != NULL) {
+        return ucs_event_set_uring_mod(event_set->uring, fd, events,
+                                       callback_data);
+    }
+
     memset(&raw_event, 0, sizeof(raw_event));
     raw_event.events   = ucs_event_set_map_to_raw_events(events);
     raw_event.data.ptr = callback_data;
@@ -169,6 +225,10 @@ ucs_status_t ucs_event_set_del(ucs_sys_event_set_t *event_set, int fd)
 {
     int ret;
 
+    if (event_set->uring != NULL) {
+        return ucs_event_set_uring_del(event_set->uring, fd);
+    }
+
     ret = epoll_ctl(event_set->event_fd, EPOLL_CTL_DEL, fd, NULL);
     if (ret < 0) {
         ucs_error("epoll_ctl(event_fd=%d, DEL, fd=%d) failed: %m",
@@ -191,6 +251,11 @@ ucs_status_t ucs_event_set_wait(ucs_sys_event_set_t *event_set,
     ucs_assert(num_events != NULL);
     ucs_assert(*num_events <= ucs_sys_event_set_max_wait_events);
 
+    if (event_set->uring != NULL) {
+        return ucs_event_set_uring_wait(event_set->uring, num_events,
+                                        timeout_ms, event_set_handler, arg);
+    }
+
     events = ucs_alloca(sizeof(*events) * *num_events);
 
     nready = epoll_wait(event_set->event_fd, events, *num_events, timeout_ms);
@@ -219,7 +284,10 @@ ucs_status_t ucs_event_set_wait(ucs_sys_event_set_t *event_set,
 
 void ucs_event_set_cleanup(ucs_sys_event_set_t *event_set)
 {
-    if (!(event_set->flags & UCS_SYS_EVENT_SET_EXTERNAL_EVENT_FD)) {
+    if (event_set->uring != NULL) {
+        /* The ring file descriptor is closed by the backend */
+        ucs_event_set_uring_destroy(event_set->uring);
+    } else if (!(event_set->flags & UCS_SYS_EVENT_SET_EXTERNAL_EVENT_FD)) {
         close(event_set->event_fd);
     }
     ucs_free(event_set);
@@ -232,3 +300,10 @@ ucs_status_t ucs_event_set_fd_get(ucs_sys_event_set_t *event_set,
     *event_fd_p = event_set->event_fd;
     return UCS_OK;
 }
+
+ucs_event_set_backend_t
+ucs_event_set_get_backend(const ucs_sys_event_set_t *event_set)
+{
+    return (event_set->uring != NULL) ? UCS_EVENT_SET_BACKEND_IO_URING :
+                                        UCS_EVENT_SET_BACKEND_EPOLL;
+}
@@ -38,9 +38,22 @@ typedef enum {
     UCS_EVENT_SET_EDGE_TRIGGERED = UCS_BIT(3)
 } ucs_event_set_type_t;
 
+/**
+ * Mechanism which is used by the event set to wait for events
+ */
+typedef enum {
+    UCS_EVENT_SET_BACKEND_EPOLL,     /**< epoll(7) */
+    UCS_EVENT_SET_BACKEND_IO_URING,  /**< Poll requests of io_uring, which are
+                                          submitted in batches */
+    UCS_EVENT_SET_BACKEND_LAST
+} ucs_event_set_backend_t;
+
 /* The maximum possible number of events based on system constraints */
 extern const unsigned ucs_sys_event_set_max_wait_events;
 
+/* Names of the event set backends */
+extern const char *ucs_event_set_backend_names[];
+
 /**
  * Allocate ucs_sys_event_set_t structure and assign provided file
  * descriptor to wait for events on.
@@ -62,6 +75,28 @@ ucs_status_t ucs_event_set_create_from_fd(ucs_sys_event_set_t **event_set_p,
  */
 ucs_status_t ucs_event_set_create(ucs_sys_event_set_t **event_set_p);
 
+/**
+ * Allocate ucs_sys_event_set_t structure which uses the given backend. If
+ * io_uring backend is not supported by the system, epoll is used instead.
+ *
+ * @param [out] event_set_p  Event set pointer to initialize.
+ * @param [in]  backend      Backend to wait for events with.
+ *
+ * @return UCS_OK on success or an error code on failure.
+ */
+ucs_status_t ucs_event_set_create_backend(ucs_sys_event_set_t **event_set_p,
+                                          ucs_event_set_backend_t backend);
+
+/**
+ * Get the backend which is used by the event set.
+ *
+ * @param [in] event_set    Event set created by ucs_event_set_create.
+ *
+ * @return Backend of the event set.
+ */
+ucs_event_set_backend_t
+ucs_event_set_get_backend(const ucs_sys_event_set_t *event_set);
+
 /**
  * Register the target event.
  *
@@ -0,0 +1,749 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "event_set_uring.h"
+
+#include <ucs/datastruct/khash.h>
+#include <ucs/datastruct/list.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/assert.h>
+#include <ucs/arch/cpu.h>
+#include <ucs/sys/compiler.h>
+#include <ucs/sys/math.h>
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#if HAVE_LINUX_IO_URING_H
+#  include <linux/io_uring.h>
+#  include <sys/syscall.h>
+#  include <sys/mman.h>
+#  include <poll.h>
+#endif
+
+
+#if HAVE_LINUX_IO_URING_H && defined(__NR_io_uring_setup) && \
+    defined(__NR_io_uring_enter)
+
+/* Number of submission queue entries */
+#define UCS_EVENT_SET_URING_SQ_ENTRIES  256
+
+/* Number of completion queue entries, every watched file descriptor has at
+ * most one poll request in flight, so the completion queue is made larger to
+ * avoid overflowing it when a lot of file descriptors become ready at once */
+#define UCS_EVENT_SET_URING_CQ_ENTRIES  4096
+
+/* Poll ID of internal requests, their completions are not reported */
+#define UCS_EVENT_SET_URING_INTERNAL_ID 0
+
+
+/* Watched file descriptor */
+typedef struct ucs_event_set_uring_fd {
+    int                   fd;
+    int                   events;        /* Requested events */
+    void                  *callback_data;
+    uint32_t              poll_id;       /* ID of the armed poll request,
+                                          * or UCS_EVENT_SET_URING_INTERNAL_ID */
+    int                   poll_events;   /* Events of the armed poll request */
+    int                   arm_queued;    /* Whether the FD is in the arm list */
+    ucs_list_link_t       list;          /* Entry in the arm list */
+} ucs_event_set_uring_fd_t;
+
+
+KHASH_MAP_INIT_INT(ucs_event_set_uring_fds, ucs_event_set_uring_fd_t*);
+
+
+struct ucs_event_set_uring {
+    int                            ring_fd;
+    struct {
+        void                       *ring;
+        size_t                     ring_size;
+        volatile unsigned          *head;
+        volatile unsigned          *tail;
+        unsigned                   *array;
+        unsigned                   mask;
+        unsigned                   entries;
+        struct io_uring_sqe        *sqes;
+        size_t                     sqes_size;
+        unsigned                   local_tail;   /* Tail of prepared entries */
+        unsigned                   pending;      /* Number of prepared entries
+                                                  * not submitted yet */
+    } sq;
+    struct {
+        void                       *ring;
+        size_t                     ring_size;
+        volatile unsigned          *head;
+        volatile unsigned          *tail;
+        unsigned                   mask;
+        struct io_uring_cqe        *cqes;
+    } cq;
+    struct __kernel_timespec       timeout;      /* Timeout of the wait call */
+    uint32_t                       poll_id;      /* Last poll request ID */
+    int                            in_wait;      /* Whether events are being
+                                                  * handled */
+    ucs_list_link_t                arm_list;     /* FDs to (re-)arm */
+    khash_t(ucs_event_set_uring_fds) fds;        /* Watched FDs */
+};
+
+
+static inline uint64_t
+ucs_event_set_uring_user_data(int fd, uint32_t poll_id)
+{
+    return ((uint64_t)(uint32_t)fd << 32) | poll_id;
+}
+
+static inline int ucs_event_set_uring_map_to_raw_events(int events)
+{
+    int raw_events = 0;
+
+    if (events & UCS_EVENT_SET_EVREAD) {
+         raw_events |= POLLIN;
+    }
+    if (events & UCS_EVENT_SET_EVWRITE) {
+         raw_events |= POLLOUT;
+    }
+    if (events & UCS_EVENT_SET_EVERR) {
+         raw_events |= POLLERR;
+    }
+    return raw_events;
+}
+
+static inline int ucs_event_set_uring_map_to_events(int raw_events)
+{
+    int events = 0;
+
+    if (raw_events & POLLIN) {
+         events |= UCS_EVENT_SET_EVREAD;
+    }
+    if (raw_events & POLLOUT) {
+         events |= UCS_EVENT_SET_EVWRITE;
+    }
+    if (raw_events & POLLERR) {
+         events |= UCS_EVENT_SET_EVERR;
+    }
+    return events;
+}
+
+static ucs_status_t ucs_event_set_uring_enter(ucs_event_set_uring_t *uring,
+                                              unsigned min_complete,
+                                              unsigned flags)
+{
+    int ret;
+
+    /* Make the prepared entries visible to the kernel */
+    ucs_memory_cpu_store_fence();
+    *uring->sq.tail = uring->sq.local_tail;
+
+    ret = syscall(__NR_io_uring_enter, uring->ring_fd, uring->sq.pending,
+                  min_complete, flags, NULL, 0);
+    if (ucs_unlikely(ret < 0)) {
+        if (errno == EINTR) {
+            return UCS_INPROGRESS;
+        } else if ((errno == EBUSY) || (errno == EAGAIN)) {
+            /* The completion queue is full, it has to be reaped first */
+            return UCS_OK;
+        }
+
+        ucs_error("io_uring_enter(ring_fd=%d, to_submit=%u) failed: %m",
+                  uring->ring_fd, uring->sq.pending);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    ucs_assert(ret <= uring->sq.pending);
+    uring->sq.pending -= ret;
+    return UCS_OK;
+}
+
+static ucs_status_t ucs_event_set_uring_get_sqe(ucs_event_set_uring_t *uring,
+                                                struct io_uring_sqe **sqe_p)
+{
+    struct io_uring_sqe *sqe;
+    ucs_status_t status;
+    unsigned index;
+
+    while ((uring->sq.local_tail - *uring->sq.head) >= uring->sq.entries) {
+        status = ucs_event_set_uring_enter(uring, 0, 0);
+        if (UCS_STATUS_IS_ERR(status)) {
+            return status;
+        }
+    }
+
+    ucs_memory_cpu_load_fence();
+
+    index                  = uring->sq.local_tail & uring->sq.mask;
+    sqe                    = &uring->sq.sqes[index];
+    uring->sq.array[index] = index;
+    ++uring->sq.local_tail;
+    ++uring->sq.pending;
+
+    memset(sqe, 0, sizeof(*sqe));
+    *sqe_p = sqe;
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucs_event_set_uring_poll_add(ucs_event_set_uring_t *uring,
+                             ucs_event_set_uring_fd_t *fd_entry)
+{
+    struct io_uring_sqe *sqe;
+    ucs_status_t status;
+
+    status = ucs_event_set_uring_get_sqe(uring, &sqe);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if (++uring->poll_id == UCS_EVENT_SET_URING_INTERNAL_ID) {
+        ++uring->poll_id;
+    }
+
+    fd_entry->poll_id     = uring->poll_id;
+    fd_entry->poll_events = fd_entry->events;
+
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = fd_entry->fd;
+    sqe->poll32_events = ucs_event_set_uring_map_to_raw_events(
+                                                        fd_entry->events);
+    sqe->user_data     = ucs_event_set_uring_user_data(fd_entry->fd,
+                                                       fd_entry->poll_id);
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucs_event_set_uring_poll_remove(ucs_event_set_uring_t *uring,
+                                ucs_event_set_uring_fd_t *fd_entry)
+{
+    struct io_uring_sqe *sqe;
+    ucs_status_t status;
+
+    status = ucs_event_set_uring_get_sqe(uring, &sqe);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    sqe->opcode    = IORING_OP_POLL_REMOVE;
+    sqe->addr      = ucs_event_set_uring_user_data(fd_entry->fd,
+                                                   fd_entry->poll_id);
+    sqe->user_data = ucs_event_set_uring_user_data(
+                             fd_entry->fd, UCS_EVENT_SET_URING_INTERNAL_ID);
+
+    fd_entry->poll_id = UCS_EVENT_SET_URING_INTERNAL_ID;
+    return UCS_OK;
+}
+
+static void ucs_event_set_uring_arm_enqueue(ucs_event_set_uring_t *uring,
+                                            ucs_event_set_uring_fd_t *fd_entry)
+{
+    if (!fd_entry->arm_queued) {
+        fd_entry->arm_queued = 1;
+        ucs_list_add_tail(&uring->arm_list, &fd_entry->list);
+    }
+}
+
+static ucs_status_t ucs_event_set_uring_arm(ucs_event_set_uring_t *uring)
+{
+    ucs_event_set_uring_fd_t *fd_entry;
+    ucs_status_t status;
+
+    while (!ucs_list_is_empty(&uring->arm_list)) {
+        fd_entry = ucs_list_head(&uring->arm_list, ucs_event_set_uring_fd_t,
+                                 list);
+        if (fd_entry->events != 0) {
+            if (fd_entry->poll_id != UCS_EVENT_SET_URING_INTERNAL_ID) {
+                if (!(fd_entry->events & ~fd_entry->poll_events)) {
+                    /* The armed request waits for the requested events, the
+                     * events which are not requested anymore are filtered
+                     * out when the request completes */
+                    goto dequeue;
+                }
+
+                status = ucs_event_set_uring_poll_remove(uring, fd_entry);
+                if (status != UCS_OK) {
+                    return status;
+                }
+            }
+
+            status = ucs_event_set_uring_poll_add(uring, fd_entry);
+            if (status != UCS_OK) {
+                return status;
+            }
+        }
+
+dequeue:
+        ucs_list_del(&fd_entry->list);
+        fd_entry->arm_queued = 0;
+    }
+
+    return UCS_OK;
+}
+
+static ucs_status_t ucs_event_set_uring_update(ucs_event_set_uring_t *uring)
+{
+    ucs_status_t status;
+
+    if (uring->in_wait) {
+        /* Will be submitted along with the rest of the changes when handling
+         * of the events is completed */
+        return UCS_OK;
+    }
+
+    status = ucs_event_set_uring_arm(uring);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if (uring->sq.pending == 0) {
+        return UCS_OK;
+    }
+
+    status = ucs_event_set_uring_enter(uring, 0, 0);
+    return (status == UCS_INPROGRESS) ? UCS_OK : status;
+}
+
+static void ucs_event_set_uring_unmap(ucs_event_set_uring_t *uring)
+{
+    if (uring->sq.sqes != MAP_FAILED) {
+        munmap(uring->sq.sqes, uring->sq.sqes_size);
+    }
+    if ((uring->cq.ring != MAP_FAILED) && (uring->cq.ring != uring->sq.ring)) {
+        munmap(uring->cq.ring, uring->cq.ring_size);
+    }
+    if (uring->sq.ring != MAP_FAILED) {
+        munmap(uring->sq.ring, uring->sq.ring_size);
+    }
+}
+
+static ucs_status_t ucs_event_set_uring_setup(ucs_event_set_uring_t *uring)
+{
+    struct io_uring_params params;
+
+    memset(&params, 0, sizeof(params));
+    params.flags      = IORING_SETUP_CQSIZE;
+    params.cq_entries = UCS_EVENT_SET_URING_CQ_ENTRIES;
+
+    uring->ring_fd = syscall(__NR_io_uring_setup,
+                             UCS_EVENT_SET_URING_SQ_ENTRIES, &params);
+    if ((uring->ring_fd < 0) && (errno == EINVAL)) {
+        /* Older kernels don't support setting the completion queue size */
+        memset(&params, 0, sizeof(params));
+        uring->ring_fd = syscall(__NR_io_uring_setup,
+                                 UCS_EVENT_SET_URING_SQ_ENTRIES, &params);
+    }
+
+    if (uring->ring_fd < 0) {
+        ucs_debug("io_uring_setup() failed: %m");
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    uring->sq.ring      = MAP_FAILED;
+    uring->cq.ring      = MAP_FAILED;
+    uring->sq.sqes      = MAP_FAILED;
+    uring->sq.ring_size = params.sq_off.array +
+                          (params.sq_entries * sizeof(unsigned));
+    uring->cq.ring_size = params.cq_off.cqes +
+                          (params.cq_entries * sizeof(struct io_uring_cqe));
+    uring->sq.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        uring->sq.ring_size = ucs_max(uring->sq.ring_size,
+                                      uring->cq.ring_size);
+        uring->cq.ring_size = uring->sq.ring_size;
+    }
+
+    uring->sq.ring = mmap(NULL, uring->sq.ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, uring->ring_fd,
+                          IORING_OFF_SQ_RING);
+    if (uring->sq.ring == MAP_FAILED) {
+        goto err_unmap;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        uring->cq.ring = uring->sq.ring;
+    } else {
+        uring->cq.ring = mmap(NULL, uring->cq.ring_size,
+                              PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              uring->ring_fd, IORING_OFF_CQ_RING);
+        if (uring->cq.ring == MAP_FAILED) {
+            goto err_unmap;
+        }
+    }
+
+    uring->sq.sqes = mmap(NULL, uring->sq.sqes_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, uring->ring_fd,
+                          IORING_OFF_SQES);
+    if (uring->sq.sqes == MAP_FAILED) {
+        goto err_unmap;
+    }
+
+    uring->sq.head       = UCS_PTR_BYTE_OFFSET(uring->sq.ring,
+                                               params.sq_off.head);
+    uring->sq.tail       = UCS_PTR_BYTE_OFFSET(uring->sq.ring,
+                                               params.sq_off.tail);
+    uring->sq.array      = UCS_PTR_BYTE_OFFSET(uring->sq.ring,
+                                               params.sq_off.array);
+    uring->sq.mask       = *(unsigned*)UCS_PTR_BYTE_OFFSET(uring->sq.ring,
+                                                     params.sq_off.ring_mask);
+    uring->sq.entries    = params.sq_entries;
+    uring->sq.local_tail = *uring->sq.tail;
+    uring->sq.pending    = 0;
+
+    uring->cq.head       = UCS_PTR_BYTE_OFFSET(uring->cq.ring,
+                                               params.cq_off.head);
+    uring->cq.tail       = UCS_PTR_BYTE_OFFSET(uring->cq.ring,
+                                               params.cq_off.tail);
+    uring->cq.cqes       = UCS_PTR_BYTE_OFFSET(uring->cq.ring,
+                                               params.cq_off.cqes);
+    uring->cq.mask       = *(unsigned*)UCS_PTR_BYTE_OFFSET(uring->cq.ring,
+                                                     params.cq_off.ring_mask);
+
+    ucs_debug("created io_uring event set ring_fd %d sq_entries %u "
+              "cq_entries %u", uring->ring_fd, params.sq_entries,
+              params.cq_entries);
+    return UCS_OK;
+
+err_unmap:
+    ucs_error("failed to map io_uring ring_fd %d: %m", uring->ring_fd);
+    ucs_event_set_uring_unmap(uring);
+    close(uring->ring_fd);
+    return UCS_ERR_IO_ERROR;
+}
+
+ucs_status_t ucs_event_set_uring_create(ucs_event_set_uring_t **uring_p)
+{
+    ucs_event_set_uring_t *uring;
+    ucs_status_t status;
+
+    uring = ucs_calloc(1, sizeof(*uring), "ucs_event_set_uring");
+    if (uring == NULL) {
+        ucs_error("unable to allocate memory ucs_event_set_uring_t object");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    status = ucs_event_set_uring_setup(uring);
+    if (status != UCS_OK) {
+        ucs_free(uring);
+        return status;
+    }
+
+    uring->poll_id = UCS_EVENT_SET_URING_INTERNAL_ID;
+    uring->in_wait = 0;
+    ucs_list_head_init(&uring->arm_list);
+    kh_init_inplace(ucs_event_set_uring_fds, &uring->fds);
+
+    *uring_p = uring;
+    return UCS_OK;
+}
+
+void ucs_event_set_uring_destroy(ucs_event_set_uring_t *uring)
+{
+    ucs_event_set_uring_fd_t *fd_entry;
+
+    kh_foreach_value(&uring->fds, fd_entry, {
+        ucs_free(fd_entry);
+    })
+    kh_destroy_inplace(ucs_event_set_uring_fds, &uring->fds);
+
+    /* Closing the ring cancels all requests in flight */
+    ucs_event_set_uring_unmap(uring);
+    close(uring->ring_fd);
+    ucs_free(uring);
+}
+
+int ucs_event_set_uring_fd(ucs_event_set_uring_t *uring)
+{
+    return uring->ring_fd;
+}
+
+static ucs_event_set_uring_fd_t *
+ucs_event_set_uring_fd_find(ucs_event_set_uring_t *uring, int fd)
+{
+    khiter_t iter;
+
+    iter = kh_get(ucs_event_set_uring_fds, &uring->fds, fd);
+    if (iter == kh_end(&uring->fds)) {
+        return NULL;
+    }
+
+    return kh_val(&uring->fds, iter);
+}
+
+ucs_status_t ucs_event_set_uring_add(ucs_event_set_uring_t *uring, int fd,
+                                     ucs_event_set_type_t events,
+                                     void *callback_data)
+{
+    ucs_event_set_uring_fd_t *fd_entry;
+    khiter_t iter;
+    int ret;
+
+    if (events & UCS_EVENT_SET_EDGE_TRIGGERED) {
+        ucs_error("io_uring event set doesn't support edge-triggered mode "
+                  "(fd=%d)", fd);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    fd_entry = ucs_malloc(sizeof(*fd_entry), "ucs_event_set_uring_fd");
+    if (fd_entry == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    iter = kh_put(ucs_event_set_uring_fds, &uring->fds, fd, &ret);
+    if (ret == -1) {
+        ucs_free(fd_entry);
+        return UCS_ERR_NO_MEMORY;
+    } else if (ret == 0) {
+        ucs_error("io_uring event set (ring_fd=%d): fd %d is already added",
+                  uring->ring_fd, fd);
+        ucs_free(fd_entry);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    fd_entry->fd            = fd;
+    fd_entry->events        = events;
+    fd_entry->callback_data = callback_data;
+    fd_entry->poll_id       = UCS_EVENT_SET_URING_INTERNAL_ID;
+    fd_entry->poll_events   = 0;
+    fd_entry->arm_queued    = 0;
+    kh_val(&uring->fds, iter) = fd_entry;
+
+    ucs_event_set_uring_arm_enqueue(uring, fd_entry);
+    return ucs_event_set_uring_update(uring);
+}
+
+ucs_status_t ucs_event_set_uring_mod(ucs_event_set_uring_t *uring, int fd,
+                                     ucs_event_set_type_t events,
+                                     void *callback_data)
+{
+    ucs_event_set_uring_fd_t *fd_entry;
+
+    if (events & UCS_EVENT_SET_EDGE_TRIGGERED) {
+        ucs_error("io_uring event set doesn't support edge-triggered mode "
+                  "(fd=%d)", fd);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    fd_entry = ucs_event_set_uring_fd_find(uring, fd);
+    if (fd_entry == NULL) {
+        ucs_error("io_uring event set (ring_fd=%d): fd %d is not found",
+                  uring->ring_fd, fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    fd_entry->events        = events;
+    fd_entry->callback_data = callback_data;
+
+    ucs_event_set_uring_arm_enqueue(uring, fd_entry);
+    return ucs_event_set_uring_update(uring);
+}
+
+ucs_status_t ucs_event_set_uring_del(ucs_event_set_uring_t *uring, int fd)
+{
+    ucs_event_set_uring_fd_t *fd_entry;
+    ucs_status_t status;
+    khiter_t iter;
+
+    iter = kh_get(ucs_event_set_uring_fds, &uring->fds, fd);
+    if (iter == kh_end(&uring->fds)) {
+        ucs_error("io_uring event set (ring_fd=%d): fd %d is not found",
+                  uring->ring_fd, fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    fd_entry = kh_val(&uring->fds, iter);
+    kh_del(ucs_event_set_uring_fds, &uring->fds, iter);
+
+    if (fd_entry->arm_queued) {
+        ucs_list_del(&fd_entry->list);
+    }
+
+    /* Completion of the removed request is ignored, since the FD is not
+     * found or its poll ID doesn't match */
+    status = UCS_OK;
+    if (fd_entry->poll_id != UCS_EVENT_SET_URING_INTERNAL_ID) {
+        status = ucs_event_set_uring_poll_remove(uring, fd_entry);
+    }
+
+    ucs_free(fd_entry);
+
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    return ucs_event_set_uring_update(uring);
+}
+
+ucs_status_t ucs_event_set_uring_wait(ucs_event_set_uring_t *uring,
+                                      unsigned *num_events, int timeout_ms,
+                                      ucs_event_set_handler_t event_set_handler,
+                                      void *arg)
+{
+    unsigned max_events  = *num_events;
+    unsigned nready      = 0;
+    unsigned min_complete;
+    ucs_event_set_uring_fd_t *fd_entry;
+    struct io_uring_sqe *sqe;
+    struct io_uring_cqe *cqe;
+    ucs_status_t status;
+    uint64_t user_data;
+    void *callback_data;
+    int io_events, res;
+    unsigned head;
+
+    *num_events = 0;
+
+    status = ucs_event_set_uring_arm(uring);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if ((timeout_ms == 0) || (*uring->cq.head != *uring->cq.tail)) {
+        min_complete = 0;
+    } else {
+        min_complete = 1;
+        if (timeout_ms > 0) {
+            status = ucs_event_set_uring_get_sqe(uring, &sqe);
+            if (status != UCS_OK) {
+                return status;
+            }
+
+            /* The timeout request completes by the timeout, or by the
+             * completion of any other request */
+            uring->timeout.tv_sec  = timeout_ms / 1000;
+            uring->timeout.tv_nsec = (timeout_ms % 1000) * 1000000l;
+            sqe->opcode            = IORING_OP_TIMEOUT;
+            sqe->addr              = (uintptr_t)&uring->timeout;
+            sqe->len               = 1;
+            sqe->off               = 1;
+            sqe->user_data         = ucs_event_set_uring_user_data(
+                                          -1, UCS_EVENT_SET_URING_INTERNAL_ID);
+        }
+    }
+
+    /* Submit the changes and get the completed requests by a single call */
+    status = ucs_event_set_uring_enter(uring, min_complete,
+                                       IORING_ENTER_GETEVENTS);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    uring->in_wait = 1;
+
+    head = *uring->cq.head;
+    while (nready < max_events) {
+        ucs_memory_cpu_load_fence();
+        if (head == *uring->cq.tail) {
+            break;
+        }
+
+        cqe       = &uring->cq.cqes[head & uring->cq.mask];
+        user_data = cqe->user_data;
+        res       = cqe->res;
+        ++head;
+
+        if ((uint32_t)user_data == UCS_EVENT_SET_URING_INTERNAL_ID) {
+            continue;
+        }
+
+        fd_entry = ucs_event_set_uring_fd_find(uring, (int)(user_data >> 32));
+        if ((fd_entry == NULL) || (fd_entry->poll_id != (uint32_t)user_data)) {
+            /* The FD was removed or modified */
+            continue;
+        }
+
+        /* Keep the level-triggered semantics of epoll */
+        fd_entry->poll_id = UCS_EVENT_SET_URING_INTERNAL_ID;
+        ucs_event_set_uring_arm_enqueue(uring, fd_entry);
+
+        if (ucs_unlikely(res < 0)) {
+            ucs_debug("io_uring event set (ring_fd=%d): poll of fd %d "
+                      "failed: %s", uring->ring_fd, fd_entry->fd,
+                      strerror(-res));
+            continue;
+        }
+
+        io_events = ucs_event_set_uring_map_to_events(res) &
+                    (fd_entry->events | UCS_EVENT_SET_EVERR);
+        if (io_events == 0) {
+            continue;
+        }
+
+        /* The handler may remove the FD */
+        callback_data = fd_entry->callback_data;
+        ucs_memory_cpu_store_fence();
+        *uring->cq.head = head;
+
+        event_set_handler(callback_data, io_events, arg);
+        ++nready;
+    }
+
+    ucs_memory_cpu_store_fence();
+    *uring->cq.head = head;
+
+    uring->in_wait = 0;
+
+    ucs_trace_poll("io_uring_enter(ring_fd=%d, num_events=%u, timeout=%d) "
+                   "returned %u", uring->ring_fd, max_events, timeout_ms,
+                   nready);
+
+    *num_events = nready;
+
+    /* Re-arm the FDs, to make the event set ready for the next call or for
+     * waiting on its file descriptor */
+    status = ucs_event_set_uring_update(uring);
+    return (status == UCS_INPROGRESS) ? UCS_OK : status;
+}
+
+#else
+
+ucs_status_t ucs_event_set_uring_create(ucs_event_set_uring_t **uring_p)
+{
+    ucs_debug("io_uring is not supported");
+    return UCS_ERR_UNSUPPORTED;
+}
+
+void ucs_event_set_uring_destroy(ucs_event_set_uring_t *uring)
+{
+    ucs_fatal("io_uring is not supported");
+}
+
+int ucs_event_set_uring_fd(ucs_event_set_uring_t *uring)
+{
+    ucs_fatal("io_uring is not supported");
+}
+
+ucs_status_t ucs_event_set_uring_add(ucs_event_set_uring_t *uring, int fd,
+                                     ucs_event_set_type_t events,
+                                     void *callback_data)
+{
+    return UCS_ERR_UNSUPPORTED;
+}
+
+ucs_status_t ucs_event_set_uring_mod(ucs_event_set_uring_t *uring, int fd,
+                                     ucs_event_set_type_t events,
+                                     void *callback_data)
+{
+    return UCS_ERR_UNSUPPORTED;
+}
+
+ucs_status_t ucs_event_set_uring_del(ucs_event_set_uring_t *uring, int fd)
+{
+    return UCS_ERR_UNSUPPORTED;
+}
+
+ucs_status_t ucs_event_set_uring_wait(ucs_event_set_uring_t *uring,
+                                      unsigned *num_events, int timeout_ms,
+                                      ucs_event_set_handler_t event_set_handler,
+                                      void *arg)
+{
+    return UCS_ERR_UNSUPPORTED;
+}
+
+#endif
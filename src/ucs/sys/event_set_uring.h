@@ -0,0 +1,49 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCS_EVENT_SET_URING_H
+#define UCS_EVENT_SET_URING_H
+
+#include "event_set.h"
+
+
+/**
+ * io_uring based implementation of the event set, which is used by
+ * ucs_event_set_XXX functions when UCS_EVENT_SET_BACKEND_IO_URING is
+ * requested.
+ *
+ * File descriptors are watched by one-shot poll requests, which are re-armed
+ * after every reported event to keep the level-triggered semantics of epoll.
+ * Since the readiness is reported asynchronously, an event may be reported
+ * after the file descriptor was drained, so the handler must tolerate EAGAIN.
+ * Poll requests which are (re-)armed while handling events are submitted to
+ * the kernel all together, by a single system call.
+ */
+typedef struct ucs_event_set_uring ucs_event_set_uring_t;
+
+
+ucs_status_t ucs_event_set_uring_create(ucs_event_set_uring_t **uring_p);
+
+void ucs_event_set_uring_destroy(ucs_event_set_uring_t *uring);
+
+int ucs_event_set_uring_fd(ucs_event_set_uring_t *uring);
+
+ucs_status_t ucs_event_set_uring_add(ucs_event_set_uring_t *uring, int fd,
+                                     ucs_event_set_type_t events,
+                                     void *callback_data);
+
+ucs_status_t ucs_event_set_uring_mod(ucs_event_set_uring_t *uring, int fd,
+                                     ucs_event_set_type_t events,
+                                     void *callback_data);
+
+ucs_status_t ucs_event_set_uring_del(ucs_event_set_uring_t *uring, int fd);
+
+ucs_status_t ucs_event_set_uring_wait(ucs_event_set_uring_t *uring,
+                                      unsigned *num_events, int timeout_ms,
+                                      ucs_event_set_handler_t event_set_handler,
+                                      void *arg);
+
+#endif
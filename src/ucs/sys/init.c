@@ -14,6 +14,7 @@
 #include <ucs/stats/stats.h>
 #include <ucs/async/async.h>
 #include <ucs/sys/sys.h>
+#include <ucs/sys/topo.h>
 
 
 /* run-time CPU detection */
@@ -84,6 +85,7 @@ static void UCS_F_CTOR ucs_init()
 #endif
     ucs_memtrack_init();
     ucs_debug_init();
+    ucs_topo_init();
     ucs_profile_global_init();
     ucs_async_global_init();
     ucs_debug("%s loaded at 0x%lx", ucs_debug_get_lib_path(),
@@ -95,6 +97,7 @@ static void UCS_F_DTOR ucs_cleanup(void)
 {
     ucs_async_global_cleanup();
     ucs_profile_global_cleanup();
+    ucs_topo_cleanup();
     ucs_debug_cleanup(0);
     ucs_memtrack_cleanup();
 #if ENABLE_STATS
@@ -285,9 +285,10 @@ ucs_socket_do_io_b(int fd, void *data, size_t length,
 }
 
 static inline ucs_status_t
-ucs_socket_do_iov_nb(int fd, struct iovec *iov, size_t iov_cnt, size_t *length_p,
-                     ucs_socket_iov_func_t iov_func, const char *name,
-                     ucs_socket_io_err_cb_t err_cb, void *err_cb_arg)
+ucs_socket_do_iov_nb(int fd, struct iovec *iov, size_t iov_cnt, int flags,
+                     size_t *length_p, ucs_socket_iov_func_t iov_func,
+                     const char *name, ucs_socket_io_err_cb_t err_cb,
+                     void *err_cb_arg)
 {
     struct msghdr msg = {
         .msg_iov    = iov,
@@ -297,7 +298,7 @@ ucs_socket_do_iov_nb(int fd, struct iovec *iov, size_t iov_cnt, size_t *length_p
 
     ucs_assert(iov_cnt > 0);
 
-    ret = iov_func(fd, &msg, MSG_NOSIGNAL);
+    ret = iov_func(fd, &msg, flags | MSG_NOSIGNAL);
     if (ucs_likely(ret > 0)) {
         *length_p = ret;
         return UCS_OK;
@@ -346,10 +347,19 @@ ucs_status_t
 ucs_socket_sendv_nb(int fd, struct iovec *iov, size_t iov_cnt, size_t *length_p,
                     ucs_socket_io_err_cb_t err_cb, void *err_cb_arg)
 {
-    return ucs_socket_do_iov_nb(fd, iov, iov_cnt, length_p, sendmsg,
+    return ucs_socket_do_iov_nb(fd, iov, iov_cnt, 0, length_p, sendmsg,
                                 "sendv", err_cb, err_cb_arg);
 }
 
+ucs_status_t
+ucs_socket_sendmsg_nb(int fd, struct iovec *iov, size_t iov_cnt, int flags,
+                      size_t *length_p, ucs_socket_io_err_cb_t err_cb,
+                      void *err_cb_arg)
+{
+    return ucs_socket_do_iov_nb(fd, iov, iov_cnt, flags, length_p, sendmsg,
+                                "sendmsg", err_cb, err_cb_arg);
+}
+
 ucs_status_t ucs_sockaddr_sizeof(const struct sockaddr *addr, size_t *size_p)
 {
     switch (addr->sa_family) {
@@ -408,6 +418,40 @@ const void *ucs_sockaddr_get_inet_addr(const struct sockaddr *addr)
     }
 }
 
+ucs_status_t ucs_sockaddr_inet_addr_sizeof(const struct sockaddr *addr,
+                                           size_t *size_p)
+{
+    switch (addr->sa_family) {
+    case AF_INET:
+        *size_p = sizeof(UCS_SOCKET_INET_ADDR(addr));
+        return UCS_OK;
+    case AF_INET6:
+        *size_p = sizeof(UCS_SOCKET_INET6_ADDR(addr));
+        return UCS_OK;
+    default:
+        ucs_error("unknown address family: %d", addr->sa_family);
+        return UCS_ERR_INVALID_PARAM;
+    }
+}
+
+ucs_status_t ucs_sockaddr_set_inet_addr(struct sockaddr *addr,
+                                        const void *in_addr)
+{
+    switch (addr->sa_family) {
+    case AF_INET:
+        memcpy(&UCS_SOCKET_INET_ADDR(addr), in_addr,
+               sizeof(UCS_SOCKET_INET_ADDR(addr)));
+        return UCS_OK;
+    case AF_INET6:
+        memcpy(&UCS_SOCKET_INET6_ADDR(addr), in_addr,
+               sizeof(UCS_SOCKET_INET6_ADDR(addr)));
+        return UCS_OK;
+    default:
+        ucs_error("unknown address family: %d", addr->sa_family);
+        return UCS_ERR_INVALID_PARAM;
+    }
+}
+
 static unsigned ucs_sockaddr_is_known_af(const struct sockaddr *sa)
 {
     return ((sa->sa_family == AF_INET) ||
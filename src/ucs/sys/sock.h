@@ -221,6 +221,32 @@ ucs_status_t ucs_socket_sendv_nb(int fd, struct iovec *iov, size_t iov_cnt,
                                  void *err_cb_arg);
 
 
+/**
+ * Non-blocking send operation sends I/O vector on the connected socket
+ * referred to by the file descriptor `fd`, passing additional `flags` (e.g.
+ * MSG_ZEROCOPY) to sendmsg().
+ *
+ * @param [in]      fd              Socket fd.
+ * @param [in]      iov             A pointer to an array of iovec buffers.
+ * @param [in]      iov_cnt         The number of buffers pointed to by
+ *                                  the iov parameter.
+ * @param [in]      flags           Flags passed to sendmsg() in addition to
+ *                                  MSG_NOSIGNAL.
+ * @param [out]     length_p        The amount of data transmitted is written to
+ *                                  this argument.
+ * @param [in]      err_cb          Error callback.
+ * @param [in]      err_cb_arg      User's argument for the error callback.
+ *
+ * @return UCS_OK on success, UCS_ERR_CANCELED if connection closed,
+ *         UCS_ERR_NO_PROGRESS if system call was interrupted or
+ *         would block, UCS_ERR_IO_ERROR on failure.
+ */
+ucs_status_t ucs_socket_sendmsg_nb(int fd, struct iovec *iov, size_t iov_cnt,
+                                   int flags, size_t *length_p,
+                                   ucs_socket_io_err_cb_t err_cb,
+                                   void *err_cb_arg);
+
+
 /**
  * Blocking receive operation receives data from the connected (or bound
  * connectionless) socket referred to by the file descriptor `fd`.
@@ -287,6 +313,32 @@ ucs_status_t ucs_sockaddr_set_port(struct sockaddr *addr, uint16_t port);
 const void *ucs_sockaddr_get_inet_addr(const struct sockaddr *addr);
 
 
+/**
+ * Return size of IP addr of a given sockaddr structure.
+ *
+ * @param [in]   addr       Pointer to sockaddr structure.
+ * @param [out]  size_p     Pointer to variable where size of in_addr/in6_addr
+ *                          of sockaddr_in/sockaddr_in6 structure will be written
+ *
+ * @return UCS_OK on success or UCS_ERR_INVALID_PARAM on failure.
+ */
+ucs_status_t ucs_sockaddr_inet_addr_sizeof(const struct sockaddr *addr,
+                                           size_t *size_p);
+
+
+/**
+ * Set IP addr to a given sockaddr structure.
+ *
+ * @param [in]   addr       Pointer to sockaddr structure.
+ * @param [in]   in_addr    IP address (in_addr/in6_addr, according to the
+ *                          address family of sockaddr) that will be written
+ *
+ * @return UCS_OK on success or UCS_ERR_INVALID_PARAM on failure.
+ */
+ucs_status_t ucs_sockaddr_set_inet_addr(struct sockaddr *addr,
+                                        const void *in_addr);
+
+
 /**
  * Extract the IP address from a given sockaddr and return it as a string.
  *
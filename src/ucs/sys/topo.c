@@ -4,25 +4,484 @@
 * See file LICENSE for terms.
 */
 
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
 #include <ucs/sys/topo.h>
+#include <ucs/sys/string.h>
+#include <ucs/sys/sys.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
 #include <ucs/type/status.h>
+#include <ucs/type/cpu_set.h>
+#include <dirent.h>
+#include <float.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 
+
+#define UCS_TOPO_SYSFS_ROOT          "/sys"
+#define UCS_TOPO_NUMA_DIR            "devices/system/node"
+#define UCS_TOPO_PCI_DIR             "bus/pci/devices"
+#define UCS_TOPO_BUS_ID_FMT          "%04x:%02x:%02x.%x"
+#define UCS_TOPO_BUS_ID_ARG(_id)     (_id)->domain, (_id)->bus, (_id)->slot, \
+                                     (_id)->function
+
+/* Local NUMA distance, as reported by the ACPI SLIT table */
+#define UCS_TOPO_NUMA_MIN_DISTANCE   10
+
+/* Extra latency per distance unit above the local distance */
+#define UCS_TOPO_NUMA_HOP_LATENCY    20e-9
+
+/* Bandwidth of a remote NUMA node which is 10 distance units away */
+#define UCS_TOPO_NUMA_BANDWIDTH      20e9
+
+
+typedef struct ucs_topo_numa_node {
+    int                  id;            /* NUMA node number */
+    char                 cpulist[128];  /* CPUs of the node, as reported by sysfs */
+} ucs_topo_numa_node_t;
+
+
+/* Topology information, discovered once from sysfs */
+static struct {
+    char                 sysfs_root[PATH_MAX];
+    ucs_topo_numa_node_t *numa_nodes;    /* NUMA nodes, sorted by id */
+    unsigned             num_numa_nodes;
+    unsigned             *distances;     /* num_numa_nodes^2 distance matrix */
+    int16_t              cpu_numa_node[UCS_CPU_SETSIZE]; /* -1 if unknown */
+    ucs_sys_device_t     *devices;       /* PCI devices, sorted by bus id */
+    unsigned             num_devices;
+} ucs_topo_ctx = {
+    .numa_nodes     = NULL,
+    .num_numa_nodes = 0,
+    .distances      = NULL,
+    .devices        = NULL,
+    .num_devices    = 0
+};
+
+
+static int ucs_topo_bus_id_cmp(const ucs_sys_bus_id_t *bus_id1,
+                               const ucs_sys_bus_id_t *bus_id2)
+{
+    if (bus_id1->domain != bus_id2->domain) {
+        return (int)bus_id1->domain - (int)bus_id2->domain;
+    } else if (bus_id1->bus != bus_id2->bus) {
+        return (int)bus_id1->bus - (int)bus_id2->bus;
+    } else if (bus_id1->slot != bus_id2->slot) {
+        return (int)bus_id1->slot - (int)bus_id2->slot;
+    } else {
+        return (int)bus_id1->function - (int)bus_id2->function;
+    }
+}
+
+static int ucs_topo_device_cmp(const void *ptr1, const void *ptr2)
+{
+    return ucs_topo_bus_id_cmp(&((const ucs_sys_device_t*)ptr1)->bus_id,
+                               &((const ucs_sys_device_t*)ptr2)->bus_id);
+}
+
+static int ucs_topo_numa_node_cmp(const void *ptr1, const void *ptr2)
+{
+    return ((const ucs_topo_numa_node_t*)ptr1)->id -
+           ((const ucs_topo_numa_node_t*)ptr2)->id;
+}
+
+static int ucs_topo_parse_bus_id(const char *str, ucs_sys_bus_id_t *bus_id)
+{
+    unsigned domain, bus, slot, function;
+    char dummy;
+
+    if (sscanf(str, "%x:%x:%x.%x%c", &domain, &bus, &slot, &function,
+               &dummy) != 4) {
+        return 0;
+    }
+
+    bus_id->domain   = domain;
+    bus_id->bus      = bus;
+    bus_id->slot     = slot;
+    bus_id->function = function;
+    return 1;
+}
+
+static int ucs_topo_numa_node_index(int numa_node)
+{
+    unsigned i;
+
+    for (i = 0; i < ucs_topo_ctx.num_numa_nodes; ++i) {
+        if (ucs_topo_ctx.numa_nodes[i].id == numa_node) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/* Parse a CPU list such as "0-3,8,10-11" and map the CPUs to a NUMA node */
+static void ucs_topo_set_cpu_list(const char *cpulist, int numa_node)
+{
+    const char *p = cpulist;
+    long first, last, cpu;
+    char *endp;
+
+    while (*p != '\0') {
+        first = strtol(p, &endp, 10);
+        if (endp == p) {
+            break;
+        }
+
+        last = first;
+        if (*endp == '-') {
+            p    = endp + 1;
+            last = strtol(p, &endp, 10);
+            if (endp == p) {
+                break;
+            }
+        }
+
+        for (cpu = ucs_max(first, 0); cpu <= ucs_min(last, UCS_CPU_SETSIZE - 1);
+             ++cpu) {
+            ucs_topo_ctx.cpu_numa_node[cpu] = numa_node;
+        }
+
+        p = endp;
+        if (*p == ',') {
+            ++p;
+        } else if (*p != '\n') {
+            break;
+        }
+    }
+}
+
+static ucs_status_t ucs_topo_discover_numa_nodes()
+{
+    ucs_topo_numa_node_t *numa_node, *numa_nodes;
+    char buffer[1024], *p, *endp;
+    struct dirent *entry;
+    unsigned i, j;
+    int node_id;
+    DIR *dir;
+
+    ucs_snprintf_zero(buffer, sizeof(buffer), "%s/%s",
+                      ucs_topo_ctx.sysfs_root, UCS_TOPO_NUMA_DIR);
+    dir = opendir(buffer);
+    if (dir == NULL) {
+        ucs_debug("opendir(%s) failed: %m, assuming no NUMA", buffer);
+        return UCS_OK;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if ((sscanf(entry->d_name, "node%d%c", &node_id, buffer) != 1) ||
+            (node_id < 0)) {
+            continue;
+        }
+
+        numa_nodes = ucs_realloc(ucs_topo_ctx.numa_nodes,
+                                 (ucs_topo_ctx.num_numa_nodes + 1) *
+                                 sizeof(*numa_nodes), "topo_numa_nodes");
+        if (numa_nodes == NULL) {
+            closedir(dir);
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        ucs_topo_ctx.numa_nodes = numa_nodes;
+        numa_node               = &numa_nodes[ucs_topo_ctx.num_numa_nodes++];
+        numa_node->id           = node_id;
+        if (ucs_read_file_str(numa_node->cpulist, sizeof(numa_node->cpulist),
+                              1, "%s/%s/node%d/cpulist",
+                              ucs_topo_ctx.sysfs_root, UCS_TOPO_NUMA_DIR,
+                              node_id) < 0) {
+            numa_node->cpulist[0] = '\0';
+        }
+        ucs_strtrim(numa_node->cpulist);
+    }
+    closedir(dir);
+
+    qsort(ucs_topo_ctx.numa_nodes, ucs_topo_ctx.num_numa_nodes,
+          sizeof(*ucs_topo_ctx.numa_nodes), ucs_topo_numa_node_cmp);
+
+    ucs_topo_ctx.distances = ucs_calloc(ucs_topo_ctx.num_numa_nodes *
+                                        ucs_topo_ctx.num_numa_nodes,
+                                        sizeof(*ucs_topo_ctx.distances),
+                                        "topo_numa_distances");
+    if ((ucs_topo_ctx.distances == NULL) && (ucs_topo_ctx.num_numa_nodes > 0)) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    /* The distance file lists the distances to all nodes in ascending order
+     * of node id. Missing entries are assumed to be remote. */
+    for (i = 0; i < ucs_topo_ctx.num_numa_nodes; ++i) {
+        numa_node = &ucs_topo_ctx.numa_nodes[i];
+        ucs_topo_set_cpu_list(numa_node->cpulist, numa_node->id);
+
+        if (ucs_read_file_str(buffer, sizeof(buffer), 1, "%s/%s/node%d/distance",
+                              ucs_topo_ctx.sysfs_root, UCS_TOPO_NUMA_DIR,
+                              numa_node->id) < 0) {
+            buffer[0] = '\0';
+        }
+
+        p = buffer;
+        for (j = 0; j < ucs_topo_ctx.num_numa_nodes; ++j) {
+            ucs_topo_ctx.distances[(i * ucs_topo_ctx.num_numa_nodes) + j] =
+                            (i == j) ? UCS_TOPO_NUMA_MIN_DISTANCE :
+                                       2 * UCS_TOPO_NUMA_MIN_DISTANCE;
+            if (p != NULL) {
+                node_id = strtol(p, &endp, 10);
+                if ((endp != p) && (node_id >= UCS_TOPO_NUMA_MIN_DISTANCE)) {
+                    ucs_topo_ctx.distances[(i * ucs_topo_ctx.num_numa_nodes) + j] =
+                                    node_id;
+                    p = endp;
+                } else {
+                    p = NULL;
+                }
+            }
+        }
+    }
+
+    return UCS_OK;
+}
+
+static ucs_status_t ucs_topo_discover_pci_devices()
+{
+    ucs_sys_device_t *device, *devices;
+    ucs_sys_bus_id_t bus_id;
+    struct dirent *entry;
+    char path[PATH_MAX];
+    long numa_node;
+    unsigned i;
+    DIR *dir;
+
+    ucs_snprintf_zero(path, sizeof(path), "%s/%s", ucs_topo_ctx.sysfs_root,
+                      UCS_TOPO_PCI_DIR);
+    dir = opendir(path);
+    if (dir == NULL) {
+        ucs_debug("opendir(%s) failed: %m, assuming no PCI devices", path);
+        return UCS_OK;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (!ucs_topo_parse_bus_id(entry->d_name, &bus_id)) {
+            continue;
+        }
+
+        devices = ucs_realloc(ucs_topo_ctx.devices,
+                              (ucs_topo_ctx.num_devices + 1) * sizeof(*devices),
+                              "topo_devices");
+        if (devices == NULL) {
+            closedir(dir);
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        ucs_topo_ctx.devices = devices;
+        device               = &devices[ucs_topo_ctx.num_devices++];
+        device->bus_id       = bus_id;
+        if (ucs_read_file_number(&numa_node, 1, "%s/%s/%s/numa_node",
+                                 ucs_topo_ctx.sysfs_root, UCS_TOPO_PCI_DIR,
+                                 entry->d_name) != UCS_OK) {
+            numa_node = -1;
+        }
+
+        /* A single-node system may not report the node of its devices */
+        if ((numa_node < 0) && (ucs_topo_ctx.num_numa_nodes == 1)) {
+            numa_node = ucs_topo_ctx.numa_nodes[0].id;
+        }
+        device->numa_node    = numa_node;
+    }
+    closedir(dir);
+
+    qsort(ucs_topo_ctx.devices, ucs_topo_ctx.num_devices,
+          sizeof(*ucs_topo_ctx.devices), ucs_topo_device_cmp);
+    for (i = 0; i < ucs_topo_ctx.num_devices; ++i) {
+        ucs_topo_ctx.devices[i].id = i;
+    }
+
+    return UCS_OK;
+}
+
+static void ucs_topo_release()
+{
+    ucs_free(ucs_topo_ctx.numa_nodes);
+    ucs_free(ucs_topo_ctx.distances);
+    ucs_free(ucs_topo_ctx.devices);
+    ucs_topo_ctx.numa_nodes     = NULL;
+    ucs_topo_ctx.num_numa_nodes = 0;
+    ucs_topo_ctx.distances      = NULL;
+    ucs_topo_ctx.devices        = NULL;
+    ucs_topo_ctx.num_devices    = 0;
+}
+
+ucs_status_t ucs_topo_discover(const char *sysfs_root)
+{
+    ucs_status_t status;
+    unsigned cpu;
+
+    ucs_topo_release();
+
+    ucs_strncpy_zero(ucs_topo_ctx.sysfs_root, sysfs_root,
+                     sizeof(ucs_topo_ctx.sysfs_root));
+    for (cpu = 0; cpu < UCS_CPU_SETSIZE; ++cpu) {
+        ucs_topo_ctx.cpu_numa_node[cpu] = -1;
+    }
+
+    status = ucs_topo_discover_numa_nodes();
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    status = ucs_topo_discover_pci_devices();
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    ucs_debug("topology under %s: %u NUMA nodes, %u PCI devices", sysfs_root,
+              ucs_topo_ctx.num_numa_nodes, ucs_topo_ctx.num_devices);
+    return UCS_OK;
+
+err:
+    ucs_error("failed to discover system topology under %s: %s", sysfs_root,
+              ucs_status_string(status));
+    ucs_topo_release();
+    return status;
+}
+
+void ucs_topo_init()
+{
+    ucs_topo_discover(UCS_TOPO_SYSFS_ROOT);
+}
+
+void ucs_topo_cleanup()
+{
+    ucs_topo_release();
+}
+
 ucs_status_t ucs_topo_find_device_by_bus_id(const ucs_sys_bus_id_t *bus_id,
                                             const ucs_sys_device_t **sys_dev)
 {
-    return UCS_OK;
+    ucs_sys_device_t key;
+
+    if ((bus_id == NULL) || (sys_dev == NULL)) {
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    key.bus_id = *bus_id;
+    *sys_dev   = bsearch(&key, ucs_topo_ctx.devices, ucs_topo_ctx.num_devices,
+                         sizeof(*ucs_topo_ctx.devices), ucs_topo_device_cmp);
+    return (*sys_dev != NULL) ? UCS_OK : UCS_ERR_NO_ELEM;
+}
+
+ucs_status_t ucs_topo_find_device_by_sysfs_path(const char *dev_path,
+                                                const ucs_sys_device_t **sys_dev)
+{
+    char path[PATH_MAX], real_path[PATH_MAX];
+    ucs_sys_bus_id_t bus_id;
+    char *name;
+
+    /* The "device" link points to the PCI function, possibly through a
+     * virtual function or a bridge */
+    ucs_snprintf_zero(path, sizeof(path), "%s/%s/device",
+                      ucs_topo_ctx.sysfs_root, dev_path);
+    if (realpath(path, real_path) == NULL) {
+        ucs_debug("failed to resolve %s: %m", path);
+        return UCS_ERR_NO_ELEM;
+    }
+
+    name = strrchr(real_path, '/');
+    if ((name == NULL) || !ucs_topo_parse_bus_id(name + 1, &bus_id)) {
+        ucs_debug("%s is not a PCI device", real_path);
+        return UCS_ERR_NO_ELEM;
+    }
+
+    return ucs_topo_find_device_by_bus_id(&bus_id, sys_dev);
 }
 
+int ucs_topo_numa_node_of_cpu(int cpu)
+{
+    if ((cpu < 0) || (cpu >= UCS_CPU_SETSIZE)) {
+        return -1;
+    }
+
+    return ucs_topo_ctx.cpu_numa_node[cpu];
+}
+
+int ucs_topo_get_local_numa_node()
+{
+    return ucs_topo_numa_node_of_cpu(sched_getcpu());
+}
+
+static unsigned ucs_topo_numa_distance(int numa_node1, int numa_node2)
+{
+    int index1 = ucs_topo_numa_node_index(numa_node1);
+    int index2 = ucs_topo_numa_node_index(numa_node2);
+
+    /* Unknown location is considered local */
+    if ((index1 < 0) || (index2 < 0)) {
+        return UCS_TOPO_NUMA_MIN_DISTANCE;
+    }
+
+    return ucs_topo_ctx.distances[(index1 * ucs_topo_ctx.num_numa_nodes) +
+                                  index2];
+}
 
 ucs_status_t ucs_topo_get_distance(const ucs_sys_device_t *device1,
                                    const ucs_sys_device_t *device2,
                                    ucs_sys_dev_distance_t *distance)
 {
+    int numa_node1, numa_node2;
+    unsigned numa_distance;
+
+    if (distance == NULL) {
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    numa_node1 = (device1 != NULL) ? device1->numa_node :
+                                     ucs_topo_get_local_numa_node();
+    numa_node2 = (device2 != NULL) ? device2->numa_node :
+                                     ucs_topo_get_local_numa_node();
+
+    numa_distance = ucs_topo_numa_distance(numa_node1, numa_node2);
+    if (numa_distance <= UCS_TOPO_NUMA_MIN_DISTANCE) {
+        distance->latency   = 0;
+        distance->bandwidth = DBL_MAX;
+    } else {
+        distance->latency   = (numa_distance - UCS_TOPO_NUMA_MIN_DISTANCE) *
+                              UCS_TOPO_NUMA_HOP_LATENCY;
+        distance->bandwidth = UCS_TOPO_NUMA_BANDWIDTH *
+                              UCS_TOPO_NUMA_MIN_DISTANCE /
+                              (numa_distance - UCS_TOPO_NUMA_MIN_DISTANCE);
+    }
+
     return UCS_OK;
 }
 
-
 void ucs_topo_print_info(FILE *stream)
 {
+    const ucs_topo_numa_node_t *numa_node;
+    const ucs_sys_device_t *device;
+    unsigned i, j;
+
+    if (stream == NULL) {
+        return;
+    }
+
+    fprintf(stream, "# NUMA nodes: %u\n", ucs_topo_ctx.num_numa_nodes);
+    for (i = 0; i < ucs_topo_ctx.num_numa_nodes; ++i) {
+        numa_node = &ucs_topo_ctx.numa_nodes[i];
+        fprintf(stream, "#     node %-3d cpus: %-24s distance:", numa_node->id,
+                numa_node->cpulist);
+        for (j = 0; j < ucs_topo_ctx.num_numa_nodes; ++j) {
+            fprintf(stream, " %3u",
+                    ucs_topo_ctx.distances[(i * ucs_topo_ctx.num_numa_nodes) + j]);
+        }
+        fprintf(stream, "\n");
+    }
+
+    fprintf(stream, "# PCI devices: %u\n", ucs_topo_ctx.num_devices);
+    for (device = ucs_topo_ctx.devices;
+         device < ucs_topo_ctx.devices + ucs_topo_ctx.num_devices; ++device) {
+        fprintf(stream, "#     "UCS_TOPO_BUS_ID_FMT" numa node %d\n",
+                UCS_TOPO_BUS_ID_ARG(&device->bus_id), device->numa_node);
+    }
 }
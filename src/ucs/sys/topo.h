@@ -16,6 +16,10 @@ BEGIN_C_DECLS
 
 /** @file topo.h */
 
+
+/* System device index used when the device location is unknown */
+#define UCS_SYS_DEVICE_ID_UNKNOWN UINT_MAX
+
 typedef struct ucs_sys_bus_id {
     uint16_t domain;   /* range: 0 to ffff */
     uint8_t  bus;      /* range: 0 to ff */
@@ -46,6 +50,18 @@ typedef struct ucs_sys_dev_distance {
 } ucs_sys_dev_distance_t;
 
 
+/**
+ * Discover the system topology (NUMA nodes, their CPUs and distances, and PCI
+ * devices) from a sysfs tree, and replace the cached topology information.
+ *
+ * @param [in] sysfs_root  Root of the sysfs tree, normally "/sys".
+ *
+ * @return UCS_OK, or error if the topology information could not be stored.
+ *         Missing sysfs entries are not an error.
+ */
+ucs_status_t ucs_topo_discover(const char *sysfs_root);
+
+
 /**
  * Find system device by pci bus id
  *
@@ -59,12 +75,39 @@ ucs_status_t ucs_topo_find_device_by_bus_id(const ucs_sys_bus_id_t *bus_id,
                                             const ucs_sys_device_t **sys_dev);
 
 
+/**
+ * Find the PCI device backing a sysfs device entry.
+ *
+ * @param [in]  dev_path  Device path relative to the sysfs root, for example
+ *                        "class/net/eth0" or "class/infiniband/mlx5_0".
+ * @param [out] sys_dev   Filled with the system device of the entry.
+ *
+ * @return UCS_OK, or UCS_ERR_NO_ELEM if the entry is not a known PCI device.
+ */
+ucs_status_t ucs_topo_find_device_by_sysfs_path(const char *dev_path,
+                                                const ucs_sys_device_t **sys_dev);
+
+
+/**
+ * @return NUMA node of the given CPU, or -1 if unknown.
+ */
+int ucs_topo_numa_node_of_cpu(int cpu);
+
+
+/**
+ * @return NUMA node of the CPU the calling thread runs on, or -1 if unknown.
+ */
+int ucs_topo_get_local_numa_node();
+
+
 /**
  * Find the distance between two system devices (in terms of latency,
  * bandwidth, hops, etc)
  *
- * @param [in]     device1 ucs_sys_device_t pointing to the first device
- * @param [in]     device2 ucs_sys_device_t pointing to the second device
+ * @param [in]     device1 ucs_sys_device_t pointing to the first device, or
+ *                         NULL for the CPU of the calling thread
+ * @param [in]     device2 ucs_sys_device_t pointing to the second device, or
+ *                         NULL for the CPU of the calling thread
  * @param [in/out] result  pointer to ucs_sys_dev_distance_t
  *                         populated with distance details between the two
  *                         devices
@@ -80,6 +123,18 @@ ucs_status_t ucs_topo_get_distance(const ucs_sys_device_t *device1,
  */
 void ucs_topo_print_info(FILE *stream);
 
+
+/**
+ * Discover the topology of the local system. Called during UCS initialization.
+ */
+void ucs_topo_init();
+
+
+/**
+ * Release the cached topology information.
+ */
+void ucs_topo_cleanup();
+
 END_C_DECLS
 
 #endif
@@ -6,12 +6,64 @@
 
 #include <ucs/time/timer_wheel.h>
 
+#include <ucs/arch/bitops.h>
 #include <ucs/debug/assert.h>
 #include <ucs/debug/log.h>
 #include <ucs/debug/memtrack.h>
 #include <ucs/sys/math.h>
 
 
+static UCS_F_ALWAYS_INLINE ucs_list_link_t *
+ucs_twheel_slot(ucs_twheel_t *t, unsigned level, unsigned slot)
+{
+    return &t->wheel[(level * UCS_TWHEEL_NUM_SLOTS) + slot];
+}
+
+static UCS_F_ALWAYS_INLINE unsigned ucs_twheel_level_shift(unsigned level)
+{
+    return level * UCS_TWHEEL_SLOT_BITS;
+}
+
+static void ucs_twheel_insert(ucs_twheel_t *t, ucs_wtimer_t *timer)
+{
+    uint64_t delta = timer->expiration - t->current;
+    unsigned level, slot;
+
+    ucs_assert(timer->expiration >= t->current);
+    ucs_assert(delta < UCS_TWHEEL_MAX_TICKS);
+
+    /* find the lowest level which covers the expiration tick */
+    level = 0;
+    while (delta >= UCS_BIT(ucs_twheel_level_shift(level + 1))) {
+        ++level;
+    }
+
+    slot = (timer->expiration >> ucs_twheel_level_shift(level)) &
+           UCS_MASK(UCS_TWHEEL_SLOT_BITS);
+    ucs_list_add_tail(ucs_twheel_slot(t, level, slot), &timer->list);
+    t->occupied[level] |= UCS_BIT(slot);
+}
+
+/*
+ * Return the first tick after the current one at which a non-empty slot of
+ * the given level is reached.
+ */
+static UCS_F_ALWAYS_INLINE uint64_t
+ucs_twheel_next_tick(ucs_twheel_t *t, unsigned level)
+{
+    unsigned shift    = ucs_twheel_level_shift(level);
+    uint64_t index    = t->current >> shift;
+    uint64_t occupied = t->occupied[level];
+    unsigned rot;
+
+    /* rotate the bitmap so that the slot after the current one is bit 0 */
+    rot      = (index + 1) & UCS_MASK(UCS_TWHEEL_SLOT_BITS);
+    occupied = (occupied >> rot) |
+               (occupied << ((UCS_TWHEEL_NUM_SLOTS - rot) &
+                             UCS_MASK(UCS_TWHEEL_SLOT_BITS)));
+    return (index + 1 + ucs_ffs64(occupied)) << shift;
+}
+
 ucs_status_t ucs_twheel_init(ucs_twheel_t *twheel, ucs_time_t resolution,
                              ucs_time_t current_time)
 {
@@ -19,19 +71,23 @@ ucs_status_t ucs_twheel_init(ucs_twheel_t *twheel, ucs_time_t resolution,
 
     twheel->res         = ucs_roundup_pow2(resolution);
     twheel->res_order   = (unsigned) ucs_log2(twheel->res);
-    twheel->num_slots   = 1024;
-    twheel->current     = 0;
+    twheel->current     = current_time >> twheel->res_order;
     twheel->now         = current_time;
-    twheel->wheel       = ucs_malloc(sizeof(*twheel->wheel) * twheel->num_slots,
+    twheel->wheel       = ucs_malloc(sizeof(*twheel->wheel) *
+                                     UCS_TWHEEL_NUM_LEVELS * UCS_TWHEEL_NUM_SLOTS,
                                      "twheel");
     if (twheel->wheel == NULL) {
         return UCS_ERR_NO_MEMORY;
     }
 
-    for (i = 0; i < twheel->num_slots; i++) {
+    for (i = 0; i < UCS_TWHEEL_NUM_LEVELS * UCS_TWHEEL_NUM_SLOTS; i++) {
         ucs_list_head_init(&twheel->wheel[i]);
     }
 
+    for (i = 0; i < UCS_TWHEEL_NUM_LEVELS; i++) {
+        twheel->occupied[i] = 0;
+    }
+
     ucs_debug("high res timer created log=%d resolution=%lf usec wanted: %lf usec",
               twheel->res_order, ucs_time_to_usec(twheel->res), ucs_time_to_usec(resolution));
     return UCS_OK;
@@ -51,48 +107,101 @@ ucs_status_t ucs_wtimer_init(ucs_wtimer_t *t, ucs_twheel_callback_t cb)
 
 void __ucs_wtimer_add(ucs_twheel_t *t, ucs_wtimer_t *timer, ucs_time_t delta)
 {
-    uint64_t slot;
+    uint64_t ticks;
 
     timer->is_active = 1;
-    slot = delta>>t->res_order;
-    if (ucs_unlikely(slot == 0)) {
+    ticks = delta>>t->res_order;
+    if (ucs_unlikely(ticks == 0)) {
         /* nothing really wrong with adding timer to the current slot. However
          * we want to guard against the case we spend to much time in hi res
          * timer processing */
         ucs_fatal("Timer resolution is too low. Min resolution %lf usec, wanted %lf usec",
                 ucs_time_to_usec(t->res), ucs_time_to_usec(delta));
     }
-    ucs_assert(slot > 0);
+    ucs_assert(ticks > 0);
+
+    if (ucs_unlikely(ticks >= UCS_TWHEEL_MAX_TICKS)) {
+        ticks = UCS_TWHEEL_MAX_TICKS - 1;
+    }
 
-    if (ucs_unlikely(slot >= t->num_slots)) {
-        slot = t->num_slots - 1;
+    timer->expiration = t->current + ticks;
+    ucs_twheel_insert(t, timer);
+}
+
+/* Move the timers of a slot to the lower levels */
+static void ucs_twheel_cascade(ucs_twheel_t *t, unsigned level, unsigned slot)
+{
+    ucs_list_link_t *head = ucs_twheel_slot(t, level, slot);
+    ucs_list_link_t timers;
+    ucs_wtimer_t *timer, *tmp;
+
+    t->occupied[level] &= ~UCS_BIT(slot);
+    if (ucs_list_is_empty(head)) {
+        return;
     }
 
-    slot = (t->current + slot) % t->num_slots;
-    ucs_assert(slot != t->current);
+    ucs_list_head_init(&timers);
+    ucs_list_splice_tail(&timers, head);
+    ucs_list_head_init(head);
 
-    ucs_list_add_tail(&t->wheel[slot], &timer->list);
+    ucs_list_for_each_safe(timer, tmp, &timers, list) {
+        ucs_twheel_insert(t, timer);
+    }
 }
 
-void __ucs_twheel_sweep(ucs_twheel_t *t, ucs_time_t current_time)
+static void ucs_twheel_dispatch(ucs_twheel_t *t, unsigned slot)
 {
+    ucs_list_link_t *head = ucs_twheel_slot(t, 0, slot);
     ucs_wtimer_t *timer;
-    uint64_t slot;
 
-    slot   = (current_time - t->now) >> t->res_order;
+    /* callbacks may add timers, but never to the current slot */
+    while (!ucs_list_is_empty(head)) {
+        timer = ucs_list_extract_head(head, ucs_wtimer_t, list);
+        ucs_assert(timer->expiration == t->current);
+        timer->is_active = 0;
+        timer->cb(timer);
+    }
+
+    t->occupied[0] &= ~UCS_BIT(slot);
+}
+
+void __ucs_twheel_sweep(ucs_twheel_t *t, ucs_time_t current_time)
+{
+    uint64_t target = current_time >> t->res_order;
+    uint64_t next, tick;
+    unsigned level, shift;
+
     t->now = current_time;
 
-    if (ucs_unlikely(slot >= t->num_slots)) {
-        slot = t->num_slots - 1;
-    }
+    for (;;) {
+        /* find the nearest tick which has work on any level */
+        next = UINT64_MAX;
+        for (level = 0; level < UCS_TWHEEL_NUM_LEVELS; ++level) {
+            if (t->occupied[level] != 0) {
+                tick = ucs_twheel_next_tick(t, level);
+                next = ucs_min(next, tick);
+            }
+        }
 
-    slot = (t->current + slot) % t->num_slots;
+        if (next > target) {
+            break;
+        }
+
+        t->current = next;
 
-    for (; t->current != slot; t->current = (t->current+1) % t->num_slots) {
-        while (!ucs_list_is_empty(&t->wheel[t->current])) {
-            timer = ucs_list_extract_head(&t->wheel[t->current], ucs_wtimer_t, list);
-            timer->is_active = 0;
-            timer->cb(timer);
+        /* cascade from the top so timers may fall through several levels */
+        for (level = UCS_TWHEEL_NUM_LEVELS - 1; level > 0; --level) {
+            shift = ucs_twheel_level_shift(level);
+            if ((next & UCS_MASK(shift)) == 0) {
+                ucs_twheel_cascade(t, level, (next >> shift) &
+                                             UCS_MASK(UCS_TWHEEL_SLOT_BITS));
+            }
         }
+
+        ucs_twheel_dispatch(t, next & UCS_MASK(UCS_TWHEEL_SLOT_BITS));
+    }
+
+    if (target > t->current) {
+        t->current = target;
     }
 }
@@ -10,6 +10,17 @@
 #include <ucs/datastruct/list.h>
 #include <ucs/time/time.h>
 #include <ucs/debug/log.h>
+#include <ucs/sys/compiler_def.h>
+
+
+/* Number of slots in every level of the wheel, log2 */
+#define UCS_TWHEEL_SLOT_BITS    6
+#define UCS_TWHEEL_NUM_SLOTS    UCS_BIT(UCS_TWHEEL_SLOT_BITS)
+
+/* Number of levels. Every slot of a level covers all slots of the level below,
+ * so the wheel range is UCS_TWHEEL_MAX_TICKS times the resolution. */
+#define UCS_TWHEEL_NUM_LEVELS   4
+#define UCS_TWHEEL_MAX_TICKS    UCS_BIT(UCS_TWHEEL_SLOT_BITS * UCS_TWHEEL_NUM_LEVELS)
 
 
 /* Forward declarations */
@@ -29,17 +40,27 @@ typedef void (*ucs_twheel_callback_t)(ucs_wtimer_t *self);
 struct ucs_wtimer {
     ucs_twheel_callback_t  cb;         /* User callback */
     ucs_list_link_t        list;       /* Link in the list of timers */
+    uint64_t               expiration; /* Expiration tick */
     int                    is_active;
 };
 
 
+/**
+ * Hierarchical timer wheel.
+ *
+ * A timer is placed on the lowest level whose range covers its expiration,
+ * and is moved ("cascaded") to a lower level when the wheel reaches the
+ * beginning of its slot. Every level keeps a bitmap of non-empty slots, so a
+ * sweep jumps directly between occupied slots instead of walking idle ones.
+ * Bits are cleared lazily, since removing a timer does not track its slot.
+ */
 struct ucs_timer_wheel {
     ucs_time_t             res;
     ucs_time_t             now;        /* when wheel was last updated */
-    uint64_t               current;
-    ucs_list_link_t        *wheel;
+    uint64_t               current;    /* current tick, now >> res_order */
+    ucs_list_link_t        *wheel;     /* Slots, UCS_TWHEEL_NUM_SLOTS per level */
     unsigned               res_order;
-    unsigned               num_slots;
+    uint64_t               occupied[UCS_TWHEEL_NUM_LEVELS]; /* Non-empty slots */
 };
 
 
@@ -47,7 +68,8 @@ struct ucs_timer_wheel {
  * Initialize the timer queue.
  *
  * @param twheel        Timer queue to initialize.
- * @param resolution    Timer resolution. Timer wheel range is from now to now + UCS_TWHEEL_NSLOTS * res
+ * @param resolution    Timer resolution. Timer wheel range is from now to
+ *                      now + UCS_TWHEEL_MAX_TICKS * res
  * @param current_time  Current time to initialize the timer with.
  */
 ucs_status_t ucs_twheel_init(ucs_twheel_t *twheel, ucs_time_t resolution,
@@ -82,7 +104,7 @@ ucs_status_t ucs_wtimer_init(ucs_wtimer_t *t, ucs_twheel_callback_t cb);
 void __ucs_twheel_sweep(ucs_twheel_t *t, ucs_time_t current_time);
 static inline void ucs_twheel_sweep(ucs_twheel_t *t, ucs_time_t current_time)
 {
-    if (ucs_unlikely(current_time - t->now >= t->res)) {
+    if (ucs_unlikely((current_time >> t->res_order) > t->current)) {
         __ucs_twheel_sweep(t, current_time);
     }
 }
@@ -103,6 +125,7 @@ static inline ucs_time_t ucs_twheel_get_time(ucs_twheel_t *t)
  * @param delta      Invocation time
  *
  * NOTE: adding timer already in queue will do nothing
+ * NOTE: delta longer than the wheel range is truncated to the wheel range
  */
 void __ucs_wtimer_add(ucs_twheel_t *t, ucs_wtimer_t *timer, ucs_time_t delta);
 static inline ucs_status_t ucs_wtimer_add(ucs_twheel_t *t, ucs_wtimer_t *timer,
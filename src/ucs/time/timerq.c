@@ -12,6 +12,83 @@
 #include <stdlib.h>
 
 
+#define UCS_TIMERQ_INITIAL_SIZE  8
+
+
+KHASH_IMPL(ucs_timerq_index, int, unsigned, 1, kh_int_hash_func,
+           kh_int_hash_equal);
+
+
+/* Place a timer in the heap slot and update its index */
+static UCS_F_ALWAYS_INLINE void
+ucs_timerq_heap_set(ucs_timer_queue_t *timerq, unsigned index,
+                    const ucs_timer_t *timer)
+{
+    khiter_t iter;
+
+    timerq->timers[index] = *timer;
+    iter = kh_get(ucs_timerq_index, &timerq->index, timer->id);
+    ucs_assert(iter != kh_end(&timerq->index));
+    kh_value(&timerq->index, iter) = index;
+}
+
+static void ucs_timerq_heap_sift_up(ucs_timer_queue_t *timerq, unsigned index)
+{
+    ucs_timer_t timer = timerq->timers[index];
+    unsigned parent;
+
+    while (index > 0) {
+        parent = (index - 1) / 2;
+        if (timerq->timers[parent].expiration <= timer.expiration) {
+            break;
+        }
+
+        ucs_timerq_heap_set(timerq, index, &timerq->timers[parent]);
+        index = parent;
+    }
+
+    ucs_timerq_heap_set(timerq, index, &timer);
+}
+
+static void ucs_timerq_heap_sift_down(ucs_timer_queue_t *timerq, unsigned index)
+{
+    ucs_timer_t timer = timerq->timers[index];
+    unsigned child;
+
+    for (;;) {
+        child = (2 * index) + 1;
+        if (child >= timerq->num_timers) {
+            break;
+        }
+
+        if (((child + 1) < timerq->num_timers) &&
+            (timerq->timers[child + 1].expiration <
+             timerq->timers[child].expiration)) {
+            ++child;
+        }
+
+        if (timer.expiration <= timerq->timers[child].expiration) {
+            break;
+        }
+
+        ucs_timerq_heap_set(timerq, index, &timerq->timers[child]);
+        index = child;
+    }
+
+    ucs_timerq_heap_set(timerq, index, &timer);
+}
+
+static void ucs_timerq_update_min_interval(ucs_timer_queue_t *timerq)
+{
+    unsigned i;
+
+    timerq->min_interval = UCS_TIME_INFINITY;
+    for (i = 0; i < timerq->num_timers; ++i) {
+        timerq->min_interval = ucs_min(timerq->min_interval,
+                                       timerq->timers[i].interval);
+    }
+}
+
 ucs_status_t ucs_timerq_init(ucs_timer_queue_t *timerq)
 {
     ucs_trace_func("timerq=%p", timerq);
@@ -19,6 +96,8 @@ ucs_status_t ucs_timerq_init(ucs_timer_queue_t *timerq)
     ucs_spinlock_init(&timerq->lock);
     timerq->timers       = NULL;
     timerq->num_timers   = 0;
+    timerq->max_timers   = 0;
+    kh_init_inplace(ucs_timerq_index, &timerq->index);
     /* coverity[missing_lock] */
     timerq->min_interval = UCS_TIME_INFINITY;
     return UCS_OK;
@@ -34,6 +113,7 @@ void ucs_timerq_cleanup(ucs_timer_queue_t *timerq)
         ucs_warn("timer queue with %d timers being destroyed", timerq->num_timers);
     }
     ucs_free(timerq->timers);
+    kh_destroy_inplace(ucs_timerq_index, &timerq->index);
 
     status = ucs_spinlock_destroy(&timerq->lock);
     if (status != UCS_OK) {
@@ -45,7 +125,10 @@ ucs_status_t ucs_timerq_add(ucs_timer_queue_t *timerq, int timer_id,
                             ucs_time_t interval)
 {
     ucs_status_t status;
-    ucs_timer_t *ptr;
+    ucs_timer_t *ptr, timer;
+    unsigned max_timers;
+    khiter_t iter;
+    int ret;
 
     ucs_trace_func("timerq=%p interval=%.2fus timer_id=%d", timerq,
                    ucs_time_to_usec(interval), timer_id);
@@ -53,30 +136,41 @@ ucs_status_t ucs_timerq_add(ucs_timer_queue_t *timerq, int timer_id,
     ucs_spin_lock(&timerq->lock);
 
     /* Make sure ID is unique */
-    for (ptr = timerq->timers; ptr < timerq->timers + timerq->num_timers; ++ptr) {
-        if (ptr->id == timer_id) {
-            status = UCS_ERR_ALREADY_EXISTS;
+    iter = kh_put(ucs_timerq_index, &timerq->index, timer_id, &ret);
+    if (ret == 0) {
+        status = UCS_ERR_ALREADY_EXISTS;
+        goto out_unlock;
+    } else if (ret < 0) {
+        status = UCS_ERR_NO_MEMORY;
+        goto out_unlock;
+    }
+
+    /* Grow timer array */
+    if (timerq->num_timers == timerq->max_timers) {
+        max_timers = ucs_max(UCS_TIMERQ_INITIAL_SIZE, timerq->max_timers * 2);
+        ptr        = ucs_realloc(timerq->timers, max_timers * sizeof(ucs_timer_t),
+                                 "timerq");
+        if (ptr == NULL) {
+            kh_del(ucs_timerq_index, &timerq->index, iter);
+            status = UCS_ERR_NO_MEMORY;
             goto out_unlock;
         }
-    }
 
-    /* Resize timer array */
-    ptr = ucs_realloc(timerq->timers, (timerq->num_timers + 1) * sizeof(ucs_timer_t),
-                      "timerq");
-    if (ptr == NULL) {
-        status = UCS_ERR_NO_MEMORY;
-        goto out_unlock;
+        timerq->timers     = ptr;
+        timerq->max_timers = max_timers;
     }
-    timerq->timers = ptr;
-    ++timerq->num_timers;
+
     timerq->min_interval = ucs_min(interval, timerq->min_interval);
     ucs_assert(timerq->min_interval != UCS_TIME_INFINITY);
 
     /* Initialize the new timer */
-    ptr = &timerq->timers[timerq->num_timers - 1];
-    ptr->expiration = 0; /* will fire the next time sweep is called */
-    ptr->interval   = interval;
-    ptr->id         = timer_id;
+    timer.expiration = 0; /* will fire the next time sweep is called */
+    timer.interval   = interval;
+    timer.id         = timer_id;
+
+    kh_value(&timerq->index, iter)       = timerq->num_timers;
+    timerq->timers[timerq->num_timers++] = timer;
+    ucs_timerq_heap_sift_up(timerq, timerq->num_timers - 1);
 
     status = UCS_OK;
 
@@ -87,35 +181,80 @@ out_unlock:
 
 ucs_status_t ucs_timerq_remove(ucs_timer_queue_t *timerq, int timer_id)
 {
+    ucs_time_t interval;
     ucs_status_t status;
-    ucs_timer_t *ptr;
+    unsigned index;
+    khiter_t iter;
 
     ucs_trace_func("timerq=%p timer_id=%d", timerq, timer_id);
 
-    status = UCS_ERR_NO_ELEM;
-
     ucs_spin_lock(&timerq->lock);
-    timerq->min_interval = UCS_TIME_INFINITY;
-    ptr = timerq->timers;
-    while (ptr < timerq->timers + timerq->num_timers) {
-        if (ptr->id == timer_id) {
-            *ptr = timerq->timers[--timerq->num_timers];
-            status = UCS_OK;
+
+    iter = kh_get(ucs_timerq_index, &timerq->index, timer_id);
+    if (iter == kh_end(&timerq->index)) {
+        status = UCS_ERR_NO_ELEM;
+        goto out_unlock;
+    }
+
+    index    = kh_value(&timerq->index, iter);
+    interval = timerq->timers[index].interval;
+    kh_del(ucs_timerq_index, &timerq->index, iter);
+
+    /* Move the last timer to the vacant slot and restore heap order */
+    if (index != --timerq->num_timers) {
+        ucs_timerq_heap_set(timerq, index, &timerq->timers[timerq->num_timers]);
+        if ((index > 0) &&
+            (timerq->timers[(index - 1) / 2].expiration >
+             timerq->timers[index].expiration)) {
+            ucs_timerq_heap_sift_up(timerq, index);
         } else {
-            timerq->min_interval = ucs_min(timerq->min_interval, ptr->interval);
-            ++ptr;
+            ucs_timerq_heap_sift_down(timerq, index);
         }
     }
 
-    /* TODO realloc - shrink */
+    /* Only removing a timer with the minimal interval requires a rescan */
+    if (interval == timerq->min_interval) {
+        ucs_timerq_update_min_interval(timerq);
+    }
+
     if (timerq->num_timers == 0) {
         ucs_assert(timerq->min_interval == UCS_TIME_INFINITY);
-        free(timerq->timers);
-        timerq->timers = NULL;
+        ucs_free(timerq->timers);
+        timerq->timers     = NULL;
+        timerq->max_timers = 0;
     } else {
         ucs_assert(timerq->min_interval != UCS_TIME_INFINITY);
     }
 
+    status = UCS_OK;
+
+out_unlock:
     ucs_spin_unlock(&timerq->lock);
     return status;
 }
+
+ucs_time_t ucs_timerq_next_expiration(ucs_timer_queue_t *timerq)
+{
+    ucs_time_t expiration;
+
+    ucs_spin_lock(&timerq->lock);
+    expiration = (timerq->num_timers > 0) ? timerq->timers[0].expiration :
+                 UCS_TIME_INFINITY;
+    ucs_spin_unlock(&timerq->lock);
+    return expiration;
+}
+
+int ucs_timerq_expire_next(ucs_timer_queue_t *timerq, ucs_time_t current_time,
+                           ucs_timer_t *timer)
+{
+    if ((timerq->num_timers == 0) ||
+        (current_time < timerq->timers[0].expiration)) {
+        return 0;
+    }
+
+    /* Update expiration time */
+    timerq->timers[0].expiration = current_time + timerq->timers[0].interval;
+    *timer                       = timerq->timers[0];
+    ucs_timerq_heap_sift_down(timerq, 0);
+    return 1;
+}
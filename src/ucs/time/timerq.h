@@ -7,6 +7,7 @@
 #ifndef UCS_TIMERQ_H
 #define UCS_TIMERQ_H
 
+#include <ucs/datastruct/khash.h>
 #include <ucs/datastruct/queue.h>
 #include <ucs/time/time.h>
 #include <ucs/type/status.h>
@@ -21,11 +22,18 @@ typedef struct ucs_timer {
 } ucs_timer_t;
 
 
+/* Map timer ID to its index in the heap */
+KHASH_TYPE(ucs_timerq_index, int, unsigned);
+
+
 typedef struct ucs_timer_queue {
     ucs_spinlock_t             lock;
-    ucs_time_t                 min_interval; /* Expiration of next timer */
-    ucs_timer_t                *timers;      /* Array of timers */
+    ucs_time_t                 min_interval; /* Minimal interval of all timers */
+    ucs_timer_t                *timers;      /* Min-heap of timers, ordered by
+                                                expiration time */
     unsigned                   num_timers;   /* Number of timers */
+    unsigned                   max_timers;   /* Allocated size of timers array */
+    khash_t(ucs_timerq_index)  index;        /* Timer ID -> heap index */
 } ucs_timer_queue_t;
 
 
@@ -65,6 +73,31 @@ ucs_status_t ucs_timerq_add(ucs_timer_queue_t *timerq, int timer_id,
 ucs_status_t ucs_timerq_remove(ucs_timer_queue_t *timerq, int timer_id);
 
 
+/**
+ * Get the expiration time of the earliest timer.
+ *
+ * @param timerq     Timer queue to query.
+ *
+ * @return Expiration time of the next timer to expire, or UCS_TIME_INFINITY
+ *         if the queue is empty.
+ */
+ucs_time_t ucs_timerq_next_expiration(ucs_timer_queue_t *timerq);
+
+
+/**
+ * Remove the earliest timer from the heap if it has expired, and re-schedule
+ * it to the next interval. Must be called with the queue lock held.
+ *
+ * @param timerq        Timer queue.
+ * @param current_time  Current time.
+ * @param timer         Filled with a copy of the expired timer.
+ *
+ * @return Nonzero if an expired timer was found.
+ */
+int ucs_timerq_expire_next(ucs_timer_queue_t *timerq, ucs_time_t current_time,
+                           ucs_timer_t *timer);
+
+
 /**
  * @return Minimal timer interval.
  */
@@ -97,21 +130,24 @@ static inline int ucs_timerq_is_empty(ucs_timer_queue_t *timerq) {
  * @param _current_time Current time to dispatch the timers for.
  *
  * @note Timers which expired between calls to this function will also be dispatched.
- * @note There is no guarantee on the order of dispatching.
+ * @note Timers are dispatched in the order of their expiration, and every
+ *       timer is dispatched at most once per call.
+ * @note @a _timer points to a copy of the timer, which was already
+ *       re-scheduled to the next interval.
  */
 #define ucs_timerq_for_each_expired(_timer, _timerq, _current_time, _code) \
     { \
         ucs_time_t __current_time = _current_time; \
+        ucs_timer_t __expired_timer; \
+        unsigned __count; \
         ucs_spin_lock(&(_timerq)->lock); /* Grab lock */ \
-        for (_timer = (_timerq)->timers; \
-             _timer != (_timerq)->timers + (_timerq)->num_timers; \
-             ++_timer) \
+        for (__count = (_timerq)->num_timers; \
+             (__count > 0) && \
+             ucs_timerq_expire_next(_timerq, __current_time, &__expired_timer); \
+             --__count) \
         { \
-            if (__current_time >= (_timer)->expiration) { \
-                /* Update expiration time */ \
-                (_timer)->expiration = __current_time + (_timer)->interval; \
-                _code; \
-            } \
+            _timer = &__expired_timer; \
+            _code; \
         } \
         ucs_spin_unlock(&(_timerq)->lock); /* Release lock  */ \
     }
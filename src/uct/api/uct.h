@@ -21,6 +21,7 @@
 #include <ucs/type/cpu_set.h>
 #include <ucs/stats/stats_fwd.h>
 #include <ucs/sys/compiler_def.h>
+#include <ucs/sys/topo.h>
 
 #include <sys/socket.h>
 #include <stdio.h>
@@ -310,6 +311,10 @@ typedef struct uct_tl_resource_desc {
     char                     tl_name[UCT_TL_NAME_MAX];   /**< Transport name */
     char                     dev_name[UCT_DEVICE_NAME_MAX]; /**< Hardware device name */
     uct_device_type_t        dev_type;     /**< Device type. To which UCT group it belongs to */
+    ucs_sys_device_t         sys_device;   /**< System device which hosts the
+                                                resource. Its id is
+                                                @ref UCS_SYS_DEVICE_ID_UNKNOWN
+                                                if the location is unknown. */
 } uct_tl_resource_desc_t;
 
 #define UCT_TL_RESOURCE_DESC_FMT              "%s/%s"
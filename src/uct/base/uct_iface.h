@@ -252,6 +252,7 @@ UCS_CLASS_DECLARE(uct_base_ep_t, uct_base_iface_t*);
 typedef struct uct_tl_device_resource {
     char                     name[UCT_DEVICE_NAME_MAX]; /**< Hardware device name */
     uct_device_type_t        type;     /**< Device type. To which UCT group it belongs to */
+    const ucs_sys_device_t   *sys_device; /**< System device, NULL if unknown */
 } uct_tl_device_resource_t;
 
 
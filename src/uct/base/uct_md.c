@@ -39,6 +39,17 @@ ucs_config_field_t uct_md_config_rcache_table[] = {
          "between "UCS_PP_MAKE_STRING(UCS_PGT_ADDR_ALIGN)"and system page size",
      ucs_offsetof(uct_md_rcache_config_t, alignment), UCS_CONFIG_TYPE_UINT},
 
+    {"RCACHE_MAX_REGIONS", "inf",
+     "Maximal number of regions in the registration cache. When the limit is\n"
+     "reached, least recently used regions which are not in use are deregistered.",
+     ucs_offsetof(uct_md_rcache_config_t, max_regions), UCS_CONFIG_TYPE_ULUNITS},
+
+    {"RCACHE_MAX_SIZE", "inf",
+     "Maximal total size of registered memory regions in the registration cache.\n"
+     "When the limit is reached, least recently used regions which are not in\n"
+     "use are deregistered.",
+     ucs_offsetof(uct_md_rcache_config_t, max_size), UCS_CONFIG_TYPE_MEMUNITS},
+
     {NULL}
 };
 
@@ -117,6 +128,15 @@ ucs_status_t uct_md_query_tl_resources(uct_md_h md,
             ucs_strncpy_zero(tmp[num_resources + i].dev_name, tl_devices[i].name,
                              sizeof(tmp[num_resources + i].dev_name));
             tmp[num_resources + i].dev_type = tl_devices[i].type;
+            if (tl_devices[i].sys_device != NULL) {
+                tmp[num_resources + i].sys_device = *tl_devices[i].sys_device;
+            } else {
+                memset(&tmp[num_resources + i].sys_device, 0,
+                       sizeof(tmp[num_resources + i].sys_device));
+                tmp[num_resources + i].sys_device.id        =
+                                UCS_SYS_DEVICE_ID_UNKNOWN;
+                tmp[num_resources + i].sys_device.numa_node = -1;
+            }
         }
 
         resources      = tmp;
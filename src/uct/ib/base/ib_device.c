@@ -14,6 +14,7 @@
 #include <ucs/sys/compiler.h>
 #include <ucs/sys/string.h>
 #include <ucs/sys/sys.h>
+#include <ucs/sys/topo.h>
 #include <sys/poll.h>
 #include <sched.h>
 
@@ -811,7 +812,9 @@ ucs_status_t uct_ib_device_query_ports(uct_ib_device_t *dev, unsigned flags,
                                        uct_tl_device_resource_t **tl_devices_p,
                                        unsigned *num_tl_devices_p)
 {
+    const ucs_sys_device_t *sys_device;
     uct_tl_device_resource_t *tl_devices;
+    char dev_path[PATH_MAX];
     unsigned num_tl_devices;
     ucs_status_t status;
     uint8_t port_num;
@@ -824,6 +827,13 @@ ucs_status_t uct_ib_device_query_ports(uct_ib_device_t *dev, unsigned flags,
         goto err;
     }
 
+    /* All ports of the device share the same PCI function */
+    ucs_snprintf_zero(dev_path, sizeof(dev_path), "class/infiniband/%s",
+                      uct_ib_device_name(dev));
+    if (ucs_topo_find_device_by_sysfs_path(dev_path, &sys_device) != UCS_OK) {
+        sys_device = NULL;
+    }
+
     /* Second pass: fill port information */
     num_tl_devices = 0;
     for (port_num = dev->first_port; port_num < dev->first_port + dev->num_ports;
@@ -842,7 +852,8 @@ ucs_status_t uct_ib_device_query_ports(uct_ib_device_t *dev, unsigned flags,
         ucs_snprintf_zero(tl_devices[num_tl_devices].name,
                           sizeof(tl_devices[num_tl_devices].name),
                           "%s:%d", uct_ib_device_name(dev), port_num);
-        tl_devices[num_tl_devices].type = UCT_DEVICE_TYPE_NET;
+        tl_devices[num_tl_devices].type       = UCT_DEVICE_TYPE_NET;
+        tl_devices[num_tl_devices].sys_device = sys_device;
         ++num_tl_devices;
     }
 
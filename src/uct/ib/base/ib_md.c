@@ -1127,6 +1127,8 @@ uct_ib_md_parse_reg_methods(uct_ib_md_t *md, uct_md_attr_t *md_attr,
             }
             rcache_params.ucm_event_priority = md_config->rcache.event_prio;
             rcache_params.context            = md;
+            rcache_params.max_regions        = md_config->rcache.max_regions;
+            rcache_params.max_size           = md_config->rcache.max_size;
             rcache_params.ops                = &uct_ib_rcache_ops;
 
             status = ucs_rcache_create(&rcache_params, uct_ib_device_name(&md->dev),
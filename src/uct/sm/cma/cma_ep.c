@@ -13,10 +13,7 @@
 #include "cma_ep.h"
 #include <ucs/debug/log.h>
 #include <ucs/sys/iovec.h>
-
-typedef ssize_t (*uct_cma_ep_zcopy_fn_t)(pid_t, const struct iovec *,
-                                         unsigned long, const struct iovec *,
-                                         unsigned long, unsigned long);
+#include <ucs/sys/sys.h>
 
 static UCS_CLASS_INIT_FUNC(uct_cma_ep_t, const uct_ep_params_t *params)
 {
@@ -45,7 +42,7 @@ UCS_CLASS_DEFINE_DELETE_FUNC(uct_cma_ep_t, uct_ep_t);
                     (_rkey))
 
 static UCS_F_ALWAYS_INLINE
-ucs_status_t uct_cma_ep_do_zcopy(uct_cma_ep_t *ep, struct iovec *local_iov,
+ucs_status_t uct_cma_ep_do_zcopy(pid_t remote_pid, struct iovec *local_iov,
                                  size_t local_iov_cnt, struct iovec *remote_iov,
                                  uct_cma_ep_zcopy_fn_t fn_p, const char *fn_name)
 {
@@ -54,11 +51,11 @@ ucs_status_t uct_cma_ep_do_zcopy(uct_cma_ep_t *ep, struct iovec *local_iov,
     ssize_t ret;
 
     do {
-        ret = fn_p(ep->remote_pid, &local_iov[local_iov_idx],
+        ret = fn_p(remote_pid, &local_iov[local_iov_idx],
                    local_iov_cnt - local_iov_idx, remote_iov, 1, 0);
         if (ucs_unlikely(ret < 0)) {
             ucs_error("%s(pid=%d length=%zu) returned %zd: %m",
-                      fn_name, ep->remote_pid, remote_iov->iov_len, ret);
+                      fn_name, remote_pid, remote_iov->iov_len, ret);
             return UCS_ERR_IO_ERROR;
         }
 
@@ -70,6 +67,143 @@ ucs_status_t uct_cma_ep_do_zcopy(uct_cma_ep_t *ep, struct iovec *local_iov,
     return UCS_OK;
 }
 
+ucs_status_t uct_cma_ep_copy_chunk(uct_cma_copy_chunk_t *chunk)
+{
+    uct_cma_copy_op_t *op = chunk->op;
+
+    return uct_cma_ep_do_zcopy(op->remote_pid, chunk->local_iov,
+                               chunk->local_iov_cnt, &chunk->remote_iov,
+                               op->fn_p, op->fn_name);
+}
+
+/* Take the part [offset, offset + length) of the data described by iov */
+static size_t uct_cma_ep_iov_slice(const struct iovec *iov, size_t iov_cnt,
+                                   size_t offset, size_t length,
+                                   struct iovec *slice_iov)
+{
+    size_t slice_iov_cnt = 0;
+    size_t iov_idx, iov_offset, slice_len;
+
+    for (iov_idx = 0; (iov_idx < iov_cnt) && (length > 0); ++iov_idx) {
+        if (offset >= iov[iov_idx].iov_len) {
+            offset -= iov[iov_idx].iov_len;
+            continue;
+        }
+
+        iov_offset = offset;
+        slice_len  = ucs_min(iov[iov_idx].iov_len - iov_offset, length);
+        slice_iov[slice_iov_cnt].iov_base = UCS_PTR_BYTE_OFFSET(
+                                                iov[iov_idx].iov_base,
+                                                iov_offset);
+        slice_iov[slice_iov_cnt].iov_len  = slice_len;
+        ++slice_iov_cnt;
+        offset  = 0;
+        length -= slice_len;
+    }
+
+    ucs_assert(length == 0);
+    return slice_iov_cnt;
+}
+
+/*
+ * Split the operation to page-aligned chunks, hand all of them but the first
+ * one to the copy helper threads, and execute the first one on the calling
+ * thread. The operation is completed from iface progress, unless the helper
+ * threads are done before the calling thread.
+ */
+static ucs_status_t
+uct_cma_ep_parallel_zcopy(uct_cma_ep_t *ep, struct iovec *local_iov,
+                          size_t local_iov_cnt, struct iovec *remote_iov,
+                          uct_completion_t *comp, uct_cma_ep_zcopy_fn_t fn_p,
+                          const char *fn_name)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_cma_iface_t);
+    size_t length          = remote_iov->iov_len;
+    uintptr_t remote_addr  = (uintptr_t)remote_iov->iov_base;
+    size_t page_size       = ucs_get_page_size();
+    uct_cma_copy_chunk_t *chunk;
+    uct_cma_copy_op_t *op;
+    unsigned i, num_chunks;
+    size_t chunk_len, offset, end;
+    ucs_status_t status;
+
+    num_chunks = ucs_min(iface->copy.num_threads + 1,
+                         length / ucs_max(iface->copy.min_chunk, page_size));
+    if (num_chunks < 2) {
+        goto out_sync;
+    }
+
+    op = ucs_mpool_get_inline(&iface->copy.op_mp);
+    if (ucs_unlikely(op == NULL)) {
+        goto out_sync;
+    }
+
+    op->comp       = comp;
+    op->status     = UCS_OK;
+    op->pending    = num_chunks;
+    op->remote_pid = ep->remote_pid;
+    op->fn_p       = fn_p;
+    op->fn_name    = fn_name;
+
+    /* Every chunk is at least one page long, so the aligned boundaries are
+     * strictly increasing */
+    chunk_len = length / num_chunks;
+    offset    = 0;
+    for (i = 0; i < num_chunks; ++i) {
+        if (i == (num_chunks - 1)) {
+            end = length;
+        } else {
+            end = ucs_align_up(remote_addr + ((i + 1) * chunk_len),
+                               page_size) - remote_addr;
+        }
+
+        ucs_assert(end > offset);
+        chunk                      = &op->chunks[i];
+        chunk->op                  = op;
+        chunk->remote_iov.iov_base = UCS_PTR_BYTE_OFFSET(remote_iov->iov_base,
+                                                         offset);
+        chunk->remote_iov.iov_len  = end - offset;
+        chunk->local_iov_cnt       = uct_cma_ep_iov_slice(local_iov,
+                                                          local_iov_cnt,
+                                                          offset, end - offset,
+                                                          chunk->local_iov);
+        offset                     = end;
+    }
+
+    pthread_mutex_lock(&iface->copy.lock);
+    for (i = 1; i < num_chunks; ++i) {
+        ucs_queue_push(&iface->copy.chunk_q, &op->chunks[i].queue);
+    }
+    pthread_cond_broadcast(&iface->copy.cond);
+    pthread_mutex_unlock(&iface->copy.lock);
+
+    status = uct_cma_ep_copy_chunk(&op->chunks[0]);
+
+    pthread_mutex_lock(&iface->copy.lock);
+    if (status != UCS_OK) {
+        op->status = status;
+    }
+    if (--op->pending > 0) {
+        /* Helper threads will add the operation to the done queue */
+        ++iface->copy.outstanding;
+        op = NULL;
+    }
+    pthread_mutex_unlock(&iface->copy.lock);
+
+    if (op == NULL) {
+        return UCS_INPROGRESS;
+    }
+
+    status = op->status;
+    ucs_mpool_put_inline(op);
+    return status;
+
+out_sync:
+    return uct_cma_ep_do_zcopy(ep->remote_pid, local_iov, local_iov_cnt,
+                               remote_iov, fn_p, fn_name);
+}
+
 static UCS_F_ALWAYS_INLINE
 ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
                                      const uct_iov_t *iov,
@@ -84,8 +218,9 @@ ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
                                                      unsigned long),
                                      const char *fn_name)
 {
-    uct_cma_ep_t *ep = ucs_derived_of(tl_ep, uct_cma_ep_t);
-    size_t iov_idx   = 0;
+    uct_cma_ep_t *ep       = ucs_derived_of(tl_ep, uct_cma_ep_t);
+    uct_cma_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_cma_iface_t);
+    size_t iov_idx         = 0;
     ucs_status_t status;
     size_t local_iov_cnt;
     size_t length;
@@ -110,7 +245,13 @@ ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
 
         remote_iov.iov_len = length;
 
-        status = uct_cma_ep_do_zcopy(ep, local_iov, local_iov_cnt,
+        if ((length >= iface->copy.thresh) && (iovcnt == cur_iov_cnt)) {
+            /* Whole operation fits in a single batch */
+            return uct_cma_ep_parallel_zcopy(ep, local_iov, local_iov_cnt,
+                                             &remote_iov, comp, fn_p, fn_name);
+        }
+
+        status = uct_cma_ep_do_zcopy(ep->remote_pid, local_iov, local_iov_cnt,
                                      &remote_iov, fn_p, fn_name);
         if (ucs_unlikely(status != UCS_OK)) {
             return status;
@@ -120,6 +261,21 @@ ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
     return UCS_OK;
 }
 
+ucs_status_t uct_cma_ep_flush(uct_ep_h tl_ep, unsigned flags,
+                              uct_completion_t *comp)
+{
+    ucs_status_t status;
+
+    status = uct_iface_flush(tl_ep->iface, flags, comp);
+    if (status == UCS_OK) {
+        UCT_TL_EP_STAT_FLUSH(ucs_derived_of(tl_ep, uct_base_ep_t));
+    } else if (status == UCS_INPROGRESS) {
+        UCT_TL_EP_STAT_FLUSH_WAIT(ucs_derived_of(tl_ep, uct_base_ep_t));
+    }
+
+    return status;
+}
+
 ucs_status_t uct_cma_ep_put_zcopy(uct_ep_h tl_ep, const uct_iov_t *iov, size_t iovcnt,
                                   uint64_t remote_addr, uct_rkey_t rkey,
                                   uct_completion_t *comp)
@@ -4,12 +4,19 @@
  * See file LICENSE for terms.
  */
 
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
 #include "cma_md.h"
 #include "cma_iface.h"
 #include "cma_ep.h"
 
 #include <uct/base/uct_md.h>
+#include <ucs/arch/cpu.h>
 #include <ucs/sys/string.h>
+#include <ucs/sys/sys.h>
+#include <ucs/sys/topo.h>
 
 
 static ucs_config_field_t uct_cma_iface_config_table[] = {
@@ -17,6 +24,30 @@ static ucs_config_field_t uct_cma_iface_config_table[] = {
     ucs_offsetof(uct_cma_iface_config_t, super),
     UCS_CONFIG_TYPE_TABLE(uct_sm_iface_config_table)},
 
+    {"COPY_THREADS", "0",
+     "Number of helper threads which execute large get/put operations in\n"
+     "parallel with the calling thread. 0 disables the helper threads.",
+     ucs_offsetof(uct_cma_iface_config_t, copy.num_threads),
+     UCS_CONFIG_TYPE_UINT},
+
+    {"COPY_THRESH", "4m",
+     "Minimal size of a get/put operation which is split between the calling\n"
+     "thread and the helper threads.",
+     ucs_offsetof(uct_cma_iface_config_t, copy.thresh),
+     UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"COPY_MIN_CHUNK", "1m",
+     "Minimal size of the part of a get/put operation executed by a single\n"
+     "thread. The parts are aligned to the page size.",
+     ucs_offsetof(uct_cma_iface_config_t, copy.min_chunk),
+     UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"COPY_NUMA_BIND", "y",
+     "Bind the helper threads to the CPUs of the NUMA node of the CPU which\n"
+     "creates the interface.",
+     ucs_offsetof(uct_cma_iface_config_t, copy.numa_bind),
+     UCS_CONFIG_TYPE_BOOL},
+
     {NULL}
 };
 
@@ -68,6 +99,205 @@ static ucs_status_t uct_cma_iface_query(uct_iface_h tl_iface,
     return UCS_OK;
 }
 
+static ucs_status_t uct_cma_iface_flush(uct_iface_h tl_iface, unsigned flags,
+                                        uct_completion_t *comp)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(tl_iface, uct_cma_iface_t);
+    uct_cma_copy_op_t *op;
+
+    if (iface->copy.outstanding == 0) {
+        UCT_TL_IFACE_STAT_FLUSH(&iface->super.super);
+        return UCS_OK;
+    }
+
+    if (comp != NULL) {
+        op = ucs_mpool_get_inline(&iface->copy.op_mp);
+        if (op == NULL) {
+            return UCS_ERR_NO_RESOURCE;
+        }
+
+        op->comp = comp;
+        ucs_queue_push(&iface->copy.flush_q, &op->queue);
+    }
+
+    UCT_TL_IFACE_STAT_FLUSH_WAIT(&iface->super.super);
+    return UCS_INPROGRESS;
+}
+
+static void uct_cma_iface_complete_flush(uct_cma_iface_t *iface)
+{
+    uct_cma_copy_op_t *op;
+
+    ucs_queue_for_each_extract(op, &iface->copy.flush_q, queue, 1) {
+        uct_invoke_completion(op->comp, UCS_OK);
+        ucs_mpool_put_inline(op);
+    }
+}
+
+static unsigned uct_cma_iface_progress(uct_iface_h tl_iface)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(tl_iface, uct_cma_iface_t);
+    ucs_queue_head_t done_q;
+    uct_cma_copy_op_t *op;
+    unsigned count;
+
+    if (ucs_likely(iface->copy.outstanding == 0)) {
+        return 0;
+    }
+
+    ucs_queue_head_init(&done_q);
+    pthread_mutex_lock(&iface->copy.lock);
+    ucs_queue_splice(&done_q, &iface->copy.done_q);
+    pthread_mutex_unlock(&iface->copy.lock);
+
+    count = 0;
+    ucs_queue_for_each_extract(op, &done_q, queue, 1) {
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, op->status);
+        }
+        ucs_mpool_put_inline(op);
+        --iface->copy.outstanding;
+        ++count;
+    }
+
+    if (iface->copy.outstanding == 0) {
+        uct_cma_iface_complete_flush(iface);
+    }
+
+    return count;
+}
+
+static void uct_cma_iface_progress_enable(uct_iface_h tl_iface, unsigned flags)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(tl_iface, uct_cma_iface_t);
+
+    /* Progress is needed only to complete operations of the helper threads */
+    if (iface->copy.num_threads > 0) {
+        uct_base_iface_progress_enable(tl_iface, flags);
+    }
+}
+
+static void *uct_cma_iface_copy_thread_func(void *arg)
+{
+    uct_cma_iface_t *iface = arg;
+    uct_cma_copy_chunk_t *chunk;
+    ucs_status_t status;
+
+    pthread_mutex_lock(&iface->copy.lock);
+    for (;;) {
+        while (ucs_queue_is_empty(&iface->copy.chunk_q) && !iface->copy.stop) {
+            pthread_cond_wait(&iface->copy.cond, &iface->copy.lock);
+        }
+
+        /* Finish the queued chunks before exiting */
+        if (ucs_queue_is_empty(&iface->copy.chunk_q)) {
+            break;
+        }
+
+        chunk = ucs_queue_pull_elem_non_empty(&iface->copy.chunk_q,
+                                              uct_cma_copy_chunk_t, queue);
+        pthread_mutex_unlock(&iface->copy.lock);
+
+        status = uct_cma_ep_copy_chunk(chunk);
+
+        pthread_mutex_lock(&iface->copy.lock);
+        if (status != UCS_OK) {
+            chunk->op->status = status;
+        }
+        if (--chunk->op->pending == 0) {
+            ucs_queue_push(&iface->copy.done_q, &chunk->op->queue);
+        }
+    }
+    pthread_mutex_unlock(&iface->copy.lock);
+
+    return NULL;
+}
+
+/* Find the CPUs of the NUMA node of the calling thread */
+static int uct_cma_iface_copy_numa_cpuset(ucs_sys_cpuset_t *cpuset)
+{
+    ucs_sys_cpuset_t parent_set;
+    int numa_node, cpu, num_cpus;
+
+    numa_node = ucs_topo_get_local_numa_node();
+    if ((numa_node < 0) || (ucs_sys_getaffinity(&parent_set) < 0)) {
+        return 0;
+    }
+
+    num_cpus = 0;
+    CPU_ZERO(cpuset);
+    for (cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &parent_set) &&
+            (ucs_topo_numa_node_of_cpu(cpu) == numa_node)) {
+            CPU_SET(cpu, cpuset);
+            ++num_cpus;
+        }
+    }
+
+    return num_cpus;
+}
+
+static void uct_cma_iface_copy_threads_stop(uct_cma_iface_t *iface,
+                                            unsigned num_threads)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&iface->copy.lock);
+    iface->copy.stop = 1;
+    pthread_cond_broadcast(&iface->copy.cond);
+    pthread_mutex_unlock(&iface->copy.lock);
+
+    for (i = 0; i < num_threads; ++i) {
+        pthread_join(iface->copy.threads[i], NULL);
+    }
+}
+
+static ucs_status_t
+uct_cma_iface_copy_threads_start(uct_cma_iface_t *iface,
+                                 const uct_cma_iface_config_t *config)
+{
+    ucs_sys_cpuset_t cpuset;
+    pthread_attr_t attr;
+    unsigned i;
+    int ret;
+
+    iface->copy.threads = ucs_calloc(iface->copy.num_threads,
+                                     sizeof(*iface->copy.threads),
+                                     "cma_copy_threads");
+    if (iface->copy.threads == NULL) {
+        ucs_error("failed to allocate %u cma copy threads",
+                  iface->copy.num_threads);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    pthread_attr_init(&attr);
+    if (config->copy.numa_bind && (uct_cma_iface_copy_numa_cpuset(&cpuset) > 0)) {
+        pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
+    }
+
+    for (i = 0; i < iface->copy.num_threads; ++i) {
+        ret = pthread_create(&iface->copy.threads[i], &attr,
+                             uct_cma_iface_copy_thread_func, iface);
+        if (ret != 0) {
+            ucs_error("pthread_create() returned %d: %m", ret);
+            pthread_attr_destroy(&attr);
+            uct_cma_iface_copy_threads_stop(iface, i);
+            ucs_free(iface->copy.threads);
+            return UCS_ERR_IO_ERROR;
+        }
+    }
+
+    pthread_attr_destroy(&attr);
+    return UCS_OK;
+}
+
+static ucs_mpool_ops_t uct_cma_iface_op_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
+
 static UCS_CLASS_DECLARE_DELETE_FUNC(uct_cma_iface_t, uct_iface_t);
 
 static uct_iface_ops_t uct_cma_iface_ops = {
@@ -75,15 +305,15 @@ static uct_iface_ops_t uct_cma_iface_ops = {
     .ep_get_zcopy             = uct_cma_ep_get_zcopy,
     .ep_pending_add           = ucs_empty_function_return_busy,
     .ep_pending_purge         = ucs_empty_function,
-    .ep_flush                 = uct_base_ep_flush,
+    .ep_flush                 = uct_cma_ep_flush,
     .ep_fence                 = uct_sm_ep_fence,
     .ep_create                = UCS_CLASS_NEW_FUNC_NAME(uct_cma_ep_t),
     .ep_destroy               = UCS_CLASS_DELETE_FUNC_NAME(uct_cma_ep_t),
-    .iface_flush              = uct_base_iface_flush,
+    .iface_flush              = uct_cma_iface_flush,
     .iface_fence              = uct_sm_iface_fence,
-    .iface_progress_enable    = ucs_empty_function,
-    .iface_progress_disable   = ucs_empty_function,
-    .iface_progress           = ucs_empty_function_return_zero,
+    .iface_progress_enable    = uct_cma_iface_progress_enable,
+    .iface_progress_disable   = uct_base_iface_progress_disable,
+    .iface_progress           = uct_cma_iface_progress,
     .iface_close              = UCS_CLASS_DELETE_FUNC_NAME(uct_cma_iface_t),
     .iface_query              = uct_cma_iface_query,
     .iface_get_address        = uct_cma_iface_get_address,
@@ -95,14 +325,85 @@ static UCS_CLASS_INIT_FUNC(uct_cma_iface_t, uct_md_h md, uct_worker_h worker,
                            const uct_iface_params_t *params,
                            const uct_iface_config_t *tl_config)
 {
+    uct_cma_iface_config_t *config = ucs_derived_of(tl_config,
+                                                    uct_cma_iface_config_t);
+    ucs_status_t status;
+
     UCS_CLASS_CALL_SUPER_INIT(uct_sm_iface_t, &uct_cma_iface_ops, md,
                               worker, params, tl_config);
 
+    self->copy.num_threads = config->copy.num_threads;
+    self->copy.thresh      = (self->copy.num_threads > 0) ?
+                             config->copy.thresh : SIZE_MAX;
+    self->copy.min_chunk   = config->copy.min_chunk;
+    self->copy.stop        = 0;
+    self->copy.outstanding = 0;
+    self->copy.threads     = NULL;
+    ucs_queue_head_init(&self->copy.chunk_q);
+    ucs_queue_head_init(&self->copy.done_q);
+    ucs_queue_head_init(&self->copy.flush_q);
+
+    if (self->copy.num_threads == 0) {
+        return UCS_OK;
+    }
+
+    status = ucs_mpool_init(&self->copy.op_mp, 0,
+                            sizeof(uct_cma_copy_op_t) +
+                            ((self->copy.num_threads + 1) *
+                             sizeof(uct_cma_copy_chunk_t)),
+                            0, UCS_SYS_CACHE_LINE_SIZE, 16, UINT_MAX,
+                            &uct_cma_iface_op_mpool_ops, "cma_copy_ops");
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    pthread_mutex_init(&self->copy.lock, NULL);
+    pthread_cond_init(&self->copy.cond, NULL);
+
+    status = uct_cma_iface_copy_threads_start(self, config);
+    if (status != UCS_OK) {
+        goto err_destroy;
+    }
+
+    ucs_debug("cma iface %p: started %u copy threads", self,
+              self->copy.num_threads);
     return UCS_OK;
+
+err_destroy:
+    pthread_cond_destroy(&self->copy.cond);
+    pthread_mutex_destroy(&self->copy.lock);
+    ucs_mpool_cleanup(&self->copy.op_mp, 1);
+    return status;
 }
 
 static UCS_CLASS_CLEANUP_FUNC(uct_cma_iface_t)
 {
+    uct_cma_copy_op_t *op;
+
+    if (self->copy.num_threads == 0) {
+        return;
+    }
+
+    uct_base_iface_progress_disable(&self->super.super.super,
+                                    UCT_PROGRESS_SEND | UCT_PROGRESS_RECV);
+    uct_cma_iface_copy_threads_stop(self, self->copy.num_threads);
+
+    if (self->copy.outstanding > 0) {
+        ucs_warn("cma iface %p: %u operations are not completed", self,
+                 self->copy.outstanding);
+    }
+
+    ucs_queue_for_each_extract(op, &self->copy.done_q, queue, 1) {
+        ucs_mpool_put_inline(op);
+    }
+    ucs_queue_for_each_extract(op, &self->copy.flush_q, queue, 1) {
+        ucs_mpool_put_inline(op);
+    }
+
+    ucs_free(self->copy.threads);
+    pthread_cond_destroy(&self->copy.cond);
+    pthread_mutex_destroy(&self->copy.lock);
+    ucs_mpool_cleanup(&self->copy.op_mp, 1);
 }
 
 UCS_CLASS_DEFINE(uct_cma_iface_t, uct_base_iface_t);
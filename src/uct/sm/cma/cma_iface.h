@@ -9,15 +9,75 @@
 
 #include <uct/base/uct_iface.h>
 #include <uct/sm/base/sm_iface.h>
+#include <ucs/datastruct/mpool.h>
+#include <ucs/datastruct/queue.h>
+#include <sys/uio.h>
+#include <pthread.h>
+
+
+typedef ssize_t (*uct_cma_ep_zcopy_fn_t)(pid_t, const struct iovec *,
+                                         unsigned long, const struct iovec *,
+                                         unsigned long, unsigned long);
 
 
 typedef struct uct_cma_iface_config {
     uct_sm_iface_config_t         super;
+    struct {
+        unsigned                  num_threads;
+        size_t                    thresh;
+        size_t                    min_chunk;
+        int                       numa_bind;
+    } copy;
 } uct_cma_iface_config_t;
 
 
+/**
+ * Part of a get/put operation, executed by a single thread.
+ */
+typedef struct uct_cma_copy_chunk {
+    struct uct_cma_copy_op        *op;
+    ucs_queue_elem_t              queue;         /* Entry in the chunk queue */
+    size_t                        local_iov_cnt;
+    struct iovec                  local_iov[UCT_SM_MAX_IOV];
+    struct iovec                  remote_iov;
+} uct_cma_copy_chunk_t;
+
+
+/**
+ * Get/put operation which is split between the calling thread and the copy
+ * helper threads. Also used as a placeholder for flush completions.
+ */
+typedef struct uct_cma_copy_op {
+    ucs_queue_elem_t              queue;         /* Entry in done/flush queue */
+    uct_completion_t              *comp;         /* User completion */
+    ucs_status_t                  status;        /* Status of the operation */
+    unsigned                      pending;       /* Number of chunks in progress,
+                                                    protected by the lock */
+    pid_t                         remote_pid;
+    uct_cma_ep_zcopy_fn_t         fn_p;
+    const char                    *fn_name;
+    uct_cma_copy_chunk_t          chunks[0];
+} uct_cma_copy_op_t;
+
+
 typedef struct uct_cma_iface {
     uct_sm_iface_t                super;
+    struct {
+        unsigned                  num_threads;   /* Number of helper threads */
+        size_t                    thresh;        /* Minimal size to split */
+        size_t                    min_chunk;     /* Minimal chunk size */
+        pthread_t                 *threads;
+        pthread_mutex_t           lock;
+        pthread_cond_t            cond;
+        int                       stop;          /* Helper threads should exit */
+        ucs_queue_head_t          chunk_q;       /* Chunks to execute, protected
+                                                    by the lock */
+        ucs_queue_head_t          done_q;        /* Completed operations,
+                                                    protected by the lock */
+        ucs_queue_head_t          flush_q;       /* Pending flush completions */
+        unsigned                  outstanding;   /* Operations in progress */
+        ucs_mpool_t               op_mp;         /* Operations memory pool */
+    } copy;
 } uct_cma_iface_t;
 
 
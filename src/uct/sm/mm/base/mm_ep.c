@@ -14,6 +14,7 @@
 typedef enum {
     UCT_MM_SEND_AM_BCOPY,
     UCT_MM_SEND_AM_SHORT,
+    UCT_MM_SEND_AM_ZCOPY,
 } uct_mm_send_op_t;
 
 
@@ -114,6 +115,61 @@ static void uct_mm_ep_signal_remote(uct_mm_ep_t *ep)
     }
 }
 
+/* Take a free dedicated ring in the remote receive FIFO segment, if there is
+ * one. Otherwise, the ep sends to the shared FIFO. */
+static void uct_mm_ep_spsc_init(uct_mm_ep_t *ep, uct_mm_iface_t *iface)
+{
+    volatile uint64_t *alloc;
+    uint64_t map, bit;
+    unsigned ring;
+
+    ep->spsc.ctl   = NULL;
+    ep->spsc.elems = NULL;
+    ep->spsc.head  = 0;
+    ep->spsc.index = 0;
+
+    ring = 0;
+    while (ring < iface->config.spsc_num_rings) {
+        alloc = &ep->fifo_ctl->spsc_alloc[ring / 64];
+        map   = *alloc;
+        bit   = UCS_BIT(ring % 64);
+        if (map & bit) {
+            ++ring;
+        } else if (ucs_atomic_cswap64(alloc, map, map | bit) == map) {
+            ep->spsc.ctl   = UCT_MM_IFACE_GET_SPSC_CTL(iface, ep->fifo_elems,
+                                                       ring);
+            ep->spsc.elems = UCT_MM_IFACE_GET_SPSC_ELEMS(iface, ep->fifo_elems,
+                                                         ring);
+            ep->spsc.index = ring;
+            /* the ring is drained by the receiver before it's released, so
+             * the sender continues from where the previous user stopped */
+            ep->spsc.head  = ep->spsc.ctl->head;
+            ep->cached_tail = ep->spsc.ctl->tail;
+            ucs_assert(ep->spsc.head == ep->cached_tail);
+            ep->spsc.ctl->released = 0;
+            ucs_debug("mm ep %p: using dedicated ring %u", ep, ring);
+            return;
+        }
+        /* else, the bitmap was updated concurrently - retry the same ring */
+    }
+
+    if (iface->config.spsc_num_rings > 0) {
+        ucs_debug("mm ep %p: no free dedicated ring, using the shared FIFO", ep);
+    }
+}
+
+static void uct_mm_ep_spsc_cleanup(uct_mm_ep_t *ep, uct_mm_iface_t *iface)
+{
+    if (ep->spsc.ctl == NULL) {
+        return;
+    }
+
+    /* the receiver frees the ring after reading all elements up to head */
+    ep->spsc.ctl->head = ep->spsc.head;
+    ucs_memory_cpu_store_fence();
+    ep->spsc.ctl->released = 1;
+}
+
 static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, const uct_ep_params_t *params)
 {
     uct_mm_iface_t            *iface = ucs_derived_of(params->iface, uct_mm_iface_t);
@@ -127,6 +183,10 @@ static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, const uct_ep_params_t *params)
 
     kh_init_inplace(uct_mm_remote_seg, &self->remote_segs);
     ucs_arbiter_group_init(&self->arb_group);
+    self->pending_count   = 0;
+    self->tx_batch.head   = 0;
+    self->tx_batch.count  = 0;
+    self->tx_batch.budget = 0;
 
     /* save remote md address */
     if (md->iface_addr_len > 0) {
@@ -153,6 +213,7 @@ static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, const uct_ep_params_t *params)
     /* Initialize remote FIFO control structure */
     uct_mm_iface_set_fifo_ptrs(fifo_ptr, &self->fifo_ctl, &self->fifo_elems);
     self->cached_tail     = self->fifo_ctl->tail;
+    uct_mm_ep_spsc_init(self, iface);
     self->signal.addrlen  = self->fifo_ctl->signal_addrlen;
     self->signal.sockaddr = self->fifo_ctl->signal_sockaddr;
 
@@ -173,6 +234,7 @@ static UCS_CLASS_CLEANUP_FUNC(uct_mm_ep_t)
     uct_mm_remote_seg_t remote_seg;
 
     uct_mm_ep_pending_purge(&self->super.super, NULL, NULL);
+    uct_mm_ep_spsc_cleanup(self, iface);
 
     kh_foreach_value(&self->remote_segs, remote_seg, {
         uct_mm_iface_mapper_call(iface, mem_detach, &remote_seg);
@@ -210,21 +272,129 @@ static inline ucs_status_t uct_mm_ep_get_remote_elem(uct_mm_ep_t *ep, uint64_t h
 static inline void uct_mm_ep_update_cached_tail(uct_mm_ep_t *ep)
 {
     ucs_memory_cpu_load_fence();
-    ep->cached_tail = ep->fifo_ctl->tail;
+    ep->cached_tail = (ep->spsc.ctl != NULL) ? ep->spsc.ctl->tail :
+                      ep->fifo_ctl->tail;
+}
+
+/* Check if there is room in the remote FIFO or ring to write at 'head'.
+ * return 1 if can send, 0 otherwise. */
+static UCS_F_ALWAYS_INLINE int
+uct_mm_ep_check_fifo_space(uct_mm_ep_t *ep, uint64_t head, unsigned fifo_size)
+{
+    if (UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, fifo_size)) {
+        return 1;
+    }
+
+    if (!ucs_arbiter_group_is_empty(&ep->arb_group)) {
+        /* pending isn't empty. don't send now to prevent out-of-order sending */
+        UCS_STATS_UPDATE_COUNTER(ep->super.stats, UCT_EP_STAT_NO_RES, 1);
+        return 0;
+    }
+
+    /* pending is empty */
+    /* update the local copy of the tail to its actual value on the remote peer */
+    uct_mm_ep_update_cached_tail(ep);
+    if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, fifo_size)) {
+        UCS_STATS_UPDATE_COUNTER(ep->super.stats, UCT_EP_STAT_NO_RES, 1);
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Set the owner bit to indicate that the writing of the element is complete.
+ * The owner bit flips after every FIFO wraparound */
+static UCS_F_ALWAYS_INLINE void
+uct_mm_ep_elem_publish(uct_mm_fifo_element_t *elem, uint64_t head,
+                       unsigned fifo_size, uint8_t elem_flags)
+{
+    if (head & fifo_size) {
+        elem_flags |= UCT_MM_FIFO_ELEM_FLAG_OWNER;
+    }
+    elem->flags = elem_flags;
+}
+
+/* Reserve up to 'count' elements of the remote FIFO by a single atomic
+ * operation. They are used by the sends from the pending queue, instead of
+ * competing with the other senders on the FIFO head for every element. */
+static void uct_mm_ep_tx_batch_reserve(uct_mm_ep_t *ep, uct_mm_iface_t *iface,
+                                       unsigned count)
+{
+    unsigned num_elems;
+    uint64_t head;
+
+    ucs_assert(ep->tx_batch.count == 0);
+
+    do {
+        head = ep->fifo_ctl->head;
+        if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail,
+                                       iface->config.fifo_size)) {
+            return;
+        }
+
+        num_elems = ucs_min(count, iface->config.fifo_size -
+                                   (head - ep->cached_tail));
+    } while (ucs_atomic_cswap64(ucs_unaligned_ptr(&ep->fifo_ctl->head), head,
+                                head + num_elems) != head);
+
+    ucs_trace_data("ep %p: reserved %u FIFO elements from %"PRIu64, ep,
+                   num_elems, head);
+    ep->tx_batch.head  = head;
+    ep->tx_batch.count = num_elems;
+}
+
+/* Publish the reserved elements which were not used as no-op, since the
+ * receiver consumes the FIFO in order */
+static void uct_mm_ep_tx_batch_release(uct_mm_ep_t *ep, uct_mm_iface_t *iface)
+{
+    uct_mm_fifo_element_t *elem;
+
+    for (; ep->tx_batch.count > 0; --ep->tx_batch.count, ++ep->tx_batch.head) {
+        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, ep->fifo_elems,
+                                          ep->tx_batch.head & iface->fifo_mask);
+        uct_mm_ep_elem_publish(elem, ep->tx_batch.head,
+                               iface->config.fifo_size,
+                               UCT_MM_FIFO_ELEM_FLAG_NOP);
+    }
+
+    ep->tx_batch.budget = 0;
+}
+
+/* Copy the AM Zcopy header and the user's IOVs to the remote receive
+ * descriptor, this is the only copy of the data on the way to the receiver */
+static UCS_F_ALWAYS_INLINE size_t
+uct_mm_ep_am_zcopy_pack(void *dst, const void *header, unsigned header_length,
+                        const uct_iov_t *iov, size_t iovcnt)
+{
+    size_t length = header_length;
+    size_t iov_it, iov_length;
+
+    memcpy(dst, header, header_length);
+    for (iov_it = 0; iov_it < iovcnt; ++iov_it) {
+        iov_length = uct_iov_get_length(&iov[iov_it]);
+        memcpy(UCS_PTR_BYTE_OFFSET(dst, length), iov[iov_it].buffer,
+               iov_length);
+        length    += iov_length;
+    }
+
+    return length;
 }
 
 /* A common mm active message sending function.
- * The first parameter indicates the origin of the call.
- * is_short = 1 - perform AM short sending
- * is_short = 0 - perform AM bcopy sending
+ * The first parameter indicates the origin of the call:
+ * UCT_MM_SEND_AM_SHORT - perform AM short sending
+ * UCT_MM_SEND_AM_BCOPY - perform AM bcopy sending
+ * UCT_MM_SEND_AM_ZCOPY - perform AM zcopy sending, 'payload' and 'length' are
+ *                        the AM header
  */
 static UCS_F_ALWAYS_INLINE ssize_t
 uct_mm_ep_am_common_send(uct_mm_send_op_t send_op, uct_mm_ep_t *ep,
                          uct_mm_iface_t *iface, uint8_t am_id, size_t length,
                          uint64_t header, const void *payload,
                          uct_pack_callback_t pack_cb, void *arg,
-                         unsigned flags)
+                         const uct_iov_t *iov, size_t iovcnt, unsigned flags)
 {
+    unsigned fifo_size = iface->config.fifo_size;
     uct_mm_fifo_element_t *elem;
     ucs_status_t status;
     void *base_address;
@@ -233,23 +403,32 @@ uct_mm_ep_am_common_send(uct_mm_send_op_t send_op, uct_mm_ep_t *ep,
 
     UCT_CHECK_AM_ID(am_id);
 
+    if (ep->spsc.ctl != NULL) {
+        /* the ep is the only writer to its dedicated ring, so the element is
+         * taken without an atomic operation */
+        head      = ep->spsc.head;
+        fifo_size = iface->config.spsc_ring_size;
+        if (!uct_mm_ep_check_fifo_space(ep, head, fifo_size)) {
+            return UCS_ERR_NO_RESOURCE;
+        }
+
+        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, ep->spsc.elems,
+                                          head & iface->spsc.mask);
+        goto fill;
+    } else if (ep->tx_batch.count > 0) {
+        /* use an element which was reserved for the pending sends */
+        head = ep->tx_batch.head++;
+        --ep->tx_batch.count;
+        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, ep->fifo_elems,
+                                          head & iface->fifo_mask);
+        goto fill;
+    }
+
 retry:
     head = ep->fifo_ctl->head;
     /* check if there is room in the remote process's receive FIFO to write */
-    if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, iface->config.fifo_size)) {
-        if (!ucs_arbiter_group_is_empty(&ep->arb_group)) {
-            /* pending isn't empty. don't send now to prevent out-of-order sending */
-            UCS_STATS_UPDATE_COUNTER(ep->super.stats, UCT_EP_STAT_NO_RES, 1);
-            return UCS_ERR_NO_RESOURCE;
-        } else {
-            /* pending is empty */
-            /* update the local copy of the tail to its actual value on the remote peer */
-            uct_mm_ep_update_cached_tail(ep);
-            if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, iface->config.fifo_size)) {
-                UCS_STATS_UPDATE_COUNTER(ep->super.stats, UCT_EP_STAT_NO_RES, 1);
-                return UCS_ERR_NO_RESOURCE;
-            }
-        }
+    if (!uct_mm_ep_check_fifo_space(ep, head, fifo_size)) {
+        return UCS_ERR_NO_RESOURCE;
     }
 
     status = uct_mm_ep_get_remote_elem(ep, head, &elem);
@@ -259,6 +438,7 @@ retry:
         goto retry;
     }
 
+fill:
     switch (send_op) {
     case UCT_MM_SEND_AM_SHORT:
         /* write to the remote FIFO */
@@ -291,6 +471,26 @@ retry:
                            length, "TX: AM_BCOPY");
         UCT_TL_EP_STAT_OP(&ep->super, AM, BCOPY, length);
         break;
+    case UCT_MM_SEND_AM_ZCOPY:
+        /* write to the remote descriptor, using the same cache of attached
+         * remote segments as AM bcopy */
+        status = uct_mm_ep_get_remote_seg(ep, elem->desc.seg_id,
+                                          elem->desc.seg_size, &base_address);
+        if (ucs_unlikely(status != UCS_OK)) {
+            return status;
+        }
+
+        length       = uct_mm_ep_am_zcopy_pack(UCS_PTR_BYTE_OFFSET(base_address,
+                                                                   elem->desc.offset),
+                                               payload, length, iov, iovcnt);
+        elem_flags   = 0;
+        elem->length = length;
+
+        uct_iface_trace_am(&iface->super.super, UCT_AM_TRACE_TYPE_SEND, am_id,
+                           UCS_PTR_BYTE_OFFSET(base_address, elem->desc.offset),
+                           length, "TX: AM_ZCOPY");
+        UCT_TL_EP_STAT_OP(&ep->super, AM, ZCOPY, length);
+        break;
     }
 
     elem->am_id = am_id;
@@ -299,12 +499,10 @@ retry:
      * 'writing is complete' flag which the reader checks */
     ucs_memory_cpu_store_fence();
 
-    /* set the owner bit to indicate that the writing is complete.
-     * the owner bit flips after every FIFO wraparound */
-    if (head & iface->config.fifo_size) {
-        elem_flags |= UCT_MM_FIFO_ELEM_FLAG_OWNER;
+    uct_mm_ep_elem_publish(elem, head, fifo_size, elem_flags);
+    if (ep->spsc.ctl != NULL) {
+        ep->spsc.head = head + 1;
     }
-    elem->flags = elem_flags;
 
     if (ucs_unlikely(flags & UCT_SEND_FLAG_SIGNALED)) {
         uct_mm_ep_signal_remote(ep);
@@ -312,6 +510,9 @@ retry:
 
     switch (send_op) {
     case UCT_MM_SEND_AM_SHORT:
+    case UCT_MM_SEND_AM_ZCOPY:
+        /* the data was copied to the receiver, so the user's buffers
+         * can be reused */
         return UCS_OK;
     case UCT_MM_SEND_AM_BCOPY:
         return length;
@@ -332,7 +533,8 @@ ucs_status_t uct_mm_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
 
     return (ucs_status_t)uct_mm_ep_am_common_send(UCT_MM_SEND_AM_SHORT, ep,
                                                   iface, id, length, header,
-                                                  payload, NULL, NULL, 0);
+                                                  payload, NULL, NULL, NULL, 0,
+                                                  0);
 }
 
 ssize_t uct_mm_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id, uct_pack_callback_t pack_cb,
@@ -342,12 +544,38 @@ ssize_t uct_mm_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id, uct_pack_callback_t pack_
     uct_mm_ep_t *ep = ucs_derived_of(tl_ep, uct_mm_ep_t);
 
     return uct_mm_ep_am_common_send(UCT_MM_SEND_AM_BCOPY, ep, iface, id, 0, 0,
-                                    NULL, pack_cb, arg, flags);
+                                    NULL, pack_cb, arg, NULL, 0, flags);
+}
+
+ucs_status_t uct_mm_ep_am_zcopy(uct_ep_h tl_ep, uint8_t id, const void *header,
+                                unsigned header_length, const uct_iov_t *iov,
+                                size_t iovcnt, unsigned flags,
+                                uct_completion_t *comp)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_mm_iface_t);
+    uct_mm_ep_t *ep = ucs_derived_of(tl_ep, uct_mm_ep_t);
+
+    UCT_CHECK_IOV_SIZE(iovcnt, uct_sm_get_max_iov(), "uct_mm_ep_am_zcopy");
+    UCT_CHECK_LENGTH(header_length, 0, UCT_MM_AM_ZCOPY_MAX_HDR(iface),
+                     "am_zcopy header");
+    UCT_CHECK_LENGTH(header_length + uct_iov_total_length(iov, iovcnt), 0,
+                     iface->config.seg_size, "am_zcopy");
+
+    return (ucs_status_t)uct_mm_ep_am_common_send(UCT_MM_SEND_AM_ZCOPY, ep,
+                                                  iface, id, header_length, 0,
+                                                  header, NULL, NULL, iov,
+                                                  iovcnt, flags);
 }
 
 static inline int uct_mm_ep_has_tx_resources(uct_mm_ep_t *ep)
 {
     uct_mm_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_mm_iface_t);
+
+    if (ep->spsc.ctl != NULL) {
+        return UCT_MM_EP_IS_ABLE_TO_SEND(ep->spsc.head, ep->cached_tail,
+                                         iface->config.spsc_ring_size);
+    }
+
     return UCT_MM_EP_IS_ABLE_TO_SEND(ep->fifo_ctl->head, ep->cached_tail,
                                      iface->config.fifo_size);
 }
@@ -367,6 +595,7 @@ ucs_status_t uct_mm_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *n,
     UCS_STATIC_ASSERT(sizeof(uct_pending_req_priv_arb_t) <=
                       UCT_PENDING_REQ_PRIV_LEN);
     uct_pending_req_arb_group_push(&ep->arb_group, n);
+    ++ep->pending_count;
     /* add the ep's group to the arbiter */
     ucs_arbiter_group_schedule(&iface->arbiter, &ep->arb_group);
     UCT_TL_EP_STAT_PEND(&ep->super);
@@ -381,13 +610,24 @@ ucs_arbiter_cb_result_t uct_mm_ep_process_pending(ucs_arbiter_t *arbiter,
     uct_pending_req_t *req = ucs_container_of(elem, uct_pending_req_t, priv);
     ucs_status_t status;
     uct_mm_ep_t *ep = ucs_container_of(ucs_arbiter_elem_group(elem), uct_mm_ep_t, arb_group);
+    uct_mm_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_mm_iface_t);
+    int is_last = ucs_arbiter_elem_is_last(&ep->arb_group, elem);
 
-    /* update the local tail with its actual value from the remote peer
-     * making sure that the pending sends would use the real tail value */
-    uct_mm_ep_update_cached_tail(ep);
+    if (ep->tx_batch.budget == 0) {
+        /* first dispatch of this ep in the current progress call:
+         * update the local tail with its actual value from the remote peer
+         * making sure that the pending sends would use the real tail value */
+        uct_mm_ep_update_cached_tail(ep);
 
-    if (!uct_mm_ep_has_tx_resources(ep)) {
-        return UCS_ARBITER_CB_RESULT_RESCHED_GROUP;
+        if (!uct_mm_ep_has_tx_resources(ep)) {
+            return UCS_ARBITER_CB_RESULT_RESCHED_GROUP;
+        }
+
+        /* the arbiter dispatches up to tx_batch requests of the group */
+        ep->tx_batch.budget = ucs_min(ep->pending_count, iface->config.tx_batch);
+        if ((ep->tx_batch.budget > 1) && (ep->spsc.ctl == NULL)) {
+            uct_mm_ep_tx_batch_reserve(ep, iface, ep->tx_batch.budget);
+        }
     }
 
     ucs_trace_data("progressing pending request %p", req);
@@ -395,8 +635,19 @@ ucs_arbiter_cb_result_t uct_mm_ep_process_pending(ucs_arbiter_t *arbiter,
     ucs_trace_data("status returned from progress pending: %s",
                    ucs_status_string(status));
 
+    if ((status == UCS_OK) && (--ep->tx_batch.budget > 0) && !is_last) {
+        /* sent successfully, and the arbiter proceeds with the next request
+         * of this ep */
+        --ep->pending_count;
+        return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+    }
+
+    /* the arbiter moves to the next ep */
+    uct_mm_ep_tx_batch_release(ep, iface);
+
     if (status == UCS_OK) {
         /* sent successfully. remove from the arbiter */
+        --ep->pending_count;
         return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
     } else if (status == UCS_INPROGRESS) {
         /* sent but not completed, keep in the arbiter */
@@ -417,6 +668,7 @@ static ucs_arbiter_cb_result_t uct_mm_ep_abriter_purge_cb(ucs_arbiter_t *arbiter
     uct_pending_purge_callback_t cb = cb_args->cb;
     uct_mm_ep_t *ep = ucs_container_of(ucs_arbiter_elem_group(elem),
                                        uct_mm_ep_t, arb_group);
+    --ep->pending_count;
     if (cb != NULL) {
         cb(req, cb_args->arg);
     } else {
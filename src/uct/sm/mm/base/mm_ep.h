@@ -30,6 +30,15 @@ typedef struct uct_mm_ep {
     uint64_t                   cached_tail; /* the sender's own copy of the remote FIFO's tail.
                                                it is not always updated with the actual remote tail value */
 
+    /* Dedicated SPSC ring in the destination's receive FIFO segment */
+    struct {
+        uct_mm_spsc_ctl_t      *ctl;      /* ring control, NULL if the ep sends
+                                             to the shared FIFO */
+        void                   *elems;    /* ring elements */
+        uint64_t               head;      /* where to write next */
+        unsigned               index;     /* ring index */
+    } spsc;
+
     /* mapped remote memory chunks to which remote descriptors belong to.
      * (after attaching to them) */
     khash_t(uct_mm_remote_seg) remote_segs;
@@ -37,6 +46,15 @@ typedef struct uct_mm_ep {
     void                       *remote_iface_addr; /* remote md-specific address, can be NULL */
 
     ucs_arbiter_group_t        arb_group;   /* the group that holds this ep's pending operations */
+    unsigned                   pending_count; /* number of pending operations */
+
+    /* FIFO elements reserved for the pending operations which are dispatched
+     * in the current progress call */
+    struct {
+        uint64_t               head;      /* first reserved element */
+        unsigned               count;     /* number of reserved elements left */
+        unsigned               budget;    /* pending dispatches left */
+    } tx_batch;
 
     /* Used for signaling remote side wakeup */
     struct {
@@ -53,6 +71,10 @@ ucs_status_t uct_mm_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
                                 const void *payload, unsigned length);
 ssize_t uct_mm_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id, uct_pack_callback_t pack_cb,
                            void *arg, unsigned flags);
+ucs_status_t uct_mm_ep_am_zcopy(uct_ep_h tl_ep, uint8_t id, const void *header,
+                                unsigned header_length, const uct_iov_t *iov,
+                                size_t iovcnt, unsigned flags,
+                                uct_completion_t *comp);
 
 ucs_status_t uct_mm_ep_flush(uct_ep_h tl_ep, unsigned flags,
                              uct_completion_t *comp);
@@ -16,7 +16,9 @@
 #include <ucs/arch/atomic.h>
 #include <ucs/arch/bitops.h>
 #include <ucs/async/async.h>
+#include <ucs/memory/numa.h>
 #include <ucs/sys/string.h>
+#include <ucs/sys/topo.h>
 #include <sys/poll.h>
 
 
@@ -57,6 +59,39 @@ ucs_config_field_t uct_mm_iface_config_table[] = {
      "Size of the FIFO element size (data + header) in the MM UCTs.",
      ucs_offsetof(uct_mm_iface_config_t, fifo_elem_size), UCS_CONFIG_TYPE_UINT},
 
+    {"FIFO_NUMA_LOCAL", "y",
+     "Place the receive FIFO on the NUMA node of the CPU which creates the\n"
+     "interface. Senders write to the FIFO remotely, while the receiver polls it,\n"
+     "so keeping it local to the receiver avoids cross-socket polling.",
+     ucs_offsetof(uct_mm_iface_config_t, fifo_numa_local), UCS_CONFIG_TYPE_BOOL},
+
+    {"FIFO_MAX_POLL", "16",
+     "Maximal number of receive FIFO elements to process in a single progress\n"
+     "call. Draining several ready elements at once reduces the per-message\n"
+     "overhead when many peers send to the same interface.",
+     ucs_offsetof(uct_mm_iface_config_t, fifo_max_poll), UCS_CONFIG_TYPE_UINT},
+
+    {"TX_BATCH", "8",
+     "Maximal number of pending sends of an endpoint to dispatch in a single\n"
+     "progress call. The remote FIFO elements for all of them are reserved by\n"
+     "a single atomic operation, which reduces the contention on the FIFO head\n"
+     "when many peers send to the same interface.",
+     ucs_offsetof(uct_mm_iface_config_t, tx_batch), UCS_CONFIG_TYPE_UINT},
+
+    {"SPSC_RINGS", "0",
+     "Number of dedicated single-producer receive rings in addition to the\n"
+     "shared receive FIFO. Every connected sender takes a free ring, if there is\n"
+     "one, and sends to it without atomic operations and without sharing cache\n"
+     "lines with other senders. Senders which do not get a ring use the shared\n"
+     "FIFO. Must be the same on all peers, and not larger than "
+     UCS_PP_MAKE_STRING(UCT_MM_SPSC_MAX_RINGS) ".",
+     ucs_offsetof(uct_mm_iface_config_t, spsc_num_rings), UCS_CONFIG_TYPE_UINT},
+
+    {"SPSC_RING_SIZE", "16",
+     "Size of a dedicated single-producer receive ring. Must be a power of two,\n"
+     "and the same on all peers.",
+     ucs_offsetof(uct_mm_iface_config_t, spsc_ring_size), UCS_CONFIG_TYPE_UINT},
+
     {NULL}
 };
 
@@ -108,23 +143,25 @@ static ucs_status_t uct_mm_iface_query(uct_iface_h tl_iface,
     iface_attr->cap.put.max_zcopy       = SIZE_MAX;
     iface_attr->cap.put.opt_zcopy_align = UCS_SYS_CACHE_LINE_SIZE;
     iface_attr->cap.put.align_mtu       = iface_attr->cap.put.opt_zcopy_align;
-    iface_attr->cap.put.max_iov         = 1;
+    iface_attr->cap.put.max_iov         = uct_sm_get_max_iov();
 
     iface_attr->cap.get.max_bcopy       = SIZE_MAX;
     iface_attr->cap.get.min_zcopy       = 0;
     iface_attr->cap.get.max_zcopy       = SIZE_MAX;
     iface_attr->cap.get.opt_zcopy_align = UCS_SYS_CACHE_LINE_SIZE;
     iface_attr->cap.get.align_mtu       = iface_attr->cap.get.opt_zcopy_align;
-    iface_attr->cap.get.max_iov         = 1;
+    iface_attr->cap.get.max_iov         = uct_sm_get_max_iov();
 
     iface_attr->cap.am.max_short        = iface->config.fifo_elem_size -
                                           sizeof(uct_mm_fifo_element_t);
     iface_attr->cap.am.max_bcopy        = iface->config.seg_size;
     iface_attr->cap.am.min_zcopy        = 0;
-    iface_attr->cap.am.max_zcopy        = 0;
+    iface_attr->cap.am.max_zcopy        = iface->config.seg_size -
+                                          UCT_MM_AM_ZCOPY_MAX_HDR(iface);
+    iface_attr->cap.am.max_hdr          = UCT_MM_AM_ZCOPY_MAX_HDR(iface);
     iface_attr->cap.am.opt_zcopy_align  = UCS_SYS_CACHE_LINE_SIZE;
     iface_attr->cap.am.align_mtu        = iface_attr->cap.am.opt_zcopy_align;
-    iface_attr->cap.am.max_iov          = 1;
+    iface_attr->cap.am.max_iov          = uct_sm_get_max_iov();
 
     iface_attr->iface_addr_len          = sizeof(uct_mm_iface_addr_t) +
                                           md->iface_addr_len;
@@ -133,10 +170,13 @@ static ucs_status_t uct_mm_iface_query(uct_iface_h tl_iface,
     iface_attr->max_conn_priv           = 0;
     iface_attr->cap.flags               = UCT_IFACE_FLAG_PUT_SHORT           |
                                           UCT_IFACE_FLAG_PUT_BCOPY           |
+                                          UCT_IFACE_FLAG_PUT_ZCOPY           |
                                           UCT_IFACE_FLAG_ATOMIC_CPU          |
                                           UCT_IFACE_FLAG_GET_BCOPY           |
+                                          UCT_IFACE_FLAG_GET_ZCOPY           |
                                           UCT_IFACE_FLAG_AM_SHORT            |
                                           UCT_IFACE_FLAG_AM_BCOPY            |
+                                          UCT_IFACE_FLAG_AM_ZCOPY            |
                                           UCT_IFACE_FLAG_PENDING             |
                                           UCT_IFACE_FLAG_CB_SYNC             |
                                           UCT_IFACE_FLAG_EVENT_SEND_COMP     |
@@ -200,7 +240,10 @@ static inline ucs_status_t uct_mm_iface_process_recv(uct_mm_iface_t *iface,
     ucs_status_t status;
     void         *data;
 
-    if (ucs_likely(elem->flags & UCT_MM_FIFO_ELEM_FLAG_INLINE)) {
+    if (ucs_unlikely(elem->flags & UCT_MM_FIFO_ELEM_FLAG_NOP)) {
+        /* the element was reserved by a batch of sends, but not used */
+        return UCS_OK;
+    } else if (ucs_likely(elem->flags & UCT_MM_FIFO_ELEM_FLAG_INLINE)) {
         /* read short (inline) messages from the FIFO elements */
         uct_iface_trace_am(&iface->super.super, UCT_AM_TRACE_TYPE_RECV,
                            elem->am_id, elem + 1, elem->length, "RX: AM_SHORT");
@@ -224,10 +267,12 @@ static inline ucs_status_t uct_mm_iface_process_recv(uct_mm_iface_t *iface,
     return status;
 }
 
-static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
+/* Process the element at read_index of a FIFO or a ring, if it was written.
+ * return 1 if the element was processed, 0 otherwise. */
+static UCS_F_ALWAYS_INLINE int
+uct_mm_iface_poll_elem(uct_mm_iface_t *iface, uct_mm_fifo_element_t *elem,
+                       uint64_t read_index, uint8_t fifo_shift)
 {
-    uint64_t read_index_loc, read_index;
-    uct_mm_fifo_element_t* read_index_elem;
     ucs_status_t status;
 
     /* check the memory pool to make sure that there is a new descriptor available */
@@ -236,49 +281,151 @@ static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
                                  iface->last_recv_desc, return 0);
     }
 
-    read_index = iface->read_index;
-    read_index_loc = (read_index & iface->fifo_mask);
+    /* check the read_index to see if there is a new item to read (checking the owner bit) */
+    if (((read_index >> fifo_shift) & 1) != ((elem->flags) & 1)) {
+        return 0;
+    }
+
+    /* read from the element */
+    ucs_memory_cpu_load_fence();
+
+    status = uct_mm_iface_process_recv(iface, elem);
+    if (status != UCS_OK) {
+        /* the last_recv_desc is in use. get a new descriptor for it */
+        UCT_TL_IFACE_GET_RX_DESC(&iface->super.super, &iface->recv_desc_mp,
+                                 iface->last_recv_desc, ucs_debug("recv mpool is empty"));
+    }
+
+    return 1;
+}
+
+static inline unsigned uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
+{
+    uct_mm_fifo_element_t* read_index_elem;
+
     /* the fifo_element which the read_index points to */
     read_index_elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elems,
-                                                 read_index_loc);
+                                                 iface->read_index &
+                                                 iface->fifo_mask);
+    if (!uct_mm_iface_poll_elem(iface, read_index_elem, iface->read_index,
+                                iface->fifo_shift)) {
+        return 0;
+    }
 
-    /* check the read_index to see if there is a new item to read (checking the owner bit) */
-    if (((read_index >> iface->fifo_shift) & 1) == ((read_index_elem->flags) & 1)) {
+    ucs_assert(iface->read_index < iface->recv_fifo_ctl->head);
 
-        /* read from read_index_elem */
-        ucs_memory_cpu_load_fence();
-        ucs_assert(iface->read_index <= iface->recv_fifo_ctl->head);
+    /* raise the read_index. */
+    iface->read_index++;
 
-        status = uct_mm_iface_process_recv(iface, read_index_elem);
-        if (status != UCS_OK) {
-            /* the last_recv_desc is in use. get a new descriptor for it */
-            UCT_TL_IFACE_GET_RX_DESC(&iface->super.super, &iface->recv_desc_mp,
-                                     iface->last_recv_desc, ucs_debug("recv mpool is empty"));
-        }
+    uct_mm_progress_fifo_tail(iface);
 
-        /* raise the read_index. */
-        iface->read_index++;
+    return 1;
+}
 
-        uct_mm_progress_fifo_tail(iface);
+static inline unsigned uct_mm_iface_poll_spsc_ring(uct_mm_iface_t *iface,
+                                                   unsigned ring)
+{
+    uint64_t read_index = iface->spsc.read_index[ring];
+    uct_mm_fifo_element_t *elem;
 
-        return 1;
-    } else {
+    elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface,
+                                      UCT_MM_IFACE_GET_SPSC_ELEMS(iface,
+                                                                  iface->recv_fifo_elems,
+                                                                  ring),
+                                      read_index & iface->spsc.mask);
+    if (!uct_mm_iface_poll_elem(iface, elem, read_index, iface->spsc.shift)) {
         return 0;
     }
+
+    iface->spsc.read_index[ring] = ++read_index;
+
+    /* release the ring elements in batches, as the shared FIFO */
+    if (!(read_index & iface->spsc.release_factor_mask)) {
+        UCT_MM_IFACE_GET_SPSC_CTL(iface, iface->recv_fifo_elems,
+                                  ring)->tail = read_index;
+    }
+
+    return 1;
+}
+
+/* Free a dedicated ring if its sender stopped using it, and all the elements
+ * it has written were read */
+static void uct_mm_iface_spsc_ring_check_free(uct_mm_iface_t *iface,
+                                              unsigned ring)
+{
+    uct_mm_spsc_ctl_t *ctl = UCT_MM_IFACE_GET_SPSC_CTL(iface,
+                                                       iface->recv_fifo_elems,
+                                                       ring);
+    uint64_t read_index    = iface->spsc.read_index[ring];
+
+    if (!ctl->released) {
+        return;
+    }
+
+    /* the sender updates the head before setting the released flag */
+    ucs_memory_cpu_load_fence();
+    if (ctl->head != read_index) {
+        return;
+    }
+
+    /* the next sender which takes the ring starts with the exact tail */
+    ctl->tail = read_index;
+    ucs_memory_cpu_store_fence();
+    ucs_atomic_and64(&iface->recv_fifo_ctl->spsc_alloc[ring / 64],
+                     ~UCS_BIT(ring % 64));
+    ucs_debug("mm_iface %p: freed dedicated ring %u", iface, ring);
+}
+
+/* Poll the dedicated rings which are taken by senders */
+static UCS_F_NOINLINE unsigned uct_mm_iface_poll_spsc(uct_mm_iface_t *iface)
+{
+    unsigned total_count = 0;
+    unsigned word, bit, count, ring_count;
+    uint64_t alloc;
+
+    for (word = 0; word < ucs_div_round_up(iface->config.spsc_num_rings, 64);
+         ++word) {
+        alloc = iface->recv_fifo_ctl->spsc_alloc[word];
+        ucs_for_each_bit(bit, alloc) {
+            ring_count = 0;
+            do {
+                count       = uct_mm_iface_poll_spsc_ring(iface,
+                                                          (word * 64) + bit);
+                ring_count += count;
+            } while ((count != 0) && (ring_count < iface->config.fifo_max_poll));
+
+            if (ring_count == 0) {
+                uct_mm_iface_spsc_ring_check_free(iface, (word * 64) + bit);
+            }
+
+            total_count += ring_count;
+        }
+    }
+
+    return total_count;
 }
 
 unsigned uct_mm_iface_progress(void *arg)
 {
     uct_mm_iface_t *iface = arg;
+    unsigned total_count = 0;
     unsigned count;
 
-    /* progress receive */
-    count = uct_mm_iface_poll_fifo(iface);
+    /* progress receive - drain up to fifo_max_poll ready elements */
+    do {
+        count        = uct_mm_iface_poll_fifo(iface);
+        total_count += count;
+    } while ((count != 0) && (total_count < iface->config.fifo_max_poll));
+
+    if (iface->config.spsc_num_rings > 0) {
+        total_count += uct_mm_iface_poll_spsc(iface);
+    }
 
     /* progress the pending sends (if there are any) */
-    ucs_arbiter_dispatch(&iface->arbiter, 1, uct_mm_ep_process_pending, NULL);
+    ucs_arbiter_dispatch(&iface->arbiter, iface->config.tx_batch,
+                         uct_mm_ep_process_pending, NULL);
 
-    return count;
+    return total_count;
 }
 
 static ucs_status_t uct_mm_iface_event_fd_get(uct_iface_h tl_iface, int *fd_p)
@@ -317,9 +464,12 @@ static UCS_CLASS_DECLARE_DELETE_FUNC(uct_mm_iface_t, uct_iface_t);
 static uct_iface_ops_t uct_mm_iface_ops = {
     .ep_put_short             = uct_sm_ep_put_short,
     .ep_put_bcopy             = uct_sm_ep_put_bcopy,
+    .ep_put_zcopy             = uct_sm_ep_put_zcopy,
     .ep_get_bcopy             = uct_sm_ep_get_bcopy,
+    .ep_get_zcopy             = uct_sm_ep_get_zcopy,
     .ep_am_short              = uct_mm_ep_am_short,
     .ep_am_bcopy              = uct_mm_ep_am_bcopy,
+    .ep_am_zcopy              = uct_mm_ep_am_zcopy,
     .ep_atomic_cswap64        = uct_sm_ep_atomic_cswap64,
     .ep_atomic64_post         = uct_sm_ep_atomic64_post,
     .ep_atomic64_fetch        = uct_sm_ep_atomic64_fetch,
@@ -466,9 +616,27 @@ static void uct_mm_iface_log_created(uct_mm_iface_t *iface)
 {
     uct_mm_seg_t UCS_V_UNUSED *seg = iface->recv_fifo_mem.memh;
 
-    ucs_debug("created mm iface %p FIFO id 0x%lx va %p size %zu (%u x %u elems)",
-              iface, seg->seg_id, seg->address, seg->length,
-              iface->config.fifo_elem_size, iface->config.fifo_size);
+    ucs_debug("created mm iface %p FIFO id 0x%lx va %p size %zu (%u x %u elems, "
+              "%u x %u rings)", iface, seg->seg_id, seg->address, seg->length,
+              iface->config.fifo_elem_size, iface->config.fifo_size,
+              iface->config.spsc_num_rings, iface->config.spsc_ring_size);
+}
+
+static void uct_mm_iface_place_fifo(uct_mm_iface_t *iface)
+{
+    int numa_node = ucs_topo_get_local_numa_node();
+    ucs_status_t status;
+
+    if (numa_node < 0) {
+        return;
+    }
+
+    /* Best effort: the FIFO stays usable if the policy cannot be set */
+    status = ucs_numa_set_preferred_node(iface->recv_fifo_mem.address,
+                                         UCT_MM_GET_FIFO_SIZE(iface),
+                                         numa_node);
+    ucs_debug("mm_iface %p: placing receive FIFO on numa node %d: %s", iface,
+              numa_node, ucs_status_string(status));
 }
 
 static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
@@ -478,6 +646,7 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
     uct_mm_iface_config_t *mm_config =
                     ucs_derived_of(tl_config, uct_mm_iface_config_t);
     uct_mm_fifo_element_t* fifo_elem_p;
+    uct_mm_spsc_ctl_t *spsc_ctl;
     ucs_status_t status;
     unsigned i;
 
@@ -512,15 +681,47 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto err;
     }
 
+    if ((mm_config->spsc_num_rings > UCT_MM_SPSC_MAX_RINGS) ||
+        ((mm_config->spsc_num_rings > 0) &&
+         ((mm_config->spsc_ring_size <= 1) ||
+          !ucs_is_pow2(mm_config->spsc_ring_size)))) {
+        ucs_error("The MM SPSC rings number must be at most %d, and their size "
+                  "must be a power of two and bigger than 1.",
+                  UCT_MM_SPSC_MAX_RINGS);
+        status = UCS_ERR_INVALID_PARAM;
+        goto err;
+    }
+
+    if ((mm_config->fifo_max_poll == 0) || (mm_config->tx_batch == 0)) {
+        ucs_error("The MM FIFO_MAX_POLL and TX_BATCH parameters must be "
+                  "positive.");
+        status = UCS_ERR_INVALID_PARAM;
+        goto err;
+    }
+
     self->config.fifo_size         = mm_config->fifo_size;
     self->config.fifo_elem_size    = mm_config->fifo_elem_size;
     self->config.seg_size          = mm_config->seg_size;
+    self->config.fifo_max_poll     = mm_config->fifo_max_poll;
+    self->config.tx_batch          = mm_config->tx_batch;
+    self->config.spsc_num_rings    = mm_config->spsc_num_rings;
+    self->config.spsc_ring_size    = (mm_config->spsc_num_rings > 0) ?
+                                     mm_config->spsc_ring_size : 0;
     /* cppcheck-suppress internalAstError */
     self->fifo_release_factor_mask = UCS_MASK(ucs_ilog2(ucs_max((int)
                                      (mm_config->fifo_size * mm_config->release_fifo_factor),
                                      1)));
     self->fifo_mask                = mm_config->fifo_size - 1;
     self->fifo_shift               = ucs_count_trailing_zero_bits(mm_config->fifo_size);
+    if (self->config.spsc_num_rings > 0) {
+        self->spsc.mask                = self->config.spsc_ring_size - 1;
+        self->spsc.shift               = ucs_count_trailing_zero_bits(
+                                                 self->config.spsc_ring_size);
+        self->spsc.release_factor_mask = UCS_MASK(ucs_ilog2(ucs_max((int)
+                                         (self->config.spsc_ring_size *
+                                          mm_config->release_fifo_factor), 1)));
+    }
+    memset(self->spsc.read_index, 0, sizeof(self->spsc.read_index));
     self->rx_headroom              = (params->field_mask &
                                       UCT_IFACE_PARAM_FIELD_RX_HEADROOM) ?
                                      params->rx_headroom : 0;
@@ -536,11 +737,23 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         return status;
     }
 
+    if (mm_config->fifo_numa_local) {
+        uct_mm_iface_place_fifo(self);
+    }
+
     uct_mm_iface_set_fifo_ptrs(self->recv_fifo_mem.address,
                                &self->recv_fifo_ctl, &self->recv_fifo_elems);
     self->recv_fifo_ctl->head = 0;
     self->recv_fifo_ctl->tail = 0;
     self->read_index          = 0;
+    memset((void*)self->recv_fifo_ctl->spsc_alloc, 0,
+           sizeof(self->recv_fifo_ctl->spsc_alloc));
+    for (i = 0; i < self->config.spsc_num_rings; i++) {
+        spsc_ctl       = UCT_MM_IFACE_GET_SPSC_CTL(self, self->recv_fifo_elems, i);
+        spsc_ctl->head     = 0;
+        spsc_ctl->tail     = 0;
+        spsc_ctl->released = 0;
+    }
 
     /* create a unix file descriptor to receive event notifications */
     status = uct_mm_iface_create_signal_fd(self);
@@ -564,7 +777,8 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto err_close_signal_fd;
     }
 
-    ucs_mpool_grow(&self->recv_desc_mp, mm_config->fifo_size * 2);
+    ucs_mpool_grow(&self->recv_desc_mp, UCT_MM_IFACE_NUM_FIFO_ELEMS(self) +
+                                        mm_config->fifo_size);
 
     /* set the first receive descriptor */
     self->last_recv_desc = ucs_mpool_get(&self->recv_desc_mp);
@@ -575,9 +789,9 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto destroy_recv_mpool;
     }
 
-    /* initiate the owner bit in all the FIFO elements and assign a receive descriptor
-     * per every FIFO element */
-    for (i = 0; i < mm_config->fifo_size; i++) {
+    /* initiate the owner bit in all the FIFO and rings elements and assign a
+     * receive descriptor per every element */
+    for (i = 0; i < UCT_MM_IFACE_NUM_FIFO_ELEMS(self); i++) {
         fifo_elem_p = UCT_MM_IFACE_GET_FIFO_ELEM(self, self->recv_fifo_elems, i);
         fifo_elem_p->flags = UCT_MM_FIFO_ELEM_FLAG_OWNER;
 
@@ -613,7 +827,7 @@ static UCS_CLASS_CLEANUP_FUNC(uct_mm_iface_t)
 
     /* return all the descriptors that are now 'assigned' to the FIFO,
      * to their mpool */
-    uct_mm_iface_free_rx_descs(self, self->config.fifo_size);
+    uct_mm_iface_free_rx_descs(self, UCT_MM_IFACE_NUM_FIFO_ELEMS(self));
 
     ucs_mpool_put(self->last_recv_desc);
     ucs_mpool_cleanup(&self->recv_desc_mp, 1);
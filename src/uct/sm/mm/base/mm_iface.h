@@ -24,17 +24,37 @@
 enum {
     UCT_MM_FIFO_ELEM_FLAG_OWNER  = UCS_BIT(0), /* new/old info */
     UCT_MM_FIFO_ELEM_FLAG_INLINE = UCS_BIT(1), /* if inline or not */
+    UCT_MM_FIFO_ELEM_FLAG_NOP    = UCS_BIT(2), /* reserved by a batch of sends
+                                                  but not used, to be skipped */
 };
 
 
+/* Maximal number of dedicated SPSC rings in the receive FIFO segment */
+#define UCT_MM_SPSC_MAX_RINGS  256
+
+
 #define UCT_MM_FIFO_CTL_SIZE \
     ucs_align_up(sizeof(uct_mm_fifo_ctl_t), UCS_SYS_CACHE_LINE_SIZE)
 
 
+/* Number of elements in the shared FIFO and in all the dedicated SPSC rings.
+ * The elements of the rings follow the shared FIFO elements. */
+#define UCT_MM_IFACE_NUM_FIFO_ELEMS(_iface) \
+    ((_iface)->config.fifo_size + \
+     ((_iface)->config.spsc_num_rings * (_iface)->config.spsc_ring_size))
+
+
 #define UCT_MM_GET_FIFO_SIZE(_iface) \
     (UCT_MM_FIFO_CTL_SIZE + \
-     ((_iface)->config.fifo_size * (_iface)->config.fifo_elem_size) + \
-      (UCS_SYS_CACHE_LINE_SIZE - 1))
+     (UCT_MM_IFACE_NUM_FIFO_ELEMS(_iface) * (_iface)->config.fifo_elem_size) + \
+     ((_iface)->config.spsc_num_rings * sizeof(uct_mm_spsc_ctl_t)) + \
+     (2 * (UCS_SYS_CACHE_LINE_SIZE - 1)))
+
+
+/* AM Zcopy header is limited as AM Short data, the rest of the receive
+ * descriptor is used for the payload */
+#define UCT_MM_AM_ZCOPY_MAX_HDR(_iface) \
+    ((_iface)->config.fifo_elem_size - sizeof(uct_mm_fifo_element_t))
 
 
 #define UCT_MM_IFACE_GET_FIFO_ELEM(_iface, _fifo, _index) \
@@ -42,6 +62,20 @@ enum {
      UCS_PTR_BYTE_OFFSET(_fifo, (_index) * (_iface)->config.fifo_elem_size))
 
 
+/* First element of a dedicated SPSC ring */
+#define UCT_MM_IFACE_GET_SPSC_ELEMS(_iface, _fifo, _ring) \
+    UCT_MM_IFACE_GET_FIFO_ELEM(_iface, _fifo, (_iface)->config.fifo_size + \
+                               ((_ring) * (_iface)->config.spsc_ring_size))
+
+
+/* Control structure of a dedicated SPSC ring, they follow all FIFO elements */
+#define UCT_MM_IFACE_GET_SPSC_CTL(_iface, _fifo, _ring) \
+    ((uct_mm_spsc_ctl_t*)ucs_align_up_pow2_ptr( \
+        UCT_MM_IFACE_GET_FIFO_ELEM(_iface, _fifo, \
+                                   UCT_MM_IFACE_NUM_FIFO_ELEMS(_iface)), \
+        UCS_SYS_CACHE_LINE_SIZE) + (_ring))
+
+
 #define uct_mm_iface_mapper_call(_iface, _func, ...) \
     ({ \
         uct_mm_md_t *md = ucs_derived_of((_iface)->super.super.md, uct_mm_md_t); \
@@ -61,6 +95,16 @@ typedef struct uct_mm_iface_config {
     ucs_ternary_value_t      hugetlb_mode;    /* Enable using huge pages for
                                                * shared memory buffers */
     unsigned                 fifo_elem_size;  /* Size of the FIFO element size */
+    int                      fifo_numa_local; /* Place the receive FIFO on the
+                                               * NUMA node of the receiver */
+    unsigned                 fifo_max_poll;   /* How many FIFO elements to
+                                               * process in one progress call */
+    unsigned                 tx_batch;        /* How many FIFO elements to
+                                               * reserve at once for pending
+                                               * sends */
+    unsigned                 spsc_num_rings;  /* Number of dedicated SPSC
+                                               * rings for senders */
+    unsigned                 spsc_ring_size;  /* Size of a dedicated ring */
     uct_iface_mpool_config_t mp;
 } uct_mm_iface_config_t;
 
@@ -88,9 +132,37 @@ typedef struct uct_mm_fifo_ctl {
 
     /* 2nd cacheline */
     volatile uint64_t         tail;           /* How much was consumed */
+    UCS_CACHELINE_PADDING(uint64_t);
+
+    /* 3rd cacheline */
+    volatile uint64_t         spsc_alloc[UCT_MM_SPSC_MAX_RINGS / 64];
+                                              /* Bitmap of the dedicated SPSC
+                                                 rings taken by senders, a
+                                                 ring is freed by the receiver
+                                                 when it's released by the
+                                                 sender and drained */
 } UCS_S_PACKED UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE) uct_mm_fifo_ctl_t;
 
 
+/**
+ * MM dedicated SPSC ring control. The ring is written by a single sender, so
+ * it does not need an atomic operation to allocate an element.
+ */
+typedef struct uct_mm_spsc_ctl {
+    /* 1st cacheline */
+    volatile uint64_t         head;           /* Where to write next, updated by
+                                                 the sender only when it stops
+                                                 using the ring */
+    volatile uint32_t         released;       /* Set by the sender when it stops
+                                                 using the ring */
+    UCS_CACHELINE_PADDING(uint64_t, uint32_t);
+
+    /* 2nd cacheline */
+    volatile uint64_t         tail;           /* How much was consumed */
+    UCS_CACHELINE_PADDING(uint64_t);
+} UCS_S_PACKED UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE) uct_mm_spsc_ctl_t;
+
+
 /**
  * MM receive descriptor info in the shared FIFO
  */
@@ -170,7 +242,20 @@ typedef struct uct_mm_iface {
         unsigned            fifo_size;
         unsigned            fifo_elem_size;
         unsigned            seg_size;         /* size of the receive descriptor (for payload)*/
+        unsigned            fifo_max_poll;    /* max. FIFO elements to process per progress */
+        unsigned            tx_batch;         /* max. pending sends per FIFO reservation */
+        unsigned            spsc_num_rings;   /* number of dedicated SPSC rings */
+        unsigned            spsc_ring_size;   /* size of a dedicated SPSC ring */
     } config;
+
+    /* Dedicated SPSC rings */
+    struct {
+        uint8_t             shift;            /* = log2(spsc_ring_size) */
+        unsigned            mask;             /* = spsc_ring_size - 1 */
+        uint64_t            release_factor_mask;
+        uint64_t            read_index[UCT_MM_SPSC_MAX_RINGS];
+                                              /* reading location per ring */
+    } spsc;
 } uct_mm_iface_t;
 
 
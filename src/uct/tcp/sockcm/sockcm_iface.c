@@ -197,13 +197,13 @@ static void uct_sockcm_iface_event_handler(int fd, void *arg)
     size_t recv_len               = 0;
     uct_sockcm_iface_t *iface     = arg;
     uct_sockcm_ctx_t *sock_id_ctx = NULL;
-    struct sockaddr peer_addr;
+    struct sockaddr_storage peer_addr;
     socklen_t addrlen;
     int accept_fd;
     char ip_port_str[UCS_SOCKADDR_STRING_LEN];
     ucs_status_t status;
 
-    addrlen   = sizeof(struct sockaddr);
+    addrlen   = sizeof(peer_addr);
     accept_fd = accept(iface->listen_fd, (struct sockaddr*)&peer_addr, &addrlen);
     if (accept_fd == -1) {
          if ((errno == EAGAIN) || (errno == EINTR)) {
@@ -217,7 +217,7 @@ static void uct_sockcm_iface_event_handler(int fd, void *arg)
     }
 
     ucs_debug("sockcm_iface %p: accepted connection from %s at fd %d %m", iface,
-              ucs_sockaddr_str(&peer_addr, ip_port_str,
+              ucs_sockaddr_str((struct sockaddr*)&peer_addr, ip_port_str,
                                UCS_SOCKADDR_STRING_LEN), accept_fd);
 
     /* Unlike rdmacm, socket connect/accept does not permit exchange of
@@ -36,16 +36,32 @@
  * (TCP protocol and user's AM headers, payload) */
 #define UCT_TCP_EP_AM_SHORTV_IOV_COUNT        3
 
+/* Whether the kernel headers support zero-copy send (MSG_ZEROCOPY) */
+#define UCT_TCP_HAVE_MSG_ZCOPY                (HAVE_DECL_MSG_ZEROCOPY && \
+                                               HAVE_DECL_SO_ZEROCOPY && \
+                                               HAVE_DECL_SO_EE_ORIGIN_ZEROCOPY)
+
 /* Maximum size of a data that can be sent by PUT Zcopy
  * operation */
 #define UCT_TCP_EP_PUT_ZCOPY_MAX              SIZE_MAX
 
+/* Maximum size of a data that can be read by GET Zcopy operation */
+#define UCT_TCP_EP_GET_ZCOPY_MAX              SIZE_MAX
+
+/* Length of a data that is used by GET protocol */
+#define UCT_TCP_EP_GET_SERVICE_LENGTH        (sizeof(uct_tcp_am_hdr_t) + \
+                                              sizeof(uct_tcp_ep_get_rep_hdr_t))
+
 /* Length of a data that is used by PUT protocol */
 #define UCT_TCP_EP_PUT_SERVICE_LENGTH        (sizeof(uct_tcp_am_hdr_t) + \
                                               sizeof(uct_tcp_ep_put_req_hdr_t))
 
 #define UCT_TCP_CONFIG_MAX_CONN_RETRIES      "MAX_CONN_RETRIES"
 
+/* Maximum number of sockets that can be used by a single EP to send
+ * PUT Zcopy payload, including the EP's own socket */
+#define UCT_TCP_EP_MAX_STRIPES               16
+
 
 /**
  * TCP context type
@@ -70,7 +86,9 @@ typedef enum uct_tcp_ep_ctx_type {
     UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK,
     /* - PUT RX operation is waiting for resources to send an ACK
      *   for received PUT operations on a given EP */
-    UCT_TCP_EP_CTX_TYPE_PUT_RX_SENDING_ACK
+    UCT_TCP_EP_CTX_TYPE_PUT_RX_SENDING_ACK,
+    /* - GET reply is being received to a user's buffer on a given EP */
+    UCT_TCP_EP_CTX_TYPE_GET_RX
 } uct_tcp_ep_ctx_type_t;
 
 
@@ -105,13 +123,29 @@ typedef enum uct_tcp_ep_conn_state {
     UCT_TCP_EP_CONN_STATE_CONNECTED
 } uct_tcp_ep_conn_state_t;
 
+
+/**
+ * TCP endpoint stripe type
+ */
+typedef enum uct_tcp_ep_stripe_type {
+    /* Regular EP. */
+    UCT_TCP_EP_STRIPE_NONE,
+    /* EP is connected to a peer to send parts of PUT operations issued on
+     * the parent EP. It is hidden from a user and destroyed with the
+     * parent EP. */
+    UCT_TCP_EP_STRIPE_TX,
+    /* EP is accepted from a peer to receive parts of PUT operations destined
+     * to the parent EP. It is destroyed when the peer closes the connection. */
+    UCT_TCP_EP_STRIPE_RX
+} uct_tcp_ep_stripe_type_t;
+
 /* Forward declaration */
 typedef struct uct_tcp_ep uct_tcp_ep_t;
 
 typedef unsigned (*uct_tcp_ep_progress_t)(uct_tcp_ep_t *ep);
 
-static inline int uct_tcp_khash_sockaddr_in_equal(struct sockaddr_in sa1,
-                                                  struct sockaddr_in sa2)
+static inline int uct_tcp_khash_sockaddr_equal(struct sockaddr_storage sa1,
+                                               struct sockaddr_storage sa2)
 {
     ucs_status_t status;
     int cmp;
@@ -123,19 +157,35 @@ static inline int uct_tcp_khash_sockaddr_in_equal(struct sockaddr_in sa1,
     return !cmp;
 }
 
-static inline uint32_t uct_tcp_khash_sockaddr_in_hash(struct sockaddr_in sa)
+static inline uint32_t uct_tcp_khash_sockaddr_hash(struct sockaddr_storage sa)
 {
     ucs_status_t UCS_V_UNUSED status;
-    size_t addr_size;
+    size_t in_addr_size;
+    uint16_t port;
 
-    status = ucs_sockaddr_sizeof((const struct sockaddr*)&sa,
-                                 &addr_size);
+    /* Only the fields which are compared by ucs_sockaddr_cmp() are hashed,
+     * since IPv6 flow info and scope ID may be not initialized */
+    status = ucs_sockaddr_inet_addr_sizeof((const struct sockaddr*)&sa,
+                                           &in_addr_size);
+    ucs_assert(status == UCS_OK);
+    status = ucs_sockaddr_get_port((const struct sockaddr*)&sa, &port);
     ucs_assert(status == UCS_OK);
-    return ucs_crc32(0, (const void *)&sa, addr_size);
+    return ucs_crc32(port,
+                     ucs_sockaddr_get_inet_addr((const struct sockaddr*)&sa),
+                     in_addr_size);
 }
 
-KHASH_INIT(uct_tcp_cm_eps, struct sockaddr_in, ucs_list_link_t*,
-           1, uct_tcp_khash_sockaddr_in_hash, uct_tcp_khash_sockaddr_in_equal);
+KHASH_INIT(uct_tcp_cm_eps, struct sockaddr_storage, ucs_list_link_t*,
+           1, uct_tcp_khash_sockaddr_hash, uct_tcp_khash_sockaddr_equal);
+
+
+/**
+ * TCP device address, the IP address of the iface follows the header.
+ * Its size (in_addr or in6_addr) is defined by the address family.
+ */
+typedef struct uct_tcp_device_addr {
+    sa_family_t                   sa_family;  /* Address family of the iface */
+} UCS_S_PACKED uct_tcp_device_addr_t;
 
 
 /**
@@ -161,6 +211,10 @@ typedef enum uct_tcp_cm_conn_event {
      * The mesage is not sent separately (only along with a connection
      * acknowledgment.) */
     UCT_TCP_CM_CONN_WAIT_REQ          = UCS_BIT(2),
+    /* Connection request from a EP that has to send parts of PUT operations
+     * of another EP (stripe connection). The peer attaches the connection to
+     * the EP which receives data from this EP. */
+    UCT_TCP_CM_CONN_STRIPE_REQ        = UCS_BIT(3),
     /* Connection acknowledgment + Connection request. The mesasge is sent
      * from a EP that accepts remote conenction when it was in
      * `UCT_TCP_EP_CONN_STATE_CONNECTING` state (i.e. original
@@ -183,7 +237,10 @@ typedef enum uct_tcp_cm_conn_event {
  */
 typedef struct uct_tcp_cm_conn_req_pkt {
     uct_tcp_cm_conn_event_t       event;      /* Connection event ID */
-    struct sockaddr_in            iface_addr; /* Socket address of UCT local iface */
+    struct sockaddr_storage       iface_addr; /* Socket address of UCT local iface,
+                                               * its family is checked by the peer */
+    uint64_t                      ep_id;      /* ID of the EP which sends data
+                                               * through the connection */
 } UCS_S_PACKED uct_tcp_cm_conn_req_pkt_t;
 
 
@@ -205,7 +262,20 @@ typedef enum uct_tcp_ep_am_id {
     /* AM ID reserved for TCP internal PUT REQ message */
     UCT_TCP_EP_PUT_REQ_AM_ID = UCT_AM_ID_MAX + 1,
     /* AM ID reserved for TCP internal PUT ACK message */
-    UCT_TCP_EP_PUT_ACK_AM_ID = UCT_AM_ID_MAX + 2
+    UCT_TCP_EP_PUT_ACK_AM_ID = UCT_AM_ID_MAX + 2,
+    /* AM ID reserved for TCP internal PUT REQ message of a PUT operation
+     * whose parts are sent through stripe connections */
+    UCT_TCP_EP_PUT_STRIPE_REQ_AM_ID = UCT_AM_ID_MAX + 3,
+    /* AM ID reserved for TCP internal GET REQ message */
+    UCT_TCP_EP_GET_REQ_AM_ID = UCT_AM_ID_MAX + 4,
+    /* AM ID reserved for TCP internal GET REP message, which is followed
+     * by the requested data */
+    UCT_TCP_EP_GET_REP_AM_ID = UCT_AM_ID_MAX + 5,
+    /* AM ID reserved for TCP internal ATOMIC REQ message */
+    UCT_TCP_EP_ATOMIC_REQ_AM_ID = UCT_AM_ID_MAX + 6,
+    /* AM ID reserved for TCP internal ATOMIC REP message of fetching
+     * atomic operations */
+    UCT_TCP_EP_ATOMIC_REP_AM_ID = UCT_AM_ID_MAX + 7
 } uct_tcp_ep_am_id_t;
 
 
@@ -219,6 +289,17 @@ typedef struct uct_tcp_ep_put_req_hdr {
 } UCS_S_PACKED uct_tcp_ep_put_req_hdr_t;
 
 
+/**
+ * TCP striped PUT request header
+ */
+typedef struct uct_tcp_ep_put_stripe_req_hdr {
+    uct_tcp_ep_put_req_hdr_t      super;       /* PUT request of the part sent
+                                                * through the EP's own socket */
+    uint32_t                      count;       /* Number of parts sent through
+                                                * stripe connections */
+} UCS_S_PACKED uct_tcp_ep_put_stripe_req_hdr_t;
+
+
 /**
  * TCP PUT acknowledge header
  */
@@ -227,6 +308,70 @@ typedef struct uct_tcp_ep_put_ack_hdr {
 } UCS_S_PACKED uct_tcp_ep_put_ack_hdr_t;
 
 
+/**
+ * TCP GET request header
+ */
+typedef struct uct_tcp_ep_get_req_hdr {
+    uint64_t                      addr;        /* Address of a remote memory buffer */
+    size_t                        length;      /* Length of a remote memory buffer */
+    uint32_t                      sn;          /* Sequence number of the current GET operation */
+} UCS_S_PACKED uct_tcp_ep_get_req_hdr_t;
+
+
+/**
+ * TCP GET reply header
+ */
+typedef struct uct_tcp_ep_get_rep_hdr {
+    size_t                        length;      /* Length of the data which follows
+                                                * the header */
+    uint32_t                      sn;          /* Sequence number of the replied GET operation */
+} UCS_S_PACKED uct_tcp_ep_get_rep_hdr_t;
+
+
+/**
+ * TCP ATOMIC request header
+ */
+typedef struct uct_tcp_ep_atomic_req_hdr {
+    uint64_t                      addr;        /* Address of a remote operand */
+    uint64_t                      value;       /* Operand value, or value to swap
+                                                * for compare-and-swap */
+    uint64_t                      compare;     /* Value to compare for compare-and-swap */
+    uint32_t                      sn;          /* Sequence number of the current ATOMIC operation */
+    uint8_t                       opcode;      /* Atomic operation, uct_atomic_op_t */
+    uint8_t                       size;        /* Size of the operand: 4 or 8 bytes */
+    uint8_t                       fetch;       /* Whether the original value of the
+                                                * operand has to be replied */
+} UCS_S_PACKED uct_tcp_ep_atomic_req_hdr_t;
+
+
+/**
+ * TCP ATOMIC reply header
+ */
+typedef struct uct_tcp_ep_atomic_rep_hdr {
+    uint64_t                      result;      /* Original value of the operand */
+    uint32_t                      sn;          /* Sequence number of the replied ATOMIC operation */
+} UCS_S_PACKED uct_tcp_ep_atomic_rep_hdr_t;
+
+
+/**
+ * TCP GET or fetching ATOMIC operation. The initiator keeps it until the
+ * reply is received, the target keeps it until it has resources to send the
+ * reply. Replies are sent in the order of the requests, so the operations are
+ * kept in FIFO queues.
+ */
+typedef struct uct_tcp_ep_rma_op {
+    uint8_t                       am_id;       /* AM ID of the reply */
+    uint8_t                       size;        /* Size of the atomic operand */
+    uint32_t                      sn;          /* Sequence number of the operation */
+    void                          *buffer;     /* Initiator: where to place the reply;
+                                                * target: GET source buffer */
+    size_t                        length;      /* Remaining length of GET data */
+    uint64_t                      result;      /* Target: atomic result to reply */
+    uct_completion_t              *comp;       /* Initiator: user's completion */
+    ucs_queue_elem_t              elem;        /* Element in TCP EP RMA queues */
+} uct_tcp_ep_rma_op_t;
+
+
 /**
  * TCP PUT completion
  */
@@ -241,6 +386,20 @@ typedef struct uct_tcp_ep_put_completion {
 } uct_tcp_ep_put_completion_t;
 
 
+/**
+ * TCP completion of an operation sent with MSG_ZEROCOPY
+ */
+typedef struct uct_tcp_ep_msg_zcopy_completion {
+    uct_completion_t              *comp;           /* User's completion passed to
+                                                    * Zcopy operation or uct_ep_flush */
+    uint32_t                      wait_sn;         /* Number of MSG_ZEROCOPY sends that
+                                                    * have to be reported by the kernel
+                                                    * before invoking the completion */
+    ucs_queue_elem_t              elem;            /* Element to insert completion into
+                                                    * TCP EP MSG_ZEROCOPY queue */
+} uct_tcp_ep_msg_zcopy_completion_t;
+
+
 /**
  * TCP endpoint communication context
  */
@@ -262,6 +421,8 @@ typedef struct uct_tcp_ep_zcopy_tx {
     uct_completion_t              *comp;     /* Local UCT completion object */
     size_t                        iov_index; /* Current IOV index */
     size_t                        iov_cnt;   /* Number of IOVs that should be sent */
+    size_t                        msg_zcopy_iov; /* Index of the first IOV that can be
+                                                  * sent with MSG_ZEROCOPY, or iov_cnt */
     struct iovec                  iov[0];    /* IOVs that should be sent */
 } uct_tcp_ep_zcopy_tx_t;
 
@@ -278,10 +439,49 @@ struct uct_tcp_ep {
     int                           events;           /* Current notifications */
     uct_tcp_ep_ctx_t              tx;               /* TX resources */
     uct_tcp_ep_ctx_t              rx;               /* RX resources */
-    struct sockaddr_in            peer_addr;        /* Remote iface addr */
+    struct sockaddr_storage       peer_addr;        /* Remote iface addr */
     ucs_queue_head_t              pending_q;        /* Pending operations */
     ucs_queue_head_t              put_comp_q;       /* Flush completions waiting for
                                                      * outstanding PUTs acknowledgment */
+    struct {
+        ucs_queue_head_t          wait_q;           /* GET and fetching ATOMIC operations
+                                                     * waiting for replies */
+        ucs_queue_head_t          reply_q;          /* Replies to the peer's operations
+                                                     * waiting for TX resources */
+    } rma;
+    struct {
+        int                       enabled;          /* Whether MSG_ZEROCOPY is used */
+        uint32_t                  sn;               /* Number of sends done with
+                                                     * MSG_ZEROCOPY */
+        uint32_t                  acked_sn;         /* All sends before this number
+                                                     * were reported by the kernel */
+        uint32_t                  ooo_count;        /* Number of sends after acked_sn
+                                                     * reported out of order */
+        ucs_queue_head_t          comp_q;           /* Completions waiting for
+                                                     * MSG_ZEROCOPY notifications */
+    } msg_zcopy;
+    struct {
+        uct_tcp_ep_stripe_type_t  type;             /* Whether the EP is a stripe */
+        uct_tcp_ep_t              *parent;          /* EP which the stripe belongs to */
+        uint64_t                  id;               /* ID sent in connection requests */
+        uint64_t                  peer_id;          /* ID of the peer's EP which
+                                                     * sends data to this EP */
+        int                       tx_started;       /* Whether stripe connections
+                                                     * were initiated */
+        int                       rx_stalled;       /* RX is paused until the current
+                                                     * striped PUT is received */
+        uint32_t                  rx_sn;            /* SN of the striped PUT operation
+                                                     * (parent) or of the received part
+                                                     * (stalled stripe) */
+        unsigned                  rx_pending;       /* Number of parts of the current
+                                                     * striped PUT not received yet */
+        unsigned                  tx_count;         /* Number of TX stripes */
+        unsigned                  rx_count;         /* Number of RX stripes */
+        uct_worker_cb_id_t        destroy_id;       /* Deferred destroy of a
+                                                     * closed TX stripe */
+        uct_tcp_ep_t              *tx[UCT_TCP_EP_MAX_STRIPES - 1];
+        uct_tcp_ep_t              *rx[UCT_TCP_EP_MAX_STRIPES - 1];
+    } stripe;
     ucs_list_link_t               list;             /* List element to insert into TCP EP list */
 };
 
@@ -299,17 +499,27 @@ typedef struct uct_tcp_iface {
     ucs_sys_event_set_t           *event_set;        /* Event set identifier */
     ucs_mpool_t                   tx_mpool;          /* TX memory pool */
     ucs_mpool_t                   rx_mpool;          /* RX memory pool */
+    ucs_mpool_t                   rma_mpool;         /* GET/ATOMIC operations pool */
+    uint64_t                      ep_id;             /* ID of the last created EP */
     size_t                        outstanding;       /* How much data in the EP send buffers
                                                       * + how many non-blocking connections
                                                       * are in progress + how many EPs are
                                                       * waiting for PUT Zcopy operation ACKs
+                                                      * (0/1 for each EP, including GET and
+                                                      * ATOMIC replies) + how many EPs are
+                                                      * waiting for MSG_ZEROCOPY notifications
                                                       * (0/1 for each EP) */
 
     struct {
         size_t                    tx_seg_size;       /* TX AM buffer size */
         size_t                    rx_seg_size;       /* RX AM buffer size */
+        size_t                    rx_buf_size;       /* RX buffer size, the buffer
+                                                      * keeps a batch of AMs
+                                                      * received together */
         size_t                    sendv_thresh;      /* Minimum size of user's payload from which
                                                       * non-blocking vector send should be used */
+        size_t                    msg_zcopy_thresh;  /* Minimum size of Zcopy payload from
+                                                      * which MSG_ZEROCOPY should be used */
         struct {
             size_t                max_iov;           /* Maximum supported IOVs limited by
                                                       * user configuration and service buffers
@@ -318,14 +528,20 @@ typedef struct uct_tcp_iface {
             size_t                hdr_offset;        /* Offset in TX buffer to empty space that
                                                       * can be used for AM Zcopy header */
         } zcopy;
-        struct sockaddr_in        ifaddr;            /* Network address */
-        struct sockaddr_in        netmask;           /* Network address mask */
+        struct sockaddr_storage   ifaddr;            /* Network address */
+        struct sockaddr_storage   netmask;           /* Network address mask */
         int                       prefer_default;    /* Prefer default gateway */
         int                       conn_nb;           /* Use non-blocking connect() */
         unsigned                  max_poll;          /* Number of events to poll per socket*/
         unsigned                  max_conn_retries;  /* How many connection establishment attmepts
                                                       * should be done if dropped connection was
                                                       * detected due to lack of system resources */
+        struct {
+            unsigned              count;             /* Number of sockets used by EP for
+                                                      * large PUT Zcopy operations */
+            size_t                thresh;            /* Minimum size of PUT Zcopy payload
+                                                      * which is striped */
+        } stripe;
     } config;
 
     struct {
@@ -345,10 +561,15 @@ typedef struct uct_tcp_iface_config {
     size_t                        rx_seg_size;
     size_t                        max_iov;
     size_t                        sendv_thresh;
+    size_t                        msg_zcopy_thresh;
     int                           prefer_default;
     int                           conn_nb;
     unsigned                      max_poll;
     unsigned                      max_conn_retries;
+    unsigned                      stripes;
+    size_t                        stripe_thresh;
+    ucs_event_set_backend_t       event_set;
+    ucs_config_names_array_t      af_prio;
     int                           sockopt_nodelay;
     size_t                        sockopt_sndbuf;
     size_t                        sockopt_rcvbuf;
@@ -365,14 +586,12 @@ extern const uct_tcp_ep_progress_t uct_tcp_ep_progress_rx_cb[];
 ucs_status_t uct_tcp_netif_caps(const char *if_name, double *latency_p,
                                 double *bandwidth_p);
 
-ucs_status_t uct_tcp_netif_inaddr(const char *if_name, struct sockaddr_in *ifaddr,
-                                  struct sockaddr_in *netmask);
+ucs_status_t uct_tcp_netif_inaddr(const char *if_name, sa_family_t af,
+                                  struct sockaddr_storage *ifaddr,
+                                  struct sockaddr_storage *netmask);
 
 ucs_status_t uct_tcp_netif_is_default(const char *if_name, int *result_p);
 
-int uct_tcp_sockaddr_cmp(const struct sockaddr *sa1,
-                         const struct sockaddr *sa2);
-
 ucs_status_t uct_tcp_iface_set_sockopt(uct_tcp_iface_t *iface, int fd);
 
 size_t uct_tcp_iface_get_max_iov(const uct_tcp_iface_t *iface);
@@ -389,8 +608,12 @@ unsigned uct_tcp_ep_progress_am_rx(uct_tcp_ep_t *ep);
 
 unsigned uct_tcp_ep_progress_put_rx(uct_tcp_ep_t *ep);
 
+unsigned uct_tcp_ep_progress_get_rx(uct_tcp_ep_t *ep);
+
+unsigned uct_tcp_ep_progress_msg_zcopy(uct_tcp_ep_t *ep);
+
 ucs_status_t uct_tcp_ep_init(uct_tcp_iface_t *iface, int fd,
-                             const struct sockaddr_in *dest_addr,
+                             const struct sockaddr_storage *dest_addr,
                              uct_tcp_ep_t **ep_p);
 
 ucs_status_t uct_tcp_ep_create(const uct_ep_params_t *params,
@@ -425,6 +648,8 @@ void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, int add, int remove);
 
 void uct_tcp_ep_pending_queue_dispatch(uct_tcp_ep_t *ep);
 
+void uct_tcp_ep_stripe_attach(uct_tcp_ep_t *ep, uct_tcp_ep_t *parent);
+
 ucs_status_t uct_tcp_ep_am_short(uct_ep_h uct_ep, uint8_t am_id, uint64_t header,
                                  const void *payload, unsigned length);
 
@@ -441,6 +666,38 @@ ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
                                   size_t iovcnt, uint64_t remote_addr,
                                   uct_rkey_t rkey, uct_completion_t *comp);
 
+ucs_status_t uct_tcp_ep_get_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
+                                  size_t iovcnt, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp);
+
+ucs_status_t uct_tcp_ep_atomic32_post(uct_ep_h uct_ep, unsigned opcode,
+                                      uint32_t value, uint64_t remote_addr,
+                                      uct_rkey_t rkey);
+
+ucs_status_t uct_tcp_ep_atomic64_post(uct_ep_h uct_ep, unsigned opcode,
+                                      uint64_t value, uint64_t remote_addr,
+                                      uct_rkey_t rkey);
+
+ucs_status_t uct_tcp_ep_atomic32_fetch(uct_ep_h uct_ep, uct_atomic_op_t opcode,
+                                       uint32_t value, uint32_t *result,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uct_completion_t *comp);
+
+ucs_status_t uct_tcp_ep_atomic64_fetch(uct_ep_h uct_ep, uct_atomic_op_t opcode,
+                                       uint64_t value, uint64_t *result,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uct_completion_t *comp);
+
+ucs_status_t uct_tcp_ep_atomic_cswap32(uct_ep_h uct_ep, uint32_t compare,
+                                       uint32_t swap, uint64_t remote_addr,
+                                       uct_rkey_t rkey, uint32_t *result,
+                                       uct_completion_t *comp);
+
+ucs_status_t uct_tcp_ep_atomic_cswap64(uct_ep_h uct_ep, uint64_t compare,
+                                       uint64_t swap, uint64_t remote_addr,
+                                       uct_rkey_t rkey, uint64_t *result,
+                                       uct_completion_t *comp);
+
 ucs_status_t uct_tcp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req,
                                     unsigned flags);
 
@@ -468,13 +725,17 @@ ucs_status_t uct_tcp_cm_add_ep(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep);
 void uct_tcp_cm_remove_ep(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep);
 
 uct_tcp_ep_t *uct_tcp_cm_search_ep(uct_tcp_iface_t *iface,
-                                   const struct sockaddr_in *peer_addr,
+                                   const struct sockaddr_storage *peer_addr,
                                    uct_tcp_ep_ctx_type_t with_ctx_type);
 
+uct_tcp_ep_t *uct_tcp_cm_search_stripe_parent(uct_tcp_iface_t *iface,
+                                              const struct sockaddr_storage *peer_addr,
+                                              uint64_t ep_id);
+
 void uct_tcp_cm_purge_ep(uct_tcp_ep_t *ep);
 
 ucs_status_t uct_tcp_cm_handle_incoming_conn(uct_tcp_iface_t *iface,
-                                             const struct sockaddr_in *peer_addr,
+                                             const struct sockaddr_storage *peer_addr,
                                              int fd);
 
 ucs_status_t uct_tcp_cm_conn_start(uct_tcp_ep_t *ep);
@@ -486,10 +747,13 @@ static inline unsigned uct_tcp_ep_progress_tx(uct_tcp_ep_t *ep)
 
 static inline unsigned uct_tcp_ep_progress_rx(uct_tcp_ep_t *ep)
 {
-    if (!(ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_RX))) {
+    if (!(ep->ctx_caps & (UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_RX) |
+                          UCS_BIT(UCT_TCP_EP_CTX_TYPE_GET_RX)))) {
         return uct_tcp_ep_progress_am_rx(ep);
-    } else {
+    } else if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_RX)) {
         return uct_tcp_ep_progress_put_rx(ep);
+    } else {
+        return uct_tcp_ep_progress_get_rx(ep);
     }
 }
 
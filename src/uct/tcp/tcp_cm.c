@@ -106,7 +106,14 @@ static void uct_tcp_cm_trace_conn_pkt(const uct_tcp_ep_t *ep,
     char str_addr[UCS_SOCKADDR_STRING_LEN], msg[128], *p;
 
     p = event_str;
+    if (event & UCT_TCP_CM_CONN_STRIPE_REQ) {
+        ucs_snprintf_zero(event_str, sizeof(event_str), "%s",
+                          UCS_PP_MAKE_STRING(UCT_TCP_CM_CONN_STRIPE_REQ));
+        p += strlen(event_str);
+    }
+
     if (event & UCT_TCP_CM_CONN_REQ) {
+        ucs_assert(p == event_str);
         ucs_snprintf_zero(event_str, sizeof(event_str), "%s",
                           UCS_PP_MAKE_STRING(UCT_TCP_CM_CONN_REQ));
         p += strlen(event_str);
@@ -141,6 +148,13 @@ static void uct_tcp_cm_trace_conn_pkt(const uct_tcp_ep_t *ep,
                              str_addr, UCS_SOCKADDR_STRING_LEN));
 }
 
+static inline uct_tcp_cm_conn_event_t
+uct_tcp_cm_conn_req_event(const uct_tcp_ep_t *ep)
+{
+    return (ep->stripe.type == UCT_TCP_EP_STRIPE_NONE) ?
+           UCT_TCP_CM_CONN_REQ : UCT_TCP_CM_CONN_STRIPE_REQ;
+}
+
 ucs_status_t uct_tcp_cm_send_event(uct_tcp_ep_t *ep, uct_tcp_cm_conn_event_t event)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
@@ -154,11 +168,12 @@ ucs_status_t uct_tcp_cm_send_event(uct_tcp_ep_t *ep, uct_tcp_cm_conn_event_t eve
 
     ucs_assertv(!(event & ~(UCT_TCP_CM_CONN_REQ |
                             UCT_TCP_CM_CONN_ACK |
-                            UCT_TCP_CM_CONN_WAIT_REQ)),
+                            UCT_TCP_CM_CONN_WAIT_REQ |
+                            UCT_TCP_CM_CONN_STRIPE_REQ)),
                 "ep=%p", ep);
 
     pkt_length        = sizeof(*pkt_hdr);
-    if (event == UCT_TCP_CM_CONN_REQ) {
+    if (event & (UCT_TCP_CM_CONN_REQ | UCT_TCP_CM_CONN_STRIPE_REQ)) {
         cm_pkt_length = sizeof(*conn_pkt);
     } else {
         cm_pkt_length = sizeof(event);
@@ -170,10 +185,14 @@ ucs_status_t uct_tcp_cm_send_event(uct_tcp_ep_t *ep, uct_tcp_cm_conn_event_t eve
     pkt_hdr->am_id  = UCT_AM_ID_MAX;
     pkt_hdr->length = cm_pkt_length;
 
-    if (event == UCT_TCP_CM_CONN_REQ) {
+    if (event & (UCT_TCP_CM_CONN_REQ | UCT_TCP_CM_CONN_STRIPE_REQ)) {
         conn_pkt             = (uct_tcp_cm_conn_req_pkt_t*)(pkt_hdr + 1);
-        conn_pkt->event      = UCT_TCP_CM_CONN_REQ;
+        conn_pkt->event      = event;
         conn_pkt->iface_addr = iface->config.ifaddr;
+        /* stripe connections are attached to the EP on the peer which
+         * receives data from the parent EP */
+        conn_pkt->ep_id      = (ep->stripe.parent != NULL) ?
+                               ep->stripe.parent->stripe.id : ep->stripe.id;
     } else {
         pkt_event            = (uct_tcp_cm_conn_event_t*)(pkt_hdr + 1);
         *pkt_event           = event;
@@ -249,7 +268,7 @@ void uct_tcp_cm_remove_ep(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
 }
 
 uct_tcp_ep_t *uct_tcp_cm_search_ep(uct_tcp_iface_t *iface,
-                                   const struct sockaddr_in *peer_addr,
+                                   const struct sockaddr_storage *peer_addr,
                                    uct_tcp_ep_ctx_type_t with_ctx_type)
 {
     uct_tcp_ep_t *ep;
@@ -271,6 +290,46 @@ uct_tcp_ep_t *uct_tcp_cm_search_ep(uct_tcp_iface_t *iface,
     return NULL;
 }
 
+static uct_tcp_ep_t *
+uct_tcp_cm_search_stripe_parent_in_list(ucs_list_link_t *ep_list,
+                                        const struct sockaddr_storage *peer_addr,
+                                        uint64_t ep_id)
+{
+    uct_tcp_ep_t *ep;
+
+    ucs_list_for_each(ep, ep_list, list) {
+        if ((ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX)) &&
+            (ep->stripe.peer_id == ep_id) &&
+            uct_tcp_khash_sockaddr_equal(ep->peer_addr, *peer_addr)) {
+            return ep;
+        }
+    }
+
+    return NULL;
+}
+
+uct_tcp_ep_t *uct_tcp_cm_search_stripe_parent(uct_tcp_iface_t *iface,
+                                              const struct sockaddr_storage *peer_addr,
+                                              uint64_t ep_id)
+{
+    uct_tcp_ep_t *ep;
+    khiter_t iter;
+
+    /* EPs that have both TX and RX capabilities are kept in iface's EP list */
+    iter = kh_get(uct_tcp_cm_eps, &iface->ep_cm_map, *peer_addr);
+    if (iter != kh_end(&iface->ep_cm_map)) {
+        ep = uct_tcp_cm_search_stripe_parent_in_list(kh_value(&iface->ep_cm_map,
+                                                              iter),
+                                                     peer_addr, ep_id);
+        if (ep != NULL) {
+            return ep;
+        }
+    }
+
+    return uct_tcp_cm_search_stripe_parent_in_list(&iface->ep_list, peer_addr,
+                                                   ep_id);
+}
+
 void uct_tcp_cm_purge_ep(uct_tcp_ep_t *ep)
 {
     /* Move from a khash's EP list to iface's EP list */
@@ -351,6 +410,9 @@ static ucs_status_t uct_tcp_cm_handle_simult_conn(uct_tcp_iface_t *iface,
     ucs_status_t status;
     int cmp;
 
+    /* The found EP is going to receive data from the peer's EP */
+    connect_ep->stripe.peer_id = accept_ep->stripe.peer_id;
+
     if ((connect_ep->conn_state != UCT_TCP_EP_CONN_STATE_CONNECTED) &&
         (connect_ep->conn_state != UCT_TCP_EP_CONN_STATE_WAITING_REQ)) {
         cmp = ucs_sockaddr_cmp((const struct sockaddr*)&connect_ep->peer_addr,
@@ -395,6 +457,26 @@ static ucs_status_t uct_tcp_cm_handle_simult_conn(uct_tcp_iface_t *iface,
     return status;
 }
 
+static ucs_status_t
+uct_tcp_cm_check_conn_req_af(uct_tcp_ep_t *ep,
+                             const uct_tcp_cm_conn_req_pkt_t *cm_req_pkt)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    /* The peer's iface must use the same address family, since the peer's
+     * address is used to find the EP which is connected to the peer */
+    if (cm_req_pkt->iface_addr.ss_family != iface->config.ifaddr.ss_family) {
+        ucs_error("tcp_ep %p: connection request with address family %d "
+                  "doesn't match the iface's one %d", ep,
+                  cm_req_pkt->iface_addr.ss_family,
+                  iface->config.ifaddr.ss_family);
+        return UCS_ERR_UNREACHABLE;
+    }
+
+    return UCS_OK;
+}
+
 static unsigned
 uct_tcp_cm_handle_conn_req(uct_tcp_ep_t **ep_p,
                            const uct_tcp_cm_conn_req_pkt_t *cm_req_pkt)
@@ -406,7 +488,13 @@ uct_tcp_cm_handle_conn_req(uct_tcp_ep_t **ep_p,
     ucs_status_t status;
     uct_tcp_ep_t *peer_ep;
 
-    ep->peer_addr = cm_req_pkt->iface_addr;
+    status = uct_tcp_cm_check_conn_req_af(ep, cm_req_pkt);
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    ep->peer_addr      = cm_req_pkt->iface_addr;
+    ep->stripe.peer_id = cm_req_pkt->ep_id;
     uct_tcp_cm_trace_conn_pkt(ep, UCS_LOG_LEVEL_TRACE,
                               "%s received from", UCT_TCP_CM_CONN_REQ);
 
@@ -448,10 +536,57 @@ uct_tcp_cm_handle_conn_req(uct_tcp_ep_t **ep_p,
 err:
     if (!(ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_TX))) {
         uct_tcp_ep_destroy_internal(&ep->super.super);
+        *ep_p = NULL;
     }
     return progress_count;
 }
 
+static unsigned
+uct_tcp_cm_handle_stripe_req(uct_tcp_ep_t **ep_p,
+                             const uct_tcp_cm_conn_req_pkt_t *cm_req_pkt)
+{
+    uct_tcp_ep_t *ep       = *ep_p;
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_ep_t *parent;
+    ucs_status_t status;
+
+    status = uct_tcp_cm_check_conn_req_af(ep, cm_req_pkt);
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    ep->peer_addr = cm_req_pkt->iface_addr;
+    uct_tcp_cm_trace_conn_pkt(ep, UCS_LOG_LEVEL_TRACE,
+                              "%s received from", UCT_TCP_CM_CONN_STRIPE_REQ);
+
+    ucs_assertv(ep->conn_state == UCT_TCP_EP_CONN_STATE_ACCEPTING, "ep=%p", ep);
+
+    parent = uct_tcp_cm_search_stripe_parent(iface, &ep->peer_addr,
+                                             cm_req_pkt->ep_id);
+    if ((parent == NULL) ||
+        (parent->stripe.rx_count == ucs_static_array_size(parent->stripe.rx))) {
+        /* The peer doesn't use this connection if it is closed without ACK */
+        ucs_debug("tcp_ep %p: no tcp_ep to attach the stripe connection of "
+                  "peer's ep_id %"PRIu64" to", ep, cm_req_pkt->ep_id);
+        goto err;
+    }
+
+    status = uct_tcp_cm_send_event(ep, UCT_TCP_CM_CONN_ACK);
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    uct_tcp_ep_stripe_attach(ep, parent);
+    uct_tcp_cm_change_conn_state(ep, UCT_TCP_EP_CONN_STATE_CONNECTED);
+    return 1;
+
+err:
+    uct_tcp_ep_destroy_internal(&ep->super.super);
+    *ep_p = NULL;
+    return 0;
+}
+
 void uct_tcp_cm_handle_conn_ack(uct_tcp_ep_t *ep, uct_tcp_cm_conn_event_t cm_event,
                                 uct_tcp_ep_conn_state_t new_conn_state)
 {
@@ -480,6 +615,10 @@ unsigned uct_tcp_cm_handle_conn_pkt(uct_tcp_ep_t **ep, void *pkt, uint32_t lengt
         ucs_assertv(length == sizeof(*cm_req_pkt), "ep=%p", *ep);
         cm_req_pkt = (uct_tcp_cm_conn_req_pkt_t*)pkt;
         return uct_tcp_cm_handle_conn_req(ep, cm_req_pkt);
+    case UCT_TCP_CM_CONN_STRIPE_REQ:
+        ucs_assertv(length == sizeof(*cm_req_pkt), "ep=%p", *ep);
+        cm_req_pkt = (uct_tcp_cm_conn_req_pkt_t*)pkt;
+        return uct_tcp_cm_handle_stripe_req(ep, cm_req_pkt);
     case UCT_TCP_CM_CONN_ACK_WITH_WAIT_REQ:
         if (!((*ep)->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX))) {
             new_conn_state = UCT_TCP_EP_CONN_STATE_WAITING_REQ;
@@ -489,6 +628,10 @@ unsigned uct_tcp_cm_handle_conn_pkt(uct_tcp_ep_t **ep, void *pkt, uint32_t lengt
         uct_tcp_cm_handle_conn_ack(*ep, cm_event, new_conn_state);
         return 0;
     case UCT_TCP_CM_CONN_ACK_WITH_REQ:
+        ucs_assertv(length == sizeof(*cm_req_pkt), "ep=%p", *ep);
+        cm_req_pkt            = (uct_tcp_cm_conn_req_pkt_t*)pkt;
+        (*ep)->stripe.peer_id = cm_req_pkt->ep_id;
+
         status = uct_tcp_ep_add_ctx_cap(*ep, UCT_TCP_EP_CTX_TYPE_RX);
         if (status != UCS_OK) {
             return 0;
@@ -518,7 +661,7 @@ unsigned uct_tcp_cm_conn_progress(uct_tcp_ep_t *ep)
         goto err;
     }
 
-    status = uct_tcp_cm_send_event(ep, UCT_TCP_CM_CONN_REQ);
+    status = uct_tcp_cm_send_event(ep, uct_tcp_cm_conn_req_event(ep));
     if (status != UCS_OK) {
         return 0;
     }
@@ -566,7 +709,7 @@ ucs_status_t uct_tcp_cm_conn_start(uct_tcp_ep_t *ep)
         }
     }
 
-    status = uct_tcp_cm_send_event(ep, UCT_TCP_CM_CONN_REQ);
+    status = uct_tcp_cm_send_event(ep, uct_tcp_cm_conn_req_event(ep));
     if (status != UCS_OK) {
         return status;
     }
@@ -579,7 +722,7 @@ ucs_status_t uct_tcp_cm_conn_start(uct_tcp_ep_t *ep)
 
 /* This function is called from async thread */
 ucs_status_t uct_tcp_cm_handle_incoming_conn(uct_tcp_iface_t *iface,
-                                             const struct sockaddr_in *peer_addr,
+                                             const struct sockaddr_storage *peer_addr,
                                              int fd)
 {
     char str_local_addr[UCS_SOCKADDR_STRING_LEN];
@@ -590,7 +733,7 @@ ucs_status_t uct_tcp_cm_handle_incoming_conn(uct_tcp_iface_t *iface,
     if (!ucs_socket_is_connected(fd)) {
         ucs_warn("tcp_iface %p: connection establishment for socket fd %d "
                  "from %s to %s was unsuccessful", iface, fd,
-                 ucs_sockaddr_str((const struct sockaddr*)&peer_addr,
+                 ucs_sockaddr_str((const struct sockaddr*)peer_addr,
                                   str_remote_addr, UCS_SOCKADDR_STRING_LEN),
                  ucs_sockaddr_str((const struct sockaddr*)&iface->config.ifaddr,
                                   str_local_addr, UCS_SOCKADDR_STRING_LEN));
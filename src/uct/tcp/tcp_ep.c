@@ -10,6 +10,10 @@
 #include "tcp.h"
 
 #include <ucs/async/async.h>
+#include <ucs/arch/atomic.h>
+#if UCT_TCP_HAVE_MSG_ZCOPY
+#  include <linux/errqueue.h>
+#endif
 
 
 /* Forward declaration */
@@ -93,15 +97,14 @@ static inline void uct_tcp_ep_ctx_reset(uct_tcp_ep_ctx_t *ctx)
     uct_tcp_ep_ctx_rewind(ctx);
 }
 
-static void uct_tcp_ep_addr_cleanup(struct sockaddr_in *sock_addr)
+static void uct_tcp_ep_addr_cleanup(struct sockaddr_storage *sock_addr)
 {
     memset(sock_addr, 0, sizeof(*sock_addr));
 }
 
-static void uct_tcp_ep_addr_init(struct sockaddr_in *sock_addr,
-                                 const struct sockaddr_in *peer_addr)
+static void uct_tcp_ep_addr_init(struct sockaddr_storage *sock_addr,
+                                 const struct sockaddr_storage *peer_addr)
 {
-    /* TODO: handle IPv4 and IPv6 */
     if (peer_addr == NULL) {
         uct_tcp_ep_addr_cleanup(sock_addr);
     } else {
@@ -131,6 +134,34 @@ unsigned uct_tcp_ep_is_self(const uct_tcp_ep_t *ep)
     return !cmp;
 }
 
+static inline int uct_tcp_ep_msg_zcopy_pending(uct_tcp_ep_t *ep)
+{
+    return ep->msg_zcopy.sn != ep->msg_zcopy.acked_sn;
+}
+
+static void uct_tcp_ep_msg_zcopy_init(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
+#if UCT_TCP_HAVE_MSG_ZCOPY
+    int optval = 1;
+
+    ucs_assert(!uct_tcp_ep_msg_zcopy_pending(ep));
+
+    ep->msg_zcopy.enabled = 0;
+    if (iface->config.msg_zcopy_thresh == UCS_MEMUNITS_INF) {
+        return;
+    }
+
+    if (setsockopt(ep->fd, SOL_SOCKET, SO_ZEROCOPY, &optval,
+                   sizeof(optval)) < 0) {
+        ucs_debug("tcp_ep %p: setsockopt(fd=%d, SO_ZEROCOPY) failed: %m, "
+                  "MSG_ZEROCOPY will not be used", ep, ep->fd);
+        return;
+    }
+
+    ep->msg_zcopy.enabled = 1;
+#endif
+}
+
 static void uct_tcp_ep_cleanup(uct_tcp_ep_t *ep)
 {
     uct_tcp_ep_addr_cleanup(&ep->peer_addr);
@@ -151,7 +182,7 @@ static void uct_tcp_ep_cleanup(uct_tcp_ep_t *ep)
 }
 
 static UCS_CLASS_INIT_FUNC(uct_tcp_ep_t, uct_tcp_iface_t *iface,
-                           int fd, const struct sockaddr_in *dest_addr)
+                           int fd, const struct sockaddr_storage *dest_addr)
 {
     ucs_status_t status;
 
@@ -173,6 +204,26 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_ep_t, uct_tcp_iface_t *iface,
     ucs_list_head_init(&self->list);
     ucs_queue_head_init(&self->pending_q);
     ucs_queue_head_init(&self->put_comp_q);
+    ucs_queue_head_init(&self->rma.wait_q);
+    ucs_queue_head_init(&self->rma.reply_q);
+    ucs_queue_head_init(&self->msg_zcopy.comp_q);
+
+    self->msg_zcopy.enabled   = 0;
+    self->msg_zcopy.sn        = 0;
+    self->msg_zcopy.acked_sn  = 0;
+    self->msg_zcopy.ooo_count = 0;
+
+    self->stripe.type       = UCT_TCP_EP_STRIPE_NONE;
+    self->stripe.parent     = NULL;
+    self->stripe.id         = ++iface->ep_id;
+    self->stripe.peer_id    = 0;
+    self->stripe.tx_started = 0;
+    self->stripe.rx_stalled = 0;
+    self->stripe.rx_sn      = 0;
+    self->stripe.rx_pending = 0;
+    self->stripe.tx_count   = 0;
+    self->stripe.rx_count   = 0;
+    self->stripe.destroy_id = UCS_CALLBACKQ_ID_NULL;
 
     /* Make a socket non-blocking if an EP is created during accepting
      * a connection or non-blocking connection mode is requested */
@@ -188,6 +239,7 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_ep_t, uct_tcp_iface_t *iface,
         goto err_cleanup;
     }
 
+    uct_tcp_ep_msg_zcopy_init(iface, self);
     uct_tcp_iface_add_ep(self);
 
     ucs_debug("tcp_ep %p: created on iface %p, fd %d", self, iface, self->fd);
@@ -278,12 +330,127 @@ ucs_status_t uct_tcp_ep_move_ctx_cap(uct_tcp_ep_t *from_ep, uct_tcp_ep_t *to_ep,
     return uct_tcp_ep_add_ctx_cap(to_ep, ctx_cap);
 }
 
+void uct_tcp_ep_stripe_attach(uct_tcp_ep_t *ep, uct_tcp_ep_t *parent)
+{
+    ucs_assertv(parent->stripe.rx_count <
+                ucs_static_array_size(parent->stripe.rx), "ep=%p", parent);
+
+    ep->stripe.type   = UCT_TCP_EP_STRIPE_RX;
+    ep->stripe.parent = parent;
+    parent->stripe.rx[parent->stripe.rx_count++] = ep;
+
+    ucs_debug("tcp_ep %p: attached to tcp_ep %p as stripe connection",
+              ep, parent);
+}
+
+static void uct_tcp_ep_stripe_detach(uct_tcp_ep_t *ep)
+{
+    uct_tcp_ep_t *parent = ep->stripe.parent;
+    uct_tcp_ep_t **stripes;
+    unsigned *count_p;
+    unsigned i;
+
+    if (parent == NULL) {
+        return;
+    }
+
+    if (ep->stripe.type == UCT_TCP_EP_STRIPE_TX) {
+        stripes = parent->stripe.tx;
+        count_p = &parent->stripe.tx_count;
+    } else {
+        ucs_assert(ep->stripe.type == UCT_TCP_EP_STRIPE_RX);
+        stripes = parent->stripe.rx;
+        count_p = &parent->stripe.rx_count;
+    }
+
+    for (i = 0; i < *count_p; ++i) {
+        if (stripes[i] == ep) {
+            stripes[i] = stripes[--(*count_p)];
+            break;
+        }
+    }
+
+    ep->stripe.parent = NULL;
+}
+
+static unsigned uct_tcp_ep_stripe_destroy_progress(void *arg)
+{
+    uct_tcp_ep_t *ep = (uct_tcp_ep_t*)arg;
+
+    ep->stripe.destroy_id = UCS_CALLBACKQ_ID_NULL;
+    uct_tcp_ep_destroy_internal(&ep->super.super);
+    return 1;
+}
+
+static void uct_tcp_ep_stripe_release(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    ucs_debug("tcp_ep %p: stripe connection of tcp_ep %p is closed",
+              ep, ep->stripe.parent);
+
+    uct_tcp_ep_stripe_detach(ep);
+    if (ep->stripe.destroy_id != UCS_CALLBACKQ_ID_NULL) {
+        /* Already released */
+        return;
+    }
+
+    uct_tcp_ep_mod_events(ep, 0, ep->events);
+    uct_tcp_ep_close_fd(&ep->fd);
+    if (ep->conn_state != UCT_TCP_EP_CONN_STATE_CLOSED) {
+        uct_tcp_cm_change_conn_state(ep, UCT_TCP_EP_CONN_STATE_CLOSED);
+    }
+
+    /* The stripe is destroyed from the progress, since the current batch
+     * of events may still refer to it */
+    uct_worker_progress_register_safe(&iface->super.worker->super,
+                                      uct_tcp_ep_stripe_destroy_progress,
+                                      ep, UCS_CALLBACKQ_FLAG_ONESHOT,
+                                      &ep->stripe.destroy_id);
+}
+
+static void uct_tcp_ep_stripe_destroy_tx(uct_tcp_ep_t *ep)
+{
+    while (ep->stripe.tx_count > 0) {
+        uct_tcp_ep_stripe_release(ep->stripe.tx[0]);
+    }
+
+    ep->stripe.tx_started = 0;
+}
+
+static void uct_tcp_ep_stripe_cleanup(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_ep_t *stripe_ep;
+
+    uct_worker_progress_unregister_safe(&iface->super.worker->super,
+                                        &ep->stripe.destroy_id);
+    uct_tcp_ep_stripe_detach(ep);
+    uct_tcp_ep_stripe_destroy_tx(ep);
+
+    /* RX stripes are destroyed when the peer closes the connections, they
+     * only have to keep reading to detect it */
+    while (ep->stripe.rx_count > 0) {
+        stripe_ep = ep->stripe.rx[0];
+        uct_tcp_ep_stripe_detach(stripe_ep);
+        if (stripe_ep->stripe.rx_stalled) {
+            stripe_ep->stripe.rx_stalled = 0;
+            uct_tcp_ep_mod_events(stripe_ep, UCS_EVENT_SET_EVREAD, 0);
+        }
+    }
+}
+
 static UCS_CLASS_CLEANUP_FUNC(uct_tcp_ep_t)
 {
-    uct_tcp_iface_t UCS_V_UNUSED *iface =
-        ucs_derived_of(self->super.super.iface, uct_tcp_iface_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(self->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_ep_msg_zcopy_completion_t *zcopy_comp;
     uct_tcp_ep_put_completion_t *put_comp;
+    uct_tcp_ep_rma_op_t *rma_op;
 
+    uct_tcp_ep_stripe_cleanup(self);
     uct_tcp_ep_mod_events(self, 0, self->events);
 
     if (self->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_TX)) {
@@ -300,6 +467,22 @@ static UCS_CLASS_CLEANUP_FUNC(uct_tcp_ep_t)
         ucs_free(put_comp);
     }
 
+    ucs_queue_for_each_extract(zcopy_comp, &self->msg_zcopy.comp_q, elem, 1) {
+        ucs_free(zcopy_comp);
+    }
+
+    ucs_queue_for_each_extract(rma_op, &self->rma.wait_q, elem, 1) {
+        ucs_mpool_put_inline(rma_op);
+    }
+
+    ucs_queue_for_each_extract(rma_op, &self->rma.reply_q, elem, 1) {
+        ucs_mpool_put_inline(rma_op);
+    }
+
+    if (uct_tcp_ep_msg_zcopy_pending(self)) {
+        uct_tcp_iface_outstanding_dec(iface);
+    }
+
     uct_tcp_iface_remove_ep(self);
 
     if (self->conn_state != UCT_TCP_EP_CONN_STATE_CLOSED) {
@@ -315,7 +498,7 @@ UCS_CLASS_DEFINE(uct_tcp_ep_t, uct_base_ep_t);
 
 UCS_CLASS_DEFINE_NAMED_NEW_FUNC(uct_tcp_ep_init, uct_tcp_ep_t, uct_tcp_ep_t,
                                 uct_tcp_iface_t*, int,
-                                const struct sockaddr_in*)
+                                const struct sockaddr_storage*)
 UCS_CLASS_DEFINE_NAMED_DELETE_FUNC(uct_tcp_ep_destroy_internal,
                                    uct_tcp_ep_t, uct_ep_t)
 
@@ -329,6 +512,7 @@ void uct_tcp_ep_destroy(uct_ep_h tl_ep)
                            UCS_BIT(UCT_TCP_EP_CTX_TYPE_TX))) {
         /* remove TX capability, but still will be able to receive data */
         uct_tcp_ep_remove_ctx_cap(ep, UCT_TCP_EP_CTX_TYPE_TX);
+        uct_tcp_ep_stripe_destroy_tx(ep);
     } else {
         uct_tcp_ep_destroy_internal(tl_ep);
     }
@@ -339,6 +523,13 @@ void uct_tcp_ep_set_failed(uct_tcp_ep_t *ep)
     uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
                                             uct_tcp_iface_t);
 
+    if (ep->stripe.type != UCT_TCP_EP_STRIPE_NONE) {
+        /* Stripes are hidden from the user, the parent EP just doesn't
+         * use the connection */
+        uct_tcp_ep_stripe_release(ep);
+        return;
+    }
+
     if (ep->conn_state != UCT_TCP_EP_CONN_STATE_CLOSED) {
         uct_tcp_cm_change_conn_state(ep, UCT_TCP_EP_CONN_STATE_CLOSED);
     }
@@ -350,7 +541,7 @@ void uct_tcp_ep_set_failed(uct_tcp_ep_t *ep)
 
 static ucs_status_t
 uct_tcp_ep_create_socket_and_connect(uct_tcp_iface_t *iface,
-                                     const struct sockaddr_in *dest_addr,
+                                     const struct sockaddr_storage *dest_addr,
                                      uct_tcp_ep_t **ep_p)
 {
     uct_tcp_ep_t *ep = NULL;
@@ -360,7 +551,8 @@ uct_tcp_ep_create_socket_and_connect(uct_tcp_iface_t *iface,
     /* if EP is already allocated, dest_addr can be NULL */
     ucs_assert((*ep_p != NULL) || (dest_addr != NULL));
 
-    status = ucs_socket_create(AF_INET, SOCK_STREAM, &fd);
+    status = ucs_socket_create(iface->config.ifaddr.ss_family, SOCK_STREAM,
+                               &fd);
     if (status != UCS_OK) {
         return status;
     }
@@ -376,6 +568,7 @@ uct_tcp_ep_create_socket_and_connect(uct_tcp_iface_t *iface,
     } else {
         ep     = *ep_p;
         ep->fd = fd;
+        uct_tcp_ep_msg_zcopy_init(iface, ep);
     }
 
     status = uct_tcp_cm_conn_start(ep);
@@ -402,7 +595,7 @@ err_close_fd:
 }
 
 static ucs_status_t uct_tcp_ep_create_connected(uct_tcp_iface_t *iface,
-                                                const struct sockaddr_in *dest_addr,
+                                                const struct sockaddr_storage *dest_addr,
                                                 uct_tcp_ep_t **ep_p)
 {
     ucs_status_t status;
@@ -429,15 +622,29 @@ ucs_status_t uct_tcp_ep_create(const uct_ep_params_t *params,
 {
     uct_tcp_iface_t *iface = ucs_derived_of(params->iface, uct_tcp_iface_t);
     uct_tcp_ep_t *ep       = NULL;
-    struct sockaddr_in dest_addr;
+    const uct_tcp_device_addr_t *dev_addr;
+    struct sockaddr_storage dest_addr;
     ucs_status_t status;
 
     UCT_EP_PARAMS_CHECK_DEV_IFACE_ADDRS(params);
+    dev_addr = (const uct_tcp_device_addr_t*)params->dev_addr;
+    if (dev_addr->sa_family != iface->config.ifaddr.ss_family) {
+        ucs_error("tcp_iface %p: address family %d of the peer differs from "
+                  "the iface's one %d", iface, dev_addr->sa_family,
+                  iface->config.ifaddr.ss_family);
+        return UCS_ERR_UNREACHABLE;
+    }
+
     memset(&dest_addr, 0, sizeof(dest_addr));
-    /* TODO: handle AF_INET6 */
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_port   = *(in_port_t*)params->iface_addr;
-    dest_addr.sin_addr   = *(struct in_addr*)params->dev_addr;
+    dest_addr.ss_family = dev_addr->sa_family;
+    status              = ucs_sockaddr_set_inet_addr((struct sockaddr*)&dest_addr,
+                                                     dev_addr + 1);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucs_sockaddr_set_port((struct sockaddr*)&dest_addr,
+                          ntohs(*(const in_port_t*)params->iface_addr));
 
     do {
         ep = uct_tcp_cm_search_ep(iface, &dest_addr,
@@ -502,14 +709,13 @@ void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, int add, int remove)
     }
 }
 
-static inline void uct_tcp_ep_handle_put_ack(uct_tcp_ep_t *ep,
-                                             uct_tcp_ep_put_ack_hdr_t *put_ack)
+static inline void uct_tcp_ep_handle_put_ack(uct_tcp_ep_t *ep, uint32_t sn)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
                                             uct_tcp_iface_t);
     uct_tcp_ep_put_completion_t *put_comp;
 
-    if (put_ack->sn == ep->tx.put_sn) {
+    if (sn == ep->tx.put_sn) {
         /* Since there are no other PUT operations in-flight, can remove flag
          * and decrement iface outstanding operations counter */
         ucs_assert(ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK));
@@ -519,7 +725,7 @@ static inline void uct_tcp_ep_handle_put_ack(uct_tcp_ep_t *ep,
 
     ucs_queue_for_each_extract(put_comp, &ep->put_comp_q, elem,
                                (UCS_CIRCULAR_COMPARE32(put_comp->wait_put_sn,
-                                                       <=, put_ack->sn))) {
+                                                       <=, sn))) {
         uct_invoke_completion(put_comp->comp, UCS_OK);
         ucs_free(put_comp);
     }
@@ -551,9 +757,12 @@ static void uct_tcp_ep_handle_disconnected(uct_tcp_ep_t *ep,
 
         uct_tcp_ep_mod_events(ep, 0, ep->events);
         uct_tcp_ep_close_fd(&ep->fd);
-    } else if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX)) {
+    } else if ((ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX)) ||
+               (ep->stripe.type == UCT_TCP_EP_STRIPE_RX)) {
         /* If the EP supports RX only, destroy it */
         uct_tcp_ep_destroy_internal(&ep->super.super);
+    } else if (ep->stripe.type == UCT_TCP_EP_STRIPE_TX) {
+        uct_tcp_ep_stripe_release(ep);
     }
 }
 
@@ -582,14 +791,93 @@ static inline ssize_t uct_tcp_ep_send(uct_tcp_ep_t *ep)
     return sent_length;
 }
 
+static void
+uct_tcp_ep_msg_zcopy_push_comp(uct_tcp_ep_t *ep,
+                               uct_tcp_ep_msg_zcopy_completion_t *zcopy_comp,
+                               uct_completion_t *comp)
+{
+    /* the completion is invoked when the kernel reports all MSG_ZEROCOPY
+     * sends done so far, since they may refer to the user's buffers */
+    zcopy_comp->comp    = comp;
+    zcopy_comp->wait_sn = ep->msg_zcopy.sn;
+    ucs_queue_push(&ep->msg_zcopy.comp_q, &zcopy_comp->elem);
+}
+
 static inline void uct_tcp_ep_comp_zcopy(uct_tcp_ep_t *ep,
                                          uct_completion_t *comp,
                                          ucs_status_t status)
 {
+    uct_tcp_ep_msg_zcopy_completion_t *zcopy_comp;
+
     ep->ctx_caps &= ~UCS_BIT(UCT_TCP_EP_CTX_TYPE_ZCOPY_TX);
-    if (comp != NULL) {
-        uct_invoke_completion(comp, status);
+    if (comp == NULL) {
+        return;
+    }
+
+    if ((status == UCS_OK) && uct_tcp_ep_msg_zcopy_pending(ep)) {
+        zcopy_comp = ucs_malloc(sizeof(*zcopy_comp), "msg_zcopy completion");
+        if (zcopy_comp != NULL) {
+            uct_tcp_ep_msg_zcopy_push_comp(ep, zcopy_comp, comp);
+            return;
+        }
+
+        ucs_error("tcp_ep %p: failed to allocate MSG_ZEROCOPY completion", ep);
+        status = UCS_ERR_NO_MEMORY;
     }
+
+    uct_invoke_completion(comp, status);
+}
+
+#if UCT_TCP_HAVE_MSG_ZCOPY
+static ucs_status_t uct_tcp_ep_msg_zcopy_err_cb(void *arg, int io_errno)
+{
+    int *no_bufs_p = (int*)arg;
+
+    if (io_errno == ENOBUFS) {
+        /* the socket reached the limit of pinned user pages, the data has to
+         * be sent with copying */
+        *no_bufs_p = 1;
+        return UCS_OK;
+    }
+
+    return UCS_ERR_IO_ERROR;
+}
+#endif
+
+static ucs_status_t
+uct_tcp_ep_msg_zcopy_sendv(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                           struct iovec *iov, size_t iov_cnt,
+                           size_t *length_p)
+{
+#if UCT_TCP_HAVE_MSG_ZCOPY
+    ucs_status_t status;
+    int no_bufs;
+
+    if (ep->msg_zcopy.enabled) {
+        no_bufs = 0;
+        status  = ucs_socket_sendmsg_nb(ep->fd, iov, iov_cnt, MSG_ZEROCOPY,
+                                        length_p, uct_tcp_ep_msg_zcopy_err_cb,
+                                        &no_bufs);
+        if (status == UCS_OK) {
+            if (!uct_tcp_ep_msg_zcopy_pending(ep)) {
+                /* don't complete iface flush until the kernel reports the
+                 * sends done, the notifications arrive on the error queue */
+                uct_tcp_iface_outstanding_inc(iface);
+                uct_tcp_ep_mod_events(ep, UCS_EVENT_SET_EVERR, 0);
+            }
+
+            ep->msg_zcopy.sn++;
+            return UCS_OK;
+        } else if (!no_bufs) {
+            return status;
+        }
+
+        ucs_trace("tcp_ep %p: MSG_ZEROCOPY send returned ENOBUFS, sending "
+                  "with copy", ep);
+    }
+#endif
+
+    return ucs_socket_sendv_nb(ep->fd, iov, iov_cnt, length_p, NULL, NULL);
 }
 
 static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
@@ -602,9 +890,18 @@ static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
 
     ucs_assertv(ep->tx.offset < ep->tx.length, "ep=%p", ep);
 
-    status = ucs_socket_sendv_nb(ep->fd, &ctx->iov[ctx->iov_index],
-                                 ctx->iov_cnt - ctx->iov_index,
-                                 &sent_length, NULL, NULL);
+    if (ctx->iov_index < ctx->msg_zcopy_iov) {
+        /* Service headers are never sent with MSG_ZEROCOPY, since they are
+         * kept in the TX buffer which is reused once the operation completes */
+        status = ucs_socket_sendv_nb(ep->fd, &ctx->iov[ctx->iov_index],
+                                     ctx->msg_zcopy_iov - ctx->iov_index,
+                                     &sent_length, NULL, NULL);
+    } else {
+        status = uct_tcp_ep_msg_zcopy_sendv(iface, ep,
+                                            &ctx->iov[ctx->iov_index],
+                                            ctx->iov_cnt - ctx->iov_index,
+                                            &sent_length);
+    }
 
     if (ucs_unlikely(status != UCS_OK)) {
         if (status == UCS_ERR_NO_PROGRESS) {
@@ -630,6 +927,105 @@ static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
     return sent_length;
 }
 
+#if UCT_TCP_HAVE_MSG_ZCOPY
+static void uct_tcp_ep_msg_zcopy_ack(uct_tcp_ep_t *ep,
+                                     const struct sock_extended_err *serr)
+{
+    /* the kernel reports a range [ee_info, ee_data] of MSG_ZEROCOPY sends,
+     * which is usually the next one after the sends reported before */
+    if (serr->ee_info == ep->msg_zcopy.acked_sn) {
+        ep->msg_zcopy.acked_sn   = serr->ee_data + 1;
+    } else {
+        ep->msg_zcopy.ooo_count += serr->ee_data - serr->ee_info + 1;
+    }
+
+    if ((ep->msg_zcopy.sn - ep->msg_zcopy.acked_sn) ==
+        ep->msg_zcopy.ooo_count) {
+        /* out-of-order reports filled the gap */
+        ep->msg_zcopy.acked_sn  = ep->msg_zcopy.sn;
+        ep->msg_zcopy.ooo_count = 0;
+    }
+
+    if ((serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) &&
+        ep->msg_zcopy.enabled) {
+        /* e.g loopback device or a NIC without scatter-gather support */
+        ucs_debug("tcp_ep %p: the kernel copied MSG_ZEROCOPY data, disabling "
+                  "zero-copy send on fd %d", ep, ep->fd);
+        ep->msg_zcopy.enabled = 0;
+    }
+}
+#endif
+
+unsigned uct_tcp_ep_progress_msg_zcopy(uct_tcp_ep_t *ep)
+{
+    unsigned count = 0;
+#if UCT_TCP_HAVE_MSG_ZCOPY
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err) +
+                            sizeof(struct sockaddr_in6))];
+    uct_tcp_ep_msg_zcopy_completion_t *zcopy_comp;
+    struct sock_extended_err *serr;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+
+    if (!uct_tcp_ep_msg_zcopy_pending(ep)) {
+        return 0;
+    }
+
+    for (;;) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(ep->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if ((errno != EAGAIN) && (errno != EINTR)) {
+                ucs_debug("tcp_ep %p: recvmsg(fd=%d, MSG_ERRQUEUE) failed: %m",
+                          ep, ep->fd);
+            }
+            break;
+        }
+
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+             cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!(((cmsg->cmsg_level == SOL_IP) &&
+                   (cmsg->cmsg_type == IP_RECVERR)) ||
+                  ((cmsg->cmsg_level == SOL_IPV6) &&
+                   (cmsg->cmsg_type == IPV6_RECVERR)))) {
+                continue;
+            }
+
+            serr = (struct sock_extended_err*)CMSG_DATA(cmsg);
+            if ((serr->ee_errno != 0) ||
+                (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)) {
+                continue;
+            }
+
+            uct_tcp_ep_msg_zcopy_ack(ep, serr);
+            ++count;
+        }
+    }
+
+    ucs_trace_data("tcp_ep %p: MSG_ZEROCOPY sends acked %u/%u", ep,
+                   ep->msg_zcopy.acked_sn, ep->msg_zcopy.sn);
+
+    ucs_queue_for_each_extract(zcopy_comp, &ep->msg_zcopy.comp_q, elem,
+                               UCS_CIRCULAR_COMPARE32(zcopy_comp->wait_sn, <=,
+                                                      ep->msg_zcopy.acked_sn)) {
+        uct_invoke_completion(zcopy_comp->comp, UCS_OK);
+        ucs_free(zcopy_comp);
+    }
+
+    if (!uct_tcp_ep_msg_zcopy_pending(ep)) {
+        ucs_assert(ucs_queue_is_empty(&ep->msg_zcopy.comp_q));
+        uct_tcp_ep_mod_events(ep, 0, UCS_EVENT_SET_EVERR);
+        uct_tcp_iface_outstanding_dec(iface);
+    }
+#endif
+
+    return count;
+}
+
 ucs_status_t uct_tcp_ep_handle_dropped_connect(uct_tcp_ep_t *ep, int io_errno)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
@@ -676,7 +1072,8 @@ static ucs_status_t uct_tcp_ep_io_err_handler_cb(void *arg, int io_errno)
 
     if ((io_errno == ECONNRESET) &&
         (ep->conn_state == UCT_TCP_EP_CONN_STATE_CONNECTED) &&
-        (ep->ctx_caps == UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX)) /* only RX cap */) {
+        ((ep->ctx_caps == UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX)) /* only RX cap */ ||
+         (ep->stripe.type == UCT_TCP_EP_STRIPE_RX))) {
         ucs_debug("tcp_ep %p: detected %d (%s) error, the [%s <-> %s] "
                   "connection was dropped by the peer",
                   ep, io_errno, strerror(io_errno),
@@ -696,8 +1093,12 @@ static inline void uct_tcp_ep_handle_recv_err(uct_tcp_ep_t *ep,
     if (status == UCS_ERR_NO_PROGRESS) {
         /* If no data were read to the allocated buffer,
          * we can safely reset it for futher re-use and to
-         * avoid overwriting this buffer, because `rx::length == 0` */
-        if (!ep->rx.length) {
+         * avoid overwriting this buffer, because `rx::length == 0`.
+         * During PUT/GET RX the buffer is kept for the operation, and the
+         * event could be reported spuriously (e.g. by io_uring event set) */
+        if (!ep->rx.length &&
+            !(ep->ctx_caps & (UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_RX) |
+                              UCS_BIT(UCT_TCP_EP_CTX_TYPE_GET_RX)))) {
             uct_tcp_ep_ctx_reset(&ep->rx);
         }
     } else {
@@ -730,6 +1131,13 @@ static inline unsigned uct_tcp_ep_recv(uct_tcp_ep_t *ep, size_t recv_length)
  * functions implemented below */
 static void uct_tcp_ep_post_put_ack(uct_tcp_ep_t *ep);
 
+/* Forward declaration - the function depends on AM send
+ * functions implemented below */
+static void uct_tcp_ep_progress_rma_replies(uct_tcp_ep_t *ep);
+
+/* Forward declaration - the function is used to resume RX */
+static unsigned uct_tcp_ep_am_rx_parse(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep);
+
 static unsigned uct_tcp_ep_progress_data_tx(uct_tcp_ep_t *ep)
 {
     unsigned ret = 0;
@@ -755,6 +1163,10 @@ static unsigned uct_tcp_ep_progress_data_tx(uct_tcp_ep_t *ep)
         }
     }
 
+    if (!ucs_queue_is_empty(&ep->rma.reply_q)) {
+        uct_tcp_ep_progress_rma_replies(ep);
+    }
+
     if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_RX_SENDING_ACK)) {
         uct_tcp_ep_post_put_ack(ep);
     }
@@ -783,15 +1195,99 @@ uct_tcp_ep_comp_recv_am(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
     uct_iface_invoke_am(&iface->super, hdr->am_id, hdr + 1, hdr->length, 0);
 }
 
+static void uct_tcp_ep_rx_stall(uct_tcp_ep_t *ep)
+{
+    ucs_trace("tcp_ep %p: RX is stalled", ep);
+    ep->stripe.rx_stalled = 1;
+    uct_tcp_ep_mod_events(ep, 0, UCS_EVENT_SET_EVREAD);
+}
+
+static void uct_tcp_ep_rx_resume(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    ucs_trace("tcp_ep %p: RX is resumed", ep);
+    ep->stripe.rx_stalled = 0;
+    uct_tcp_ep_mod_events(ep, UCS_EVENT_SET_EVREAD, 0);
+
+    /* Messages kept in RX buffer have to be handled now, since the socket
+     * may have no data to report */
+    if (uct_tcp_ep_ctx_buf_need_progress(&ep->rx)) {
+        uct_tcp_ep_am_rx_parse(iface, ep);
+    }
+}
+
+static void uct_tcp_ep_stripe_rx_start(uct_tcp_ep_t *ep, uint32_t sn,
+                                       unsigned count)
+{
+    uct_tcp_ep_t *stripe_ep;
+    unsigned i;
+
+    ucs_assertv(ep->stripe.rx_pending == 0, "ep=%p", ep);
+
+    ep->stripe.rx_sn      = sn;
+    ep->stripe.rx_pending = count;
+
+    /* Account the parts which were received before the PUT request */
+    for (i = 0; i < ep->stripe.rx_count; ++i) {
+        stripe_ep = ep->stripe.rx[i];
+        if (stripe_ep->stripe.rx_stalled && (stripe_ep->stripe.rx_sn == sn)) {
+            ucs_assertv(ep->stripe.rx_pending > 0, "ep=%p", ep);
+            --ep->stripe.rx_pending;
+            uct_tcp_ep_rx_resume(stripe_ep);
+        }
+    }
+}
+
+static void uct_tcp_ep_stripe_rx_done(uct_tcp_ep_t *ep, uint32_t sn)
+{
+    uct_tcp_ep_t *parent = ep->stripe.parent;
+
+    if (parent == NULL) {
+        /* The parent EP was destroyed */
+        return;
+    }
+
+    if ((parent->stripe.rx_pending == 0) || (parent->stripe.rx_sn != sn)) {
+        /* The parent EP didn't start receiving this PUT operation, don't
+         * receive parts of next operations until it does */
+        ep->stripe.rx_sn = sn;
+        uct_tcp_ep_rx_stall(ep);
+        return;
+    }
+
+    if ((--parent->stripe.rx_pending == 0) && parent->stripe.rx_stalled) {
+        uct_tcp_ep_post_put_ack(parent);
+        uct_tcp_ep_rx_resume(parent);
+    }
+}
+
+static void uct_tcp_ep_put_rx_done(uct_tcp_ep_t *ep, uint32_t sn)
+{
+    if (ep->stripe.type == UCT_TCP_EP_STRIPE_RX) {
+        uct_tcp_ep_stripe_rx_done(ep, sn);
+    } else if (ep->stripe.rx_pending == 0) {
+        uct_tcp_ep_post_put_ack(ep);
+    } else {
+        /* Parts of the PUT operation are still being received through
+         * stripe connections, the next operations mustn't be handled
+         * before they arrive */
+        uct_tcp_ep_rx_stall(ep);
+    }
+}
+
 static inline ucs_status_t
 uct_tcp_ep_put_rx_advance(uct_tcp_ep_t *ep, uct_tcp_ep_put_req_hdr_t *put_req,
                           size_t recv_length)
 {
+    uint32_t sn;
+
     put_req->addr   += recv_length;
     put_req->length -= recv_length;
 
     if (!put_req->length) {
-        uct_tcp_ep_post_put_ack(ep);
+        sn = put_req->sn;
 
         /* EP's ctx_caps doen't have UCT_TCP_EP_CTX_TYPE_PUT_RX flag
          * set in case of entire PUT payload was received through
@@ -801,6 +1297,7 @@ uct_tcp_ep_put_rx_advance(uct_tcp_ep_t *ep, uct_tcp_ep_put_req_hdr_t *put_req,
             uct_tcp_ep_ctx_reset(&ep->rx);
         }
 
+        uct_tcp_ep_put_rx_done(ep, sn);
         return UCS_OK;
     }
 
@@ -834,102 +1331,371 @@ static inline void uct_tcp_ep_handle_put_req(uct_tcp_ep_t *ep,
     ep->ctx_caps |= UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_RX);
 }
 
-unsigned uct_tcp_ep_progress_am_rx(uct_tcp_ep_t *ep)
+static inline uct_tcp_ep_rma_op_t *
+uct_tcp_ep_rma_op_get(uct_tcp_iface_t *iface, uint8_t am_id, uint32_t sn)
 {
-    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
-                                            uct_tcp_iface_t);
-    unsigned handled       = 0;
-    uct_tcp_am_hdr_t *hdr;
-    size_t recv_length;
-    size_t remainder;
+    uct_tcp_ep_rma_op_t *op;
 
-    ucs_trace_func("ep=%p", ep);
-
-    if (!uct_tcp_ep_ctx_buf_need_progress(&ep->rx)) {
-        ep->rx.buf = ucs_mpool_get_inline(&iface->rx_mpool);
-        if (ucs_unlikely(ep->rx.buf == NULL)) {
-            ucs_warn("tcp_ep %p: unable to get a buffer from RX memory pool", ep);
-            return 0;
-        }
+    op = ucs_mpool_get_inline(&iface->rma_mpool);
+    if (ucs_unlikely(op == NULL)) {
+        return NULL;
+    }
 
-        /* post the entire AM buffer */
-        recv_length = iface->config.rx_seg_size;
-    } else if (ep->rx.length - ep->rx.offset < sizeof(*hdr)) {
-        ucs_assert(ep->rx.buf != NULL);
+    op->am_id = am_id;
+    op->sn    = sn;
+    return op;
+}
 
-        /* do partial receive of the remaining part of the hdr
-         * and post the entire AM buffer */
-        recv_length = iface->config.rx_seg_size - ep->rx.length;
-    } else {
-        ucs_assert(ep->rx.buf != NULL);
+static void uct_tcp_ep_rma_op_complete(uct_tcp_ep_t *ep)
+{
+    uct_tcp_ep_rma_op_t *op;
+    uint32_t sn;
 
-        /* do partial receive of the remaining user data */
-        hdr         = UCS_PTR_BYTE_OFFSET(ep->rx.buf, ep->rx.offset);
-        recv_length = hdr->length - (ep->rx.length - ep->rx.offset - sizeof(*hdr));
+    op = ucs_queue_pull_elem_non_empty(&ep->rma.wait_q, uct_tcp_ep_rma_op_t,
+                                       elem);
+    sn = op->sn;
+    if (op->comp != NULL) {
+        uct_invoke_completion(op->comp, UCS_OK);
     }
+    ucs_mpool_put_inline(op);
 
-    if (!uct_tcp_ep_recv(ep, recv_length)) {
-        goto out;
-    }
+    /* The peer handles operations in order, so the reply also confirms
+     * completion of all preceding PUT and ATOMIC operations */
+    uct_tcp_ep_handle_put_ack(ep, sn);
+}
 
-    /* Parse received active messages */
-    while (uct_tcp_ep_ctx_buf_need_progress(&ep->rx)) {
-        remainder = ep->rx.length - ep->rx.offset;
-        if (remainder < sizeof(*hdr)) {
-            /* Move the partially received hdr to the beginning of the buffer */
-            memmove(ep->rx.buf, UCS_PTR_BYTE_OFFSET(ep->rx.buf, ep->rx.offset),
-                    remainder);
-            ep->rx.offset = 0;
-            ep->rx.length = remainder;
-            handled++;
-            goto out;
-        }
+static void uct_tcp_ep_post_rma_reply(uct_tcp_ep_t *ep,
+                                      uct_tcp_ep_rma_op_t *op)
+{
+    ucs_queue_push(&ep->rma.reply_q, &op->elem);
+    uct_tcp_ep_progress_rma_replies(ep);
+}
 
-        hdr = UCS_PTR_BYTE_OFFSET(ep->rx.buf, ep->rx.offset);
-        ucs_assert(hdr->length <= (iface->config.rx_seg_size -
-                                   sizeof(uct_tcp_am_hdr_t)));
+static void uct_tcp_ep_handle_get_req(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                                      const uct_tcp_ep_get_req_hdr_t *get_req)
+{
+    uct_tcp_ep_rma_op_t *op;
 
-        if (remainder < (sizeof(*hdr) + hdr->length)) {
-            handled++;
-            goto out;
-        }
+    ucs_assert(get_req->addr || !get_req->length);
 
-        /* Full message was received */
-        ep->rx.offset += sizeof(*hdr) + hdr->length;
+    op = uct_tcp_ep_rma_op_get(iface, UCT_TCP_EP_GET_REP_AM_ID, get_req->sn);
+    if (ucs_unlikely(op == NULL)) {
+        ucs_error("tcp_ep %p: unable to allocate GET reply", ep);
+        return;
+    }
 
-        if (ucs_likely(hdr->am_id < UCT_AM_ID_MAX)) {
-            uct_tcp_ep_comp_recv_am(iface, ep, hdr);
-            handled++;
-        } else if (hdr->am_id == UCT_TCP_EP_PUT_REQ_AM_ID) {
-            ucs_assert(hdr->length == sizeof(uct_tcp_ep_put_req_hdr_t));
-            uct_tcp_ep_handle_put_req(ep, (uct_tcp_ep_put_req_hdr_t*)(hdr + 1),
-                                      ep->rx.length - ep->rx.offset);
-            handled++;
-            if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_RX)) {
-                /* It means that PUT RX is in progress and EP RX buffer
-                 * is used to keep PUT header. So, we don't need to
-                 * release a EP RX buffer */
-                goto out;
-            }
+    op->buffer = (void*)(uintptr_t)get_req->addr;
+    op->length = get_req->length;
+    uct_tcp_ep_post_rma_reply(ep, op);
+}
+
+/* The functions are kept out of line: being inlined into the RX parsing loop,
+ * the compare-and-swap loops of AND/OR/XOR are miscompiled by GCC 12 */
+static UCS_F_NOINLINE uint32_t
+uct_tcp_ep_atomic32_exec(volatile uint32_t *ptr, uint8_t opcode,
+                         uint32_t value, uint32_t compare)
+{
+    switch (opcode) {
+    case UCT_ATOMIC_OP_ADD:
+        return ucs_atomic_fadd32(ptr, value);
+    case UCT_ATOMIC_OP_AND:
+        return ucs_atomic_fand32(ptr, value);
+    case UCT_ATOMIC_OP_OR:
+        return ucs_atomic_for32(ptr, value);
+    case UCT_ATOMIC_OP_XOR:
+        return ucs_atomic_fxor32(ptr, value);
+    case UCT_ATOMIC_OP_SWAP:
+        return ucs_atomic_swap32(ptr, value);
+    case UCT_ATOMIC_OP_CSWAP:
+        return ucs_atomic_cswap32(ptr, compare, value);
+    default:
+        ucs_fatal("incorrect atomic opcode: %d", opcode);
+    }
+}
+
+static UCS_F_NOINLINE uint64_t
+uct_tcp_ep_atomic64_exec(volatile uint64_t *ptr, uint8_t opcode,
+                         uint64_t value, uint64_t compare)
+{
+    switch (opcode) {
+    case UCT_ATOMIC_OP_ADD:
+        return ucs_atomic_fadd64(ptr, value);
+    case UCT_ATOMIC_OP_AND:
+        return ucs_atomic_fand64(ptr, value);
+    case UCT_ATOMIC_OP_OR:
+        return ucs_atomic_for64(ptr, value);
+    case UCT_ATOMIC_OP_XOR:
+        return ucs_atomic_fxor64(ptr, value);
+    case UCT_ATOMIC_OP_SWAP:
+        return ucs_atomic_swap64(ptr, value);
+    case UCT_ATOMIC_OP_CSWAP:
+        return ucs_atomic_cswap64(ptr, compare, value);
+    default:
+        ucs_fatal("incorrect atomic opcode: %d", opcode);
+    }
+}
+
+static void
+uct_tcp_ep_handle_atomic_req(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                             const uct_tcp_ep_atomic_req_hdr_t *atomic_req)
+{
+    uct_tcp_ep_rma_op_t *op;
+    uint64_t result;
+
+    /* The operation is executed with CPU atomics, so it is atomic with
+     * respect to the operations done by the local process as well */
+    if (atomic_req->size == sizeof(uint32_t)) {
+        result = uct_tcp_ep_atomic32_exec((uint32_t*)(uintptr_t)atomic_req->addr,
+                                          atomic_req->opcode, atomic_req->value,
+                                          atomic_req->compare);
+    } else {
+        ucs_assert(atomic_req->size == sizeof(uint64_t));
+        result = uct_tcp_ep_atomic64_exec((uint64_t*)(uintptr_t)atomic_req->addr,
+                                          atomic_req->opcode, atomic_req->value,
+                                          atomic_req->compare);
+    }
+
+    if (!atomic_req->fetch) {
+        /* Non-fetching operations are acknowledged as PUT operations */
+        ep->rx.put_sn = atomic_req->sn;
+        uct_tcp_ep_post_put_ack(ep);
+        return;
+    }
+
+    op = uct_tcp_ep_rma_op_get(iface, UCT_TCP_EP_ATOMIC_REP_AM_ID,
+                               atomic_req->sn);
+    if (ucs_unlikely(op == NULL)) {
+        ucs_error("tcp_ep %p: unable to allocate ATOMIC reply", ep);
+        return;
+    }
+
+    op->result = result;
+    uct_tcp_ep_post_rma_reply(ep, op);
+}
+
+static inline ucs_status_t
+uct_tcp_ep_get_rx_advance(uct_tcp_ep_t *ep, uct_tcp_ep_rma_op_t *op,
+                          size_t recv_length)
+{
+    op->buffer  = UCS_PTR_BYTE_OFFSET(op->buffer, recv_length);
+    op->length -= recv_length;
+
+    if (op->length) {
+        return UCS_INPROGRESS;
+    }
+
+    /* EP's ctx_caps doesn't have UCT_TCP_EP_CTX_TYPE_GET_RX flag set in case
+     * of entire GET data was received along with the reply header */
+    if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_GET_RX)) {
+        ep->ctx_caps &= ~UCS_BIT(UCT_TCP_EP_CTX_TYPE_GET_RX);
+        uct_tcp_ep_ctx_reset(&ep->rx);
+    }
+
+    uct_tcp_ep_rma_op_complete(ep);
+    return UCS_OK;
+}
+
+static void uct_tcp_ep_handle_get_rep(uct_tcp_ep_t *ep,
+                                      const uct_tcp_ep_get_rep_hdr_t *get_rep)
+{
+    uct_tcp_ep_rma_op_t *op;
+    size_t copied_length;
+    ucs_status_t status;
+
+    op = ucs_queue_head_elem_non_empty(&ep->rma.wait_q, uct_tcp_ep_rma_op_t,
+                                       elem);
+    ucs_assertv((op->am_id == UCT_TCP_EP_GET_REP_AM_ID) &&
+                (op->sn == get_rep->sn) && (op->length == get_rep->length),
+                "ep=%p op: am_id %d sn %u length %zu, reply: sn %u length %zu",
+                ep, op->am_id, op->sn, op->length, get_rep->sn,
+                get_rep->length);
+
+    copied_length = ucs_min(op->length, ep->rx.length - ep->rx.offset);
+    memcpy(op->buffer, UCS_PTR_BYTE_OFFSET(ep->rx.buf, ep->rx.offset),
+           copied_length);
+    ep->rx.offset += copied_length;
+
+    status = uct_tcp_ep_get_rx_advance(ep, op, copied_length);
+    if (status == UCS_OK) {
+        return;
+    }
+
+    /* The rest of the data is received directly to the user's buffer, the
+     * RX buffer is kept until the operation is completed */
+    ucs_assert(ep->rx.offset == ep->rx.length);
+    uct_tcp_ep_ctx_rewind(&ep->rx);
+    ep->ctx_caps |= UCS_BIT(UCT_TCP_EP_CTX_TYPE_GET_RX);
+}
+
+static void
+uct_tcp_ep_handle_atomic_rep(uct_tcp_ep_t *ep,
+                             const uct_tcp_ep_atomic_rep_hdr_t *atomic_rep)
+{
+    uct_tcp_ep_rma_op_t *op;
+
+    op = ucs_queue_head_elem_non_empty(&ep->rma.wait_q, uct_tcp_ep_rma_op_t,
+                                       elem);
+    ucs_assertv((op->am_id == UCT_TCP_EP_ATOMIC_REP_AM_ID) &&
+                (op->sn == atomic_rep->sn), "ep=%p op: am_id %d sn %u, "
+                "reply: sn %u", ep, op->am_id, op->sn, atomic_rep->sn);
+
+    if (op->size == sizeof(uint32_t)) {
+        *(uint32_t*)op->buffer = atomic_rep->result;
+    } else {
+        *(uint64_t*)op->buffer = atomic_rep->result;
+    }
+
+    uct_tcp_ep_rma_op_complete(ep);
+}
+
+static unsigned uct_tcp_ep_am_rx_parse(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
+    unsigned handled = 0;
+    uct_tcp_ep_put_stripe_req_hdr_t *stripe_req;
+    uct_tcp_ep_put_req_hdr_t *put_req;
+    uct_tcp_am_hdr_t *hdr;
+    size_t remainder;
+
+    /* Parse received active messages */
+    while (uct_tcp_ep_ctx_buf_need_progress(&ep->rx)) {
+        remainder = ep->rx.length - ep->rx.offset;
+        if (remainder < sizeof(*hdr)) {
+            /* The partially received hdr is kept until the next receive */
+            handled++;
+            return handled;
+        }
+
+        hdr = UCS_PTR_BYTE_OFFSET(ep->rx.buf, ep->rx.offset);
+        ucs_assert(hdr->length <= (iface->config.rx_seg_size -
+                                   sizeof(uct_tcp_am_hdr_t)));
+
+        if (remainder < (sizeof(*hdr) + hdr->length)) {
+            handled++;
+            return handled;
+        }
+
+        /* Full message was received */
+        ep->rx.offset += sizeof(*hdr) + hdr->length;
+
+        if (ucs_likely(hdr->am_id < UCT_AM_ID_MAX)) {
+            uct_tcp_ep_comp_recv_am(iface, ep, hdr);
+            handled++;
+        } else if ((hdr->am_id == UCT_TCP_EP_PUT_REQ_AM_ID) ||
+                   (hdr->am_id == UCT_TCP_EP_PUT_STRIPE_REQ_AM_ID)) {
+            put_req = (uct_tcp_ep_put_req_hdr_t*)(hdr + 1);
+            if (hdr->am_id == UCT_TCP_EP_PUT_STRIPE_REQ_AM_ID) {
+                ucs_assert(hdr->length == sizeof(*stripe_req));
+                stripe_req = ucs_derived_of(put_req,
+                                            uct_tcp_ep_put_stripe_req_hdr_t);
+                uct_tcp_ep_stripe_rx_start(ep, put_req->sn, stripe_req->count);
+            } else {
+                ucs_assert(hdr->length == sizeof(*put_req));
+            }
+
+            uct_tcp_ep_handle_put_req(ep, put_req,
+                                      ep->rx.length - ep->rx.offset);
+            handled++;
+            if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_RX)) {
+                /* It means that PUT RX is in progress and EP RX buffer
+                 * is used to keep PUT header. So, we don't need to
+                 * release a EP RX buffer */
+                return handled;
+            }
+
+            if (ep->stripe.rx_stalled) {
+                /* Keep the rest of received data until RX is resumed */
+                if (!uct_tcp_ep_ctx_buf_need_progress(&ep->rx)) {
+                    uct_tcp_ep_ctx_reset(&ep->rx);
+                }
+                return handled;
+            }
+        } else if (hdr->am_id == UCT_TCP_EP_GET_REQ_AM_ID) {
+            ucs_assert(hdr->length == sizeof(uct_tcp_ep_get_req_hdr_t));
+            uct_tcp_ep_handle_get_req(iface, ep,
+                                      (uct_tcp_ep_get_req_hdr_t*)(hdr + 1));
+            handled++;
+        } else if (hdr->am_id == UCT_TCP_EP_GET_REP_AM_ID) {
+            ucs_assert(hdr->length == sizeof(uct_tcp_ep_get_rep_hdr_t));
+            uct_tcp_ep_handle_get_rep(ep, (uct_tcp_ep_get_rep_hdr_t*)(hdr + 1));
+            handled++;
+            if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_GET_RX)) {
+                /* GET RX is in progress, the EP RX buffer is released
+                 * when it completes */
+                return handled;
+            }
+        } else if (hdr->am_id == UCT_TCP_EP_ATOMIC_REQ_AM_ID) {
+            ucs_assert(hdr->length == sizeof(uct_tcp_ep_atomic_req_hdr_t));
+            uct_tcp_ep_handle_atomic_req(iface, ep,
+                                         (uct_tcp_ep_atomic_req_hdr_t*)(hdr + 1));
+            handled++;
+        } else if (hdr->am_id == UCT_TCP_EP_ATOMIC_REP_AM_ID) {
+            ucs_assert(hdr->length == sizeof(uct_tcp_ep_atomic_rep_hdr_t));
+            uct_tcp_ep_handle_atomic_rep(ep,
+                                         (uct_tcp_ep_atomic_rep_hdr_t*)(hdr + 1));
+            handled++;
         } else if (hdr->am_id == UCT_TCP_EP_PUT_ACK_AM_ID) {
             ucs_assert(hdr->length == sizeof(uint32_t));
-            uct_tcp_ep_handle_put_ack(ep, (uct_tcp_ep_put_ack_hdr_t*)(hdr + 1));
+            uct_tcp_ep_handle_put_ack(ep,
+                                      ((uct_tcp_ep_put_ack_hdr_t*)(hdr + 1))->sn);
             handled++;
         } else {
             ucs_assert(hdr->am_id == UCT_TCP_EP_CM_AM_ID);
             handled += 1 + uct_tcp_cm_handle_conn_pkt(&ep, hdr + 1, hdr->length);
             if (ep == NULL) {
-                goto out;
+                return handled;
             }
         }
     }
 
     uct_tcp_ep_ctx_reset(&ep->rx);
-
-out:
     return handled;
 }
 
+unsigned uct_tcp_ep_progress_am_rx(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_am_hdr_t *hdr;
+    size_t remainder;
+
+    ucs_trace_func("ep=%p", ep);
+
+    if (!uct_tcp_ep_ctx_buf_need_progress(&ep->rx)) {
+        ep->rx.buf = ucs_mpool_get_inline(&iface->rx_mpool);
+        if (ucs_unlikely(ep->rx.buf == NULL)) {
+            ucs_warn("tcp_ep %p: unable to get a buffer from RX memory pool", ep);
+            return 0;
+        }
+    } else {
+        ucs_assert(ep->rx.buf != NULL);
+
+        remainder = ep->rx.length - ep->rx.offset;
+        hdr       = UCS_PTR_BYTE_OFFSET(ep->rx.buf, ep->rx.offset);
+        if ((remainder >= sizeof(*hdr)) &&
+            ((remainder - sizeof(*hdr)) >= hdr->length)) {
+            /* The message was received before RX was stalled */
+            return uct_tcp_ep_am_rx_parse(iface, ep);
+        }
+
+        /* Only the partially received message is kept, move it to the
+         * beginning of the buffer to receive as many of the next messages
+         * as possible by a single system call */
+        if (ep->rx.offset != 0) {
+            memmove(ep->rx.buf, hdr, remainder);
+            ep->rx.offset = 0;
+            ep->rx.length = remainder;
+        }
+    }
+
+    /* post the entire free part of the RX buffer, all the complete messages
+     * are handled from the buffer in place */
+    if (!uct_tcp_ep_recv(ep, iface->config.rx_buf_size - ep->rx.length)) {
+        return 0;
+    }
+
+    return uct_tcp_ep_am_rx_parse(iface, ep);
+}
+
 static inline ucs_status_t
 uct_tcp_ep_am_prepare(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
                       uint8_t am_id, uct_tcp_am_hdr_t **hdr)
@@ -987,6 +1753,29 @@ unsigned uct_tcp_ep_progress_put_rx(uct_tcp_ep_t *ep)
     return 1;
 }
 
+unsigned uct_tcp_ep_progress_get_rx(uct_tcp_ep_t *ep)
+{
+    uct_tcp_ep_rma_op_t *op;
+    size_t recv_length;
+    ucs_status_t status;
+
+    op          = ucs_queue_head_elem_non_empty(&ep->rma.wait_q,
+                                                uct_tcp_ep_rma_op_t, elem);
+    recv_length = op->length;
+    status      = ucs_socket_recv_nb(ep->fd, op->buffer, &recv_length,
+                                     uct_tcp_ep_io_err_handler_cb, ep);
+    if (ucs_unlikely(status != UCS_OK)) {
+        uct_tcp_ep_handle_recv_err(ep, status);
+        return 0;
+    }
+
+    ucs_assertv(recv_length, "ep=%p", ep);
+
+    uct_tcp_ep_get_rx_advance(ep, op, recv_length);
+
+    return 1;
+}
+
 static inline void
 uct_tcp_ep_set_outstanding_zcopy(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
                                  uct_tcp_ep_zcopy_tx_t *ctx, const void *header,
@@ -1103,6 +1892,13 @@ static void uct_tcp_ep_post_put_ack(uct_tcp_ep_t *ep)
     uct_tcp_ep_put_ack_hdr_t *put_ack;
     ucs_status_t status;
 
+    if (!ucs_queue_is_empty(&ep->rma.reply_q)) {
+        /* The ACK mustn't overtake replies to the preceding operations, it
+         * will be sent once all of them are sent */
+        ep->ctx_caps |= UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_RX_SENDING_ACK);
+        return;
+    }
+
     /* Make sure that we are sending nothing through this EP at the moment.
      * This check is needed to avoid mixing AM/PUT data sent from this EP
      * and this PUT ACK message */
@@ -1276,10 +2072,18 @@ uct_tcp_ep_prepare_zcopy(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep, uint8_t am_id
         ctx->iov_cnt++;
     }
 
+    /* Large payload is sent with MSG_ZEROCOPY after the headers */
+    ctx->msg_zcopy_iov = ctx->iov_cnt;
+
     /* User-defined payload */
     ctx->iov_cnt += uct_iovec_fill_iov(&ctx->iov[ctx->iov_cnt], iov,
                                        iovcnt, zcopy_payload_p);
 
+    if (!ep->msg_zcopy.enabled || (*zcopy_payload_p == 0) ||
+        (*zcopy_payload_p < iface->config.msg_zcopy_thresh)) {
+        ctx->msg_zcopy_iov = ctx->iov_cnt;
+    }
+
     *ctx_p = ctx;
 
     return UCS_OK;
@@ -1310,9 +2114,10 @@ ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id, const void *hea
 
     ctx->super.length = payload_length + header_length;
 
+    /* If MSG_ZEROCOPY is used, only the headers are sent right away */
     status = uct_tcp_ep_am_sendv(iface, ep, 0, &ctx->super,
                                  iface->config.rx_seg_size,
-                                 header, ctx->iov, ctx->iov_cnt);
+                                 header, ctx->iov, ctx->msg_zcopy_iov);
     if (ucs_unlikely((status != UCS_OK) && (status != UCS_ERR_NO_PROGRESS))) {
         goto out;
     }
@@ -1332,42 +2137,80 @@ out:
     return status;
 }
 
-ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
-                                  size_t iovcnt, uint64_t remote_addr,
-                                  uct_rkey_t rkey, uct_completion_t *comp)
+static void uct_tcp_ep_stripe_connect(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
 {
-    uct_tcp_ep_t *ep                 = ucs_derived_of(uct_ep, uct_tcp_ep_t);
-    uct_tcp_iface_t *iface           = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
-    uct_tcp_ep_zcopy_tx_t *ctx       = NULL;
-    uct_tcp_ep_put_req_hdr_t put_req = {0}; /* Suppress Cppcheck false-positive */
+    uct_tcp_ep_t *stripe_ep;
     ucs_status_t status;
+    unsigned i;
+    int fd;
 
-    UCT_CHECK_LENGTH(sizeof(put_req) + uct_iov_total_length(iov, iovcnt), 0,
-                     UCT_TCP_EP_PUT_ZCOPY_MAX - sizeof(uct_tcp_am_hdr_t),
-                     "put_zcopy");
+    /* Stripe connections are established once, the failed ones are not
+     * retried and PUT operations are striped over the rest of them */
+    ep->stripe.tx_started = 1;
 
-    status = uct_tcp_ep_prepare_zcopy(iface, ep, UCT_TCP_EP_PUT_REQ_AM_ID,
-                                      &put_req, sizeof(put_req),
-                                      iov, iovcnt, "put_zcopy",
-                                      /* Set a payload length directly to the
-                                       * TX length, since PUT Zcopy doesn't
-                                       * set the payload length to TCP AM hdr */
-                                      &ep->tx.length, &ctx);
-    if (ucs_unlikely(status != UCS_OK)) {
-        return status;
+    for (i = 1; i < iface->config.stripe.count; ++i) {
+        status = ucs_socket_create(iface->config.ifaddr.ss_family,
+                                   SOCK_STREAM, &fd);
+        if (status != UCS_OK) {
+            break;
+        }
+
+        status = uct_tcp_ep_init(iface, fd, &ep->peer_addr, &stripe_ep);
+        if (status != UCS_OK) {
+            uct_tcp_ep_close_fd(&fd);
+            break;
+        }
+
+        stripe_ep->stripe.type   = UCT_TCP_EP_STRIPE_TX;
+        stripe_ep->stripe.parent = ep;
+        ep->stripe.tx[ep->stripe.tx_count++] = stripe_ep;
+
+        status = uct_tcp_cm_conn_start(stripe_ep);
+        if (status != UCS_OK) {
+            uct_tcp_ep_destroy_internal(&stripe_ep->super.super);
+            break;
+        }
     }
 
-    ctx->super.length = sizeof(put_req);
-    put_req.addr      = remote_addr;
-    put_req.length    = ep->tx.length;
-    put_req.sn        = ep->tx.put_sn + 1;
+    ucs_debug("tcp_ep %p: started %u stripe connections", ep,
+              ep->stripe.tx_count);
+}
 
-    status = uct_tcp_ep_am_sendv(iface, ep, 0, &ctx->super, UCT_TCP_EP_PUT_ZCOPY_MAX,
-                                 &put_req, ctx->iov, ctx->iov_cnt);
-    if (ucs_unlikely((status != UCS_OK) && (status != UCS_ERR_NO_PROGRESS))) {
-        goto out;
+static size_t uct_tcp_ep_iov_slice(const uct_iov_t *iov, size_t iovcnt,
+                                   size_t offset, size_t length,
+                                   uct_iov_t *slice_iov)
+{
+    size_t slice_iovcnt = 0;
+    size_t iov_length;
+    size_t iov_it;
+
+    for (iov_it = 0; (iov_it < iovcnt) && (length > 0); ++iov_it) {
+        iov_length = uct_iov_get_length(&iov[iov_it]);
+        if (offset >= iov_length) {
+            offset -= iov_length;
+            continue;
+        }
+
+        /* IOV elements are sent as contiguous buffers, the same way as
+         * uct_iovec_fill_iov() does */
+        slice_iov[slice_iovcnt].buffer = UCS_PTR_BYTE_OFFSET(iov[iov_it].buffer,
+                                                             offset);
+        slice_iov[slice_iovcnt].length = ucs_min(iov_length - offset, length);
+        slice_iov[slice_iovcnt].memh   = iov[iov_it].memh;
+        slice_iov[slice_iovcnt].stride = 0;
+        slice_iov[slice_iovcnt].count  = 1;
+
+        length -= slice_iov[slice_iovcnt].length;
+        offset  = 0;
+        ++slice_iovcnt;
     }
 
+    return slice_iovcnt;
+}
+
+static inline void
+uct_tcp_ep_rma_sn_advance(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep)
+{
     ep->tx.put_sn++;
 
     if (!(ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK))) {
@@ -1375,16 +2218,45 @@ ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
          * outstanding operations counter in order to ensure returning
          * UCS_INPROGRESS from flush functions and do progressing.
          * UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK flag has to be removed upon PUT
-         * ACK message receiving if there are no other PUT operations in-flight */
+         * ACK or GET/ATOMIC reply message receiving if there are no other
+         * operations in-flight */
         ep->ctx_caps |= UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK);
         uct_tcp_iface_outstanding_inc(iface);
     }
+}
 
-    UCT_TL_EP_STAT_OP(&ep->super, PUT, ZCOPY, put_req.length);
+static ucs_status_t
+uct_tcp_ep_put_zcopy_send(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                          uint8_t am_id, uct_tcp_ep_put_req_hdr_t *put_req,
+                          unsigned put_req_length, const uct_iov_t *iov,
+                          size_t iovcnt, uct_completion_t *comp)
+{
+    uct_tcp_ep_zcopy_tx_t *ctx = NULL;
+    ucs_status_t status;
+
+    status = uct_tcp_ep_prepare_zcopy(iface, ep, am_id, put_req, put_req_length,
+                                      iov, iovcnt, "put_zcopy",
+                                      /* Set a payload length directly to the
+                                       * TX length, since PUT Zcopy doesn't
+                                       * set the payload length to TCP AM hdr */
+                                      &ep->tx.length, &ctx);
+    if (ucs_unlikely(status != UCS_OK)) {
+        return status;
+    }
+
+    ctx->super.length = put_req_length;
+    put_req->length   = ep->tx.length;
+
+    /* If MSG_ZEROCOPY is used, only the headers are sent right away */
+    status = uct_tcp_ep_am_sendv(iface, ep, 0, &ctx->super, UCT_TCP_EP_PUT_ZCOPY_MAX,
+                                 put_req, ctx->iov, ctx->msg_zcopy_iov);
+    if (ucs_unlikely((status != UCS_OK) && (status != UCS_ERR_NO_PROGRESS))) {
+        goto out;
+    }
 
     if (uct_tcp_ep_ctx_buf_need_progress(&ep->tx)) {
-        uct_tcp_ep_set_outstanding_zcopy(iface, ep, ctx, &put_req,
-                                         sizeof(put_req), comp);
+        uct_tcp_ep_set_outstanding_zcopy(iface, ep, ctx, put_req,
+                                         put_req_length, comp);
         return UCS_INPROGRESS;
     }
 
@@ -1395,6 +2267,434 @@ out:
     return status;
 }
 
+static ucs_status_t
+uct_tcp_ep_send_get_rep(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                        const uct_tcp_ep_rma_op_t *op)
+{
+    uct_tcp_ep_get_rep_hdr_t get_rep;
+    uct_tcp_ep_zcopy_tx_t *ctx;
+    uct_iov_t iov;
+    ucs_status_t status;
+
+    iov.buffer     = op->buffer;
+    iov.length     = op->length;
+    iov.memh       = UCT_MEM_HANDLE_NULL;
+    iov.stride     = 0;
+    iov.count      = 1;
+    get_rep.length = op->length;
+    get_rep.sn     = op->sn;
+
+    /* The data is sent from the target memory without copying, the same
+     * way as PUT Zcopy does */
+    status = uct_tcp_ep_prepare_zcopy(iface, ep, UCT_TCP_EP_GET_REP_AM_ID,
+                                      &get_rep, sizeof(get_rep), &iov, 1,
+                                      "get_rep", &ep->tx.length, &ctx);
+    if (ucs_unlikely(status != UCS_OK)) {
+        return status;
+    }
+
+    ctx->super.length = sizeof(get_rep);
+
+    status = uct_tcp_ep_am_sendv(iface, ep, 0, &ctx->super,
+                                 UCT_TCP_EP_GET_ZCOPY_MAX, &get_rep, ctx->iov,
+                                 ctx->msg_zcopy_iov);
+    if (ucs_unlikely((status != UCS_OK) && (status != UCS_ERR_NO_PROGRESS))) {
+        goto out;
+    }
+
+    if (uct_tcp_ep_ctx_buf_need_progress(&ep->tx)) {
+        uct_tcp_ep_set_outstanding_zcopy(iface, ep, ctx, &get_rep,
+                                         sizeof(get_rep), NULL);
+        return UCS_OK;
+    }
+
+    status = UCS_OK;
+
+out:
+    uct_tcp_ep_ctx_reset(&ep->tx);
+    return status;
+}
+
+static ucs_status_t
+uct_tcp_ep_send_atomic_rep(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                           const uct_tcp_ep_rma_op_t *op)
+{
+    uct_tcp_am_hdr_t *hdr = NULL;
+    uct_tcp_ep_atomic_rep_hdr_t *atomic_rep;
+    ucs_status_t status;
+
+    status = uct_tcp_ep_am_prepare(iface, ep, UCT_TCP_EP_ATOMIC_REP_AM_ID,
+                                   &hdr);
+    if (ucs_unlikely(status != UCS_OK)) {
+        return status;
+    }
+
+    ucs_assertv(hdr != NULL, "ep=%p", ep);
+    hdr->length        = sizeof(*atomic_rep);
+    atomic_rep         = (uct_tcp_ep_atomic_rep_hdr_t*)(hdr + 1);
+    atomic_rep->result = op->result;
+    atomic_rep->sn     = op->sn;
+
+    status = uct_tcp_ep_am_send(iface, ep, hdr);
+    if (ucs_unlikely(status != UCS_OK)) {
+        uct_tcp_ep_ctx_reset(&ep->tx);
+    }
+
+    return status;
+}
+
+static void uct_tcp_ep_progress_rma_replies(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_ep_rma_op_t *op;
+    ucs_status_t status;
+
+    while (!ucs_queue_is_empty(&ep->rma.reply_q)) {
+        op = ucs_queue_head_elem_non_empty(&ep->rma.reply_q,
+                                           uct_tcp_ep_rma_op_t, elem);
+        if (op->am_id == UCT_TCP_EP_GET_REP_AM_ID) {
+            status = uct_tcp_ep_send_get_rep(iface, ep, op);
+        } else {
+            ucs_assert(op->am_id == UCT_TCP_EP_ATOMIC_REP_AM_ID);
+            status = uct_tcp_ep_send_atomic_rep(iface, ep, op);
+        }
+
+        if (status == UCS_ERR_NO_RESOURCE) {
+            /* EVWRITE event was requested to resume sending replies */
+            return;
+        } else if (ucs_unlikely(status != UCS_OK)) {
+            ucs_error("tcp_ep %p: failed to send reply for sn %u: %s",
+                      ep, op->sn, ucs_status_string(status));
+        }
+
+        ucs_queue_pull_non_empty(&ep->rma.reply_q);
+        ucs_mpool_put_inline(op);
+    }
+}
+
+static unsigned
+uct_tcp_ep_put_zcopy_stripes(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                             size_t length, uct_tcp_ep_t **stripes)
+{
+    unsigned count = 0;
+    unsigned i;
+
+    if ((length < iface->config.stripe.thresh) ||
+        (uct_tcp_ep_check_tx_res(ep) != UCS_OK)) {
+        return 0;
+    }
+
+    if (!ep->stripe.tx_started) {
+        /* The current operation is sent through the EP itself, the next
+         * ones will use the stripes when they are connected */
+        uct_tcp_ep_stripe_connect(iface, ep);
+        return 0;
+    }
+
+    /* Don't create empty parts */
+    for (i = 0; (i < ep->stripe.tx_count) && ((count + 1) < length); ++i) {
+        if (uct_tcp_ep_check_tx_res(ep->stripe.tx[i]) == UCS_OK) {
+            stripes[count++] = ep->stripe.tx[i];
+        }
+    }
+
+    return count;
+}
+
+static ucs_status_t
+uct_tcp_ep_put_zcopy_striped(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                             const uct_iov_t *iov, size_t iovcnt,
+                             size_t length, uint64_t remote_addr,
+                             uct_tcp_ep_t **stripes, unsigned count,
+                             uct_completion_t *comp)
+{
+    uct_tcp_ep_put_stripe_req_hdr_t stripe_req = {{0}};
+    uct_tcp_ep_put_req_hdr_t put_req           = {0};
+    size_t part_length                         = length / (count + 1);
+    unsigned inprogress_count                  = 0;
+    uct_tcp_ep_t *inprogress[UCT_TCP_EP_MAX_STRIPES];
+    uct_tcp_ep_zcopy_tx_t *ctx;
+    size_t part_iovcnt;
+    uct_iov_t *part_iov;
+    ucs_status_t status;
+    size_t offset;
+    unsigned i;
+
+    part_iov = ucs_alloca(iovcnt * sizeof(*part_iov));
+
+    /* The first part is sent through the EP itself along with the number of
+     * parts that the peer has to receive before acknowledging the operation */
+    offset                = length - (part_length * count);
+    stripe_req.super.addr = remote_addr;
+    stripe_req.super.sn   = ep->tx.put_sn + 1;
+    stripe_req.count      = count;
+
+    part_iovcnt = uct_tcp_ep_iov_slice(iov, iovcnt, 0, offset, part_iov);
+    status      = uct_tcp_ep_put_zcopy_send(iface, ep,
+                                            UCT_TCP_EP_PUT_STRIPE_REQ_AM_ID,
+                                            &stripe_req.super,
+                                            sizeof(stripe_req), part_iov,
+                                            part_iovcnt, comp);
+    if (UCS_STATUS_IS_ERR(status)) {
+        return status;
+    } else if (status == UCS_INPROGRESS) {
+        inprogress[inprogress_count++] = ep;
+    }
+
+    for (i = 0; i < count; ++i, offset += part_length) {
+        put_req.addr = remote_addr + offset;
+        put_req.sn   = stripe_req.super.sn;
+        part_iovcnt  = uct_tcp_ep_iov_slice(iov, iovcnt, offset, part_length,
+                                            part_iov);
+        status       = uct_tcp_ep_put_zcopy_send(iface, stripes[i],
+                                                 UCT_TCP_EP_PUT_REQ_AM_ID,
+                                                 &put_req, sizeof(put_req),
+                                                 part_iov, part_iovcnt, comp);
+        if (UCS_STATUS_IS_ERR(status)) {
+            ucs_error("tcp_ep %p: failed to send PUT part through stripe "
+                      "tcp_ep %p: %s", ep, stripes[i],
+                      ucs_status_string(status));
+            uct_tcp_ep_stripe_release(stripes[i]);
+            goto err;
+        } else if (status == UCS_INPROGRESS) {
+            inprogress[inprogress_count++] = stripes[i];
+        }
+    }
+
+    if (inprogress_count == 0) {
+        return UCS_OK;
+    }
+
+    if (comp != NULL) {
+        /* The completion is invoked by every part which is in progress */
+        comp->count += inprogress_count - 1;
+    }
+
+    return UCS_INPROGRESS;
+
+err:
+    /* The operation failed, so the user's completion mustn't be invoked by
+     * the parts which are in progress */
+    for (i = 0; i < inprogress_count; ++i) {
+        ctx       = (uct_tcp_ep_zcopy_tx_t*)inprogress[i]->tx.buf;
+        ctx->comp = NULL;
+    }
+    return status;
+}
+
+ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
+                                  size_t iovcnt, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep                 = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface           = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    uct_tcp_ep_put_req_hdr_t put_req = {0}; /* Suppress Cppcheck false-positive */
+    size_t length                    = uct_iov_total_length(iov, iovcnt);
+    uct_tcp_ep_t *stripes[UCT_TCP_EP_MAX_STRIPES];
+    unsigned stripes_count;
+    ucs_status_t status;
+
+    UCT_CHECK_LENGTH(sizeof(put_req) + length, 0,
+                     UCT_TCP_EP_PUT_ZCOPY_MAX - sizeof(uct_tcp_am_hdr_t),
+                     "put_zcopy");
+
+    stripes_count = uct_tcp_ep_put_zcopy_stripes(iface, ep, length, stripes);
+    if (stripes_count > 0) {
+        status = uct_tcp_ep_put_zcopy_striped(iface, ep, iov, iovcnt, length,
+                                              remote_addr, stripes,
+                                              stripes_count, comp);
+    } else {
+        put_req.addr = remote_addr;
+        put_req.sn   = ep->tx.put_sn + 1;
+        status       = uct_tcp_ep_put_zcopy_send(iface, ep,
+                                                 UCT_TCP_EP_PUT_REQ_AM_ID,
+                                                 &put_req, sizeof(put_req),
+                                                 iov, iovcnt, comp);
+    }
+
+    if (ucs_unlikely(UCS_STATUS_IS_ERR(status))) {
+        return status;
+    }
+
+    uct_tcp_ep_rma_sn_advance(iface, ep);
+
+    UCT_TL_EP_STAT_OP(&ep->super, PUT, ZCOPY, length);
+
+    return status;
+}
+
+static ucs_status_t
+uct_tcp_ep_rma_req_send(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                        uint8_t am_id, const void *req, unsigned req_length)
+{
+    uct_tcp_am_hdr_t *hdr = NULL;
+    ucs_status_t status;
+
+    status = uct_tcp_ep_am_prepare(iface, ep, am_id, &hdr);
+    if (ucs_unlikely(status != UCS_OK)) {
+        return status;
+    }
+
+    ucs_assertv(hdr != NULL, "ep=%p", ep);
+    hdr->length = req_length;
+    memcpy(hdr + 1, req, req_length);
+
+    status = uct_tcp_ep_am_send(iface, ep, hdr);
+    if (ucs_unlikely(status != UCS_OK)) {
+        uct_tcp_ep_ctx_reset(&ep->tx);
+        return status;
+    }
+
+    uct_tcp_ep_rma_sn_advance(iface, ep);
+    return UCS_OK;
+}
+
+ucs_status_t uct_tcp_ep_get_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
+                                  size_t iovcnt, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep                 = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface           = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    uct_tcp_ep_get_req_hdr_t get_req = {0};
+    uct_tcp_ep_rma_op_t *op;
+    ucs_status_t status;
+
+    UCT_CHECK_IOV_SIZE(iovcnt, 1ul, "get_zcopy");
+    UCT_CHECK_LENGTH(uct_iov_total_length(iov, iovcnt), 0,
+                     UCT_TCP_EP_GET_ZCOPY_MAX - UCT_TCP_EP_GET_SERVICE_LENGTH,
+                     "get_zcopy");
+
+    op = uct_tcp_ep_rma_op_get(iface, UCT_TCP_EP_GET_REP_AM_ID,
+                               ep->tx.put_sn + 1);
+    if (ucs_unlikely(op == NULL)) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    op->buffer     = iov[0].buffer;
+    op->length     = uct_iov_total_length(iov, iovcnt);
+    op->comp       = comp;
+    get_req.addr   = remote_addr;
+    get_req.length = op->length;
+    get_req.sn     = op->sn;
+
+    status = uct_tcp_ep_rma_req_send(iface, ep, UCT_TCP_EP_GET_REQ_AM_ID,
+                                     &get_req, sizeof(get_req));
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucs_mpool_put_inline(op);
+        return status;
+    }
+
+    ucs_queue_push(&ep->rma.wait_q, &op->elem);
+    UCT_TL_EP_STAT_OP(&ep->super, GET, ZCOPY, op->length);
+
+    return UCS_INPROGRESS;
+}
+
+static ucs_status_t
+uct_tcp_ep_atomic(uct_ep_h uct_ep, uint8_t opcode, uint8_t size,
+                  uint64_t value, uint64_t compare, uint64_t remote_addr,
+                  void *result, uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep                       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface                 = ucs_derived_of(uct_ep->iface,
+                                                            uct_tcp_iface_t);
+    uct_tcp_ep_atomic_req_hdr_t atomic_req = {0};
+    uct_tcp_ep_rma_op_t *op                = NULL;
+    ucs_status_t status;
+
+    atomic_req.addr    = remote_addr;
+    atomic_req.value   = value;
+    atomic_req.compare = compare;
+    atomic_req.sn      = ep->tx.put_sn + 1;
+    atomic_req.opcode  = opcode;
+    atomic_req.size    = size;
+    atomic_req.fetch   = (result != NULL);
+
+    if (atomic_req.fetch) {
+        op = uct_tcp_ep_rma_op_get(iface, UCT_TCP_EP_ATOMIC_REP_AM_ID,
+                                   atomic_req.sn);
+        if (ucs_unlikely(op == NULL)) {
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        op->size   = size;
+        op->buffer = result;
+        op->comp   = comp;
+    }
+
+    status = uct_tcp_ep_rma_req_send(iface, ep, UCT_TCP_EP_ATOMIC_REQ_AM_ID,
+                                     &atomic_req, sizeof(atomic_req));
+    if (ucs_unlikely(status != UCS_OK)) {
+        if (op != NULL) {
+            ucs_mpool_put_inline(op);
+        }
+        return status;
+    }
+
+    UCT_TL_EP_STAT_ATOMIC(&ep->super);
+
+    if (op == NULL) {
+        /* Non-fetching operations are completed by flush, as PUT operations */
+        return UCS_OK;
+    }
+
+    ucs_queue_push(&ep->rma.wait_q, &op->elem);
+    return UCS_INPROGRESS;
+}
+
+ucs_status_t uct_tcp_ep_atomic32_post(uct_ep_h uct_ep, unsigned opcode,
+                                      uint32_t value, uint64_t remote_addr,
+                                      uct_rkey_t rkey)
+{
+    return uct_tcp_ep_atomic(uct_ep, opcode, sizeof(uint32_t), value, 0,
+                             remote_addr, NULL, NULL);
+}
+
+ucs_status_t uct_tcp_ep_atomic64_post(uct_ep_h uct_ep, unsigned opcode,
+                                      uint64_t value, uint64_t remote_addr,
+                                      uct_rkey_t rkey)
+{
+    return uct_tcp_ep_atomic(uct_ep, opcode, sizeof(uint64_t), value, 0,
+                             remote_addr, NULL, NULL);
+}
+
+ucs_status_t uct_tcp_ep_atomic32_fetch(uct_ep_h uct_ep, uct_atomic_op_t opcode,
+                                       uint32_t value, uint32_t *result,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uct_completion_t *comp)
+{
+    return uct_tcp_ep_atomic(uct_ep, opcode, sizeof(uint32_t), value, 0,
+                             remote_addr, result, comp);
+}
+
+ucs_status_t uct_tcp_ep_atomic64_fetch(uct_ep_h uct_ep, uct_atomic_op_t opcode,
+                                       uint64_t value, uint64_t *result,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uct_completion_t *comp)
+{
+    return uct_tcp_ep_atomic(uct_ep, opcode, sizeof(uint64_t), value, 0,
+                             remote_addr, result, comp);
+}
+
+ucs_status_t uct_tcp_ep_atomic_cswap32(uct_ep_h uct_ep, uint32_t compare,
+                                       uint32_t swap, uint64_t remote_addr,
+                                       uct_rkey_t rkey, uint32_t *result,
+                                       uct_completion_t *comp)
+{
+    return uct_tcp_ep_atomic(uct_ep, UCT_ATOMIC_OP_CSWAP, sizeof(uint32_t),
+                             swap, compare, remote_addr, result, comp);
+}
+
+ucs_status_t uct_tcp_ep_atomic_cswap64(uct_ep_h uct_ep, uint64_t compare,
+                                       uint64_t swap, uint64_t remote_addr,
+                                       uct_rkey_t rkey, uint64_t *result,
+                                       uct_completion_t *comp)
+{
+    return uct_tcp_ep_atomic(uct_ep, UCT_ATOMIC_OP_CSWAP, sizeof(uint64_t),
+                             swap, compare, remote_addr, result, comp);
+}
+
 ucs_status_t uct_tcp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req,
                                     unsigned flags)
 {
@@ -1422,29 +2722,75 @@ ucs_status_t uct_tcp_ep_flush(uct_ep_h tl_ep, unsigned flags,
                               uct_completion_t *comp)
 {
     uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    uct_tcp_ep_msg_zcopy_completion_t *zcopy_comp[UCT_TCP_EP_MAX_STRIPES];
+    uct_tcp_ep_t *zcopy_ep[UCT_TCP_EP_MAX_STRIPES];
     uct_tcp_ep_put_completion_t *put_comp;
+    unsigned zcopy_count, i;
+    int put_wait;
 
     if (uct_tcp_ep_check_tx_res(ep) == UCS_ERR_NO_RESOURCE) {
         UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
         return UCS_ERR_NO_RESOURCE;
     }
 
-    if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK)) {
-        if (comp != NULL) {
-            put_comp = ucs_calloc(1, sizeof(*put_comp), "put completion");
-            if (put_comp == NULL) {
-                return UCS_ERR_NO_MEMORY;
-            }
+    /* MSG_ZEROCOPY sends may be pending on the EP and its stripes */
+    zcopy_count = 0;
+    if (uct_tcp_ep_msg_zcopy_pending(ep)) {
+        zcopy_ep[zcopy_count++] = ep;
+    }
 
-            put_comp->wait_put_sn = ep->tx.put_sn;
-            put_comp->comp        = comp;
-            ucs_queue_push(&ep->put_comp_q, &put_comp->elem);
+    for (i = 0; i < ep->stripe.tx_count; ++i) {
+        if (uct_tcp_ep_msg_zcopy_pending(ep->stripe.tx[i])) {
+            zcopy_ep[zcopy_count++] = ep->stripe.tx[i];
         }
+    }
 
+    put_wait = ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK);
+    if (!put_wait && (zcopy_count == 0)) {
+        UCT_TL_EP_STAT_FLUSH(&ep->super);
+        return UCS_OK;
+    }
+
+    if (comp == NULL) {
         return UCS_INPROGRESS;
     }
 
-    UCT_TL_EP_STAT_FLUSH(&ep->super);
-    return UCS_OK;
+    put_comp = NULL;
+    if (put_wait) {
+        put_comp = ucs_calloc(1, sizeof(*put_comp), "put completion");
+        if (put_comp == NULL) {
+            return UCS_ERR_NO_MEMORY;
+        }
+    }
+
+    for (i = 0; i < zcopy_count; ++i) {
+        zcopy_comp[i] = ucs_malloc(sizeof(*zcopy_comp[i]),
+                                   "msg_zcopy completion");
+        if (zcopy_comp[i] == NULL) {
+            goto err_free;
+        }
+    }
+
+    /* the completion is invoked from all queues */
+    comp->count += (put_wait ? 1 : 0) + zcopy_count - 1;
+
+    if (put_wait) {
+        put_comp->wait_put_sn = ep->tx.put_sn;
+        put_comp->comp        = comp;
+        ucs_queue_push(&ep->put_comp_q, &put_comp->elem);
+    }
+
+    for (i = 0; i < zcopy_count; ++i) {
+        uct_tcp_ep_msg_zcopy_push_comp(zcopy_ep[i], zcopy_comp[i], comp);
+    }
+
+    return UCS_INPROGRESS;
+
+err_free:
+    while (i-- > 0) {
+        ucs_free(zcopy_comp[i]);
+    }
+    ucs_free(put_comp);
+    return UCS_ERR_NO_MEMORY;
 }
 
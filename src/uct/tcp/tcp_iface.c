@@ -12,6 +12,7 @@
 
 #include <ucs/async/async.h>
 #include <ucs/sys/string.h>
+#include <ucs/sys/topo.h>
 #include <ucs/config/types.h>
 #include <sys/socket.h>
 #include <sys/poll.h>
@@ -41,6 +42,12 @@ static ucs_config_field_t uct_tcp_iface_config_table[] = {
    "Threshold for switching from send() to sendmsg() for short active messages",
    ucs_offsetof(uct_tcp_iface_config_t, sendv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"MSG_ZCOPY_THRESH", "inf",
+   "Minimal payload size of AM/PUT Zcopy operations which is sent by the kernel\n"
+   "without copying (MSG_ZEROCOPY). The operations complete when the kernel reports\n"
+   "that the user buffers are no longer used. \"inf\" disables zero-copy send.",
+   ucs_offsetof(uct_tcp_iface_config_t, msg_zcopy_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"PREFER_DEFAULT", "y",
    "Give higher priority to the default network interface on the host",
    ucs_offsetof(uct_tcp_iface_config_t, prefer_default), UCS_CONFIG_TYPE_BOOL},
@@ -59,6 +66,33 @@ static ucs_config_field_t uct_tcp_iface_config_table[] = {
    "connection was detected due to lack of system resources",
    ucs_offsetof(uct_tcp_iface_config_t, max_conn_retries), UCS_CONFIG_TYPE_UINT},
 
+  {"STRIPES", "1",
+   "Number of sockets which are used by an endpoint to send large PUT Zcopy\n"
+   "operations, including the endpoint's own socket. The payload is split evenly\n"
+   "between the sockets and the receiver completes the operation when all parts\n"
+   "arrive, keeping the order with other operations. 1 disables striping.",
+   ucs_offsetof(uct_tcp_iface_config_t, stripes), UCS_CONFIG_TYPE_UINT},
+
+  {"STRIPE_THRESH", "256kb",
+   "Minimal payload size of PUT Zcopy operations which is striped between the\n"
+   "sockets of an endpoint",
+   ucs_offsetof(uct_tcp_iface_config_t, stripe_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"EVENT_SET", "epoll",
+   "Mechanism which is used to wait for socket events:\n"
+   " epoll    - epoll_wait(), every change of the watched events is a system call.\n"
+   " io_uring - io_uring poll requests, changes of the watched events are\n"
+   "            submitted in batches. Falls back to epoll if not supported.",
+   ucs_offsetof(uct_tcp_iface_config_t, event_set),
+   UCS_CONFIG_TYPE_ENUM(ucs_event_set_backend_names)},
+
+  {"AF_PRIO", "inet,inet6",
+   "Priority of address families which are used to select the address of the\n"
+   "network interface. The first family the interface has an address of is used:\n"
+   " inet  - IPv4\n"
+   " inet6 - IPv6, link-local addresses are not used",
+   ucs_offsetof(uct_tcp_iface_config_t, af_prio), UCS_CONFIG_TYPE_STRING_ARRAY},
+
   {"NODELAY", "y",
    "Set TCP_NODELAY socket option to disable Nagle algorithm. Setting this\n"
    "option usually provides better performance",
@@ -87,17 +121,36 @@ static UCS_CLASS_DEFINE_DELETE_FUNC(uct_tcp_iface_t, uct_iface_t);
 static ucs_status_t uct_tcp_iface_get_device_address(uct_iface_h tl_iface,
                                                      uct_device_addr_t *addr)
 {
-    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    uct_tcp_iface_t *iface          = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    uct_tcp_device_addr_t *dev_addr = (uct_tcp_device_addr_t*)addr;
+    const struct sockaddr *saddr    = (const struct sockaddr*)
+                                      &iface->config.ifaddr;
+    ucs_status_t status;
+    size_t in_addr_size;
+
+    status = ucs_sockaddr_inet_addr_sizeof(saddr, &in_addr_size);
+    if (status != UCS_OK) {
+        return status;
+    }
 
-    *(struct in_addr*)addr = iface->config.ifaddr.sin_addr;
+    dev_addr->sa_family = saddr->sa_family;
+    memcpy(dev_addr + 1, ucs_sockaddr_get_inet_addr(saddr), in_addr_size);
     return UCS_OK;
 }
 
 static ucs_status_t uct_tcp_iface_get_address(uct_iface_h tl_iface, uct_iface_addr_t *addr)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    ucs_status_t status;
+    uint16_t port;
 
-    *(in_port_t*)addr = iface->config.ifaddr.sin_port;
+    status = ucs_sockaddr_get_port((const struct sockaddr*)&iface->config.ifaddr,
+                                   &port);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    *(in_port_t*)addr = htons(port);
     return UCS_OK;
 }
 
@@ -105,20 +158,32 @@ static int uct_tcp_iface_is_reachable(const uct_iface_h tl_iface,
                                       const uct_device_addr_t *dev_addr,
                                       const uct_iface_addr_t *iface_addr)
 {
-    /* We always report that a peer is reachable. connect() call will
-     * fail if the peer is unreachable when creating UCT/TCP EP */
-    return 1;
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+
+    /* The peer is reachable only by the same address family. Otherwise, we
+     * always report that a peer is reachable. connect() call will fail if
+     * the peer is unreachable when creating UCT/TCP EP */
+    return ((const uct_tcp_device_addr_t*)dev_addr)->sa_family ==
+           iface->config.ifaddr.ss_family;
 }
 
 static ucs_status_t uct_tcp_iface_query(uct_iface_h tl_iface, uct_iface_attr_t *attr)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
     size_t am_buf_size     = iface->config.tx_seg_size - sizeof(uct_tcp_am_hdr_t);
+    size_t in_addr_size;
     ucs_status_t status;
     int is_default;
 
     uct_base_iface_query(&iface->super, attr);
 
+    status = ucs_sockaddr_inet_addr_sizeof((const struct sockaddr*)
+                                           &iface->config.ifaddr,
+                                           &in_addr_size);
+    if (status != UCS_OK) {
+        return status;
+    }
+
     status = uct_tcp_netif_caps(iface->if_name, &attr->latency.overhead,
                                 &attr->bandwidth.shared);
     if (status != UCS_OK) {
@@ -126,7 +191,7 @@ static ucs_status_t uct_tcp_iface_query(uct_iface_h tl_iface, uct_iface_attr_t *
     }
 
     attr->iface_addr_len   = sizeof(in_port_t);
-    attr->device_addr_len  = sizeof(struct in_addr);
+    attr->device_addr_len  = sizeof(uct_tcp_device_addr_t) + in_addr_size;
     attr->cap.flags        = UCT_IFACE_FLAG_CONNECT_TO_IFACE |
                              UCT_IFACE_FLAG_AM_SHORT         |
                              UCT_IFACE_FLAG_AM_BCOPY         |
@@ -155,7 +220,30 @@ static ucs_status_t uct_tcp_iface_query(uct_iface_h tl_iface, uct_iface_attr_t *
                                          UCT_TCP_EP_PUT_SERVICE_LENGTH;
         attr->cap.put.opt_zcopy_align  = 1;
         attr->cap.flags               |= UCT_IFACE_FLAG_PUT_ZCOPY;
-    }
+
+        /* GET */
+        attr->cap.get.max_iov          = 1;
+        attr->cap.get.max_zcopy        = UCT_TCP_EP_GET_ZCOPY_MAX -
+                                         UCT_TCP_EP_GET_SERVICE_LENGTH;
+        attr->cap.get.opt_zcopy_align  = 1;
+        attr->cap.flags               |= UCT_IFACE_FLAG_GET_ZCOPY;
+    }
+
+    /* ATOMIC: the operations are executed by the peer's progress using CPU
+     * atomics, so they are atomic with respect to the peer's CPU accesses */
+    attr->cap.flags            |= UCT_IFACE_FLAG_ATOMIC_CPU;
+    attr->cap.atomic32.op_flags =
+    attr->cap.atomic64.op_flags = UCS_BIT(UCT_ATOMIC_OP_ADD) |
+                                  UCS_BIT(UCT_ATOMIC_OP_AND) |
+                                  UCS_BIT(UCT_ATOMIC_OP_OR)  |
+                                  UCS_BIT(UCT_ATOMIC_OP_XOR);
+    attr->cap.atomic32.fop_flags =
+    attr->cap.atomic64.fop_flags = UCS_BIT(UCT_ATOMIC_OP_ADD)  |
+                                   UCS_BIT(UCT_ATOMIC_OP_AND)  |
+                                   UCS_BIT(UCT_ATOMIC_OP_OR)   |
+                                   UCS_BIT(UCT_ATOMIC_OP_XOR)  |
+                                   UCS_BIT(UCT_ATOMIC_OP_SWAP) |
+                                   UCS_BIT(UCT_ATOMIC_OP_CSWAP);
 
     attr->bandwidth.dedicated = 0;
     attr->latency.growth      = 0;
@@ -188,8 +276,16 @@ static void uct_tcp_iface_handle_events(void *callback_data,
     unsigned *count  = (unsigned*)arg;
     uct_tcp_ep_t *ep = (uct_tcp_ep_t*)callback_data;
 
-    ucs_assertv(ep->conn_state != UCT_TCP_EP_CONN_STATE_CLOSED, "ep=%p", ep);
+    if (ucs_unlikely(ep->conn_state == UCT_TCP_EP_CONN_STATE_CLOSED)) {
+        /* The stripe connection was closed while handling the previous
+         * events of the same batch */
+        ucs_assertv(ep->stripe.type != UCT_TCP_EP_STRIPE_NONE, "ep=%p", ep);
+        return;
+    }
 
+    if (events & UCS_EVENT_SET_EVERR) {
+        *count += uct_tcp_ep_progress_msg_zcopy(ep);
+    }
     if (events & UCS_EVENT_SET_EVREAD) {
         *count += uct_tcp_ep_progress_rx(ep);
     }
@@ -251,7 +347,7 @@ static void uct_tcp_iface_listen_close(uct_tcp_iface_t *iface)
 static void uct_tcp_iface_connect_handler(int listen_fd, void *arg)
 {
     uct_tcp_iface_t *iface = arg;
-    struct sockaddr_in peer_addr;
+    struct sockaddr_storage peer_addr;
     socklen_t addrlen;
     ucs_status_t status;
     int fd;
@@ -316,6 +412,13 @@ static uct_iface_ops_t uct_tcp_iface_ops = {
     .ep_am_bcopy              = uct_tcp_ep_am_bcopy,
     .ep_am_zcopy              = uct_tcp_ep_am_zcopy,
     .ep_put_zcopy             = uct_tcp_ep_put_zcopy,
+    .ep_get_zcopy             = uct_tcp_ep_get_zcopy,
+    .ep_atomic_cswap64        = uct_tcp_ep_atomic_cswap64,
+    .ep_atomic_cswap32        = uct_tcp_ep_atomic_cswap32,
+    .ep_atomic64_post         = uct_tcp_ep_atomic64_post,
+    .ep_atomic32_post         = uct_tcp_ep_atomic32_post,
+    .ep_atomic64_fetch        = uct_tcp_ep_atomic64_fetch,
+    .ep_atomic32_fetch        = uct_tcp_ep_atomic32_fetch,
     .ep_pending_add           = uct_tcp_ep_pending_add,
     .ep_pending_purge         = uct_tcp_ep_pending_purge,
     .ep_flush                 = uct_tcp_ep_flush,
@@ -338,14 +441,23 @@ static uct_iface_ops_t uct_tcp_iface_ops = {
 
 static ucs_status_t uct_tcp_iface_listener_init(uct_tcp_iface_t *iface)
 {
-    struct sockaddr_in bind_addr = iface->config.ifaddr;
-    socklen_t addrlen            = sizeof(bind_addr);
-    int backlog                  = ucs_socket_max_conn();
+    struct sockaddr_storage bind_addr = iface->config.ifaddr;
+    socklen_t addrlen                 = sizeof(bind_addr);
+    int backlog                       = ucs_socket_max_conn();
+    char ip_port_str[UCS_SOCKADDR_STRING_LEN];
+    size_t bind_addr_size;
     ucs_status_t status;
+    uint16_t port;
     int ret;
 
+    status = ucs_sockaddr_sizeof((struct sockaddr*)&bind_addr, &bind_addr_size);
+    if (status != UCS_OK) {
+        return status;
+    }
+
     /* Create the server socket for accepting incoming connections */
-    status = ucs_socket_create(AF_INET, SOCK_STREAM, &iface->listen_fd);
+    status = ucs_socket_create(bind_addr.ss_family, SOCK_STREAM,
+                               &iface->listen_fd);
     if (status != UCS_OK) {
         return status;
     }
@@ -359,8 +471,9 @@ static ucs_status_t uct_tcp_iface_listener_init(uct_tcp_iface_t *iface)
     /* Loop until unused port found */
     do {
         /* Bind socket to random available port */
-        bind_addr.sin_port = 0;
-        ret = bind(iface->listen_fd, (struct sockaddr*)&bind_addr, sizeof(bind_addr));
+        ucs_sockaddr_set_port((struct sockaddr*)&bind_addr, 0);
+        ret = bind(iface->listen_fd, (struct sockaddr*)&bind_addr,
+                   bind_addr_size);
     } while ((ret < 0) && (errno == EADDRINUSE));
 
     if (ret < 0) {
@@ -376,7 +489,8 @@ static ucs_status_t uct_tcp_iface_listener_init(uct_tcp_iface_t *iface)
         status = UCS_ERR_IO_ERROR;
         goto err_close_sock;
     }
-    iface->config.ifaddr.sin_port = bind_addr.sin_port;
+    ucs_sockaddr_get_port((struct sockaddr*)&bind_addr, &port);
+    ucs_sockaddr_set_port((struct sockaddr*)&iface->config.ifaddr, port);
 
     /* Listen for connections */
     ret = listen(iface->listen_fd, backlog);
@@ -387,8 +501,9 @@ static ucs_status_t uct_tcp_iface_listener_init(uct_tcp_iface_t *iface)
         goto err_close_sock;
     }
 
-    ucs_debug("tcp_iface %p: listening for connections on %s:%d", iface,
-              inet_ntoa(bind_addr.sin_addr), ntohs(bind_addr.sin_port));
+    ucs_debug("tcp_iface %p: listening for connections on %s", iface,
+              ucs_sockaddr_str((struct sockaddr*)&bind_addr, ip_port_str,
+                               UCS_SOCKADDR_STRING_LEN));
 
     /* Register event handler for incoming connections */
     status = ucs_async_set_event_handler(iface->super.worker->async->mode,
@@ -408,6 +523,35 @@ err_close_sock:
     return status;
 }
 
+static ucs_status_t uct_tcp_iface_set_ifaddr(uct_tcp_iface_t *iface,
+                                             const ucs_config_names_array_t *af_prio)
+{
+    ucs_status_t status;
+    sa_family_t af;
+    unsigned i;
+
+    for (i = 0; i < af_prio->count; ++i) {
+        if (!strcmp(af_prio->names[i], "inet")) {
+            af = AF_INET;
+        } else if (!strcmp(af_prio->names[i], "inet6")) {
+            af = AF_INET6;
+        } else {
+            ucs_error("invalid address family: %s", af_prio->names[i]);
+            return UCS_ERR_INVALID_PARAM;
+        }
+
+        status = uct_tcp_netif_inaddr(iface->if_name, af, &iface->config.ifaddr,
+                                      &iface->config.netmask);
+        if (status != UCS_ERR_INVALID_ADDR) {
+            return status;
+        }
+    }
+
+    ucs_error("%s doesn't have an address of the requested address families",
+              iface->if_name);
+    return UCS_ERR_INVALID_ADDR;
+}
+
 static ucs_mpool_ops_t uct_tcp_mpool_ops = {
     ucs_mpool_chunk_malloc,
     ucs_mpool_chunk_free,
@@ -445,10 +589,14 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
     ucs_strncpy_zero(self->if_name, params->mode.device.dev_name,
                      sizeof(self->if_name));
     self->outstanding        = 0;
+    self->ep_id              = 0;
     self->config.tx_seg_size = config->tx_seg_size +
                                sizeof(uct_tcp_am_hdr_t);
     self->config.rx_seg_size = config->rx_seg_size +
                                sizeof(uct_tcp_am_hdr_t);
+    /* A partially received message is always followed by enough space to
+     * receive at least one more maximal message */
+    self->config.rx_buf_size = self->config.rx_seg_size * 2;
 
     if (ucs_iov_get_max() >= UCT_TCP_EP_AM_SHORTV_IOV_COUNT) {
         self->config.sendv_thresh = config->sendv_thresh;
@@ -457,6 +605,15 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
         self->config.sendv_thresh = UCS_MEMUNITS_INF;
     }
 
+#if UCT_TCP_HAVE_MSG_ZCOPY
+    self->config.msg_zcopy_thresh = config->msg_zcopy_thresh;
+#else
+    if (config->msg_zcopy_thresh != UCS_MEMUNITS_INF) {
+        ucs_debug("tcp_iface %p: MSG_ZEROCOPY is not supported", self);
+    }
+    self->config.msg_zcopy_thresh = UCS_MEMUNITS_INF;
+#endif
+
     /* Maximum IOV count allowed by user's configuration (considering TCP
      * protocol and user's AM headers that use 1st and 2nd IOVs
      * correspondingly) and system constraints */
@@ -482,12 +639,22 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
     self->config.conn_nb           = config->conn_nb;
     self->config.max_poll          = config->max_poll;
     self->config.max_conn_retries  = config->max_conn_retries;
+    self->config.stripe.count      = config->stripes;
+    self->config.stripe.thresh     = (config->stripes > 1) ?
+                                     config->stripe_thresh : UCS_MEMUNITS_INF;
     self->sockopt.nodelay          = config->sockopt_nodelay;
     self->sockopt.sndbuf           = config->sockopt_sndbuf;
     self->sockopt.rcvbuf           = config->sockopt_rcvbuf;
     ucs_list_head_init(&self->ep_list);
     kh_init_inplace(uct_tcp_cm_eps, &self->ep_cm_map);
 
+    if ((self->config.stripe.count == 0) ||
+        (self->config.stripe.count > UCT_TCP_EP_MAX_STRIPES)) {
+        ucs_error("number of stripes (%u) must be in range [1..%d]",
+                  self->config.stripe.count, UCT_TCP_EP_MAX_STRIPES);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
     if (self->config.tx_seg_size > self->config.rx_seg_size) {
         ucs_error("RX segment size (%zu) must be >= TX segment size (%zu)",
                   self->config.rx_seg_size, self->config.tx_seg_size);
@@ -504,7 +671,7 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
         goto err;
     }
 
-    status = ucs_mpool_init(&self->rx_mpool, 0, self->config.rx_seg_size * 2,
+    status = ucs_mpool_init(&self->rx_mpool, 0, self->config.rx_buf_size,
                             0, UCS_SYS_CACHE_LINE_SIZE,
                             (config->rx_mpool.bufs_grow == 0) ?
                             32 : config->rx_mpool.bufs_grow,
@@ -514,16 +681,23 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
         goto err_cleanup_tx_mpool;
     }
 
-    status = uct_tcp_netif_inaddr(self->if_name, &self->config.ifaddr,
-                                  &self->config.netmask);
+    status = ucs_mpool_init(&self->rma_mpool, 0, sizeof(uct_tcp_ep_rma_op_t),
+                            0, UCS_SYS_CACHE_LINE_SIZE, 32, UINT_MAX,
+                            &uct_tcp_mpool_ops, "uct_tcp_iface_rma_op_mp");
     if (status != UCS_OK) {
         goto err_cleanup_rx_mpool;
     }
 
-    status = ucs_event_set_create(&self->event_set);
+    status = uct_tcp_iface_set_ifaddr(self, &config->af_prio);
+    if (status != UCS_OK) {
+        goto err_cleanup_rma_mpool;
+    }
+
+    status = ucs_event_set_create_backend(&self->event_set,
+                                          config->event_set);
     if (status != UCS_OK) {
         status = UCS_ERR_IO_ERROR;
-        goto err_cleanup_rx_mpool;
+        goto err_cleanup_rma_mpool;
     }
 
     status = uct_tcp_iface_listener_init(self);
@@ -535,6 +709,8 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
 
 err_cleanup_event_set:
     ucs_event_set_cleanup(self->event_set);
+err_cleanup_rma_mpool:
+    ucs_mpool_cleanup(&self->rma_mpool, 1);
 err_cleanup_rx_mpool:
     ucs_mpool_cleanup(&self->rx_mpool, 1);
 err_cleanup_tx_mpool:
@@ -557,6 +733,15 @@ static void uct_tcp_iface_ep_list_cleanup(uct_tcp_iface_t *iface,
 static void uct_tcp_iface_eps_cleanup(uct_tcp_iface_t *iface)
 {
     ucs_list_link_t *ep_list;
+    uct_tcp_ep_t *ep, *tmp;
+
+    /* Stripes are destroyed first, since they are destroyed along with
+     * their parent EPs otherwise */
+    ucs_list_for_each_safe(ep, tmp, &iface->ep_list, list) {
+        if (ep->stripe.type != UCT_TCP_EP_STRIPE_NONE) {
+            uct_tcp_ep_destroy_internal(&ep->super.super);
+        }
+    }
 
     uct_tcp_iface_ep_list_cleanup(iface, &iface->ep_list);
 
@@ -603,6 +788,7 @@ static UCS_CLASS_CLEANUP_FUNC(uct_tcp_iface_t)
 
     uct_tcp_iface_eps_cleanup(self);
 
+    ucs_mpool_cleanup(&self->rma_mpool, 1);
     ucs_mpool_cleanup(&self->rx_mpool, 1);
     ucs_mpool_cleanup(&self->tx_mpool, 1);
 
@@ -621,6 +807,7 @@ ucs_status_t uct_tcp_query_devices(uct_md_h md,
 {
     uct_tl_device_resource_t *devices, *tmp;
     static const char *netdev_dir = "/sys/class/net";
+    char dev_path[PATH_MAX];
     struct dirent *entry;
     unsigned num_devices;
     ucs_status_t status;
@@ -675,6 +862,15 @@ ucs_status_t uct_tcp_query_devices(uct_md_h md,
                           sizeof(devices[num_devices].name),
                           "%s", entry->d_name);
         devices[num_devices].type = UCT_DEVICE_TYPE_NET;
+
+        /* Virtual interfaces, such as loopback, have no backing device */
+        ucs_snprintf_zero(dev_path, sizeof(dev_path), "class/net/%s",
+                          entry->d_name);
+        if (ucs_topo_find_device_by_sysfs_path(dev_path,
+                                               &devices[num_devices].sys_device)
+            != UCS_OK) {
+            devices[num_devices].sys_device = NULL;
+        }
         ++num_devices;
     }
 
@@ -19,6 +19,7 @@
 #include <net/if_arp.h>
 #include <net/if.h>
 #include <netdb.h>
+#include <ifaddrs.h>
 
 
 typedef ssize_t (*uct_tcp_io_func_t)(int fd, void *data, size_t size, int flags);
@@ -105,35 +106,57 @@ ucs_status_t uct_tcp_netif_caps(const char *if_name, double *latency_p,
     return UCS_OK;
 }
 
-ucs_status_t uct_tcp_netif_inaddr(const char *if_name, struct sockaddr_in *ifaddr,
-                                  struct sockaddr_in *netmask)
+ucs_status_t uct_tcp_netif_inaddr(const char *if_name, sa_family_t af,
+                                  struct sockaddr_storage *ifaddr,
+                                  struct sockaddr_storage *netmask)
 {
-    ucs_status_t status;
-    struct ifreq ifra, ifrnm;
+    ucs_status_t status = UCS_ERR_INVALID_ADDR;
+    struct ifaddrs *ifaddrs, *ifa;
+    size_t addr_size;
 
-    status = ucs_netif_ioctl(if_name, SIOCGIFADDR, &ifra);
-    if (status != UCS_OK) {
-        return status;
+    if (getifaddrs(&ifaddrs) < 0) {
+        ucs_error("getifaddrs() failed: %m");
+        return UCS_ERR_IO_ERROR;
     }
 
-    if (netmask != NULL) {
-        status = ucs_netif_ioctl(if_name, SIOCGIFNETMASK, &ifrnm);
+    for (ifa = ifaddrs; ifa != NULL; ifa = ifa->ifa_next) {
+        if ((ifa->ifa_addr == NULL) || (ifa->ifa_addr->sa_family != af) ||
+            strcmp(ifa->ifa_name, if_name)) {
+            continue;
+        }
+
+        /* Link-local IPv6 address can't be used to connect to the iface
+         * without the scope ID of the peer's network interface */
+        if ((af == AF_INET6) &&
+            IN6_IS_ADDR_LINKLOCAL(&UCS_SOCKET_INET6_ADDR(ifa->ifa_addr))) {
+            continue;
+        }
+
+        status = ucs_sockaddr_sizeof(ifa->ifa_addr, &addr_size);
         if (status != UCS_OK) {
-            return status;
+            break;
         }
-    }
 
-    if ((ifra.ifr_addr.sa_family != AF_INET) ) {
-        ucs_error("%s address is not INET", if_name);
-        return UCS_ERR_INVALID_ADDR;
+        memset(ifaddr, 0, sizeof(*ifaddr));
+        memcpy(ifaddr, ifa->ifa_addr, addr_size);
+
+        if (netmask != NULL) {
+            memset(netmask, 0, sizeof(*netmask));
+            if (ifa->ifa_netmask != NULL) {
+                memcpy(netmask, ifa->ifa_netmask, addr_size);
+            }
+        }
+        break;
     }
 
-    memcpy(ifaddr,  (struct sockaddr_in*)&ifra.ifr_addr,  sizeof(*ifaddr));
-    if (netmask != NULL) {
-        memcpy(netmask, (struct sockaddr_in*)&ifrnm.ifr_addr, sizeof(*netmask));
+    freeifaddrs(ifaddrs);
+
+    if (status == UCS_ERR_INVALID_ADDR) {
+        ucs_debug("%s doesn't have %s address", if_name,
+                  (af == AF_INET6) ? "IPv6" : "IPv4");
     }
 
-    return UCS_OK;
+    return status;
 }
 
 ucs_status_t uct_tcp_netif_is_default(const char *if_name, int *result_p)
@@ -121,6 +121,7 @@ protected:
     void do_send_process_data_test(int test_release, uint16_t am_id,
                                    int send_reply);
     void do_send_process_data_iov_test();
+    void do_send_process_many_long_test(size_t count, size_t size);
     void set_handlers(uint16_t am_id);
     void set_reply_handlers();
 };
@@ -245,6 +246,50 @@ void test_ucp_am::do_send_process_data_iov_test()
     }
 }
 
+void test_ucp_am::do_send_process_many_long_test(size_t count, size_t size)
+{
+    std::vector<std::vector<char> > bufs(count);
+    std::vector<ucs_status_ptr_t> sreqs;
+    ucs_time_t start_time;
+    double elapsed;
+
+    recv_ams = 0;
+    sent_ams = 0;
+    release  = 0;
+
+    set_handlers(UCP_SEND_ID);
+
+    /* Post all messages without waiting, so the receiver has many
+     * multi-fragment messages in reassembly at the same time */
+    start_time = ucs_get_time();
+    for (size_t i = 0; i < count; ++i) {
+        size_t length = size + i;
+        bufs[i].assign(length, (char)length);
+
+        ucs_status_ptr_t sstatus = ucp_am_send_nb(receiver().ep(), UCP_SEND_ID,
+                                                  bufs[i].data(), length,
+                                                  ucp_dt_make_contig(1),
+                                                  (ucp_send_callback_t)
+                                                  ucs_empty_function, 0);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(sstatus));
+        sreqs.push_back(sstatus);
+        sent_ams++;
+    }
+
+    while (sent_ams != recv_ams) {
+        progress();
+    }
+
+    elapsed = ucs_time_to_sec(ucs_get_time() - start_time);
+
+    for (size_t i = 0; i < sreqs.size(); ++i) {
+        wait(sreqs[i]);
+    }
+
+    UCS_TEST_MESSAGE << count << " messages of " << size << " bytes: "
+                     << (count / elapsed) << " msg/sec";
+}
+
 void test_ucp_am::do_set_am_handler_realloc_test()
 {
     set_handlers(UCP_SEND_ID);
@@ -277,9 +322,140 @@ UCS_TEST_P(test_ucp_am, send_process_iov_am)
     do_send_process_data_iov_test();
 }
 
+UCS_TEST_P(test_ucp_am, send_process_many_long_am)
+{
+    /* Cover both pooled and malloc'ed reassembly buffers */
+    do_send_process_many_long_test(256, 64 * UCS_KBYTE);
+    do_send_process_many_long_test(16, 2 * UCS_MBYTE);
+}
+
 UCS_TEST_P(test_ucp_am, set_am_handler_realloc)
 {
     do_set_am_handler_realloc_test();
 }
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_am)
+
+
+class test_ucp_am_rndv : public test_ucp_am {
+public:
+    virtual void init() {
+        modify_config("AM_RNDV_THRESH", "4096");
+        test_ucp_am::init();
+    }
+
+protected:
+    struct rndv_recv {
+        test_ucp_am_rndv  *test;
+        bool              drop;
+        int               rndv_ams;
+        std::vector<char> buffer;
+        void              *request;
+    };
+
+    static ucs_status_t rndv_am_cb(void *arg, void *data, size_t length,
+                                   ucp_ep_h reply_ep, unsigned flags)
+    {
+        rndv_recv *recv = reinterpret_cast<rndv_recv*>(arg);
+
+        recv->test->recv_ams++;
+        if (!(flags & UCP_CB_PARAM_FLAG_RNDV)) {
+            EXPECT_EQ(std::vector<char>(length, (char)length),
+                      std::vector<char>((char*)data, (char*)data + length));
+            return UCS_OK;
+        }
+
+        recv->rndv_ams++;
+        if (recv->drop) {
+            return UCS_OK;
+        }
+
+        recv->buffer.assign(length, 'r');
+        recv->request = ucp_am_rndv_recv_nb(recv->test->receiver().worker(),
+                                            data, recv->buffer.data(), length,
+                                            ucp_dt_make_contig(1),
+                                            rndv_recv_cb);
+        EXPECT_FALSE(UCS_PTR_IS_ERR(recv->request));
+        return UCS_INPROGRESS;
+    }
+
+    static void rndv_recv_cb(void *request, ucs_status_t status, size_t length)
+    {
+        EXPECT_UCS_OK(status);
+    }
+
+    void do_send_rndv_user_buffer_test(bool drop);
+};
+
+void test_ucp_am_rndv::do_send_rndv_user_buffer_test(bool drop)
+{
+    rndv_recv recv;
+
+    recv.test     = this;
+    recv.drop     = drop;
+    recv.rndv_ams = 0;
+
+    ucp_worker_set_am_handler(receiver().worker(), UCP_SEND_ID, rndv_am_cb,
+                              &recv, UCP_AM_FLAG_WHOLE_MSG | UCP_AM_FLAG_RNDV);
+
+    for (size_t length = 1; length <= UCS_MBYTE; length *= 4) {
+        std::vector<char> buf(length, (char)length);
+
+        recv_ams     = 0;
+        recv.request = NULL;
+
+        ucs_status_ptr_t sreq = ucp_am_send_nb(sender().ep(), UCP_SEND_ID,
+                                               buf.data(), length,
+                                               ucp_dt_make_contig(1),
+                                               (ucp_send_callback_t)
+                                               ucs_empty_function, 0);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+
+        while (recv_ams == 0) {
+            progress();
+        }
+
+        if (recv.request != NULL) {
+            wait(recv.request);
+            EXPECT_EQ(buf, recv.buffer);
+        }
+
+        wait(sreq);
+    }
+
+    /* Messages from 16k to 1m are above the rendezvous threshold, and
+     * larger than AM short of all transports */
+    EXPECT_GE(recv.rndv_ams, 4);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, send_process_am)
+{
+    set_handlers(UCP_SEND_ID);
+    do_send_process_data_test(0, UCP_SEND_ID, 0);
+
+    set_reply_handlers();
+    do_send_process_data_test(0, UCP_SEND_ID, UCP_AM_SEND_REPLY);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, send_process_am_release)
+{
+    set_handlers(UCP_SEND_ID);
+    do_send_process_data_test(UCP_RELEASE, 0, 0);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, send_process_many_long_am)
+{
+    do_send_process_many_long_test(16, 2 * UCS_MBYTE);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, recv_user_buffer)
+{
+    do_send_rndv_user_buffer_test(false);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, recv_drop)
+{
+    do_send_rndv_user_buffer_test(true);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am_rndv)
@@ -6,6 +6,7 @@
 
 #include "ucp_test.h"
 extern "C" {
+#include <ucp/core/ucp_worker.h>
 #include <ucs/sys/sys.h>
 }
 
@@ -108,3 +109,96 @@ UCS_TEST_P(test_ucp_version, version_string) {
 }
 
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_version, all, "all")
+
+
+class test_ucp_calib : public test_ucp_context {
+protected:
+    virtual void init() {
+        char tmpl[] = "/tmp/ucx_test_calib_XXXXXX";
+        ASSERT_TRUE(mkdtemp(tmpl) != NULL);
+        m_dir = tmpl;
+
+        modify_config("CALIBRATE", "refresh");
+        modify_config("CALIBRATE_DIR", m_dir);
+        test_ucp_context::init();
+    }
+
+    virtual void cleanup() {
+        test_ucp_context::cleanup();
+        std::string cmd = "rm -rf " + m_dir;
+        EXPECT_EQ(0, system(cmd.c_str()));
+    }
+
+    /* Checks that the worker interfaces use the calibrated performance, and
+     * returns how many of them have the given source */
+    unsigned check_worker(const entity &e, ucp_calib_source_t source) {
+        ucp_context_h context = e.ucph();
+        ucp_worker_h worker   = e.worker();
+        unsigned count        = 0;
+
+        for (unsigned i = 0; i < worker->num_ifaces; ++i) {
+            ucp_worker_iface_t *wiface   = worker->ifaces[i];
+            ucp_tl_resource_desc_t *rsc  = &context->tl_rscs[wiface->rsc_index];
+            const ucp_calib_result_t &calib = rsc->calib;
+
+            EXPECT_NE(UCP_CALIB_SOURCE_NONE, calib.source);
+            if ((calib.source == UCP_CALIB_SOURCE_MEASURED) ||
+                (calib.source == UCP_CALIB_SOURCE_CACHED)) {
+                EXPECT_GT(calib.bandwidth, 0) << rsc->tl_rsc.tl_name;
+                EXPECT_GE(calib.latency, 0)   << rsc->tl_rsc.tl_name;
+                EXPECT_DOUBLE_EQ(calib.overhead, wiface->attr.overhead)
+                                              << rsc->tl_rsc.tl_name;
+            }
+            if (calib.source == source) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    std::string m_dir;
+};
+
+UCS_TEST_P(test_ucp_calib, measure) {
+    EXPECT_GT(check_worker(sender(), UCP_CALIB_SOURCE_MEASURED), 0u);
+
+    /* Another worker on the same context reuses the results */
+    ucp_worker_params_t params;
+    params.field_mask = 0;
+
+    ucs::handle<ucp_worker_h> worker;
+    UCS_TEST_CREATE_HANDLE(ucp_worker_h, worker, ucp_worker_destroy,
+                           ucp_worker_create, sender().ucph(), &params);
+
+    ASSERT_EQ(sender().worker()->num_ifaces, worker.get()->num_ifaces);
+    for (unsigned i = 0; i < worker.get()->num_ifaces; ++i) {
+        EXPECT_DOUBLE_EQ(sender().worker()->ifaces[i]->attr.overhead,
+                         worker.get()->ifaces[i]->attr.overhead);
+    }
+}
+
+UCS_TEST_P(test_ucp_calib, cached) {
+    unsigned num_measured = check_worker(sender(), UCP_CALIB_SOURCE_MEASURED);
+
+    /* A new context loads the results from the cache file */
+    modify_config("CALIBRATE", "on");
+    entity *e = create_entity();
+    EXPECT_EQ(num_measured, check_worker(*e, UCP_CALIB_SOURCE_CACHED));
+    EXPECT_EQ(0u, check_worker(*e, UCP_CALIB_SOURCE_MEASURED));
+}
+
+UCS_TEST_P(test_ucp_calib, corrupted_cache) {
+    /* Overwrite the cache with garbage, the results are measured again */
+    std::string cmd = "for f in " + m_dir + "/ucx_calib_*; do "
+                      "echo garbage > $f; done";
+    ASSERT_EQ(0, system(cmd.c_str()));
+
+    modify_config("CALIBRATE", "on");
+    entity *e = create_entity();
+    EXPECT_EQ(0u, check_worker(*e, UCP_CALIB_SOURCE_CACHED));
+    EXPECT_GT(check_worker(*e, UCP_CALIB_SOURCE_MEASURED), 0u);
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_calib, self, "self")
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_calib, shm,  "shm")
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_calib, tcp,  "tcp")
@@ -46,3 +46,200 @@ UCS_TEST_F(test_ucp_dt_iov, seek)
         }
     }
 }
+
+class test_ucp_dt_strided : public ucs::test {
+protected:
+    struct layout {
+        size_t                       blocklen;
+        std::vector<ucp_dt_stride_t> dims;
+
+        size_t elem_length() const {
+            size_t length = blocklen;
+            for (size_t i = 0; i < dims.size(); ++i) {
+                length *= dims[i].count;
+            }
+            return length;
+        }
+
+        size_t extent() const {
+            return dims.back().count * dims.back().stride;
+        }
+    };
+
+    static layout random_layout() {
+        layout l;
+        size_t span;
+
+        l.blocklen = (ucs::rand() % 64) + 1;
+        span       = l.blocklen;
+        l.dims.resize((ucs::rand() % UCP_DT_STRIDED_MAX_DIMS) + 1);
+        for (size_t i = 0; i < l.dims.size(); ++i) {
+            l.dims[i].count  = (ucs::rand() % 5) + 1;
+            /* sometimes contiguous, to exercise dimensions merging */
+            l.dims[i].stride = span + ((ucs::rand() % 2) ? 0 : (ucs::rand() % 16));
+            span             = (l.dims[i].count - 1) * l.dims[i].stride + span;
+        }
+        return l;
+    }
+
+    /* offsets of all blocks, in the packed order */
+    static void block_offsets(const layout &l, size_t count,
+                              std::vector<size_t> &offsets) {
+        for (size_t elem = 0; elem < count; ++elem) {
+            add_block_offsets(l, l.dims.size(), elem * l.extent(), offsets);
+        }
+    }
+
+    static void add_block_offsets(const layout &l, size_t dim, size_t base,
+                                  std::vector<size_t> &offsets) {
+        if (dim == 0) {
+            offsets.push_back(base);
+            return;
+        }
+
+        for (size_t i = 0; i < l.dims[dim - 1].count; ++i) {
+            add_block_offsets(l, dim - 1, base + i * l.dims[dim - 1].stride,
+                              offsets);
+        }
+    }
+
+    static void ref_pack(const layout &l, size_t count,
+                         const std::vector<char> &buffer,
+                         std::vector<char> &packed) {
+        std::vector<size_t> offsets;
+
+        block_offsets(l, count, offsets);
+        packed.clear();
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            packed.insert(packed.end(), buffer.begin() + offsets[i],
+                          buffer.begin() + offsets[i] + l.blocklen);
+        }
+    }
+
+    static ucp_datatype_t create(const layout &l) {
+        ucp_datatype_t datatype;
+        ucs_status_t status;
+
+        status = ucp_dt_create_strided(l.blocklen, &l.dims[0], l.dims.size(),
+                                       &datatype);
+        EXPECT_UCS_OK(status);
+        return datatype;
+    }
+};
+
+UCS_TEST_F(test_ucp_dt_strided, pack_unpack)
+{
+    for (int iter = 0; iter < 100; ++iter) {
+        layout l             = random_layout();
+        size_t count         = (ucs::rand() % 4) + 1;
+        ucp_datatype_t dt    = create(l);
+        ucp_dt_strided_t *sd = ucp_dt_strided(dt);
+        size_t length        = count * l.elem_length();
+
+        ASSERT_EQ(length, ucp_dt_strided_length(dt, count));
+        ASSERT_LE(ucp_dt_strided_span(sd, length), count * l.extent());
+
+        std::vector<char> buffer(count * l.extent()), expected;
+        ucs::fill_random(buffer);
+        ref_pack(l, count, buffer, expected);
+        ASSERT_EQ(length, expected.size());
+
+        /* pack and unpack in random fragments */
+        std::vector<char> packed(length), unpacked(buffer.size(), 0);
+        size_t offset = 0;
+        while (offset < length) {
+            size_t frag = ucs_min((size_t)(ucs::rand() % 300) + 1,
+                                  length - offset);
+            EXPECT_EQ(frag, ucp_dt_strided_pack(sd, &packed[offset],
+                                                &buffer[0], offset, frag));
+            EXPECT_EQ(frag, ucp_dt_strided_unpack(sd, &unpacked[0],
+                                                  &packed[offset], offset,
+                                                  frag));
+            offset += frag;
+        }
+
+        EXPECT_TRUE(packed == expected) << "blocklen " << l.blocklen
+                                        << " dims " << l.dims.size();
+
+        std::vector<char> repacked;
+        ref_pack(l, count, unpacked, repacked);
+        EXPECT_TRUE(repacked == expected);
+
+        ucp_dt_destroy(dt);
+    }
+}
+
+UCS_TEST_F(test_ucp_dt_strided, uct_iov)
+{
+    const size_t max_iov = 16;
+    uct_iov_t iov[max_iov];
+
+    for (int iter = 0; iter < 100; ++iter) {
+        layout l             = random_layout();
+        size_t count         = (ucs::rand() % 4) + 1;
+        ucp_datatype_t dt    = create(l);
+        ucp_dt_strided_t *sd = ucp_dt_strided(dt);
+        size_t length        = count * l.elem_length();
+
+        std::vector<char> buffer(count * l.extent()), expected, packed;
+        ucs::fill_random(buffer);
+        ref_pack(l, count, buffer, expected);
+
+        size_t offset = 0;
+        while (offset < length) {
+            size_t frag = ucs_min((size_t)(ucs::rand() % 500) + 1,
+                                  length - offset);
+            size_t iov_length;
+            size_t iovcnt = ucp_dt_strided_to_uct_iov(sd, &buffer[0], offset,
+                                                      frag, NULL, iov, max_iov,
+                                                      &iov_length);
+            ASSERT_GT(iovcnt, 0u);
+            ASSERT_LE(iov_length, frag);
+            size_t expected_iovcnt = ucs_min(max_iov,
+                                             ucp_dt_strided_iov_count(sd, offset,
+                                                                      frag));
+            EXPECT_EQ(expected_iovcnt, iovcnt);
+            if (iovcnt < max_iov) {
+                EXPECT_EQ(frag, iov_length);
+            }
+
+            for (size_t i = 0; i < iovcnt; ++i) {
+                EXPECT_EQ(1u, iov[i].count);
+                packed.insert(packed.end(), (char*)iov[i].buffer,
+                              (char*)iov[i].buffer + iov[i].length);
+            }
+            offset += iov_length;
+        }
+
+        EXPECT_TRUE(packed == expected);
+        ucp_dt_destroy(dt);
+    }
+}
+
+UCS_TEST_F(test_ucp_dt_strided, merge_contig_dims)
+{
+    /* 4 contiguous blocks of 8 bytes, repeated with a stride of 64 */
+    ucp_dt_stride_t dims[] = {{4, 8}, {3, 64}};
+    ucp_datatype_t dt;
+
+    ASSERT_UCS_OK(ucp_dt_create_strided(8, dims, 2, &dt));
+    EXPECT_EQ(32u, ucp_dt_strided(dt)->blocklen);
+    EXPECT_EQ(96u, ucp_dt_strided_length(dt, 1));
+    EXPECT_EQ(3u, ucp_dt_strided_iov_count(ucp_dt_strided(dt), 0, 96));
+    ucp_dt_destroy(dt);
+}
+
+UCS_TEST_F(test_ucp_dt_strided, invalid)
+{
+    ucp_dt_stride_t overlap[] = {{4, 4}};
+    ucp_dt_stride_t zero[]    = {{0, 16}};
+    ucp_datatype_t dt;
+
+    scoped_log_handler wrap_err(wrap_errors_logger);
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, ucp_dt_create_strided(8, overlap, 1, &dt));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, ucp_dt_create_strided(8, zero, 1, &dt));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, ucp_dt_create_strided(0, zero, 1, &dt));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              ucp_dt_create_strided(8, overlap, UCP_DT_STRIDED_MAX_DIMS + 1,
+                                    &dt));
+}
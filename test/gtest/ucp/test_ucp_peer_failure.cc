@@ -385,14 +385,12 @@ UCS_TEST_P(test_ucp_peer_failure, basic) {
             false /* must_fail */);
 }
 
-UCS_TEST_P(test_ucp_peer_failure, rndv_disable) {
+UCS_TEST_P(test_ucp_peer_failure, rndv_enable) {
     const size_t size_max = std::numeric_limits<size_t>::max();
 
     sender().connect(&receiver(), get_ep_params(), STABLE_EP_INDEX);
-    EXPECT_EQ(size_max, ucp_ep_config(sender().ep())->tag.rndv.am_thresh);
-    EXPECT_EQ(size_max, ucp_ep_config(sender().ep())->tag.rndv.rma_thresh);
-    EXPECT_EQ(size_max, ucp_ep_config(sender().ep())->tag.rndv_send_nbr.am_thresh);
-    EXPECT_EQ(size_max, ucp_ep_config(sender().ep())->tag.rndv_send_nbr.rma_thresh);
+    EXPECT_NE(size_max, ucp_ep_config(sender().ep())->tag.rndv.am_thresh);
+    EXPECT_NE(size_max, ucp_ep_config(sender().ep())->tag.rndv_send_nbr.am_thresh);
 }
 
 UCS_TEST_P(test_ucp_peer_failure, zcopy, "ZCOPY_THRESH=1023") {
@@ -416,6 +414,34 @@ UCS_TEST_P(test_ucp_peer_failure, force_close, "RC_FC_ENABLE?=n") {
             false /* must_fail */);
 }
 
+UCS_TEST_SKIP_COND_P(test_ucp_peer_failure, rndv,
+                     !(GetParam().variant & TEST_TAG), "RNDV_THRESH=1024") {
+    do_test(16000, /* msg_size */
+            0, /* pre_msg_cnt */
+            false, /* force_close */
+            true /* must_fail */);
+}
+
+UCS_TEST_SKIP_COND_P(test_ucp_peer_failure, rndv_put,
+                     !(GetParam().variant & TEST_TAG), "RNDV_THRESH=1024",
+                     "RNDV_SCHEME=put_zcopy") {
+    do_test(16000, /* msg_size */
+            0, /* pre_msg_cnt */
+            false, /* force_close */
+            true /* must_fail */);
+}
+
+UCS_TEST_SKIP_COND_P(test_ucp_peer_failure, rndv_force_close,
+                     !(GetParam().variant & TEST_TAG), "RNDV_THRESH=1024",
+                     "RC_FC_ENABLE?=n") {
+    /* rendezvous sends which wait for a reply from the failed peer must be
+     * completed by the error flow */
+    do_test(16000, /* msg_size */
+            100, /* pre_msg_cnt */
+            true, /* force_close */
+            false /* must_fail */);
+}
+
 UCS_TEST_SKIP_COND_P(test_ucp_peer_failure, disable_sync_send,
                      !(GetParam().variant & TEST_TAG)) {
     const size_t        max_size = UCS_MBYTE;
@@ -377,6 +377,36 @@ UCS_TEST_P(test_ucp_tag_match, send_recv_nb_exp) {
     request_release(my_recv_req);
 }
 
+UCS_TEST_P(test_ucp_tag_match, recv_exp_mask_order) {
+    /* Full, partial and zero masks, more partial masks than mask classes */
+    static const ucp_tag_t masks[] = { 0xffffffffffffffffUL, 0xffff, 0xff,
+                                       0xfff, 0xf, 0x1f, 0x3f, 0x7f, 0 };
+    static const size_t num_masks  = sizeof(masks) / sizeof(masks[0]);
+    const unsigned num_requests    = 4 * num_masks;
+    std::vector<uint64_t> recv_data(num_requests, 0);
+    std::vector<request*> recv_reqs;
+
+    for (unsigned i = 0; i < num_requests; ++i) {
+        request *rreq = recv_nb(&recv_data[i], sizeof(recv_data[i]), DATATYPE,
+                                0x1337, masks[i % num_masks]);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(rreq));
+        ASSERT_TRUE(rreq != NULL);
+        recv_reqs.push_back(rreq);
+    }
+
+    /* every message should match the earliest posted receive */
+    for (uint64_t i = 0; i < num_requests; ++i) {
+        send_b(&i, sizeof(i), DATATYPE, 0x1337);
+    }
+
+    for (unsigned i = 0; i < num_requests; ++i) {
+        wait(recv_reqs[i]);
+        EXPECT_EQ(UCS_OK, recv_reqs[i]->status);
+        EXPECT_EQ(i, recv_data[i]) << "mask " << std::hex << masks[i % num_masks];
+        request_release(recv_reqs[i]);
+    }
+}
+
 UCS_TEST_P(test_ucp_tag_match, send_nb_multiple_recv_unexp) {
     const unsigned      num_requests = 1000;
     ucp_tag_recv_info_t info;
@@ -17,15 +17,22 @@ public:
     }
 
 protected:
-    static const size_t    COUNT    = 8192;
-    static const ucp_tag_t TAG_MASK = 0xffffffffffffffffUL;
-
-    double check_perf(size_t count, bool is_exp);
-    void check_scalability(double max_growth, bool is_exp);
-    void do_sends(size_t count);
+    static const size_t    COUNT      = 8192;
+    static const size_t    COUNT_DEEP = 65536;
+    static const ucp_tag_t TAG_MASK   = 0xffffffffffffffffUL;
+    /* Receive from any sender, the sender is in the low bits of the tag */
+    static const ucp_tag_t SRC_BITS   = 16;
+    static const ucp_tag_t SRC_MASK   = ~UCS_MASK(SRC_BITS);
+
+    double check_perf(size_t count, bool is_exp, ucp_tag_t tag_mask);
+    void check_scalability(double max_growth, bool is_exp,
+                           ucp_tag_t tag_mask = TAG_MASK,
+                           size_t max_count = COUNT);
+    void do_sends(size_t count, ucp_tag_t tag_mask);
 };
 
-double test_ucp_tag_perf::check_perf(size_t count, bool is_exp)
+double test_ucp_tag_perf::check_perf(size_t count, bool is_exp,
+                                     ucp_tag_t tag_mask)
 {
     ucs_time_t start_time;
 
@@ -33,14 +40,15 @@ double test_ucp_tag_perf::check_perf(size_t count, bool is_exp)
         std::vector<request*> rreqs;
 
         for (size_t i = 0; i < count; ++i) {
-            request *rreq = recv_nb(NULL, 0, DATATYPE, i, TAG_MASK);
+            request *rreq = recv_nb(NULL, 0, DATATYPE, i << SRC_BITS,
+                                    tag_mask);
             assert(!UCS_PTR_IS_ERR(rreq));
             EXPECT_FALSE(rreq->completed);
             rreqs.push_back(rreq);
         }
 
         start_time = ucs_get_time();
-        do_sends(count);
+        do_sends(count, tag_mask);
         while (!rreqs.empty()) {
             request *rreq = rreqs.back();
             rreqs.pop_back();
@@ -50,28 +58,32 @@ double test_ucp_tag_perf::check_perf(size_t count, bool is_exp)
         ucp_tag_recv_info_t info;
 
         send_b(NULL, 0, DATATYPE, 0xdeadbeef);
-        do_sends(count);
+        do_sends(count, tag_mask);
         recv_b(NULL, 0, DATATYPE, 0xdeadbeef, TAG_MASK, &info);
 
         start_time = ucs_get_time();
         for (size_t i = 0; i < count; ++i) {
-            recv_b(NULL, 0, DATATYPE, i, TAG_MASK, &info);
+            recv_b(NULL, 0, DATATYPE, i << SRC_BITS, tag_mask, &info);
         }
     }
 
     return ucs_time_to_sec(ucs_get_time() - start_time) / count;
 }
 
-void test_ucp_tag_perf::do_sends(size_t count)
+void test_ucp_tag_perf::do_sends(size_t count, ucp_tag_t tag_mask)
 {
-    size_t i = count;
+    /* the masked-out bits of the tag are set by the sender */
+    ucp_tag_t src = 0x5a5a & ~tag_mask;
+    size_t i      = count;
+
     while (i > 0) {
         --i;
-        send_b(NULL, 0, DATATYPE, i);
+        send_b(NULL, 0, DATATYPE, (i << SRC_BITS) | src);
     }
 }
 
-void test_ucp_tag_perf::check_scalability(double max_growth, bool is_exp)
+void test_ucp_tag_perf::check_scalability(double max_growth, bool is_exp,
+                                          ucp_tag_t tag_mask, size_t max_count)
 {
     double prev_time = 0.0, total_growth = 0.0, avg_growth;
     size_t n = 0;
@@ -82,11 +94,11 @@ void test_ucp_tag_perf::check_scalability(double max_growth, bool is_exp)
          * length grows by 2x. A result close to 1.0 means O(1) scalability (which
          * is good), while a result of 2.0 or higher means O(n) or higher.
          */
-        for (size_t count = 1; count <= COUNT; count *= 2) {
+        for (size_t count = 1; count <= max_count; count *= 2) {
             size_t iters = 10 * ucs_max(1ul, COUNT / count);
             double total_time = 0;
             for (size_t i = 0; i < iters; ++i) {
-                total_time += check_perf(count, is_exp);
+                total_time += check_perf(count, is_exp, tag_mask);
             }
 
             double time = total_time / iters;
@@ -122,4 +134,20 @@ UCS_TEST_P(test_ucp_tag_perf, multi_unexp) {
     check_scalability(1.5, false);
 }
 
+UCS_TEST_P(test_ucp_tag_perf, multi_exp_deep) {
+    check_scalability(1.5, true, TAG_MASK, COUNT_DEEP);
+}
+
+UCS_TEST_P(test_ucp_tag_perf, multi_unexp_deep) {
+    check_scalability(1.5, false, TAG_MASK, COUNT_DEEP);
+}
+
+UCS_TEST_P(test_ucp_tag_perf, multi_exp_any_source) {
+    check_scalability(1.5, true, SRC_MASK);
+}
+
+UCS_TEST_P(test_ucp_tag_perf, multi_exp_any_source_deep) {
+    check_scalability(1.5, true, SRC_MASK, COUNT_DEEP);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_perf)
@@ -1276,3 +1276,111 @@ UCS_TEST_SKIP_COND_P(test_ucp_wireup_asymmetric, connect, is_self()) {
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_wireup_asymmetric, rcv, "rc_v")
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_wireup_asymmetric, rcx, "rc_x")
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_wireup_asymmetric, ib, "ib")
+
+class test_ucp_ep_config : public ucp_test {
+public:
+    static ucp_params_t get_ctx_params() {
+        ucp_params_t params = ucp_test::get_ctx_params();
+        params.features |= UCP_FEATURE_TAG;
+        return params;
+    }
+
+protected:
+    /* Configuration key without lanes, which is different for every index */
+    static void make_key(unsigned index, ucp_rsc_index_t *cmpts,
+                         ucp_ep_config_key_t *key) {
+        ucp_ep_config_key_reset(key);
+        cmpts[0]              = index & UCS_MASK(8);
+        cmpts[1]              = index >> 8;
+        key->reachable_md_map = UCS_MASK(2);
+        key->dst_md_cmpts     = cmpts;
+    }
+
+    ucp_ep_cfg_index_t get_config(ucp_worker_h worker, unsigned index) {
+        ucp_rsc_index_t cmpts[2];
+        ucp_ep_config_key_t key;
+        ucp_ep_cfg_index_t cfg_index;
+
+        make_key(index, cmpts, &key);
+        ASSERT_UCS_OK(ucp_worker_get_ep_config(worker, &key, 0, &cfg_index));
+        return cfg_index;
+    }
+};
+
+UCS_TEST_P(test_ucp_ep_config, many_configs) {
+    /* More than the number of configurations which fit in the first chunk,
+     * and more than the previous fixed limit of 255 */
+    const unsigned num_configs = 4096;
+    ucp_worker_h worker        = sender().worker();
+    unsigned initial_count     = worker->ep_config_count;
+    std::vector<ucp_ep_cfg_index_t> cfg_indices;
+    ucp_ep_config_t *first_config;
+    ucs_time_t start_time;
+    unsigned i;
+
+    for (i = 0; i < num_configs; ++i) {
+        cfg_indices.push_back(get_config(worker, i));
+        if (i == 0) {
+            first_config = ucp_worker_ep_config(worker, cfg_indices[0]);
+        }
+    }
+
+    EXPECT_EQ(initial_count + num_configs, worker->ep_config_count);
+
+    /* existing configurations do not move when the array grows */
+    EXPECT_EQ(first_config, ucp_worker_ep_config(worker, cfg_indices[0]));
+
+    start_time = ucs_get_time();
+    for (i = 0; i < num_configs; ++i) {
+        ASSERT_EQ(cfg_indices[i], get_config(worker, i));
+    }
+
+    UCS_TEST_MESSAGE << num_configs << " configurations: "
+                     << (ucs_time_to_nsec(ucs_get_time() - start_time) /
+                         num_configs)
+                     << " nsec per lookup";
+
+    for (i = 0; i < num_configs; ++i) {
+        ucp_ep_config_t *config = ucp_worker_ep_config(worker, cfg_indices[i]);
+        EXPECT_EQ(i & UCS_MASK(8), config->key.dst_md_cmpts[0]);
+        EXPECT_EQ(i >> 8, config->key.dst_md_cmpts[1]);
+    }
+}
+
+UCS_TEST_P(test_ucp_ep_config, ep_create_rate) {
+    const unsigned num_eps = 1000 / ucs::test_time_multiplier();
+    std::vector<ucp_ep_h> eps;
+    ucp_address_t *address;
+    size_t address_length;
+    ucp_ep_params_t ep_params;
+    ucs_time_t start_time;
+    double elapsed;
+
+    ASSERT_UCS_OK(ucp_worker_get_address(receiver().worker(), &address,
+                                         &address_length));
+
+    ep_params.field_mask = UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
+    ep_params.address    = address;
+
+    start_time = ucs_get_time();
+    for (unsigned i = 0; i < num_eps; ++i) {
+        ucp_ep_h ep;
+        ASSERT_UCS_OK(ucp_ep_create(sender().worker(), &ep_params, &ep));
+        eps.push_back(ep);
+    }
+    elapsed = ucs_time_to_sec(ucs_get_time() - start_time);
+
+    UCS_TEST_MESSAGE << num_eps << " endpoints: "
+                     << (num_eps / elapsed) << " endpoints/sec";
+
+    ucp_worker_release_address(receiver().worker(), address);
+
+    for (std::vector<ucp_ep_h>::iterator it = eps.begin(); it != eps.end();
+         ++it) {
+        wait(ucp_ep_close_nb(*it, UCP_EP_CLOSE_MODE_FLUSH));
+    }
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_ep_config, self, "self")
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_ep_config, shm, "shm")
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_ep_config, tcp, "tcp")
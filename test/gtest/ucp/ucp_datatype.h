@@ -13,6 +13,7 @@ extern "C" {
 #include <ucp/dt/dt_contig.h>
 #include <ucp/dt/dt_generic.h>
 #include <ucp/dt/dt_iov.h>
+#include <ucp/dt/dt_strided.h>
 }
 
 #include <string.h>
@@ -19,6 +19,7 @@ static const int   UCS_EVENT_SET_EXTRA_NUM    = 0xFF;
 
 enum {
     UCS_EVENT_SET_EXTERNAL_FD = UCS_BIT(0),
+    UCS_EVENT_SET_IO_URING    = UCS_BIT(1)
 };
 
 class test_event_set : public ucs::test_base,
@@ -96,11 +97,22 @@ protected:
 
         if (GetParam() & UCS_EVENT_SET_EXTERNAL_FD) {
             status = ucs_event_set_create_from_fd(&m_event_set, m_ext_fd);
+        } else if (GetParam() & UCS_EVENT_SET_IO_URING) {
+            status = ucs_event_set_create_backend(&m_event_set,
+                                                  UCS_EVENT_SET_BACKEND_IO_URING);
         } else {
             status = ucs_event_set_create(&m_event_set);
         }
         ASSERT_UCS_OK(status);
         EXPECT_TRUE(m_event_set != NULL);
+
+        if ((GetParam() & UCS_EVENT_SET_IO_URING) &&
+            (ucs_event_set_get_backend(m_event_set) !=
+             UCS_EVENT_SET_BACKEND_IO_URING)) {
+            thread_barrier();
+            event_set_cleanup();
+            UCS_TEST_SKIP_R("io_uring is not supported");
+        }
     }
 
     void event_set_cleanup() {
@@ -256,6 +268,31 @@ UCS_TEST_P(test_event_set, ucs_event_set_trig_modes) {
         event_set_wait(1u, 0, event_set_func4, NULL);
     }
 
+    if (GetParam() & UCS_EVENT_SET_IO_URING) {
+        /* Edge-triggered mode is not supported by io_uring backend */
+        scoped_log_handler wrap_err(wrap_errors_logger);
+        EXPECT_EQ(UCS_ERR_UNSUPPORTED,
+                  ucs_event_set_mod(m_event_set, m_pipefd[0],
+                                    (ucs_event_set_type_t)
+                                    (UCS_EVENT_SET_EVREAD |
+                                     UCS_EVENT_SET_EDGE_TRIGGERED),
+                                    (void*)(uintptr_t)m_pipefd[0]));
+        event_set_func1((void*)(uintptr_t)m_pipefd[0], UCS_EVENT_SET_EVREAD,
+                        arg);
+
+        /* The readiness which was reported before the data was consumed may
+         * still be pending, but after that there should be nothing to read */
+        unsigned nread = ucs_sys_event_set_max_wait_events;
+        EXPECT_UCS_OK(ucs_event_set_wait(m_event_set, &nread, 0,
+                                         event_set_func4, NULL));
+        EXPECT_LE(nread, 1u);
+        event_set_wait(0u, 0, event_set_func3, NULL);
+
+        event_set_ctl(EVENT_SET_OP_DEL, m_pipefd[0], 0);
+        event_set_cleanup();
+        return;
+    }
+
     /* Test edge-triggered mode */
     /* Set edge-triggered mode */
     event_set_ctl(EVENT_SET_OP_MOD, m_pipefd[0],
@@ -282,3 +319,6 @@ INSTANTIATE_TEST_CASE_P(ext_fd, test_event_set,
                         ::testing::Values(static_cast<int>(
                                               UCS_EVENT_SET_EXTERNAL_FD)));
 INSTANTIATE_TEST_CASE_P(int_fd, test_event_set, ::testing::Values(0));
+INSTANTIATE_TEST_CASE_P(io_uring, test_event_set,
+                        ::testing::Values(static_cast<int>(
+                                              UCS_EVENT_SET_IO_URING)));
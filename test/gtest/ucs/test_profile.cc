@@ -13,19 +13,24 @@ extern "C" {
 
 #include <pthread.h>
 #include <fstream>
+#include <map>
 
 #if HAVE_PROFILING
 
 class scoped_profile {
 public:
     scoped_profile(ucs::test_base& test, const std::string &file_name,
-                   const char *mode) : m_test(test), m_file_name(file_name)
+                   const char *mode, const char *log_size = NULL) :
+                   m_test(test), m_file_name(file_name)
 {
         ucs_profile_global_cleanup();
         ucs_profile_reset_locations();
         m_test.push_config();
         m_test.modify_config("PROFILE_MODE", mode);
         m_test.modify_config("PROFILE_FILE", m_file_name.c_str());
+        if (log_size != NULL) {
+            m_test.modify_config("PROFILE_LOG_SIZE", log_size);
+        }
         ucs_profile_global_init();
     }
 
@@ -87,6 +92,8 @@ protected:
                                unsigned exp_num_records, const void **ptr);
 
     void do_test(unsigned int_mode, const std::string& str_mode);
+
+    void do_stream_test(int iters, const char *log_size);
 };
 
 static int sum(int a, int b)
@@ -317,6 +324,102 @@ void test_profile::do_test(unsigned int_mode, const std::string& str_mode)
     EXPECT_EQ(&data[data.size()], ptr) << data.size();
 }
 
+void test_profile::do_stream_test(int iters, const char *log_size)
+{
+    typedef std::map<uint32_t, uint64_t> records_map_t;
+    typedef std::map<uint32_t, const ucs_profile_stream_thread_t*> threads_map_t;
+
+    const uint64_t exp_num_records = NUM_LOCAITONS * iters;
+    unsigned num_locations         = 0;
+    records_map_t thread_records;
+    threads_map_t thread_infos;
+
+    scoped_profile p(*this, PROFILE_FILENAME, "stream,accum", log_size);
+    run_profiled_code(iters);
+
+    std::string data = p.read();
+    const char *ptr  = &data[0];
+    const char *end  = ptr + data.size();
+
+    const ucs_profile_header_t *hdr =
+                    reinterpret_cast<const ucs_profile_header_t*>(ptr);
+    EXPECT_EQ(UCS_PROFILE_FILE_VERSION, hdr->version);
+    EXPECT_EQ(UCS_BIT(UCS_PROFILE_MODE_STREAM) |
+              UCS_BIT(UCS_PROFILE_MODE_ACCUM), hdr->mode);
+    EXPECT_EQ(0u, hdr->num_locations);
+    EXPECT_EQ(0u, hdr->num_threads);
+    ptr = reinterpret_cast<const char*>(hdr + 1);
+
+    while (ptr < end) {
+        const ucs_profile_chunk_header_t *chunk_hdr =
+                        reinterpret_cast<const ucs_profile_chunk_header_t*>(ptr);
+        ptr = reinterpret_cast<const char*>(chunk_hdr + 1);
+
+        switch (chunk_hdr->type) {
+        case UCS_PROFILE_CHUNK_LOCATIONS: {
+            const ucs_profile_location_t *locations =
+                            reinterpret_cast<const ucs_profile_location_t*>(ptr);
+            for (uint64_t i = 0; i < chunk_hdr->count; ++i) {
+                EXPECT_EQ(std::string(basename(__FILE__)),
+                          std::string(locations[i].file));
+            }
+            num_locations += chunk_hdr->count;
+            ptr = reinterpret_cast<const char*>(locations + chunk_hdr->count);
+            break;
+        }
+        case UCS_PROFILE_CHUNK_RECORDS: {
+            const ucs_profile_record_t *records =
+                            reinterpret_cast<const ucs_profile_record_t*>(ptr);
+            EXPECT_NE(m_tids.end(), m_tids.find(chunk_hdr->tid));
+            EXPECT_GT(chunk_hdr->count, 0u);
+            for (uint64_t i = 0; i < chunk_hdr->count; ++i) {
+                /* locations are written before the records which use them */
+                EXPECT_LT(records[i].location, num_locations);
+            }
+            thread_records[chunk_hdr->tid] += chunk_hdr->count;
+            ptr = reinterpret_cast<const char*>(records + chunk_hdr->count);
+            break;
+        }
+        case UCS_PROFILE_CHUNK_THREAD: {
+            const ucs_profile_stream_thread_t *thread_info =
+                      reinterpret_cast<const ucs_profile_stream_thread_t*>(ptr);
+            const ucs_profile_thread_location_t *locations =
+                      reinterpret_cast<const ucs_profile_thread_location_t*>
+                      (thread_info + 1);
+            EXPECT_EQ(chunk_hdr->tid, thread_info->super.tid);
+            EXPECT_LE(thread_info->super.start_time, thread_info->super.end_time);
+            EXPECT_EQ(num_locations, chunk_hdr->count);
+            for (uint64_t i = 0; i < chunk_hdr->count; ++i) {
+                EXPECT_EQ(uint64_t(iters), locations[i].count);
+            }
+            thread_infos[chunk_hdr->tid] = thread_info;
+            ptr = reinterpret_cast<const char*>(locations + chunk_hdr->count);
+            break;
+        }
+        default:
+            ADD_FAILURE() << "invalid chunk type " << chunk_hdr->type;
+            return;
+        }
+    }
+
+    EXPECT_EQ(end, ptr);
+    EXPECT_EQ(NUM_LOCAITONS, num_locations);
+    EXPECT_EQ(size_t(num_threads()), thread_infos.size());
+
+    for (threads_map_t::iterator iter = thread_infos.begin();
+         iter != thread_infos.end(); ++iter) {
+        const ucs_profile_stream_thread_t *thread_info = iter->second;
+        EXPECT_EQ(thread_records[iter->first], thread_info->super.num_records);
+        EXPECT_GT(thread_info->super.num_records, 0u);
+        EXPECT_EQ(exp_num_records,
+                  thread_info->super.num_records + thread_info->num_dropped);
+        if (thread_info->num_dropped > 0) {
+            UCS_TEST_MESSAGE << "thread " << iter->first << ": "
+                             << thread_info->num_dropped << " records dropped";
+        }
+    }
+}
+
 UCS_TEST_P(test_profile, accum) {
     do_test(UCS_BIT(UCS_PROFILE_MODE_ACCUM), "accum");
 }
@@ -330,6 +433,15 @@ UCS_TEST_P(test_profile, log_accum) {
             "log,accum");
 }
 
+UCS_TEST_P(test_profile, stream) {
+    do_stream_test(5, NULL);
+}
+
+UCS_TEST_P(test_profile, stream_small_log) {
+    /* a log of few records per chunk, to stream while the threads run */
+    do_stream_test(1000, "4k");
+}
+
 INSTANTIATE_TEST_CASE_P(st, test_profile, ::testing::Values(1));
 INSTANTIATE_TEST_CASE_P(mt, test_profile, ::testing::Values(2, 4, 8));
 
@@ -30,7 +30,9 @@ UCS_TEST_F(test_rcache_basic, create_fail) {
         UCS_BIT(30), /* non-existing event */
         1000,
         &ops,
-        NULL
+        NULL,
+        UCS_ULUNITS_INF,
+        UCS_MEMUNITS_INF
     };
 
     ucs_rcache_t *rcache;
@@ -57,6 +59,10 @@ protected:
 
     virtual void init() {
         ucs::test::init();
+        create_rcache();
+    }
+
+    void create_rcache() {
         static const ucs_rcache_ops_t ops = {
             mem_reg_cb,
             mem_dereg_cb,
@@ -69,7 +75,9 @@ protected:
             UCM_EVENT_VM_UNMAPPED,
             1000,
             &ops,
-            reinterpret_cast<void*>(this)
+            reinterpret_cast<void*>(this),
+            max_regions(),
+            max_size()
         };
         UCS_TEST_CREATE_HANDLE(ucs_rcache_t*, m_rcache, ucs_rcache_destroy,
                                ucs_rcache_create, &params, "test", ucs_stats_get_root());
@@ -81,6 +89,14 @@ protected:
         ucs::test::cleanup();
     }
 
+    virtual unsigned long max_regions() const {
+        return UCS_ULUNITS_INF;
+    }
+
+    virtual size_t max_size() const {
+        return UCS_MEMUNITS_INF;
+    }
+
     region *get(void *address, size_t length, int prot = PROT_READ|PROT_WRITE) {
         ucs_status_t status;
         ucs_rcache_region_t *r;
@@ -635,6 +651,238 @@ UCS_MT_TEST_F(test_rcache_no_register, merge_invalid_prot_slow, 5)
     munmap(mem, size1+size2);
 }
 
+class test_rcache_lru : public test_rcache {
+protected:
+    static const unsigned MAX_REGIONS = 4;
+
+    virtual unsigned long max_regions() const {
+        return MAX_REGIONS;
+    }
+};
+
+const unsigned test_rcache_lru::MAX_REGIONS;
+
+UCS_TEST_F(test_rcache_lru, evict_by_count) {
+    static const unsigned num_regions = MAX_REGIONS * 4;
+    const size_t page_size            = ucs_get_page_size();
+    /* leave a gap between the regions to prevent merging */
+    void *mem = alloc_pages(num_regions * 2 * page_size, PROT_READ|PROT_WRITE);
+
+    for (unsigned i = 0; i < num_regions; ++i) {
+        region *r = get(UCS_PTR_BYTE_OFFSET(mem, 2 * i * page_size), page_size);
+        put(r);
+        EXPECT_LE(m_reg_count, MAX_REGIONS);
+    }
+    EXPECT_EQ(MAX_REGIONS, m_reg_count);
+
+    munmap(mem, num_regions * 2 * page_size);
+}
+
+UCS_TEST_F(test_rcache_lru, evict_lru_order) {
+    const size_t page_size = ucs_get_page_size();
+    void *mem = alloc_pages((MAX_REGIONS + 1) * 2 * page_size,
+                            PROT_READ|PROT_WRITE);
+    std::vector<uint32_t> ids;
+
+    for (unsigned i = 0; i < MAX_REGIONS; ++i) {
+        region *r = get(UCS_PTR_BYTE_OFFSET(mem, 2 * i * page_size), page_size);
+        ids.push_back(r->id);
+        put(r);
+    }
+
+    /* access the first region, so the second one becomes the oldest */
+    region *r = get(mem, page_size);
+    EXPECT_EQ(ids[0], r->id);
+    put(r);
+
+    /* adding one more region should evict the second one */
+    r = get(UCS_PTR_BYTE_OFFSET(mem, 2 * MAX_REGIONS * page_size), page_size);
+    put(r);
+    EXPECT_EQ(MAX_REGIONS, m_reg_count);
+
+    r = get(mem, page_size);
+    EXPECT_EQ(ids[0], r->id);
+    put(r);
+
+    r = get(UCS_PTR_BYTE_OFFSET(mem, 2 * page_size), page_size);
+    EXPECT_NE(ids[1], r->id); /* registered again */
+    put(r);
+
+    munmap(mem, (MAX_REGIONS + 1) * 2 * page_size);
+}
+
+UCS_TEST_F(test_rcache_lru, inuse_not_evicted) {
+    static const unsigned num_regions = MAX_REGIONS * 2;
+    const size_t page_size            = ucs_get_page_size();
+    void *mem = alloc_pages(num_regions * 2 * page_size, PROT_READ|PROT_WRITE);
+    std::vector<region*> regions;
+
+    /* regions which are in use are kept even above the limit */
+    for (unsigned i = 0; i < num_regions; ++i) {
+        regions.push_back(get(UCS_PTR_BYTE_OFFSET(mem, 2 * i * page_size),
+                              page_size));
+    }
+    EXPECT_EQ(num_regions, m_reg_count);
+
+    /* the cache shrinks back once the regions are released */
+    for (unsigned i = 0; i < num_regions; ++i) {
+        EXPECT_EQ(uint32_t(MAGIC), regions[i]->magic);
+        put(regions[i]);
+    }
+    EXPECT_EQ(MAX_REGIONS, m_reg_count);
+
+    munmap(mem, num_regions * 2 * page_size);
+}
+
+class test_rcache_lru_size : public test_rcache {
+protected:
+    static const unsigned MAX_PAGES = 8;
+
+    virtual size_t max_size() const {
+        return MAX_PAGES * ucs_get_page_size();
+    }
+};
+
+const unsigned test_rcache_lru_size::MAX_PAGES;
+
+UCS_TEST_F(test_rcache_lru_size, evict_by_size) {
+    static const unsigned region_pages = 3;
+    static const unsigned num_regions  = 10;
+    const size_t page_size             = ucs_get_page_size();
+    const size_t stride                = (region_pages + 1) * page_size;
+    void *mem = alloc_pages(num_regions * stride, PROT_READ|PROT_WRITE);
+
+    for (unsigned i = 0; i < num_regions; ++i) {
+        region *r = get(UCS_PTR_BYTE_OFFSET(mem, i * stride),
+                        region_pages * page_size);
+        put(r);
+        EXPECT_LE(m_reg_count * region_pages, MAX_PAGES);
+    }
+    EXPECT_EQ(MAX_PAGES / region_pages, m_reg_count);
+
+    munmap(mem, num_regions * stride);
+}
+
+UCS_MT_TEST_F(test_rcache_lru, stress, 6) {
+    static const unsigned num_regions = 64;
+    const size_t page_size            = ucs_get_page_size();
+    const size_t size                 = num_regions * 2 * page_size;
+    void *mem                         = shared_malloc(size);
+    void *ptr = (void*)ucs_align_up_pow2((uintptr_t)mem, page_size);
+
+    for (int count = 0; count < 1000 / ucs::test_time_multiplier(); ++count) {
+        unsigned i = ucs::rand() % (num_regions - 1);
+        region *r  = get(UCS_PTR_BYTE_OFFSET(ptr, 2 * i * page_size), page_size);
+        EXPECT_EQ(uint32_t(MAGIC), r->magic);
+        put(r);
+    }
+
+    barrier();
+    EXPECT_LE(m_reg_count, MAX_REGIONS);
+    shared_free(mem);
+}
+
+class test_rcache_perf : public test_rcache {
+protected:
+    struct thread_arg {
+        test_rcache_perf  *test;
+        void              *ptr;
+        size_t            length;
+        pthread_barrier_t *barrier;
+        unsigned long     count;
+    };
+
+    static void *lookup_thread(void *arg) {
+        thread_arg *targ         = reinterpret_cast<thread_arg*>(arg);
+        const ucs_time_t timeout = ucs_time_from_sec(0.2 *
+                                                     ucs::test_time_multiplier());
+        ucs_rcache_region_t *r;
+        ucs_time_t end_time;
+        ucs_status_t status;
+
+        /* register the region before starting the measurement */
+        status = ucs_rcache_get(targ->test->m_rcache, targ->ptr, targ->length,
+                                PROT_READ|PROT_WRITE, NULL, &r);
+        EXPECT_UCS_OK(status);
+        ucs_rcache_region_put(targ->test->m_rcache, r);
+
+        pthread_barrier_wait(targ->barrier);
+
+        end_time = ucs_get_time() + timeout;
+        do {
+            for (unsigned i = 0; i < 1000; ++i) {
+                ucs_rcache_get(targ->test->m_rcache, targ->ptr, targ->length,
+                               PROT_READ|PROT_WRITE, NULL, &r);
+                ucs_rcache_region_put(targ->test->m_rcache, r);
+            }
+            targ->count += 1000;
+        } while (ucs_get_time() < end_time);
+
+        return NULL;
+    }
+
+    /* @return total number of lookups per second */
+    double measure(unsigned num_threads, void *mem) {
+        const size_t page_size = ucs_get_page_size();
+        std::vector<thread_arg> args(num_threads);
+        std::vector<pthread_t> threads(num_threads);
+        pthread_barrier_t barrier;
+        unsigned long count;
+        ucs_time_t start_time;
+
+        pthread_barrier_init(&barrier, NULL, num_threads + 1);
+        for (unsigned i = 0; i < num_threads; ++i) {
+            /* every thread uses its own region */
+            args[i].test    = this;
+            args[i].ptr     = UCS_PTR_BYTE_OFFSET(mem, 2 * i * page_size);
+            args[i].length  = page_size;
+            args[i].barrier = &barrier;
+            args[i].count   = 0;
+            pthread_create(&threads[i], NULL, lookup_thread, &args[i]);
+        }
+
+        pthread_barrier_wait(&barrier);
+        start_time = ucs_get_time();
+
+        count = 0;
+        for (unsigned i = 0; i < num_threads; ++i) {
+            pthread_join(threads[i], NULL);
+            count += args[i].count;
+        }
+
+        pthread_barrier_destroy(&barrier);
+        return count / ucs_time_to_sec(ucs_get_time() - start_time);
+    }
+};
+
+UCS_TEST_SKIP_COND_F(test_rcache_perf, lookup_mt,
+                     (ucs::test_time_multiplier() > 1)) {
+    static const char *modes[] = {"n", "y"};
+    const long num_cpus        = sysconf(_SC_NPROCESSORS_ONLN);
+    const unsigned max_threads = ucs_min(64, ucs_max(2, num_cpus));
+    const size_t size          = 2 * max_threads * ucs_get_page_size();
+    void *mem                  = alloc_pages(size, PROT_READ|PROT_WRITE);
+
+    for (unsigned num_threads = 1; num_threads <= max_threads;
+         num_threads *= 2) {
+        std::stringstream ss;
+        ss << num_threads << " threads:";
+        for (unsigned mode = 0; mode < ucs_array_size(modes); ++mode) {
+            m_rcache.reset();
+            modify_config("RCACHE_THREAD_CACHE", modes[mode]);
+            create_rcache();
+
+            double rate = measure(num_threads, mem);
+            EXPECT_GT(rate, 0);
+            ss << " thread_cache=" << modes[mode] << " " << std::fixed
+               << std::setprecision(2) << (rate / 1e6) << " Mlookups/sec";
+        }
+        UCS_TEST_MESSAGE << ss.str();
+    }
+
+    munmap(mem, size);
+}
+
 #if ENABLE_STATS
 class test_rcache_stats : public test_rcache {
 protected:
@@ -663,7 +911,7 @@ protected:
     /* a helper function for stats tests debugging */
     void dump_stats() {
         printf("gets %d hf %d hs %d misses %d merges %d unmaps %d"
-               " unmaps_inv %d puts %d regs %d deregs %d\n",
+               " unmaps_inv %d puts %d regs %d deregs %d evicts %d\n",
                get_counter(UCS_RCACHE_GETS),
                get_counter(UCS_RCACHE_HITS_FAST),
                get_counter(UCS_RCACHE_HITS_SLOW),
@@ -673,7 +921,8 @@ protected:
                get_counter(UCS_RCACHE_UNMAP_INVALIDATES),
                get_counter(UCS_RCACHE_PUTS),
                get_counter(UCS_RCACHE_REGS),
-               get_counter(UCS_RCACHE_DEREGS));
+               get_counter(UCS_RCACHE_DEREGS),
+               get_counter(UCS_RCACHE_EVICTS));
     }
 };
 
@@ -796,4 +1045,43 @@ UCS_TEST_F(test_rcache_stats, hits_slow) {
     put(r2);
     munmap(mem2, size1);
 }
+
+class test_rcache_stats_lru : public test_rcache_stats {
+protected:
+    virtual unsigned long max_regions() const {
+        return 1;
+    }
+};
+
+UCS_TEST_F(test_rcache_stats_lru, evict) {
+    const size_t page_size = ucs_get_page_size();
+    void *mem = alloc_pages(4 * page_size, PROT_READ|PROT_WRITE);
+    region *r1, *r2;
+
+    r1 = get(mem, page_size);
+    put(r1);
+    EXPECT_EQ(0, get_counter(UCS_RCACHE_EVICTS));
+
+    r1 = get(mem, page_size);
+    EXPECT_EQ(1, get_counter(UCS_RCACHE_HITS_FAST));
+    put(r1);
+
+    /* a new region evicts the unused one */
+    r2 = get(UCS_PTR_BYTE_OFFSET(mem, 2 * page_size), page_size);
+    EXPECT_EQ(1, get_counter(UCS_RCACHE_EVICTS));
+    EXPECT_EQ(1, get_counter(UCS_RCACHE_DEREGS));
+    EXPECT_EQ(2, get_counter(UCS_RCACHE_MISSES));
+
+    /* the evicted region is registered again, the region in use is kept
+     * until it's released */
+    r1 = get(mem, page_size);
+    EXPECT_EQ(3, get_counter(UCS_RCACHE_MISSES));
+    EXPECT_EQ(1, get_counter(UCS_RCACHE_EVICTS));
+
+    put(r2);
+    EXPECT_EQ(2, get_counter(UCS_RCACHE_EVICTS));
+    put(r1);
+
+    munmap(mem, 4 * page_size);
+}
 #endif
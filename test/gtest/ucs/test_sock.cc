@@ -152,6 +152,89 @@ UCS_TEST_F(test_socket, sockaddr_get_inet_addr) {
     }
 }
 
+UCS_TEST_F(test_socket, sockaddr_inet_addr_sizeof) {
+    struct sockaddr_in sa_in;
+    struct sockaddr_in6 sa_in6;
+    struct sockaddr_un sa_un;
+    size_t size;
+
+    sa_in.sin_family   = AF_INET;
+    sa_in6.sin6_family = AF_INET6;
+    sa_un.sun_family   = AF_UNIX;
+
+    /* Check with IPv4 */
+    {
+        size = 0;
+        EXPECT_UCS_OK(ucs_sockaddr_inet_addr_sizeof((const struct sockaddr*)&sa_in,
+                                                    &size));
+        EXPECT_EQ(sizeof(struct in_addr), size);
+    }
+
+    /* Check with IPv6 */
+    {
+        size = 0;
+        EXPECT_UCS_OK(ucs_sockaddr_inet_addr_sizeof((const struct sockaddr*)&sa_in6,
+                                                    &size));
+        EXPECT_EQ(sizeof(struct in6_addr), size);
+    }
+
+    /* Check with wrong address family */
+    {
+        socket_err_exp_str = "unknown address family:";
+        scoped_log_handler log_handler(socket_error_handler);
+
+        size = 0;
+        EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+                  ucs_sockaddr_inet_addr_sizeof((const struct sockaddr*)&sa_un,
+                                                &size));
+        /* Check that doesn't touch provided memory in error case */
+        EXPECT_EQ(0ULL, size);
+    }
+}
+
+UCS_TEST_F(test_socket, sockaddr_set_inet_addr) {
+    struct sockaddr_in sa_in;
+    struct sockaddr_in6 sa_in6;
+    struct sockaddr_un sa_un;
+    struct in_addr sin_addr;
+    struct in6_addr sin6_addr;
+
+    memset(&sa_in, 0, sizeof(sa_in));
+    memset(&sa_in6, 0, sizeof(sa_in6));
+    sa_in.sin_family   = AF_INET;
+    sa_in6.sin6_family = AF_INET6;
+    sa_un.sun_family   = AF_UNIX;
+
+    ASSERT_EQ(1, inet_pton(AF_INET, "192.168.1.1", &sin_addr));
+    ASSERT_EQ(1, inet_pton(AF_INET6, "fe80::218:e7ff:fe16:fb97", &sin6_addr));
+
+    /* Check with IPv4 */
+    {
+        EXPECT_UCS_OK(ucs_sockaddr_set_inet_addr((struct sockaddr*)&sa_in,
+                                                 &sin_addr));
+        EXPECT_EQ(0, memcmp(&sa_in.sin_addr, &sin_addr,
+                            sizeof(sa_in.sin_addr)));
+    }
+
+    /* Check with IPv6 */
+    {
+        EXPECT_UCS_OK(ucs_sockaddr_set_inet_addr((struct sockaddr*)&sa_in6,
+                                                 &sin6_addr));
+        EXPECT_EQ(0, memcmp(&sa_in6.sin6_addr, &sin6_addr,
+                            sizeof(sa_in6.sin6_addr)));
+    }
+
+    /* Check with wrong address family */
+    {
+        socket_err_exp_str = "unknown address family:";
+        scoped_log_handler log_handler(socket_error_handler);
+
+        EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+                  ucs_sockaddr_set_inet_addr((struct sockaddr*)&sa_un,
+                                             &sin_addr));
+    }
+}
+
 UCS_TEST_F(test_socket, sockaddr_str) {
     const uint16_t port        = 65534;
     const char *ipv4_addr      = "192.168.122.157";
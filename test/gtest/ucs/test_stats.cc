@@ -28,6 +28,8 @@ public:
         m_data_stats_class->counter_names[1] = "counter1";
         m_data_stats_class->counter_names[2] = "counter2";
         m_data_stats_class->counter_names[3] = "counter3";
+        m_data_stats_class->num_histograms   = NUM_HISTOGRAMS;
+        m_data_stats_class->histogram_names  = histogram_names;
     }
 
     ~stats_test() {
@@ -73,6 +75,10 @@ public:
             UCS_STATS_UPDATE_COUNTER(data_nodes[i], 1, 20);
             UCS_STATS_UPDATE_COUNTER(data_nodes[i], 2, 30);
             UCS_STATS_UPDATE_COUNTER(data_nodes[i], 3, 40);
+
+            UCS_STATS_UPDATE_HISTOGRAM(data_nodes[i], 0, 100);
+            UCS_STATS_UPDATE_HISTOGRAM(data_nodes[i], 0, 1000);
+            UCS_STATS_UPDATE_HISTOGRAM(data_nodes[i], 0, 10000);
         }
 
         /* make sure our original node is ok */
@@ -109,15 +115,35 @@ public:
             EXPECT_EQ((unsigned)20, data_node->counters[1]);
             EXPECT_EQ((unsigned)30, data_node->counters[2]);
             EXPECT_EQ((unsigned)40, data_node->counters[3]);
+
+            ASSERT_EQ(unsigned(NUM_HISTOGRAMS), data_node->cls->num_histograms);
+            EXPECT_EQ(std::string("histogram0"),
+                      std::string(data_node->cls->histogram_names[0]));
+
+            ucs_stats_histogram_data_t histogram;
+            ucs_stats_histogram_merge(&data_node->histograms[0], &histogram);
+            EXPECT_EQ(3u, histogram.count);
+            EXPECT_EQ(11100u, histogram.sum);
+            EXPECT_EQ(1u, histogram.buckets[ucs_stats_histogram_bucket(100)]);
+            EXPECT_EQ(1000u, ucs_stats_histogram_quantile(&histogram, 0.5) /
+                             1000 * 1000);
+            EXPECT_EQ(10000u, ucs_stats_histogram_quantile(&histogram, 1.0) /
+                              10000 * 10000);
         }
     }
 
 protected:    
     static const unsigned NUM_COUNTERS   = 4;
+    static const unsigned NUM_HISTOGRAMS = 1;
+    static const char     *histogram_names[];
 
     ucs_stats_class_t *m_data_stats_class;
+    ucs_stats_node_t  *m_mt_node;
 };
 
+const char *stats_test::histogram_names[] = { "histogram0" };
+
+
 class stats_udp_test : public stats_test {
 public:
     virtual void init() {
@@ -134,7 +160,7 @@ public:
     void wait_for_stats() {
         do {
             usleep(1000 * ucs::test_time_multiplier());
-        } while (ucs_stats_server_rcvd_packets(m_server) == 0);
+        } while (ucs_stats_server_rcvd_reports(m_server) == 0);
     }
 
     virtual std::string stats_dest_config() {
@@ -244,6 +270,10 @@ public:
                 pos = data.find(value, pos);
                 EXPECT_NE(pos, std::string::npos) << value << " not found";
             }
+
+            std::string histogram = "histogram0: count 3 avg 3700";
+            pos = data.find(histogram, pos);
+            EXPECT_NE(pos, std::string::npos) << histogram << " not found";
         }
         close_pipes();
     }
@@ -324,6 +354,67 @@ UCS_TEST_F(stats_on_exit_test, dump) {
     free_nodes(cat_node, data_nodes);
 }
 
+UCS_TEST_F(stats_on_demand_test, histogram_buckets) {
+    uint64_t value, prev_max;
+    unsigned bucket;
+
+    /* small values are exact */
+    for (value = 0; value < UCS_BIT(UCS_STATS_HISTOGRAM_SUB_BITS); ++value) {
+        EXPECT_EQ(value, ucs_stats_histogram_bucket(value));
+        EXPECT_EQ(value, ucs_stats_histogram_bucket_max(value));
+    }
+
+    /* buckets are contiguous, and every value falls into its bucket */
+    prev_max = UCS_BIT(UCS_STATS_HISTOGRAM_SUB_BITS) - 1;
+    for (bucket = UCS_BIT(UCS_STATS_HISTOGRAM_SUB_BITS);
+         bucket < UCS_STATS_HISTOGRAM_NUM_BUCKETS; ++bucket) {
+        value = ucs_stats_histogram_bucket_max(bucket);
+        EXPECT_GT(value, prev_max);
+        EXPECT_EQ(bucket, ucs_stats_histogram_bucket(prev_max + 1));
+        EXPECT_EQ(bucket, ucs_stats_histogram_bucket(value));
+        /* relative error is bounded by the number of sub-buckets */
+        EXPECT_LE((value - prev_max - 1) * UCS_BIT(UCS_STATS_HISTOGRAM_SUB_BITS),
+                  prev_max + 1);
+        prev_max = value;
+    }
+
+    EXPECT_EQ(UINT64_MAX, prev_max);
+}
+
+UCS_MT_TEST_F(stats_on_demand_test, mt_histogram, 10) {
+    static const unsigned count = 100000;
+    ucs_stats_node_t *node;
+    ucs_status_t status;
+
+    if (barrier()) {
+        status = UCS_STATS_NODE_ALLOC(&m_mt_node, m_data_stats_class,
+                                      ucs_stats_get_root(), "-mt");
+        ASSERT_UCS_OK(status);
+    }
+    barrier();
+
+    node = m_mt_node;
+    for (unsigned i = 0; i < count; ++i) {
+        UCS_STATS_UPDATE_HISTOGRAM(node, 0, i);
+    }
+    barrier();
+
+    if (barrier()) {
+        ucs_stats_histogram_data_t histogram;
+        uint64_t total = 0;
+
+        ucs_stats_histogram_merge(&node->histograms[0], &histogram);
+        EXPECT_EQ(uint64_t(num_threads()) * count, histogram.count);
+        EXPECT_EQ(uint64_t(num_threads()) * count * (count - 1) / 2,
+                  histogram.sum);
+        for (unsigned i = 0; i < UCS_STATS_HISTOGRAM_NUM_BUCKETS; ++i) {
+            total += histogram.buckets[i];
+        }
+        EXPECT_EQ(histogram.count, total);
+        UCS_STATS_NODE_FREE(node);
+    }
+}
+
 UCS_MT_TEST_F(stats_file_test, mt_add_remove, 10) {
     ucs_stats_node_t       *cat_node;
     ucs_stats_node_t       *data_nodes[NUM_DATA_NODES] = {NULL};
@@ -10,6 +10,7 @@ extern "C" {
 #include <ucs/time/timerq.h>
 }
 
+#include <map>
 #include <time.h>
 
 class test_time : public ucs::test {
@@ -143,3 +144,68 @@ UCS_TEST_F(test_time, timerq) {
 }
 
 
+
+UCS_TEST_F(test_time, timerq_many) {
+    static const int NUM_TIMERS = 1000;
+
+    ucs_timer_queue_t timerq;
+    std::map<int, ucs_time_t> intervals;
+    ucs_status_t status;
+    ucs_timer_t *timer;
+
+    status = ucs_timerq_init(&timerq);
+    ASSERT_UCS_OK(status);
+
+    for (int id = 0; id < NUM_TIMERS; ++id) {
+        intervals[id] = (ucs::rand() % 1000) + 1;
+        status        = ucs_timerq_add(&timerq, id, intervals[id]);
+        ASSERT_UCS_OK(status);
+    }
+
+    status = ucs_timerq_add(&timerq, 0, 1);
+    EXPECT_EQ(UCS_ERR_ALREADY_EXISTS, status);
+
+    /* remove random half of the timers */
+    for (int id = 0; id < NUM_TIMERS; id += (ucs::rand() % 3) + 1) {
+        status = ucs_timerq_remove(&timerq, id);
+        ASSERT_UCS_OK(status);
+        intervals.erase(id);
+    }
+
+    EXPECT_EQ(UCS_ERR_NO_ELEM, ucs_timerq_remove(&timerq, NUM_TIMERS));
+    EXPECT_EQ((int)intervals.size(), ucs_timerq_size(&timerq));
+
+    ucs_time_t min_interval = UCS_TIME_INFINITY;
+    for (std::map<int, ucs_time_t>::iterator it = intervals.begin();
+         it != intervals.end(); ++it) {
+        min_interval = std::min(min_interval, it->second);
+    }
+    EXPECT_EQ(min_interval, ucs_timerq_min_interval(&timerq));
+
+    /* new timers expire immediately, then every timer expires once per its
+     * interval */
+    ucs_time_t current_time = 1;
+    std::map<int, unsigned> counters;
+    EXPECT_EQ(0u, ucs_timerq_next_expiration(&timerq));
+    for (unsigned count = 0; count < 10000; ++count, ++current_time) {
+        ucs_timerq_for_each_expired(timer, &timerq, current_time, {
+            ASSERT_TRUE(intervals.find(timer->id) != intervals.end());
+            EXPECT_EQ(current_time + intervals[timer->id], timer->expiration);
+            ++counters[timer->id];
+        })
+        EXPECT_GT(ucs_timerq_next_expiration(&timerq), current_time);
+    }
+
+    for (std::map<int, ucs_time_t>::iterator it = intervals.begin();
+         it != intervals.end(); ++it) {
+        EXPECT_NEAR(10000 / it->second, counters[it->first], 1)
+            << "timer " << it->first << " interval " << it->second;
+        status = ucs_timerq_remove(&timerq, it->first);
+        ASSERT_UCS_OK(status);
+    }
+
+    EXPECT_TRUE(ucs_timerq_is_empty(&timerq));
+    EXPECT_EQ(UCS_TIME_INFINITY, ucs_timerq_next_expiration(&timerq));
+    EXPECT_EQ(UCS_TIME_INFINITY, ucs_timerq_min_interval(&timerq));
+    ucs_timerq_cleanup(&timerq);
+}
@@ -9,23 +9,203 @@ extern "C" {
 #include <ucs/sys/topo.h>
 }
 
+#include <fstream>
+#include <sys/stat.h>
+
+
+/* Runs the topology discovery over a fake sysfs tree with two NUMA nodes and
+ * a network interface backed by a PCI device on the second node */
 class test_topo : public ucs::test {
+protected:
+    virtual void init() {
+        ucs::test::init();
+
+        char tmpl[] = "/tmp/ucx_test_topo_XXXXXX";
+        ASSERT_TRUE(mkdtemp(tmpl) != NULL);
+        m_root = tmpl;
+
+        add_numa_node(0, "0-3\n",     "10 21\n");
+        add_numa_node(1, "4-7,16\n",  "21 10\n");
+
+        add_pci_device("0000:00:02.0", "devices/pci0000:00/0000:00:02.0", 0);
+        add_pci_device("0000:03:00.0",
+                       "devices/pci0000:00/0000:00:02.0/0000:03:00.0", 1);
+        add_pci_device("0000:81:00.1", "devices/pci0000:80/0000:81:00.1", -1);
+
+        /* eth0 is backed by a PCI device, lo is virtual */
+        make_dir("class/net/eth0");
+        make_link("class/net/eth0/device",
+                  "../../../devices/pci0000:00/0000:00:02.0/0000:03:00.0");
+        make_dir("class/net/lo");
+
+        ASSERT_UCS_OK(ucs_topo_discover(m_root.c_str()));
+    }
+
+    virtual void cleanup() {
+        ucs_topo_discover("/sys");
+        if (!m_root.empty()) {
+            std::string cmd = "rm -rf " + m_root;
+            EXPECT_EQ(0, system(cmd.c_str()));
+        }
+        ucs::test::cleanup();
+    }
+
+    void make_dir(const std::string& path) {
+        std::string full_path = m_root;
+        size_t pos            = 0;
+
+        while (pos != std::string::npos) {
+            pos        = path.find('/', pos + 1);
+            full_path  = m_root + "/" + path.substr(0, pos);
+            mkdir(full_path.c_str(), 0755);
+        }
+    }
+
+    void write_file(const std::string& path, const std::string& contents) {
+        std::ofstream file((m_root + "/" + path).c_str());
+        file << contents;
+    }
+
+    void make_link(const std::string& path, const std::string& target) {
+        ASSERT_EQ(0, symlink(target.c_str(), (m_root + "/" + path).c_str()));
+    }
+
+    void add_numa_node(int node, const std::string& cpulist,
+                       const std::string& distance) {
+        std::string dir = "devices/system/node/node" + ucs::to_string(node);
+
+        make_dir(dir);
+        write_file(dir + "/cpulist", cpulist);
+        write_file(dir + "/distance", distance);
+    }
+
+    void add_pci_device(const std::string& bus_id, const std::string& dev_dir,
+                        int numa_node) {
+        make_dir(dev_dir);
+        write_file(dev_dir + "/numa_node", ucs::to_string(numa_node) + "\n");
+        make_dir("bus/pci/devices");
+        make_link("bus/pci/devices/" + bus_id, "../../../" + dev_dir);
+    }
+
+    static const ucs_sys_device_t *find_device(uint16_t domain, uint8_t bus,
+                                               uint8_t slot, uint8_t function) {
+        const ucs_sys_device_t *sys_dev;
+        ucs_sys_bus_id_t bus_id;
+
+        bus_id.domain   = domain;
+        bus_id.bus      = bus;
+        bus_id.slot     = slot;
+        bus_id.function = function;
+        if (ucs_topo_find_device_by_bus_id(&bus_id, &sys_dev) != UCS_OK) {
+            return NULL;
+        }
+
+        return sys_dev;
+    }
+
+    std::string m_root;
 };
 
 UCS_TEST_F(test_topo, find_device_by_bus_id) {
-    ucs_status_t status;
+    const ucs_sys_device_t *sys_dev;
+
+    sys_dev = find_device(0, 0x03, 0, 0);
+    ASSERT_TRUE(sys_dev != NULL);
+    EXPECT_EQ(1, sys_dev->numa_node);
+    EXPECT_EQ(0x03, sys_dev->bus_id.bus);
 
-    status = ucs_topo_find_device_by_bus_id(NULL, NULL);
-    ASSERT_UCS_OK(status);
+    sys_dev = find_device(0, 0x00, 2, 0);
+    ASSERT_TRUE(sys_dev != NULL);
+    EXPECT_EQ(0, sys_dev->numa_node);
+
+    sys_dev = find_device(0, 0x81, 0, 1);
+    ASSERT_TRUE(sys_dev != NULL);
+    EXPECT_EQ(-1, sys_dev->numa_node);
+
+    /* device indices are unique */
+    EXPECT_NE(find_device(0, 0x03, 0, 0)->id, find_device(0, 0, 2, 0)->id);
+
+    EXPECT_TRUE(find_device(0, 0x04, 0, 0) == NULL);
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, ucs_topo_find_device_by_bus_id(NULL, NULL));
+}
+
+UCS_TEST_F(test_topo, find_device_by_sysfs_path) {
+    const ucs_sys_device_t *sys_dev;
+
+    ASSERT_UCS_OK(ucs_topo_find_device_by_sysfs_path("class/net/eth0",
+                                                     &sys_dev));
+    EXPECT_EQ(find_device(0, 0x03, 0, 0), sys_dev);
+
+    EXPECT_EQ(UCS_ERR_NO_ELEM,
+              ucs_topo_find_device_by_sysfs_path("class/net/lo", &sys_dev));
+    EXPECT_EQ(UCS_ERR_NO_ELEM,
+              ucs_topo_find_device_by_sysfs_path("class/net/none", &sys_dev));
+}
+
+UCS_TEST_F(test_topo, numa_node_of_cpu) {
+    EXPECT_EQ(0,  ucs_topo_numa_node_of_cpu(0));
+    EXPECT_EQ(0,  ucs_topo_numa_node_of_cpu(3));
+    EXPECT_EQ(1,  ucs_topo_numa_node_of_cpu(4));
+    EXPECT_EQ(1,  ucs_topo_numa_node_of_cpu(7));
+    EXPECT_EQ(1,  ucs_topo_numa_node_of_cpu(16));
+    EXPECT_EQ(-1, ucs_topo_numa_node_of_cpu(8));
+    EXPECT_EQ(-1, ucs_topo_numa_node_of_cpu(-1));
 }
 
 UCS_TEST_F(test_topo, get_distance) {
-    ucs_status_t status;
+    const ucs_sys_device_t *dev_node0 = find_device(0, 0x00, 2, 0);
+    const ucs_sys_device_t *dev_node1 = find_device(0, 0x03, 0, 0);
+    const ucs_sys_device_t *dev_none  = find_device(0, 0x81, 0, 1);
+    ucs_sys_dev_distance_t distance;
+
+    ASSERT_TRUE((dev_node0 != NULL) && (dev_node1 != NULL) && (dev_none != NULL));
 
-    status = ucs_topo_get_distance(NULL, NULL, NULL);
-    ASSERT_UCS_OK(status);
+    ASSERT_UCS_OK(ucs_topo_get_distance(dev_node1, dev_node1, &distance));
+    EXPECT_EQ(0, distance.latency);
+    EXPECT_GT(distance.bandwidth, 1e12);
+
+    ASSERT_UCS_OK(ucs_topo_get_distance(dev_node0, dev_node1, &distance));
+    EXPECT_NEAR(11 * 20e-9, distance.latency, 1e-12);
+    EXPECT_NEAR(20e9 * 10 / 11, distance.bandwidth, 1);
+
+    /* symmetric distance table */
+    ucs_sys_dev_distance_t reverse;
+    ASSERT_UCS_OK(ucs_topo_get_distance(dev_node1, dev_node0, &reverse));
+    EXPECT_EQ(distance.latency, reverse.latency);
+
+    /* unknown location is considered local */
+    ASSERT_UCS_OK(ucs_topo_get_distance(dev_none, dev_node0, &distance));
+    EXPECT_EQ(0, distance.latency);
+
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              ucs_topo_get_distance(dev_node0, dev_node1, NULL));
 }
 
 UCS_TEST_F(test_topo, print_info) {
-    ucs_topo_print_info(NULL);
+    char *data;
+    size_t size;
+
+    FILE *f = open_memstream(&data, &size);
+    ucs_topo_print_info(f);
+    fclose(f);
+
+    std::string info(data, size);
+    free(data);
+
+    UCS_TEST_MESSAGE << info;
+    EXPECT_NE(std::string::npos, info.find("NUMA nodes: 2"));
+    EXPECT_NE(std::string::npos, info.find("4-7,16"));
+    EXPECT_NE(std::string::npos, info.find(" 21  10"));
+    EXPECT_NE(std::string::npos, info.find("PCI devices: 3"));
+    EXPECT_NE(std::string::npos, info.find("0000:03:00.0 numa node 1"));
+}
+
+UCS_TEST_F(test_topo, missing_sysfs) {
+    const ucs_sys_device_t *sys_dev;
+
+    ASSERT_UCS_OK(ucs_topo_discover((m_root + "/none").c_str()));
+    EXPECT_TRUE(find_device(0, 0x03, 0, 0) == NULL);
+    EXPECT_EQ(-1, ucs_topo_numa_node_of_cpu(0));
+    EXPECT_EQ(UCS_ERR_NO_ELEM,
+              ucs_topo_find_device_by_sysfs_path("class/net/eth0", &sys_dev));
 }
@@ -11,6 +11,9 @@ extern "C" {
 
 #include <time.h>
 
+/* range of timer deltas used by the tests, in wheel resolution units */
+#define N_SLOTS 1024
+
 /**
  * note: the fast timer precision is dependent on context switch latency!!!
  * expected timer precision 2x wheel resolution plus some time for processing and
@@ -29,7 +32,18 @@ protected:
         twheel       *self;
     };
 
+    /* timer used for the accuracy and latency measurements */
+    struct bench_timer {
+        ucs_wtimer_t timer;
+        uint64_t     expiration;  /* expected expiration tick */
+        int          fired;
+        twheel       *self;
+    };
+
     ucs_twheel_t m_wheel;
+    uint64_t     m_prev_target;   /* tick of the previous sweep */
+    uint64_t     m_target;        /* tick of the current sweep */
+    size_t       m_fired;
 
     // @override
     virtual void init();
@@ -43,6 +57,9 @@ protected:
     void init_timer(struct hr_timer *t, int id);
     void init_timerv(struct hr_timer *v, int n);
     void set_timer_delta(struct hr_timer *t, int how);
+    static void bench_timer_func(ucs_wtimer_t *self);
+    void bench_timer_expired(struct bench_timer *t);
+    void bench(size_t num_timers, uint64_t max_ticks);
 };
 
 void twheel::init()
@@ -101,23 +118,23 @@ void twheel::set_timer_delta(struct hr_timer *t, int how)
         break;
     case 1:
         /* last */
-        slot = m_wheel.num_slots - 1;
+        slot = N_SLOTS - 1;
         break;
     case 2:
         /* middle */
-        slot = m_wheel.num_slots / 2;
+        slot = N_SLOTS / 2;
         break;
     case -2:
         /* overflow */
-        slot = m_wheel.num_slots + (ucs::rand() % 1000000);
+        slot = N_SLOTS + (ucs::rand() % 1000000);
         break;
     default:
-        slot = 1 + ucs::rand() % (m_wheel.num_slots - 2);
+        slot = 1 + ucs::rand() % (N_SLOTS - 2);
         break;
     }
 
     if (how == -2) {
-        t->d = m_wheel.res + m_wheel.res * (m_wheel.num_slots - 1) / 2;
+        t->d = m_wheel.res + m_wheel.res * (N_SLOTS - 1) / 2;
     } else {
         t->d = m_wheel.res + m_wheel.res * slot / 2;
     }
@@ -173,7 +190,7 @@ UCS_TEST_SKIP_COND_F(twheel, precision_multi, true) {
     do {
         now = ucs_get_time();
         ucs_twheel_sweep(&m_wheel, now);
-    } while (now < start + m_wheel.res * m_wheel.num_slots);
+    } while (now < start + m_wheel.res * N_SLOTS);
 
     /* all timers should ve been triggered
      * correct delta
@@ -239,3 +256,144 @@ UCS_TEST_F(twheel, delayed_sweep) {
     }
 }
 
+
+
+void twheel::bench_timer_func(ucs_wtimer_t *self)
+{
+    struct bench_timer *t = ucs_container_of(self, struct bench_timer, timer);
+    t->self->bench_timer_expired(t);
+}
+
+void twheel::bench_timer_expired(struct bench_timer *t)
+{
+    /* the timer must expire in the first sweep which reaches its tick */
+    EXPECT_GT(t->expiration, m_prev_target);
+    EXPECT_LE(t->expiration, m_target);
+    EXPECT_EQ(0, t->fired);
+    ++t->fired;
+    ++m_fired;
+}
+
+/*
+ * Add timers with random deltas of up to max_ticks, and sweep the wheel with
+ * a virtual clock which advances by random steps. Check every timer fires
+ * exactly once, in the first sweep past its expiration, and report the sweep
+ * latency.
+ */
+void twheel::bench(size_t num_timers, uint64_t max_ticks)
+{
+    std::vector<struct bench_timer> timers(num_timers);
+    ucs_time_t res          = m_wheel.res;
+    ucs_time_t current_time = ucs_get_time();
+    ucs_time_t start, elapsed, max_elapsed, total_elapsed;
+    uint64_t ticks, last_expiration;
+    size_t num_sweeps;
+    ucs_twheel_t wheel;
+
+    ASSERT_UCS_OK(ucs_twheel_init(&wheel, res, current_time));
+
+    start           = ucs_get_time();
+    last_expiration = 0;
+    for (size_t i = 0; i < num_timers; ++i) {
+        ticks                  = 1 + (ucs::rand() % max_ticks);
+        timers[i].expiration   = (current_time >> wheel.res_order) + ticks;
+        timers[i].fired        = 0;
+        timers[i].self         = this;
+        last_expiration        = std::max(last_expiration,
+                                          timers[i].expiration);
+        ucs_wtimer_init(&timers[i].timer, bench_timer_func);
+        ASSERT_UCS_OK(ucs_wtimer_add(&wheel, &timers[i].timer, ticks * res));
+    }
+    elapsed = ucs_get_time() - start;
+
+    UCS_TEST_MESSAGE << num_timers << " timers: add "
+                     << ucs_time_to_nsec(elapsed) / num_timers
+                     << " nsec/timer";
+
+    m_fired       = 0;
+    m_target      = current_time >> wheel.res_order;
+    num_sweeps    = 0;
+    max_elapsed   = 0;
+    total_elapsed = 0;
+    do {
+        /* advance by up to 1/1000 of the range, so most steps are small */
+        current_time   += res * (1 + (ucs::rand() % ((max_ticks / 1000) + 1)));
+        m_prev_target   = m_target;
+        m_target        = current_time >> wheel.res_order;
+
+        start           = ucs_get_time();
+        ucs_twheel_sweep(&wheel, current_time);
+        elapsed         = ucs_get_time() - start;
+
+        max_elapsed     = std::max(max_elapsed, elapsed);
+        total_elapsed  += elapsed;
+        ++num_sweeps;
+    } while (m_target < last_expiration);
+
+    UCS_TEST_MESSAGE << num_timers << " timers: " << num_sweeps
+                     << " sweeps, average "
+                     << ucs_time_to_usec(total_elapsed) / num_sweeps
+                     << " usec, max " << ucs_time_to_usec(max_elapsed)
+                     << " usec";
+
+    EXPECT_EQ(num_timers, m_fired);
+    for (size_t i = 0; i < num_timers; ++i) {
+        EXPECT_EQ(1, timers[i].fired) << "timer " << i;
+        EXPECT_FALSE(timers[i].timer.is_active);
+    }
+
+    /* sweeping a long idle period must skip the empty slots */
+    start = ucs_get_time();
+    ucs_twheel_sweep(&wheel, current_time + (res * UCS_TWHEEL_MAX_TICKS));
+    elapsed = ucs_get_time() - start;
+    UCS_TEST_MESSAGE << "idle sweep: " << ucs_time_to_usec(elapsed) << " usec";
+
+    ucs_twheel_cleanup(&wheel);
+}
+
+UCS_TEST_F(twheel, bench_10k) {
+    bench(10000, N_SLOTS);
+    bench(10000, UCS_TWHEEL_MAX_TICKS / 2);
+}
+
+UCS_TEST_SKIP_COND_F(twheel, bench_1m, RUNNING_ON_VALGRIND) {
+    bench(1000000, N_SLOTS);
+    bench(1000000, UCS_TWHEEL_MAX_TICKS / 2);
+}
+
+UCS_TEST_F(twheel, remove_cascade) {
+    std::vector<struct bench_timer> timers(1000);
+    ucs_time_t current_time = ucs_get_time();
+    ucs_twheel_t wheel;
+    uint64_t ticks;
+
+    ASSERT_UCS_OK(ucs_twheel_init(&wheel, m_wheel.res, current_time));
+
+    for (size_t i = 0; i < timers.size(); ++i) {
+        ticks                = 1 + (ucs::rand() % (UCS_TWHEEL_MAX_TICKS / 64));
+        timers[i].expiration = (current_time >> wheel.res_order) + ticks;
+        timers[i].fired      = 0;
+        timers[i].self       = this;
+        ucs_wtimer_init(&timers[i].timer, bench_timer_func);
+        ASSERT_UCS_OK(ucs_wtimer_add(&wheel, &timers[i].timer,
+                                     ticks * wheel.res));
+    }
+
+    /* remove every other timer, the others must still fire on time */
+    for (size_t i = 0; i < timers.size(); i += 2) {
+        ucs_wtimer_remove(&timers[i].timer);
+    }
+
+    m_fired       = 0;
+    m_prev_target = current_time >> wheel.res_order;
+    current_time += wheel.res * UCS_TWHEEL_MAX_TICKS;
+    m_target      = current_time >> wheel.res_order;
+    ucs_twheel_sweep(&wheel, current_time);
+
+    EXPECT_EQ(timers.size() / 2, m_fired);
+    for (size_t i = 0; i < timers.size(); ++i) {
+        EXPECT_EQ((int)(i % 2), timers[i].fired) << "timer " << i;
+    }
+
+    ucs_twheel_cleanup(&wheel);
+}
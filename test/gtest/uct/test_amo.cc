@@ -116,9 +116,10 @@ void uct_amo_test::validate_replies(const std::vector<uint64_t>& exp_replies) {
 }
 
 void uct_amo_test::wait_for_remote() {
-    for (unsigned i = 0; i < num_senders(); ++i) {
-        sender(i).flush();
-    }
+    /* Call flush on all ifaces to progress data (e.g. if call flush only on
+     * senders, a receiver may not be able to execute the operations and send
+     * ACKs in case of TCP) */
+    flush();
 }
 
 void uct_amo_test::run_workers(send_func_t send, const mapped_buffer& recvbuf,
@@ -132,6 +133,12 @@ void uct_amo_test::run_workers(send_func_t send, const mapped_buffer& recvbuf,
     }
 
     for (unsigned i = 0; i < num_senders(); ++i) {
+        /* The receiver may have to progress to execute the operations and
+         * let the senders proceed (e.g. TCP), the senders are progressed by
+         * the worker threads */
+        while (!m_workers.at(i).finished) {
+            receiver().progress();
+        }
         m_workers.at(i).join();
     }
 }
@@ -139,7 +146,7 @@ void uct_amo_test::run_workers(send_func_t send, const mapped_buffer& recvbuf,
 uct_amo_test::worker::worker(uct_amo_test* test, send_func_t send,
                              const mapped_buffer& recvbuf, const entity& entity,
                              uint64_t initial_value, bool advance) :
-    test(test), value(initial_value), count(0), running(true),
+    test(test), value(initial_value), count(0), running(true), finished(false),
     m_send(send), m_advance(advance), m_recvbuf(recvbuf), m_entity(entity)
 
 {
@@ -191,6 +198,8 @@ void uct_amo_test::worker::run() {
             value = hash64(value);
         }
     }
+
+    finished = true;
 }
 
 void uct_amo_test::worker::join() {
@@ -62,7 +62,8 @@ public:
                const mapped_buffer& recvbuf,
                const entity& entity, uct_atomic_op_t op, uint32_t* error) :
             test(test), value(0), result32(0), result64(0),
-            error(error), running(true), op(op), m_send(send), m_recv(recv),
+            error(error), running(true), finished(false), op(op),
+            m_send(send), m_recv(recv),
             m_recvbuf(recvbuf), m_entity(entity) {
             pthread_create(&m_thread, NULL, run, reinterpret_cast<void*>(this));
         }
@@ -105,6 +106,7 @@ public:
         uint64_t result64;
         uint32_t* error;
         bool running;
+        volatile bool finished;
         uct_atomic_op_t op;
 
     private:
@@ -123,10 +125,15 @@ public:
                 }
                 value = local_val;
 
-                (test->*m_send)(m_entity.ep(0), *this, m_recvbuf);
+                while ((test->*m_send)(m_entity.ep(0), *this, m_recvbuf) ==
+                       UCS_ERR_NO_RESOURCE) {
+                    m_entity.progress();
+                }
                 uct_ep_fence(m_entity.ep(0), 0);
-                (test->*m_recv)(m_entity.ep(0), *this,
-                                m_recvbuf, &uct_comp);
+                while ((test->*m_recv)(m_entity.ep(0), *this, m_recvbuf,
+                                       &uct_comp) == UCS_ERR_NO_RESOURCE) {
+                    m_entity.progress();
+                }
                 m_entity.flush();
 
                 uint64_t result = (m_recvbuf.length() == sizeof(uint32_t)) ?
@@ -139,6 +146,8 @@ public:
                 result32 = 0;
                 result64 = 0;
             }
+
+            finished = true;
         }
 
         send_func_t m_send;
@@ -155,6 +164,11 @@ public:
         m_workers.clear();
         m_workers.push_back(new worker(this, send, recv, recvbuf,
                                        sender(), OP, error));
+        /* The receiver may have to progress to execute the operations
+         * (e.g. TCP), the sender is progressed by the worker thread */
+        while (!m_workers.at(0).finished) {
+            receiver().progress();
+        }
         m_workers.at(0).join();
         m_workers.clear();
     }
@@ -8,6 +8,7 @@
 
 extern "C" {
 #include <ucs/arch/atomic.h>
+#include <ucs/time/time.h>
 }
 
 class test_many2one_am : public uct_test {
@@ -170,4 +171,204 @@ UCS_TEST_SKIP_COND_P(test_many2one_am, am_bcopy,
     buffers.clear();
 }
 
-UCT_INSTANTIATE_NO_SELF_TEST_CASE(test_many2one_am)
+class test_many2one_am_incast : public test_many2one_am {
+public:
+    static const unsigned NUM_INCAST_SENDERS = 32;
+
+    struct pending_send {
+        uct_pending_req_t uct;
+        uct_ep_h          ep;
+        uint64_t          hdr;
+    };
+
+    static uint64_t am_hdr(unsigned sender, unsigned sn) {
+        return (uint64_t(sender) << 32) | sn;
+    }
+
+    static ucs_status_t pending_send_cb(uct_pending_req_t *self) {
+        pending_send *req = ucs_container_of(self, pending_send, uct);
+        return uct_ep_am_short(req->ep, AM_ID, req->hdr, NULL, 0);
+    }
+
+    static ucs_status_t am_incast_handler(void *arg, void *data, size_t length,
+                                          unsigned flags) {
+        test_many2one_am_incast *self =
+                        reinterpret_cast<test_many2one_am_incast*>(arg);
+        uint64_t hdr = *(uint64_t*)data;
+        unsigned sender = hdr >> 32;
+
+        EXPECT_EQ(sizeof(hdr), length);
+        /* messages from every sender must arrive in order */
+        EXPECT_EQ(self->m_next_sn.at(sender), unsigned(hdr & UCS_MASK(32)));
+        self->m_next_sn.at(sender)++;
+        ++self->m_am_count;
+        return UCS_OK;
+    }
+
+    /* All senders post their messages at once, so the receive FIFO is full
+     * most of the time and the messages which do not fit are sent from the
+     * pending queue */
+    void incast_am_short(unsigned num_sends) {
+        std::vector<pending_send> reqs(NUM_INCAST_SENDERS * num_sends);
+        std::vector<unsigned> sn(NUM_INCAST_SENDERS, 0);
+        std::vector<bool> is_pending(NUM_INCAST_SENDERS, false);
+        unsigned num_posted = 0;
+        ucs_status_t status;
+
+        for (unsigned i = 0; i < NUM_INCAST_SENDERS; ++i) {
+            entity *sender = create_entity(0);
+            sender->connect(0, *m_receiver, i);
+            m_entities.push_back(sender);
+        }
+
+        m_am_count = 0;
+        m_next_sn.assign(NUM_INCAST_SENDERS, 0);
+
+        status = uct_iface_set_am_handler(m_receiver->iface(), AM_ID,
+                                          am_incast_handler, (void*)this, 0);
+        ASSERT_UCS_OK(status);
+
+        ucs_time_t start_time = ucs_get_time();
+
+        while (num_posted < (NUM_INCAST_SENDERS * num_sends)) {
+            for (unsigned i = 0; i < NUM_INCAST_SENDERS; ++i) {
+                if (sn[i] == num_sends) {
+                    continue;
+                }
+
+                uct_ep_h ep  = ent(i + 1).ep(0);
+                uint64_t hdr = am_hdr(i, sn[i]);
+
+                if (!is_pending[i]) {
+                    status = uct_ep_am_short(ep, AM_ID, hdr, NULL, 0);
+                    if (status == UCS_OK) {
+                        ++sn[i];
+                        ++num_posted;
+                        continue;
+                    }
+                    ASSERT_EQ(UCS_ERR_NO_RESOURCE, status);
+                }
+
+                /* once a message of the sender is pending, the following ones
+                 * are added to the pending queue as well to keep the order */
+                pending_send &req = reqs[(i * num_sends) + sn[i]];
+                req.uct.func      = pending_send_cb;
+                req.ep            = ep;
+                req.hdr           = hdr;
+                status = uct_ep_pending_add(ep, &req.uct, 0);
+                if (status == UCS_ERR_BUSY) {
+                    /* resources became available, and the previous pending
+                     * requests were sent */
+                    is_pending[i] = false;
+                    continue;
+                }
+                ASSERT_UCS_OK(status);
+                is_pending[i] = true;
+                ++sn[i];
+                ++num_posted;
+            }
+
+            progress();
+        }
+
+        while (m_am_count < (NUM_INCAST_SENDERS * num_sends)) {
+            progress();
+        }
+
+        double elapsed = ucs_time_to_sec(ucs_get_time() - start_time);
+        UCS_TEST_MESSAGE << NUM_INCAST_SENDERS << " senders: "
+                         << (m_am_count / elapsed / 1e6) << " Mpps";
+
+        status = uct_iface_set_am_handler(m_receiver->iface(), AM_ID,
+                                          NULL, NULL, 0);
+        ASSERT_UCS_OK(status);
+
+        for (unsigned i = 0; i < NUM_INCAST_SENDERS; ++i) {
+            ent(i + 1).flush();
+        }
+    }
+
+protected:
+    std::vector<unsigned> m_next_sn;
+};
+
+UCS_TEST_SKIP_COND_P(test_many2one_am_incast, am_short,
+                     !check_caps(UCT_IFACE_FLAG_AM_SHORT |
+                                 UCT_IFACE_FLAG_PENDING  |
+                                 UCT_IFACE_FLAG_CB_SYNC))
+{
+    incast_am_short(20000 / ucs::test_time_multiplier());
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_many2one_am_incast, posix)
+_UCT_INSTANTIATE_TEST_CASE(test_many2one_am_incast, sysv)
+_UCT_INSTANTIATE_TEST_CASE(test_many2one_am_incast, xpmem)
+
+
+class test_many2one_am_incast_spsc : public test_many2one_am_incast {
+public:
+    static const unsigned NUM_RINGS = NUM_INCAST_SENDERS / 2;
+
+    void init() {
+        /* half of the senders use dedicated rings, and the rest use the
+         * shared FIFO */
+        modify_config("SPSC_RINGS", ucs::to_string(NUM_RINGS));
+        test_many2one_am_incast::init();
+    }
+};
+
+UCS_TEST_P(test_many2one_am_incast_spsc, am_short)
+{
+    incast_am_short(20000 / ucs::test_time_multiplier());
+}
+
+UCS_TEST_P(test_many2one_am_incast_spsc, ring_reuse)
+{
+    const unsigned num_senders = NUM_RINGS + 2;
+    const unsigned num_sends   = 10;
+    std::vector<entity*> senders;
+    ucs_status_t status;
+
+    for (unsigned i = 0; i < num_senders; ++i) {
+        senders.push_back(create_entity(0));
+        m_entities.push_back(senders.back());
+    }
+
+    m_next_sn.assign(num_senders, 0);
+    status = uct_iface_set_am_handler(m_receiver->iface(), AM_ID,
+                                      am_incast_handler, (void*)this, 0);
+    ASSERT_UCS_OK(status);
+
+    m_am_count = 0;
+    for (unsigned round = 0; round < 4; ++round) {
+        for (unsigned i = 0; i < num_senders; ++i) {
+            senders[i]->connect(0, *m_receiver, i);
+        }
+
+        for (unsigned i = 0; i < num_senders; ++i) {
+            for (unsigned j = 0; j < num_sends; ++j) {
+                uint64_t hdr = am_hdr(i, (round * num_sends) + j);
+                ASSERT_UCS_OK(uct_ep_am_short(senders[i]->ep(0), AM_ID, hdr,
+                                              NULL, 0));
+            }
+        }
+
+        /* release the rings before the receiver reads the messages, which
+         * should still be delivered */
+        for (unsigned i = 0; i < num_senders; ++i) {
+            senders[i]->destroy_ep(0);
+        }
+
+        while (m_am_count < ((round + 1) * num_senders * num_sends)) {
+            progress();
+        }
+    }
+
+    status = uct_iface_set_am_handler(m_receiver->iface(), AM_ID, NULL, NULL,
+                                      0);
+    ASSERT_UCS_OK(status);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_many2one_am_incast_spsc, posix)
+_UCT_INSTANTIATE_TEST_CASE(test_many2one_am_incast_spsc, sysv)
+_UCT_INSTANTIATE_TEST_CASE(test_many2one_am_incast_spsc, xpmem)
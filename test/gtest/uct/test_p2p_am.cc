@@ -8,6 +8,8 @@
 
 #include <string>
 #include <vector>
+#include <ifaddrs.h>
+#include <netinet/in.h>
 
 class uct_p2p_am_test : public uct_p2p_test
 {
@@ -552,6 +554,87 @@ UCS_TEST_SKIP_COND_P(uct_p2p_am_test, am_zcopy,
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_test)
 
+class uct_p2p_am_msg_zcopy : public uct_p2p_am_test
+{
+public:
+    virtual void init() {
+        /* send the payload of all Zcopy operations with MSG_ZEROCOPY */
+        modify_config("MSG_ZCOPY_THRESH", "1");
+        uct_p2p_am_test::init();
+    }
+};
+
+UCS_TEST_SKIP_COND_P(uct_p2p_am_msg_zcopy, am_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_AM_ZCOPY,
+                                 UCT_IFACE_FLAG_AM_DUP)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_zcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_zcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_msg_zcopy, tcp)
+
+class uct_p2p_am_inet6 : public uct_p2p_am_test
+{
+public:
+    virtual void init() {
+        if (!has_inet6_addr(GetParam()->dev_name)) {
+            UCS_TEST_SKIP_R(GetParam()->dev_name + " doesn't have IPv6 address");
+        }
+
+        modify_config("AF_PRIO", "inet6");
+        uct_p2p_am_test::init();
+    }
+
+private:
+    static bool has_inet6_addr(const std::string& dev_name) {
+        struct ifaddrs *ifaddrs, *ifa;
+        bool found = false;
+
+        if (getifaddrs(&ifaddrs) != 0) {
+            return false;
+        }
+
+        for (ifa = ifaddrs; (ifa != NULL) && !found; ifa = ifa->ifa_next) {
+            found = (ifa->ifa_addr != NULL) &&
+                    (ifa->ifa_addr->sa_family == AF_INET6) &&
+                    (dev_name == ifa->ifa_name) &&
+                    !IN6_IS_ADDR_LINKLOCAL(&((struct sockaddr_in6*)
+                                             ifa->ifa_addr)->sin6_addr);
+        }
+
+        freeifaddrs(ifaddrs);
+        return found;
+    }
+};
+
+UCS_TEST_P(uct_p2p_am_inet6, address) {
+    /* the device address carries the address family and IPv6 address */
+    EXPECT_EQ(sizeof(sa_family_t) + sizeof(struct in6_addr),
+              sender().iface_attr().device_addr_len);
+}
+
+UCS_TEST_SKIP_COND_P(uct_p2p_am_inet6, am_bcopy,
+                     !check_caps(UCT_IFACE_FLAG_AM_BCOPY,
+                                 UCT_IFACE_FLAG_AM_DUP)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_bcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_bcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+UCS_TEST_SKIP_COND_P(uct_p2p_am_inet6, am_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_AM_ZCOPY,
+                                 UCT_IFACE_FLAG_AM_DUP)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_zcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_zcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_inet6, tcp)
+
 const unsigned uct_p2p_am_misc::RX_MAX_BUFS  = 1024; /* due to hard coded 'grow'
                                                         parameter in uct_ib_iface_recv_mpool_init */
 const unsigned uct_p2p_am_misc::RX_QUEUE_LEN = 64;
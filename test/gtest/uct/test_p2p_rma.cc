@@ -134,3 +134,68 @@ UCS_TEST_SKIP_COND_P(uct_p2p_rma_test, get_zcopy,
 }
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_test)
+
+class uct_p2p_rma_msg_zcopy : public uct_p2p_rma_test {
+public:
+    virtual void init() {
+        /* send the payload of all Zcopy operations with MSG_ZEROCOPY */
+        modify_config("MSG_ZCOPY_THRESH", "1");
+        uct_p2p_rma_test::init();
+    }
+};
+
+UCS_TEST_SKIP_COND_P(uct_p2p_rma_msg_zcopy, put_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_PUT_ZCOPY)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::put_zcopy),
+                    0ul, sender().iface_attr().cap.put.max_zcopy,
+                    TEST_UCT_FLAG_SEND_ZCOPY);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_msg_zcopy, tcp)
+
+class uct_p2p_rma_stripes : public uct_p2p_rma_test {
+public:
+    virtual void init() {
+        /* split all PUT Zcopy operations over stripe connections */
+        modify_config("STRIPES", "4");
+        modify_config("STRIPE_THRESH", "1");
+        uct_p2p_rma_test::init();
+    }
+};
+
+UCS_TEST_SKIP_COND_P(uct_p2p_rma_stripes, put_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_PUT_ZCOPY)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::put_zcopy),
+                    0ul, sender().iface_attr().cap.put.max_zcopy,
+                    TEST_UCT_FLAG_SEND_ZCOPY);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_stripes, tcp)
+
+class uct_p2p_rma_copy_threads : public uct_p2p_rma_test {
+public:
+    virtual void init() {
+        /* split all large Zcopy operations between the helper threads */
+        modify_config("COPY_THREADS", "3");
+        modify_config("COPY_THRESH", "64k");
+        modify_config("COPY_MIN_CHUNK", "4k");
+        uct_p2p_rma_test::init();
+    }
+};
+
+UCS_TEST_SKIP_COND_P(uct_p2p_rma_copy_threads, put_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_PUT_ZCOPY)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::put_zcopy),
+                    0ul, sender().iface_attr().cap.put.max_zcopy,
+                    TEST_UCT_FLAG_SEND_ZCOPY);
+}
+
+UCS_TEST_SKIP_COND_P(uct_p2p_rma_copy_threads, get_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_GET_ZCOPY)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::get_zcopy),
+                    ucs_max(1ull, sender().iface_attr().cap.get.min_zcopy),
+                    sender().iface_attr().cap.get.max_zcopy,
+                    TEST_UCT_FLAG_RECV_ZCOPY);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_copy_threads, cma)
@@ -172,3 +172,32 @@ UCS_TEST_P(test_uct_perf, envelope) {
 }
 
 UCT_INSTANTIATE_NO_SELF_TEST_CASE(test_uct_perf);
+
+
+class test_uct_perf_tcp_stripes : public test_uct_perf {
+};
+
+UCS_TEST_P(test_uct_perf_tcp_stripes, put_zcopy_bw) {
+    static const unsigned stripes[] = { 1, 2, 4 };
+    test_spec test = { NULL, "MB/sec",
+                       UCX_PERF_API_UCT, UCX_PERF_CMD_PUT,
+                       UCX_PERF_TEST_TYPE_STREAM_UNI,
+                       UCT_PERF_DATA_LAYOUT_ZCOPY, 0, 1, { 4 * UCS_MBYTE }, 4,
+                       200lu,
+                       ucs_offsetof(ucx_perf_result_t, bandwidth.total_average),
+                       MB, 0.0, 0.0, 0 };
+
+    /* Report the bandwidth of large PUT Zcopy over a different number of
+     * sockets, the performance depends on the host, so it isn't enforced */
+    for (size_t i = 0; i < ucs_static_array_size(stripes); ++i) {
+        std::string title = "put zcopy bw, " +
+                            ucs::to_string(stripes[i]) + " sockets";
+        ucs::scoped_setenv env("UCX_TCP_STRIPES",
+                               ucs::to_string(stripes[i]).c_str());
+
+        test.title = title.c_str();
+        run_test(test, 0, false, GetParam()->tl_name, GetParam()->dev_name);
+    }
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_uct_perf_tcp_stripes, tcp)